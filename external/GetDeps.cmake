@@ -79,6 +79,13 @@ target_compile_definitions(GLFWPP INTERFACE GLFW_INCLUDE_NONE)
 add_library(glfwpp::glfwpp ALIAS GLFWPP)
 
 
+# === EGL ===
+# OpenGL::EGL
+if (JOSH3D_HEADLESS_EGL)
+    find_package(OpenGL REQUIRED COMPONENTS EGL)
+endif()
+
+
 # === glm ===
 # glm::glm
 find_package(glm CONFIG REQUIRED)
@@ -37,6 +37,9 @@
 #include "stages/precompute/TransformResolution.hpp"
 #include "stages/precompute/BoundingVolumeResolution.hpp"
 #include "stages/precompute/FrustumCulling.hpp"
+#include "stages/precompute/InstanceGrouping.hpp"
+#include "stages/precompute/LODSelection.hpp"
+#include "stages/precompute/MipSelection.hpp"
 #include "stages/primary/CascadedShadowMapping.hpp"
 #include "stages/primary/PointShadowMapping.hpp"
 #include "stages/primary/SSAO.hpp"
@@ -123,8 +126,10 @@ void DemoScene::update()
 {
     ZS;
     update_input_blocker_from_imgui_io_state();
+    apply_pending_pick();
 
-    runtime.async_cradle.local_context.flush_nonblocking();
+    // Time-sliced, so that bursts of local tasks (ex. scene unpacking) are spread over frames.
+    runtime.async_cradle.local_context.flush_budgeted();
 
     // TODO: Can this be removed too?
     runtime.resource_database.update();
@@ -164,6 +169,8 @@ void DemoScene::update()
 
     if (shader_pool().supports_hot_reload())
         shader_pool().hot_reload();
+
+    shader_pool().update();
 }
 
 DemoScene::DemoScene(
@@ -187,6 +194,9 @@ DemoScene::DemoScene(
     ADD_STAGE(Precompute,  TransformResolution     );
     ADD_STAGE(Precompute,  BoundingVolumeResolution);
     ADD_STAGE(Precompute,  FrustumCulling          );
+    ADD_STAGE(Precompute,  LODSelection            );
+    ADD_STAGE(Precompute,  MipSelection            );
+    ADD_STAGE(Precompute,  InstanceGrouping        );
     ADD_STAGE(Precompute,  AnimationSystem         );
     ADD_STAGE(Primary,     PointShadowMapping      );
     ADD_STAGE(Primary,     CascadedShadowMapping   );
@@ -214,6 +224,9 @@ DemoScene::DemoScene(
     _imgui.stage_hooks.add_hook(imguihooks::Type());
 
     HOOK_STAGE(PointLightSetup      );
+    HOOK_STAGE(LODSelection         );
+    HOOK_STAGE(MipSelection         );
+    HOOK_STAGE(InstanceGrouping     );
     HOOK_STAGE(PointShadowMapping   );
     HOOK_STAGE(CascadedShadowMapping);
     HOOK_STAGE(DeferredGeometry     );
@@ -247,6 +260,11 @@ DemoScene::~DemoScene() noexcept
     // NOTE: We have to drain tasks manually before destruction
     // of any of the class members, since some of the tasks might
     // depend on those members being alive.
+    //
+    // The loaders parked on the LOD hints or the texture residency
+    // would never finish otherwise.
+    runtime.resource_loader.lod_hints().set_enabled(false);
+    runtime.resource_loader.texture_residency().stop();
     usize tasks_drained = -1;
     do
     {
@@ -282,15 +300,13 @@ void DemoScene::configure_input()
         {
             // Bail if there's no ID buffer to peek at.
             if (not runtime.renderer.belt.has<IDBuffer>()) return;
+            if (not runtime.renderer.belt.has<IDPicker>()) return;
 
-            auto& registry = runtime.registry;
             auto& idbuffer = runtime.renderer.belt.get<IDBuffer>();
+            auto& picker   = runtime.renderer.belt.get<IDPicker>();
 
             if (args.is_pressed())
             {
-                const bool select_exact = args.mods & glfw::ModifierKeyBit::Control;
-                const bool toggle_mode  = args.mods & glfw::ModifierKeyBit::Shift;
-
                 // NOTE: Cursor position is in window coordinates, but we need
                 // the IDBuffer pixels, whoose resolution is syncronized with the
                 // main target, so we'll have to convert.
@@ -303,65 +319,16 @@ void DemoScene::configure_input()
                     return { int(uv.x * double(w_tgt)), int(uv.y * double(h_tgt)) };
                 };
 
-                entt::id_type id{ entt::null };
-
                 // FIXME: Is this off-by-one?
                 const Region2I target_pixel = { target_offset, { 1, 1 } };
-                const auto     pdformat     = PixelDataFormat::RedInteger;
-                const auto     pdtype       = PixelDataType::UInt;
-
-                // NOTE: This is a guaranteed way to get a stall, but we
-                // don't really care since it's not really noticeable.
-                // But it does show up as a nasty spike on the framegraph.
-                idbuffer.object_id_texture().download_image_region_into(
-                    target_pixel, pdformat, pdtype, make_span(&id, 1));
-
-                Handle provoking_handle = { registry, Entity(id) };
-
-                // Either the click intersected null value (background),
-                // or something else has destroyed the entity after
-                // the ID buffer was generated on the previous frame.
-                // (Can this even happen? Either way, bail if so.)
-                if (not provoking_handle.valid())
-                {
-                    if (toggle_mode)
-                    {
-                        // If we are in the toggle mode, then do nothing.
-                    }
-                    else /* unique mode */
-                    {
-                        // Otherwise we probably want to deselect all current selections.
-                        registry.clear<Selected>();
-                    }
-                    return;
-                }
 
-                Handle target_handle = eval%[&]() -> Handle {
-                    if (select_exact)
-                    {
-                        // Select mesh same id as returned.
-                        return provoking_handle;
-                    }
-                    else /* select root */
-                    {
-                        // Select the root of the tree if the mesh has parents.
-                        // This will just return itself, if it has no parents.
-                        return get_root_handle(provoking_handle);
-                    }
-                };
-
-                if (toggle_mode)
-                {
-                    // We add to current selection if not selected,
-                    // and deselect if it was. Don't touch others.
-                    switch_tag<Selected>(target_handle);
-                }
-                else /* unique mode */
-                {
-                    // We deselect all others, and force select target.
-                    registry.clear<Selected>();
-                    set_tag<Selected>(target_handle);
-                }
+                // NOTE: The result comes back a frame or two later, see update().
+                // A newer click just replaces the older one, if it's still in flight.
+                _pending_pick.emplace(PendingPick{
+                    .result       = picker.pick(idbuffer.object_id_texture(), target_pixel),
+                    .select_exact = bool(args.mods & glfw::ModifierKeyBit::Control),
+                    .toggle_mode  = bool(args.mods & glfw::ModifierKeyBit::Shift),
+                });
             }
         });
 
@@ -438,6 +405,65 @@ void DemoScene::init_registry()
     make_active<Camera>(camera_handle);
 }
 
+void DemoScene::apply_pending_pick()
+{
+    if (not _pending_pick or not _pending_pick->result.is_available())
+        return;
+
+    PendingPick pick = MOVE(*_pending_pick);
+    _pending_pick.reset();
+
+    auto&                  registry = runtime.registry;
+    const IDPicker::Result result   = get_result(MOVE(pick.result));
+
+    const Entity provoking_entity = result.entities.empty() ? nullent : result.entities.front();
+    Handle provoking_handle = { registry, provoking_entity };
+
+    // Either the click intersected null value (background),
+    // or something else has destroyed the entity after
+    // the ID buffer was generated a few frames ago.
+    if (not provoking_handle.valid())
+    {
+        if (pick.toggle_mode)
+        {
+            // If we are in the toggle mode, then do nothing.
+        }
+        else /* unique mode */
+        {
+            // Otherwise we probably want to deselect all current selections.
+            registry.clear<Selected>();
+        }
+        return;
+    }
+
+    Handle target_handle = eval%[&]() -> Handle {
+        if (pick.select_exact)
+        {
+            // Select mesh same id as returned.
+            return provoking_handle;
+        }
+        else /* select root */
+        {
+            // Select the root of the tree if the mesh has parents.
+            // This will just return itself, if it has no parents.
+            return get_root_handle(provoking_handle);
+        }
+    };
+
+    if (pick.toggle_mode)
+    {
+        // We add to current selection if not selected,
+        // and deselect if it was. Don't touch others.
+        switch_tag<Selected>(target_handle);
+    }
+    else /* unique mode */
+    {
+        // We deselect all others, and force select target.
+        registry.clear<Selected>();
+        set_tag<Selected>(target_handle);
+    }
+}
+
 void DemoScene::update_input_blocker_from_imgui_io_state()
 {
     auto wants = _imgui.get_io_wants();
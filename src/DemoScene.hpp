@@ -3,8 +3,10 @@
 #include "ImGuiApplicationAssembly.hpp"
 #include "Input.hpp"
 #include "InputFreeCamera.hpp"
+#include "IDPicker.hpp"
 #include "Semantics.hpp"
 #include <glfwpp/window.h>
+#include <optional>
 #include <ostream>
 
 
@@ -40,9 +42,20 @@ struct DemoScene
 
     josh::ImGuiApplicationAssembly _imgui;
 
+    // Selection click that is waiting for the IDBuffer readback.
+    struct PendingPick
+    {
+        josh::Future<josh::IDPicker::Result> result;
+        bool select_exact;
+        bool toggle_mode;
+    };
+
+    std::optional<PendingPick> _pending_pick;
+
 private:
     void configure_input();
     void init_registry();
+    void apply_pending_pick();
     void update_input_blocker_from_imgui_io_state();
 };
 
@@ -0,0 +1,530 @@
+#include "Active.hpp"
+#include "AggregateTimer.hpp"
+#include "AssetManager.hpp"
+#include "AssetUnpacker.hpp"
+#include "Camera.hpp"
+#include "ECS.hpp"
+#include "Filesystem.hpp"
+#include "FrameTimer.hpp"
+#include "GLAPICore.hpp"
+#include "GLUtils.hpp"
+#include "GlobalContext.hpp"
+#include "HeadlessContext.hpp"
+#include "LightCasters.hpp"
+#include "Logging.hpp"
+#include "NumericLimits.hpp"
+#include "PerfHarness.hpp"
+#include "Ranges.hpp"
+#include "Runtime.hpp"
+#include "ShaderPool.hpp"
+#include "Tags.hpp"
+#include "Time.hpp"
+#include "TimeHistogram.hpp"
+#include "TraceCapture.hpp"
+#include "Transform.hpp"
+#include "VPath.hpp"
+#include "VirtualFilesystem.hpp"
+#include "async/ThreadAttributes.hpp"
+#include "components/ShadowCasting.hpp"
+#include "default/Resources.hpp"
+#include "stages/precompute/AnimationSystem.hpp"
+#include "stages/precompute/PointLightSetup.hpp"
+#include "stages/precompute/TransformResolution.hpp"
+#include "stages/precompute/BoundingVolumeResolution.hpp"
+#include "stages/precompute/FrustumCulling.hpp"
+#include "stages/precompute/InstanceGrouping.hpp"
+#include "stages/precompute/LODSelection.hpp"
+#include "stages/precompute/MipSelection.hpp"
+#include "stages/primary/CascadedShadowMapping.hpp"
+#include "stages/primary/PointShadowMapping.hpp"
+#include "stages/primary/SSAO.hpp"
+#include "stages/primary/GBufferStorage.hpp"
+#include "stages/primary/DeferredGeometry.hpp"
+#include "stages/primary/SkinnedGeometry.hpp"
+#include "stages/primary/TerrainGeometry.hpp"
+#include "stages/primary/DeferredShading.hpp"
+#include "stages/primary/LightDummies.hpp"
+#include "stages/primary/Sky.hpp"
+#include "stages/postprocess/FXAA.hpp"
+#include "stages/postprocess/HDREyeAdaptation.hpp"
+#include "stages/postprocess/Fog.hpp"
+#include "stages/postprocess/BloomAW.hpp"
+#include <glbinding/glbinding.h>
+#include <glm/ext.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cxxopts.hpp>
+#include <fmt/format.h>
+#include <fmt/os.h>
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <numbers>
+#include <optional>
+#include <string>
+#include <vector>
+
+
+/*
+Renders a scene without a window for a fixed number of frames along a scripted
+camera path, then reports the per-stage timings from the PerfAssembly.
+
+Meant for automated benchmarks and regression runs on machines without a display,
+for example, on CI with Mesa llvmpipe. Requires a build with JOSH3D_HEADLESS_EGL.
+*/
+
+
+static auto get_cli_options()
+    -> cxxopts::Options
+{
+    cxxopts::Options options{ "josh3d-headless", "Headless frame benchmark for the josh3d rendering engine." };
+
+    options.add_options()
+        (
+            "vroots",
+            "Root directories for the VFS to use as base when resolving Virtual Paths",
+            cxxopts::value<std::vector<std::string>>()
+        )
+        (
+            "scene",
+            "Virtual Path of the model to render",
+            cxxopts::value<std::string>()->default_value("data/models/shadow_scene/shadow_scene.obj")
+        )
+        (
+            "frames",
+            "Number of measured frames",
+            cxxopts::value<size_t>()->default_value("600")
+        )
+        (
+            "warmup",
+            "Number of frames rendered before the measurements start",
+            cxxopts::value<size_t>()->default_value("60")
+        )
+        (
+            "width",
+            "Width of the main target",
+            cxxopts::value<int>()->default_value("1280")
+        )
+        (
+            "height",
+            "Height of the main target",
+            cxxopts::value<int>()->default_value("720")
+        )
+        (
+            "orbit-radius",
+            "Radius of the camera orbit around the origin",
+            cxxopts::value<float>()->default_value("8")
+        )
+        (
+            "orbit-height",
+            "Height of the camera orbit above the origin",
+            cxxopts::value<float>()->default_value("3")
+        )
+        (
+            "stats-output",
+            "Output path of the per-stage timings in CSV, empty to only print them",
+            cxxopts::value<std::string>()->default_value("josh3d-stats.csv")
+        )
+        (
+            "log-gl-errors",
+            "Enable logging of OpenGL errors",
+            cxxopts::value<bool>()->default_value("true")
+        )
+        (
+            "trace-frames",
+            "Capture a trace of the first N measured frames and write it in the Chrome trace format",
+            cxxopts::value<size_t>()
+        )
+        (
+            "trace-output",
+            "Output path of the trace captured with --trace-frames",
+            cxxopts::value<std::string>()->default_value("josh3d-trace.json")
+        )
+        (
+            "shader-cache",
+            "Directory of the on-disk cache of the linked shader programs, empty to disable",
+            cxxopts::value<std::string>()->default_value(".josh3d/shader_cache/")
+        )
+        (
+            "h,help",
+            "Print help and exit"
+        )
+    ;
+
+    return options;
+}
+
+static auto try_parse_cli_args(cxxopts::Options& options, int argc, const char* argv[])
+    -> std::optional<cxxopts::ParseResult>
+{
+    try
+    {
+        return options.parse(argc, argv);
+    }
+    catch (const cxxopts::exceptions::parsing& e)
+    {
+        std::cerr
+            << e.what()       << "\n"
+            << options.help() << "\n";
+            return std::nullopt;
+    }
+}
+
+
+using namespace josh;
+
+
+static void build_pipeline(Runtime& runtime)
+{
+    auto& pipeline      = runtime.renderer.pipeline;
+    auto& perf_assembly = runtime.perf_assembly;
+
+#define ADD_STAGE(Kind, Type)               \
+    pipeline.push(StageKind::Kind, Type()); \
+    perf_assembly.instrument({ .type=type_id<Type>() }, GPUTiming::Enabled)
+
+    // Same as the demo, but without the ID buffer and the overlays,
+    // since there is nothing to pick from or to present to.
+    ADD_STAGE(Precompute,  PointLightSetup         );
+    ADD_STAGE(Precompute,  TransformResolution     );
+    ADD_STAGE(Precompute,  BoundingVolumeResolution);
+    ADD_STAGE(Precompute,  FrustumCulling          );
+    ADD_STAGE(Precompute,  LODSelection            );
+    ADD_STAGE(Precompute,  MipSelection            );
+    ADD_STAGE(Precompute,  InstanceGrouping        );
+    ADD_STAGE(Precompute,  AnimationSystem         );
+    ADD_STAGE(Primary,     PointShadowMapping      );
+    ADD_STAGE(Primary,     CascadedShadowMapping   );
+    ADD_STAGE(Primary,     GBufferStorage          );
+    ADD_STAGE(Primary,     DeferredGeometry        );
+    ADD_STAGE(Primary,     SkinnedGeometry         );
+    ADD_STAGE(Primary,     TerrainGeometry         );
+    ADD_STAGE(Primary,     SSAO                    );
+    ADD_STAGE(Primary,     DeferredShading         );
+    ADD_STAGE(Primary,     LightDummies            );
+    ADD_STAGE(Primary,     Sky                     );
+    ADD_STAGE(Postprocess, Fog                     );
+    ADD_STAGE(Postprocess, BloomAW                 );
+    ADD_STAGE(Postprocess, HDREyeAdaptation        );
+    ADD_STAGE(Postprocess, FXAA                    );
+
+#undef ADD_STAGE
+}
+
+static auto init_registry(Runtime& runtime, const VPath& model_vpath, const Extent2I& resolution)
+    -> Handle
+{
+    auto& registry = runtime.registry;
+
+    const Handle alight_handle = create_handle(registry);
+    alight_handle.emplace<AmbientLight>(AmbientLight{ .color = { 0.15f, 0.15f, 0.1f } });
+    make_active<AmbientLight>(alight_handle);
+
+    const Handle dlight_handle      = create_handle(registry);
+    const quat   dlight_orientation = glm::quatLookAt(vec3{ -0.2f, -1.f, -0.3f }, { 0.f, 1.f, 0.f });
+    dlight_handle.emplace<DirectionalLight>(DirectionalLight{ .color = { 0.15f, 0.15f, 0.1f } });
+    dlight_handle.emplace<Transform>(Transform().rotate(dlight_orientation));
+    set_tag<ShadowCasting>(dlight_handle);
+    make_active<DirectionalLight>(dlight_handle);
+
+    const AssetPath model_apath = { File(model_vpath), {} };
+
+    const Handle model_handle = create_handle(registry);
+    model_handle.emplace<Transform>();
+    runtime.asset_unpacker.submit_model_for_unpacking(model_handle, runtime.asset_manager.load_model(model_apath));
+    runtime.asset_unpacker.wait_until_all_pending_are_complete(runtime.asset_manager);
+
+    const Handle camera_handle = create_handle(registry);
+    const Camera::Params camera_params = {
+        .fovy_rad     = glm::radians(80.f),
+        .aspect_ratio = resolution.aspect_ratio(),
+        .z_near       = 0.1f,
+        .z_far        = 500.f,
+    };
+    camera_handle.emplace<Camera>(camera_params);
+    camera_handle.emplace<Transform>();
+    make_active<Camera>(camera_handle);
+
+    return camera_handle;
+}
+
+// Same as the per-frame update of the demo, minus the input and the GUI.
+static void update(Runtime& runtime)
+{
+    runtime.async_cradle.local_context.flush_budgeted();
+    runtime.resource_database.update();
+    runtime.asset_manager.update();
+
+    runtime.asset_unpacker.retire_completed_requests();
+    while (runtime.asset_unpacker.can_unpack_more())
+    {
+        Handle unpacked_handle;
+        try
+        {
+            runtime.asset_unpacker.unpack_one_retired(unpacked_handle);
+        }
+        catch (const std::exception& e)
+        {
+            logstream() << "[ERROR UNPACKING ASSET]: [" << to_entity(unpacked_handle.entity()) << "] " << e.what() << "\n";
+        }
+    }
+
+    shader_pool().update();
+}
+
+// Full orbit around the origin over `num_frames`. Depends only on the
+// frame index, so that every run renders exactly the same sequence.
+static void place_camera(Transform& transform, usize frame, usize num_frames, float radius, float height)
+{
+    const float angle = 2.f * std::numbers::pi_v<float> * float(frame) / float(std::max(num_frames, usize(1)));
+    const vec3  position = { radius * std::cos(angle), height, radius * std::sin(angle) };
+    transform.position()    = position;
+    transform.orientation() = glm::quatLookAt(normalize(-position), { 0.f, 1.f, 0.f });
+}
+
+static void drain_local_tasks(Runtime& runtime)
+{
+    runtime.resource_loader.lod_hints().set_enabled(false);
+    runtime.resource_loader.texture_residency().stop();
+    usize tasks_drained = -1;
+    do
+    {
+        try
+        {
+            tasks_drained = runtime.async_cradle.local_context.drain_all_tasks();
+        }
+        catch (const std::exception& e)
+        {
+            logstream() << "[ERROR]:" << e.what() << '\n';
+        }
+    }
+    while (tasks_drained != 0);
+}
+
+static auto to_ms(TimeDeltaNS dt) -> double { return dt.to_seconds<double>() * 1e3; }
+
+static void report_stats(
+    const PerfAssembly&   perf_assembly,
+    const AggregateTimer& frame_time,
+    const TimeHistogram&  frame_time_histogram,
+    const std::string&    output_path)
+{
+    const auto header = "name,count,wall_mean_ms,wall_p50_ms,wall_p99_ms,device_mean_ms,device_p50_ms,device_p99_ms\n";
+
+    std::string csv = header;
+    const auto append_row = [&](
+        std::string_view      name,
+        const AggregateTimer& wall_time,
+        const TimeHistogram&  wall_histogram,
+        const AggregateTimer* device_time,
+        const TimeHistogram*  device_histogram)
+    {
+        const auto& wall = wall_histogram.current();
+        csv += fmt::format("{},{},{:.4f},{:.4f},{:.4f}", name, wall.count,
+            to_ms(wall_time.current().mean), to_ms(wall.p50), to_ms(wall.p99));
+
+        if (device_time and device_histogram and device_histogram->current().count)
+        {
+            const auto& device = device_histogram->current();
+            csv += fmt::format(",{:.4f},{:.4f},{:.4f}\n",
+                to_ms(device_time->current().mean), to_ms(device.p50), to_ms(device.p99));
+        }
+        else
+        {
+            csv += ",,,\n";
+        }
+    };
+
+    append_row("frame", frame_time, frame_time_histogram, nullptr, nullptr);
+
+    // Sorted by name, so that the outputs of different runs can be diffed.
+    std::vector<const PerfHarness*> harnesses;
+    for (const auto& [key, harness] : perf_assembly.view_harnesses())
+        harnesses.push_back(&harness);
+    std::ranges::sort(harnesses, {}, [](const PerfHarness* harness) { return harness->name(); });
+
+    for (const PerfHarness* harness : harnesses)
+    {
+        const auto* full = harness->get_segment(0);
+        if (not full) continue;
+        append_row(harness->name(), full->wall_time, full->wall_time_histogram,
+            &full->device_time, &full->device_time_histogram);
+    }
+
+    std::cout << csv;
+
+    if (not output_path.empty())
+    {
+        auto file = fmt::output_file(output_path);
+        file.print("{}", csv);
+        logstream() << fmt::format("[INFO]: Stats written to {}.\n", output_path);
+    }
+}
+
+
+auto main(int argc, const char* argv[])
+    -> int
+{
+    set_current_thread_name("main");
+    trace::set_current_track_name("main");
+
+    auto cli_options      = get_cli_options();
+    auto cli_parse_result = try_parse_cli_args(cli_options, argc, argv);
+
+    if (not cli_parse_result.has_value())
+        return 1;
+
+    auto& cli_args = cli_parse_result.value();
+
+    if (cli_args.count("help"))
+    {
+        std::cout << cli_options.help() << "\n";
+        return 0;
+    }
+
+    if (cli_args.count("vroots"))
+    {
+        auto vroot_strigns = cli_args["vroots"].as<std::vector<std::string>>();
+
+        try
+        {
+            for (auto&& vroot : vroot_strigns)
+                vfs().roots().push_front(Directory(std::move(vroot)));
+        }
+        catch (const DirectoryDoesNotExist& e)
+        {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    const usize    num_frames   = cli_args["frames"].as<size_t>();
+    const usize    num_warmup   = cli_args["warmup"].as<size_t>();
+    const float    orbit_radius = cli_args["orbit-radius"].as<float>();
+    const float    orbit_height = cli_args["orbit-height"].as<float>();
+    const Extent2I resolution   = { cli_args["width"].as<int>(), cli_args["height"].as<int>() };
+
+    std::optional<HeadlessContext> context;
+    try
+    {
+        context.emplace();
+        context->make_current();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    glbinding::initialize(HeadlessContext::get_proc_address);
+
+    globals::RAIIContext globals_context;
+
+    if (cli_args["log-gl-errors"].as<bool>())
+        log_gl_errors(logstream());
+
+    if (const auto shader_cache_dir = cli_args["shader-cache"].as<std::string>(); not shader_cache_dir.empty())
+    {
+        if (not shader_pool().enable_binary_cache(shader_cache_dir))
+            logstream() << fmt::format("Shader cache disabled. Program binaries are not supported by the driver, "
+                "or the directory \"{}\" could not be created.\n", shader_cache_dir);
+    }
+
+    const RuntimeParams runtime_params = {
+        .main_context      = &*context,
+        .database_root     = ".josh3d/", // TODO: Un-hardcode
+        .task_pool_size    = 6,          // ''
+        .loading_pool_size = 6,          // ''
+        .io_pool_size      = 2,          // ''
+        .main_resolution   = resolution,
+        .main_format       = HDRFormat::R11F_G11F_B10F
+    };
+
+    auto runtime = Runtime(runtime_params);
+
+    // There is no default framebuffer in a surfaceless context.
+    runtime.renderer.present_to_default_fbo = false;
+
+    build_pipeline(runtime);
+    register_default_resource_info   (resource_info());
+    register_default_resource_storage(runtime.resource_registry);
+    register_default_importers       (runtime.asset_importer);
+    register_default_loaders         (runtime.resource_loader);
+    register_default_unpackers       (runtime.resource_unpacker);
+
+    Handle camera_handle;
+    try
+    {
+        camera_handle = init_registry(runtime, VPath(cli_args["scene"].as<std::string>()), resolution);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n";
+        drain_local_tasks(runtime);
+        return 1;
+    }
+
+    FrameTimer frame_timer;
+
+    const auto render_frame = [&](usize frame)
+    {
+        frame_timer.update();
+        place_camera(camera_handle.get<Transform>(), frame, num_frames, orbit_radius, orbit_height);
+        update(runtime);
+        runtime.renderer.render(runtime, resolution, frame_timer);
+        // Wait for the GPU, so that each frame is measured in isolation.
+        glapi::finish();
+    };
+
+    // Lets the asynchronous shader compilation and loading settle,
+    // so that the measured frames are not skewed by the first frames.
+    for (const auto _ : irange(num_warmup))
+    {
+        render_frame(0);
+        runtime.perf_assembly.collect_all(TimeDeltaNS::from_seconds(frame_timer.delta()));
+    }
+
+    // Aggregate over the whole measured run, then flush once at the end.
+    runtime.perf_assembly.flush_interval = TimeDeltaNS(vmax<TimeDeltaNS::rep>);
+    runtime.perf_assembly.reset_all();
+
+    if (cli_args.count("trace-frames"))
+    {
+        if (const size_t num_trace_frames = cli_args["trace-frames"].as<size_t>())
+            runtime.perf_assembly.capture_trace(num_trace_frames, cli_args["trace-output"].as<std::string>());
+    }
+
+    AggregateTimer frame_time;
+    TimeHistogram  frame_time_histogram;
+
+    for (const usize frame : irange(num_frames))
+    {
+        const TimePointNS start = current_time();
+        render_frame(frame);
+        const TimeDeltaNS dt = current_time() - start;
+
+        frame_time.record(dt);
+        frame_time_histogram.record(dt);
+        runtime.perf_assembly.collect_all(dt);
+    }
+
+    frame_time.flush();
+    frame_time_histogram.flush();
+    runtime.perf_assembly.flush_all();
+
+    int exit_code = 0;
+    try
+    {
+        report_stats(runtime.perf_assembly, frame_time, frame_time_histogram,
+            cli_args["stats-output"].as<std::string>());
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n";
+        exit_code = 1;
+    }
+
+    drain_local_tasks(runtime);
+
+    return exit_code;
+}
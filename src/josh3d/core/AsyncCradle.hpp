@@ -2,15 +2,13 @@
 #include "Scalars.hpp"
 #include "Semantics.hpp"
 #include "async/CompletionContext.hpp"
+#include "async/IOContext.hpp"
 #include "async/LocalContext.hpp"
 #include "OffscreenContext.hpp"
 #include "async/TaskCounterGuard.hpp"
 #include "async/ThreadPool.hpp"
 
 
-namespace glfw { class Window; }
-
-
 namespace josh {
 
 struct AsyncCradleRef;
@@ -23,20 +21,23 @@ struct AsyncCradle
 {
     ThreadPool        task_pool;          // Primary thread pool for compute work.
     ThreadPool        loading_pool;       // Separate thread pool for importing/loading/unpacking jobs.
+    IOContext         io_context;         // Pages in mapped files so that the pools above would not block on disk reads.
     CompletionContext completion_context; // Spinning context for awaiting jobs. Mostly redundant.
     OffscreenContext  offscreen_context;  // Offscreen GPU context for offloading GPU tasks.
     TaskCounterGuard  task_counter;       // Task counter used for detecting when all tasks are complete.
     LocalContext      local_context;      // Main-thread context run during per-frame update. Must be last.
 
     AsyncCradle(
-        usize               task_pool_size,
-        usize               loading_pool_size,
-        const glfw::Window& main_window
+        usize          task_pool_size,
+        usize          loading_pool_size,
+        usize          io_pool_size,
+        MainContextRef main_context
     )
         : task_pool         (task_pool_size, "task pool")
         , loading_pool      (loading_pool_size, "load pool")
+        , io_context        (io_pool_size)
         , completion_context()
-        , offscreen_context (main_window)
+        , offscreen_context (main_context)
         , task_counter      ()
         , local_context     (task_counter)
     {}
@@ -51,6 +52,7 @@ struct AsyncCradleRef
 {
     ThreadPool&        task_pool;
     ThreadPool&        loading_pool;
+    IOContext&         io_context;
     CompletionContext& completion_context;
     OffscreenContext&  offscreen_context;
     TaskCounterGuard&  task_counter;
@@ -62,6 +64,7 @@ inline AsyncCradle::operator AsyncCradleRef() noexcept
     return {
         .task_pool          = task_pool,
         .loading_pool       = loading_pool,
+        .io_context         = io_context,
         .completion_context = completion_context,
         .offscreen_context  = offscreen_context,
         .task_counter       = task_counter,
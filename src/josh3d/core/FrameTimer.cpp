@@ -1,15 +1,23 @@
 #include "FrameTimer.hpp"
-#include <glfwpp/glfwpp.h>
+#include <chrono>
 
 
 namespace josh {
+namespace {
+
+// Does not depend on GLFW, so that the timer also works without a window.
+const auto epoch = std::chrono::steady_clock::now();
+
+} // namespace
+
 
 void FrameTimer::update() noexcept
 {
+    using seconds = std::chrono::duration<double>;
     previous_ = current_;
-    // FIXME: This is not the most reliable source of timing information.
-    current_ = glfw::getTime();
-    delta_ = current_ - previous_;
+    current_  = seconds(std::chrono::steady_clock::now() - epoch).count();
+    delta_    = current_ - previous_;
 }
 
+
 } // namespace josh
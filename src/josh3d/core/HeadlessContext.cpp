@@ -0,0 +1,156 @@
+#include "HeadlessContext.hpp"
+#include "Errors.hpp"
+#ifdef JOSH3D_HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+#endif
+
+
+namespace josh {
+
+
+#ifdef JOSH3D_HEADLESS_EGL
+namespace {
+
+
+[[noreturn]]
+void throw_egl_error(const char* what)
+{
+    throw_fmt("Failed to {}, EGL error 0x{:04X}.", what, eglGetError());
+}
+
+auto has_egl_extension(const char* extensions, const char* name) noexcept
+    -> bool
+{
+    if (not extensions) return false;
+    const usize len = std::strlen(name);
+    for (const char* it = extensions; (it = std::strstr(it, name)); it += len)
+    {
+        const bool starts = it == extensions or it[-1] == ' ';
+        const bool ends   = it[len] == ' ' or it[len] == '\0';
+        if (starts and ends) return true;
+    }
+    return false;
+}
+
+auto open_display()
+    -> EGLDisplay
+{
+    EGLDisplay display = EGL_NO_DISPLAY;
+
+    // Prefer the surfaceless platform, so that no X11/Wayland/DRM device is touched.
+    const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (has_egl_extension(client_extensions, "EGL_MESA_platform_surfaceless"))
+    {
+        const auto get_platform_display =
+            reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (get_platform_display)
+            display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    if (display == EGL_NO_DISPLAY)
+        throw_egl_error("get an EGL display");
+
+    EGLint major, minor;
+    if (not eglInitialize(display, &major, &minor))
+        throw_egl_error("initialize the EGL display");
+
+    if (not has_egl_extension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+        throw_fmt("EGL {}.{} display does not support EGL_KHR_surfaceless_context.", major, minor);
+
+    return display;
+}
+
+// The display is shared by all contexts and is never terminated,
+// since other contexts might still be alive during static destruction.
+auto get_display()
+    -> EGLDisplay
+{
+    static const EGLDisplay display = open_display();
+    return display;
+}
+
+
+} // namespace
+
+
+HeadlessContext::HeadlessContext(const HeadlessContext* shared_with)
+{
+    const EGLDisplay display = get_display();
+
+    if (not eglBindAPI(EGL_OPENGL_API))
+        throw_egl_error("bind the OpenGL API");
+
+    const EGLint config_attribs[] = {
+        EGL_SURFACE_TYPE,    0, // No surfaces at all.
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE,
+    };
+
+    EGLConfig config;
+    EGLint    num_configs = 0;
+    if (not eglChooseConfig(display, config_attribs, &config, 1, &num_configs) or num_configs == 0)
+        throw_egl_error("choose an EGL config for OpenGL");
+
+    const EGLint context_attribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION,       4,
+        EGL_CONTEXT_MINOR_VERSION,       6,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE,
+    };
+
+    const EGLContext share = shared_with ? shared_with->context_ : EGL_NO_CONTEXT;
+    const EGLContext context = eglCreateContext(display, config, share, context_attribs);
+    if (context == EGL_NO_CONTEXT)
+        throw_egl_error("create an OpenGL 4.6 Core EGL context");
+
+    display_ = display;
+    context_ = context;
+}
+
+void HeadlessContext::make_current() const
+{
+    if (not eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, context_))
+        throw_egl_error("make the EGL context current");
+}
+
+void HeadlessContext::release_current() noexcept
+{
+    eglMakeCurrent(get_display(), EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+auto HeadlessContext::get_proc_address(const char* name) noexcept
+    -> ProcAddress
+{
+    return eglGetProcAddress(name);
+}
+
+HeadlessContext::~HeadlessContext() noexcept
+{
+    // NOTE: Deletion is deferred by EGL until the context is not current anywhere.
+    eglDestroyContext(display_, context_);
+}
+
+
+#else // not JOSH3D_HEADLESS_EGL
+
+
+HeadlessContext::HeadlessContext(const HeadlessContext*)
+{
+    throw_fmt("Headless contexts are not available, rebuild with JOSH3D_HEADLESS_EGL enabled.");
+}
+
+void HeadlessContext::make_current() const {}
+void HeadlessContext::release_current() noexcept {}
+auto HeadlessContext::get_proc_address(const char*) noexcept -> ProcAddress { return nullptr; }
+HeadlessContext::~HeadlessContext() noexcept = default;
+
+
+#endif
+
+
+} // namespace josh
@@ -0,0 +1,57 @@
+#pragma once
+#include "Semantics.hpp"
+
+
+/*
+Window-less OpenGL contexts for running the engine without a display.
+
+Built on top of EGL with the surfaceless platform, which is what Mesa
+provides on the machines without a GPU or a display server (llvmpipe).
+Only available if the library was configured with JOSH3D_HEADLESS_EGL,
+otherwise the constructor throws.
+
+There is no default framebuffer in a surfaceless context, everything
+must be rendered into the user-created framebuffers.
+*/
+namespace josh {
+
+
+class HeadlessContext
+    : private Immovable<HeadlessContext>
+{
+public:
+    // Whether the library was built with the headless context support.
+    static constexpr bool is_available =
+#ifdef JOSH3D_HEADLESS_EGL
+        true;
+#else
+        false;
+#endif
+
+    // Creates an OpenGL 4.6 Core context.
+    // Does not make it current, call `make_current()` for that.
+    //
+    // If `shared_with` is not null, the objects are shared with that context.
+    // Throws RuntimeError if the context could not be created.
+    explicit HeadlessContext(const HeadlessContext* shared_with = nullptr);
+
+    // Make this context current on the calling thread.
+    void make_current() const;
+
+    // Release whatever context is current on the calling thread.
+    static void release_current() noexcept;
+
+    // Function loader to pass to `glbinding::initialize()`.
+    using ProcAddress = void(*)();
+    static auto get_proc_address(const char* name) noexcept -> ProcAddress;
+
+    ~HeadlessContext() noexcept;
+
+private:
+    // Opaque EGLDisplay and EGLContext, to keep the EGL headers out.
+    void* display_ = nullptr;
+    void* context_ = nullptr;
+};
+
+
+} // namespace josh
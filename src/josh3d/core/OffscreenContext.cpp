@@ -1,45 +1,80 @@
 #include "OffscreenContext.hpp"
 #include "CategoryCasts.hpp"
 #include "Common.hpp"
+#include "HeadlessContext.hpp"
+#include "KitchenSink.hpp"
 #include "async/Future.hpp"
 #include "async/ThreadAttributes.hpp"
 #include "Tracy.hpp"
 #include <glfwpp/window.h>
 #include <exception>
+#include <variant>
 
 
 namespace josh {
 
 
-OffscreenContext::OffscreenContext(const glfw::Window& shared_with)
+OffscreenContext::OffscreenContext(MainContextRef shared_with)
     : offscreen_thread_{
-        [&, this](std::stop_token stoken) // NOLINT
+        [shared_with, this](std::stop_token stoken) // NOLINT
         {
-            glfw::WindowHints{
-                .visible             = false,
-                .contextVersionMajor = 4,
-                .contextVersionMinor = 6,
-                .openglProfile       = glfw::OpenGlProfile::Core,
-            }.apply();
+            set_current_thread_name("offscreen ctx");
 
-            glfw::Window window{ 1, 1, "Offscreen Context", nullptr, &shared_with };
+            // The context is owned by this thread, so the loop runs from within the visitor.
+            const auto run = [&, this](const auto& make_current)
+            {
+                TracyGpuContext;
+                TracyGpuContextName("offscreen ctx", 13);
 
-            TracyGpuContext;
-            TracyGpuContextName("offscreen ctx", 13);
-            set_current_thread_name("offscreen ctx");
+                startup_latch_.arrive_and_wait();
+
+                offscreen_thread_loop(MOVE(stoken), make_current);
+            };
+
+            const auto with_window = [&](const glfw::Window* main_window)
+            {
+                glfw::WindowHints{
+                    .visible             = false,
+                    .contextVersionMajor = 4,
+                    .contextVersionMinor = 6,
+                    .openglProfile       = glfw::OpenGlProfile::Core,
+                }.apply();
+
+                glfw::Window window{ 1, 1, "Offscreen Context", nullptr, main_window };
+
+                run([&] { glfw::makeContextCurrent(window); });
+            };
+
+            const auto with_headless = [&](const HeadlessContext* main_context)
+            {
+                const HeadlessContext context{ main_context };
+
+                run([&] { context.make_current(); });
 
-            startup_latch_.arrive_and_wait();
+                HeadlessContext::release_current();
+            };
 
-            offscreen_thread_loop(std::move(stoken), window);
+            try
+            {
+                std::visit(overloaded{ with_window, with_headless }, shared_with);
+            }
+            catch (...)
+            {
+                // Can only fail before the startup is complete.
+                startup_error_ = std::current_exception();
+                startup_latch_.arrive_and_wait();
+            }
         }
     }
 {
     startup_latch_.arrive_and_wait();
+    if (startup_error_)
+        std::rethrow_exception(startup_error_);
 }
 
 void OffscreenContext::offscreen_thread_loop(
     std::stop_token stoken, // NOLINT
-    glfw::Window&   window)
+    const auto&     make_current)
 {
     while (!stoken.stop_requested())
     {
@@ -51,10 +86,10 @@ void OffscreenContext::offscreen_thread_loop(
         // This is to "fool-proof" away from switching contexts in a task.
         //
         // TODO: This shouldn't be expensive, but is it really not?
-        glfw::makeContextCurrent(window);
         try
         {
-            request->task(window);
+            make_current();
+            request->task();
             set_result(MOVE(request->promise));
         }
         catch (...)
@@ -1,11 +1,13 @@
 #pragma once
 #include "CategoryCasts.hpp"
+#include "Common.hpp"
 #include "async/Future.hpp"
 #include "async/ThreadsafeQueue.hpp"
 #include "GLFenceSync.hpp"
 #include "GLMutability.hpp"
 #include "UniqueFunction.hpp"
 #include <concepts>
+#include <exception>
 #include <latch>
 #include <stop_token>
 #include <thread>
@@ -17,17 +19,27 @@ namespace glfw { class Window; }
 namespace josh {
 
 
+class HeadlessContext;
+
+/*
+The main context that the offscreen context shares its objects with.
+Either a window, or a headless context when running without a display.
+*/
+using MainContextRef = Variant<const glfw::Window*, const HeadlessContext*>;
+
+
 class OffscreenContext
 {
 public:
-    OffscreenContext(const glfw::Window& shared_with);
+    // Throws if the offscreen context could not be created.
+    OffscreenContext(MainContextRef shared_with);
 
     template<typename FuncT>
-        requires std::invocable<FuncT> or std::invocable<FuncT, glfw::Window&>
+        requires std::invocable<FuncT>
     auto emplace(FuncT&& func) -> Future<void>;
 
 private:
-    using Task = UniqueFunction<void(glfw::Window&)>;
+    using Task = UniqueFunction<void()>;
 
     auto emplace_request(Task task)
         -> Future<void>;
@@ -39,22 +51,20 @@ private:
     };
 
     std::latch               startup_latch_{ 2 };
+    std::exception_ptr       startup_error_;
     ThreadsafeQueue<Request> requests_;
     std::jthread             offscreen_thread_;
 
-    void offscreen_thread_loop(std::stop_token stoken, glfw::Window& window);
+    void offscreen_thread_loop(std::stop_token stoken, const auto& make_current);
 };
 
 
 template<typename FuncT>
-    requires std::invocable<FuncT> or std::invocable<FuncT, glfw::Window&>
+    requires std::invocable<FuncT>
 auto OffscreenContext::emplace(FuncT&& func)
     -> Future<void>
 {
-    if constexpr (std::invocable<FuncT, glfw::Window&>)
-        return emplace_request(FORWARD(func));
-    else
-        return emplace_request([func=FORWARD(func)](glfw::Window&) { func(); });
+    return emplace_request(FORWARD(func));
 }
 
 
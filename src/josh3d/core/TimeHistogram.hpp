@@ -0,0 +1,168 @@
+#pragma once
+#include "Common.hpp"
+#include "NumericLimits.hpp"
+#include "Scalars.hpp"
+#include "Time.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <iterator>
+
+
+namespace josh {
+
+
+/*
+Log-bucketed histogram of time deltas that reports percentiles
+and counts spikes over user-controlled flush intervals.
+
+Complements the AggregateTimer, where the mean hides the spikes.
+
+Each power-of-two range of nanoseconds is split into 16 linear sub-buckets,
+so the reported percentiles are within ~6% of the true value. They are
+rounded *up* to the bucket bound, which errs on the side of pessimism.
+Anything above ~18 minutes is lumped into the last bucket.
+
+Recording is a couple of relaxed atomic operations and can be done from
+any number of threads concurrently. Flushing and resetting must be done
+from a single thread, but are safe to do concurrently with recording:
+a delta recorded during the flush ends up in one interval or the next.
+*/
+struct TimeHistogram
+{
+    // A delta is counted as a spike if it exceeds the median
+    // of the previous flush interval by this factor.
+    float spike_factor = 2.f;
+
+    // Record a new time delta.
+    void record(TimeDeltaNS dt) noexcept;
+
+    // Computes the percentiles of the deltas recorded since the last
+    // flush, makes them current and starts a new interval.
+    void flush() noexcept;
+
+    // Discard the deltas recorded since the last flush.
+    // The current state is still reported until the next flush.
+    void reset() noexcept;
+
+    struct State
+    {
+        TimeDeltaNS p50    = {};
+        TimeDeltaNS p90    = {};
+        TimeDeltaNS p99    = {};
+        TimeDeltaNS p999   = {};
+        usize       count  = {}; // Number of recorded deltas.
+        usize       spikes = {}; // Number of deltas that were counted as spikes.
+    };
+
+    // Returns the current state, computed on the last flush.
+    auto current() const noexcept -> const State& { return _current; }
+
+    static constexpr usize _sub_bits    = 4;
+    static constexpr usize _num_sub     = 1 << _sub_bits;
+    static constexpr usize _max_msb     = 40;
+    static constexpr usize _num_buckets = (_max_msb - _sub_bits + 2) * _num_sub;
+
+    static auto _bucket_of(u64 ns) noexcept -> usize;
+    static auto _upper_bound_of(usize bucket) noexcept -> u64;
+
+    // Atomics are not movable, so we keep them on the heap
+    // to let the owning Segments be stored in hashmaps.
+    struct Counters
+    {
+        std::atomic<u32> buckets[_num_buckets] = {};
+        std::atomic<u32> spikes                = 0;
+        std::atomic<i64> spike_threshold       = vmax<i64>; // In ns.
+    };
+
+    UniquePtr<Counters> _counters = std::make_unique<Counters>();
+    State               _current  = {};
+};
+
+
+inline auto TimeHistogram::_bucket_of(u64 ns) noexcept
+    -> usize
+{
+    if (ns < _num_sub) return ns;
+    const usize msb   = std::bit_width(ns) - 1;
+    if (msb > _max_msb) return _num_buckets - 1;
+    const usize shift = msb - _sub_bits;
+    const usize sub   = (ns >> shift) & (_num_sub - 1);
+    return (shift + 1) * _num_sub + sub;
+}
+
+inline auto TimeHistogram::_upper_bound_of(usize bucket) noexcept
+    -> u64
+{
+    if (bucket < _num_sub) return bucket;
+    const usize shift = bucket / _num_sub - 1;
+    const usize sub   = bucket % _num_sub;
+    return ((u64(_num_sub + sub + 1)) << shift) - 1;
+}
+
+inline void TimeHistogram::record(TimeDeltaNS dt) noexcept
+{
+    const i64 ns = std::max<i64>(dt.count(), 0);
+    _counters->buckets[_bucket_of(u64(ns))].fetch_add(1, std::memory_order_relaxed);
+
+    if (ns > _counters->spike_threshold.load(std::memory_order_relaxed))
+        _counters->spikes.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void TimeHistogram::flush() noexcept
+{
+    // Taking the counts out one at a time. This does not give a consistent
+    // snapshot under concurrent recording, but it never loses a delta either.
+    u32   counts[_num_buckets];
+    usize total = 0;
+    for (usize i = 0; i < _num_buckets; ++i)
+    {
+        counts[i] = _counters->buckets[i].exchange(0, std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    State s = {
+        .count  = total,
+        .spikes = _counters->spikes.exchange(0, std::memory_order_relaxed),
+    };
+
+    if (total)
+    {
+        const auto rank_of = [&](double q) { return usize(std::ceil(q * double(total))); };
+
+        struct Target { double q; TimeDeltaNS* out; };
+        const Target targets[] = {
+            { 0.5,   &s.p50  },
+            { 0.9,   &s.p90  },
+            { 0.99,  &s.p99  },
+            { 0.999, &s.p999 },
+        };
+
+        usize cumulative = 0;
+        usize itarget    = 0;
+        for (usize i = 0; i < _num_buckets and itarget < std::size(targets); ++i)
+        {
+            cumulative += counts[i];
+            while (itarget < std::size(targets) and cumulative >= rank_of(targets[itarget].q))
+                *targets[itarget++].out = TimeDeltaNS(i64(_upper_bound_of(i)));
+        }
+    }
+
+    // The spike threshold follows the median, but only if there is one.
+    const i64 threshold = total ?
+        i64(double(s.p50.count()) * double(spike_factor)) : vmax<i64>;
+    _counters->spike_threshold.store(threshold, std::memory_order_relaxed);
+
+    _current = s;
+}
+
+inline void TimeHistogram::reset() noexcept
+{
+    for (auto& bucket : _counters->buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    _counters->spikes.store(0, std::memory_order_relaxed);
+}
+
+
+} // namespace josh
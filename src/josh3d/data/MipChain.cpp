@@ -0,0 +1,276 @@
+#include "MipChain.hpp"
+#include "Common.hpp"
+#include "KitchenSink.hpp"
+#include "Ranges.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+
+namespace josh {
+namespace {
+
+
+constexpr usize max_channels = 4;
+constexpr usize max_taps     = 6;
+
+/*
+Separable 1D kernel for the 2x decimation.
+
+Tap `k` of the destination texel `x` reads the source texel `2x + first + k`.
+*/
+struct Kernel
+{
+    i32                    first;
+    usize                  num_taps;
+    Array<float, max_taps> weights;
+};
+
+auto bessel_i0(double x) noexcept
+    -> double
+{
+    // Power series. Converges quickly for the small arguments of the window.
+    double sum  = 1.0;
+    double term = 1.0;
+    for (const int k : irange(1, 32))
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum  += term;
+    }
+    return sum;
+}
+
+auto make_box_kernel() noexcept
+    -> Kernel
+{
+    return { .first = 0, .num_taps = 2, .weights = { 0.5f, 0.5f } };
+}
+
+auto make_kaiser_kernel() noexcept
+    -> Kernel
+{
+    // Sinc with the cutoff at half the source Nyquist, windowed over 3 source
+    // texels each side. The source texel centers are at +-0.5, +-1.5 and +-2.5
+    // from the destination texel center, so the kernel is symmetric and even.
+    constexpr double alpha      = 4.0;
+    constexpr double half_width = 3.0;
+    constexpr double pi         = std::numbers::pi;
+
+    Kernel kernel{ .first = -2, .num_taps = 6, .weights = {} };
+    double weights[max_taps];
+    double sum = 0.0;
+    for (const uindex k : irange(kernel.num_taps))
+    {
+        const double d      = double(k) - 2.5;
+        const double x      = pi * d / 2.0;
+        const double sinc   = std::sin(x) / x;
+        const double t      = d / half_width;
+        const double window = bessel_i0(alpha * std::sqrt(1.0 - t * t)) / bessel_i0(alpha);
+        weights[k] = sinc * window;
+        sum       += weights[k];
+    }
+    for (const uindex k : irange(kernel.num_taps))
+        kernel.weights[k] = float(weights[k] / sum);
+    return kernel;
+}
+
+const Kernel box_kernel    = make_box_kernel();
+const Kernel kaiser_kernel = make_kaiser_kernel();
+
+
+auto srgb_to_linear(double c) noexcept -> double
+{
+    return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+}
+
+auto linear_to_srgb(double c) noexcept -> double
+{
+    return c <= 0.0031308 ? c * 12.92 : 1.055 * std::pow(c, 1.0 / 2.4) - 0.055;
+}
+
+// Decoding is exact, since there are only 256 inputs.
+const auto srgb_decode_lut = eval%[]{
+    Array<float, 256> lut;
+    for (const uindex i : irange(256))
+        lut[i] = float(srgb_to_linear(double(i) / 255.0));
+    return lut;
+};
+
+// Encoding goes through a 14-bit quantization of the linear value.
+// That is precise enough even for the steep part of the curve near 0.
+constexpr usize srgb_encode_lut_size = 1 << 14;
+const auto srgb_encode_lut = eval%[]{
+    Vector<ubyte> lut(srgb_encode_lut_size);
+    for (const uindex i : irange(srgb_encode_lut_size))
+    {
+        const double linear = double(i) / double(srgb_encode_lut_size - 1);
+        lut[i] = ubyte(std::lround(linear_to_srgb(linear) * 255.0));
+    }
+    return lut;
+};
+
+// Weight of the fully transparent texels. Without this, the color of
+// the fully transparent areas would be undefined after the division.
+// Small enough to not bleed into the opaque neighbours after 8-bit rounding.
+constexpr float min_alpha_weight = 1.f / 65536.f;
+
+
+} // namespace
+
+
+auto next_mip_resolution(const Extent2S& resolution) noexcept
+    -> Extent2S
+{
+    return { std::max(resolution.width / 2, usize(1)), std::max(resolution.height / 2, usize(1)) };
+}
+
+void downsample_mip_rows(
+    ImageView<const ubyte> src,
+    ImageView<ubyte>       dst,
+    const MipChainParams&  params,
+    usize                  row_begin,
+    usize                  row_end)
+{
+    const usize num_channels = src.num_channels();
+    const usize src_w        = src.resolution().width;
+    const usize src_h        = src.resolution().height;
+    const usize dst_w        = dst.resolution().width;
+
+    assert(num_channels <= max_channels);
+    assert(dst.num_channels() == num_channels);
+    assert(dst.resolution().width  == next_mip_resolution(src.resolution()).width);
+    assert(dst.resolution().height == next_mip_resolution(src.resolution()).height);
+    assert(row_begin <= row_end and row_end <= dst.resolution().height);
+
+    if (row_begin == row_end) return;
+
+    const Kernel& kernel = params.filter == MipFilter::Box ? box_kernel : kaiser_kernel;
+
+    const bool  has_alpha  = num_channels == 4;
+    const bool  weighted   = has_alpha and params.alpha_weighted;
+    const usize num_colors = has_alpha ? 3 : num_channels;
+
+    // Filtering is done on the planar float rows, one plane per channel, plus
+    // one extra plane for the alpha weights. The loops over the planes have no
+    // branches and contiguous (or stride 2) access, so that they are vectorized.
+    const usize num_planes   = num_channels + weighted;
+    const usize weight_plane = num_channels;
+
+    // The source rows are padded by replicating the edge texels,
+    // so that the horizontal taps never need to be clamped.
+    const usize pad_left  = usize(-kernel.first);
+    const usize pad_right = kernel.num_taps + 1;
+    const usize padded_w  = pad_left + src_w + pad_right;
+
+    const auto clamp_row = [&](i64 row) -> usize { return usize(std::clamp<i64>(row, 0, i64(src_h) - 1)); };
+
+    const usize first_src_row = clamp_row(2 * i64(row_begin) + kernel.first);
+    const usize last_src_row  = clamp_row(2 * i64(row_end - 1) + kernel.first + i64(kernel.num_taps) - 1);
+    const usize num_src_rows  = last_src_row - first_src_row + 1;
+
+    thread_local Vector<float> padded;     // num_planes x padded_w
+    thread_local Vector<float> hfiltered;  // num_src_rows x num_planes x dst_w
+    thread_local Vector<float> vfiltered;  // num_planes x dst_w
+    padded   .resize(num_planes * padded_w);
+    hfiltered.resize(num_src_rows * num_planes * dst_w);
+    vfiltered.resize(num_planes * dst_w);
+
+    const auto hrow = [&](usize src_row, usize plane) -> float*
+    {
+        return hfiltered.data() + ((src_row - first_src_row) * num_planes + plane) * dst_w;
+    };
+
+    // Horizontal pass over every source row that this range of destination rows needs.
+    for (const usize src_row : irange(first_src_row, last_src_row + 1))
+    {
+        const ubyte* src_px = src.data() + src_row * src_w * num_channels;
+
+        for (const usize x : irange(src_w))
+        {
+            const ubyte* px     = src_px + x * num_channels;
+            const float  alpha  = has_alpha ? float(px[3]) / 255.f : 1.f;
+            const float  weight = weighted  ? alpha + min_alpha_weight : 1.f;
+
+            for (const usize c : irange(num_colors))
+            {
+                const float value = params.srgb ? srgb_decode_lut[px[c]] : float(px[c]) / 255.f;
+                padded[c * padded_w + pad_left + x] = value * weight;
+            }
+            if (has_alpha) padded[3            * padded_w + pad_left + x] = alpha;
+            if (weighted)  padded[weight_plane * padded_w + pad_left + x] = weight;
+        }
+
+        for (const usize p : irange(num_planes))
+        {
+            float* plane = padded.data() + p * padded_w;
+            std::fill_n(plane, pad_left, plane[pad_left]);
+            std::fill_n(plane + pad_left + src_w, pad_right, plane[pad_left + src_w - 1]);
+
+            float* out = hrow(src_row, p);
+            std::fill_n(out, dst_w, 0.f);
+            for (const usize k : irange(kernel.num_taps))
+            {
+                const float  w  = kernel.weights[k];
+                const float* in = plane + k; // Offset by `first` is cancelled by the `pad_left`.
+                for (const usize x : irange(dst_w))
+                    out[x] += w * in[2 * x];
+            }
+        }
+    }
+
+    // Vertical pass and the write-out of each destination row.
+    for (const usize dst_row : irange(row_begin, row_end))
+    {
+        std::ranges::fill(vfiltered, 0.f);
+        for (const usize k : irange(kernel.num_taps))
+        {
+            const float w       = kernel.weights[k];
+            const usize src_row = clamp_row(2 * i64(dst_row) + kernel.first + i64(k));
+            for (const usize p : irange(num_planes))
+            {
+                const float* in  = hrow(src_row, p);
+                float*       out = vfiltered.data() + p * dst_w;
+                for (const usize x : irange(dst_w))
+                    out[x] += w * in[x];
+            }
+        }
+
+        ubyte* dst_px = dst.data() + dst_row * dst_w * num_channels;
+
+        for (const usize x : irange(dst_w))
+        {
+            ubyte* px = dst_px + x * num_channels;
+
+            const float weight = weighted ?
+                std::max(vfiltered[weight_plane * dst_w + x], min_alpha_weight) : 1.f;
+
+            for (const usize c : irange(num_colors))
+            {
+                // The Kaiser filter rings, so the result can overshoot.
+                const float value = std::clamp(vfiltered[c * dst_w + x] / weight, 0.f, 1.f);
+                px[c] = params.srgb ?
+                    srgb_encode_lut[usize(value * float(srgb_encode_lut_size - 1) + 0.5f)] :
+                    ubyte(value * 255.f + 0.5f);
+            }
+            if (has_alpha)
+            {
+                const float alpha = std::clamp(vfiltered[3 * dst_w + x], 0.f, 1.f);
+                px[3] = ubyte(alpha * 255.f + 0.5f);
+            }
+        }
+    }
+}
+
+auto downsample_mip(
+    ImageView<const ubyte> src,
+    const MipChainParams&  params)
+        -> ImageData<ubyte>
+{
+    ImageData<ubyte> dst = { next_mip_resolution(src.resolution()), src.num_channels() };
+    downsample_mip_rows(src, dst, params, 0, dst.resolution().height);
+    return dst;
+}
+
+
+} // namespace josh
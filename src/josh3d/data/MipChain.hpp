@@ -0,0 +1,57 @@
+#pragma once
+#include "Common.hpp"
+#include "EnumUtils.hpp"
+#include "ImageData.hpp"
+#include "Region.hpp"
+#include "Scalars.hpp"
+
+
+/*
+CPU generation of the mip chains for 8-bit images.
+
+This is an alternative to glGenerateMipmap() that does not need a GL context,
+and, since the rows of each level are independent, can be split across threads.
+*/
+namespace josh {
+
+
+enum class MipFilter : u8
+{
+    Box,    // 2x2 average. Cheap, but blurry and aliased.
+    Kaiser, // Kaiser-windowed sinc with 6x6 taps. Sharper, but might ring a little.
+};
+JOSH3D_DEFINE_ENUM_EXTRAS(MipFilter, Box, Kaiser);
+
+struct MipChainParams
+{
+    MipFilter filter         = MipFilter::Kaiser;
+    bool      srgb           = true; // Filter the color channels in linear space. Alpha is always linear.
+    bool      alpha_weighted = true; // Weight the colors by alpha. Only for 4-channel images.
+};
+
+// Resolution of the next mip level. Halved, rounded down, but at least 1.
+auto next_mip_resolution(const Extent2S& resolution) noexcept
+    -> Extent2S;
+
+// Downsample the `src` level into the rows [row_begin, row_end) of the `dst` level.
+//
+// The rows of the `dst` can be filled independently,
+// so different row ranges can be filled from different threads.
+//
+// PRE: `dst.resolution()` is the `next_mip_resolution()` of the `src`.
+// PRE: Both images have the same number of channels, at most 4.
+void downsample_mip_rows(
+    ImageView<const ubyte> src,
+    ImageView<ubyte>       dst,
+    const MipChainParams&  params,
+    usize                  row_begin,
+    usize                  row_end);
+
+// Downsample the `src` into the next mip level. Single-threaded.
+auto downsample_mip(
+    ImageView<const ubyte> src,
+    const MipChainParams&  params)
+        -> ImageData<ubyte>;
+
+
+} // namespace josh
@@ -0,0 +1,111 @@
+#include "IDPicker.hpp"
+#include "GLAPIBinding.hpp"
+#include "GLObjectHelpers.hpp"
+#include "Tracy.hpp"
+#include <algorithm>
+
+
+namespace josh {
+namespace {
+
+auto clamp_region(const Region2I& region, const Extent2I& bounds) noexcept
+    -> Region2I
+{
+    const int x0 = std::clamp(region.offset.x,                        0, bounds.width);
+    const int y0 = std::clamp(region.offset.y,                        0, bounds.height);
+    const int x1 = std::clamp(region.offset.x + region.extent.width,  0, bounds.width);
+    const int y1 = std::clamp(region.offset.y + region.extent.height, 0, bounds.height);
+    return { { x0, y0 }, { std::max(x1 - x0, 0), std::max(y1 - y0, 0) } };
+}
+
+auto collect_entities(Span<const u32> ids)
+    -> Vector<Entity>
+{
+    constexpr u32 null_id = to_underlying(nullent);
+
+    // The neighbouring pixels likely belong to the same object,
+    // so skipping the runs first cuts down on the sorting.
+    Vector<u32> unique;
+    for (const u32 id : ids)
+        if (id != null_id and (unique.empty() or unique.back() != id))
+            unique.push_back(id);
+
+    std::ranges::sort(unique);
+    const auto [last, end] = std::ranges::unique(unique);
+    unique.erase(last, end);
+
+    Vector<Entity> entities;
+    entities.reserve(unique.size());
+    for (const u32 id : unique)
+        entities.push_back(Entity(id));
+    return entities;
+}
+
+} // namespace
+
+
+auto IDPicker::pick(RawTexture2D<GLConst> object_ids, const Region2I& region)
+    -> Future<Result>
+{
+    ZS;
+    auto [future, promise] = make_future_promise_pair<Result>();
+
+    const Region2I clamped = clamp_region(region, object_ids.get_resolution());
+    const usize    area    = usize(clamped.extent.area());
+
+    if (not area)
+    {
+        set_result(MOVE(promise), Result{ .region = clamped });
+        return MOVE(future);
+    }
+
+    UniqueBuffer<u32> buffer = allocate_buffer<u32>(NumElems(area), {
+        .mode    = StorageMode::StaticClient,
+        .mapping = PermittedMapping::Read,
+    });
+
+    {
+        const BindGuard bpack = buffer->bind<BufferTarget::PixelPack>();
+        object_ids.download_image_region_into_buffer(
+            clamped, PixelDataFormat::RedInteger, PixelDataType::UInt,
+            bpack.token(), OffsetBytes(0), GLsizei(area * sizeof(u32)));
+    }
+
+    _pending.push_back({
+        .region  = clamped,
+        .buffer  = MOVE(buffer),
+        .fence   = create_fence(),
+        .promise = MOVE(promise),
+    });
+
+    return MOVE(future);
+}
+
+void IDPicker::resolve_available()
+{
+    ZS;
+    while (not _pending.empty() and _pending.front().fence->has_signaled())
+    {
+        Pending pending = MOVE(_pending.front());
+        _pending.pop_front();
+
+        // The copy is already done, so this does not wait.
+        const Span<const u32> ids = pending.buffer->map_for_read();
+
+        Result result = {
+            .region   = pending.region,
+            .entities = collect_entities(ids),
+        };
+
+        if (not pending.buffer->unmap_current())
+        {
+            // The contents got corrupted while mapped. Rare, but the spec says it happens.
+            result.entities.clear();
+        }
+
+        set_result(MOVE(pending.promise), MOVE(result));
+    }
+}
+
+
+} // namespace josh
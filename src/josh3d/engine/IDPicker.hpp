@@ -0,0 +1,66 @@
+#pragma once
+#include "Common.hpp"
+#include "ECS.hpp"
+#include "GLObjects.hpp"
+#include "GLTextures.hpp"
+#include "Region.hpp"
+#include "async/Future.hpp"
+#include <deque>
+
+
+namespace josh {
+
+
+/*
+Asynchronous readback of the object IDs from an R32UI ID texture,
+such as the one in the IDBuffer. Used for selection picking.
+
+Instead of reading the pixels back directly, which stalls until the GPU
+catches up, each pick copies the region into a pixel pack buffer and
+inserts a fence. The result is delivered through a Future once the fence
+signals, usually a frame or two later.
+
+    Future<IDPicker::Result> result = picker.pick(idbuffer.object_id_texture(), region);
+    ...
+    if (result.is_available()) use(get_result(MOVE(result)));
+    // Or, in a coroutine:
+    co_await completion_context.until_ready_on(local_context, result);
+
+The pending picks are resolved by `resolve_available()`, which must
+be called regularly. The IDBufferStorage stage does so every frame.
+
+Everything here must be done on the thread with the GL context.
+*/
+struct IDPicker
+{
+    struct Result
+    {
+        Region2I       region;   // Region that was read, clamped to the texture.
+        Vector<Entity> entities; // Unique non-null IDs in the region. Not validated against the registry.
+    };
+
+    // Queue the read of the `region` of the `object_ids` texture.
+    // The region is clamped to the texture bounds. The read happens in the
+    // command stream order, so it will see everything drawn before this call.
+    [[nodiscard]] auto pick(RawTexture2D<GLConst> object_ids, const Region2I& region) -> Future<Result>;
+
+    // Fulfill the futures of the picks whose reads have completed. Does not block.
+    void resolve_available();
+
+    // Number of picks that are still waiting for the GPU.
+    auto num_pending() const noexcept -> usize { return _pending.size(); }
+
+    struct Pending
+    {
+        Region2I          region;
+        UniqueBuffer<u32> buffer;
+        UniqueFenceSync   fence;
+        Promise<Result>   promise;
+    };
+
+    // The fences signal in submission order, so only the front is polled.
+    std::deque<Pending> _pending;
+};
+
+
+} // namespace josh
@@ -1,9 +1,15 @@
 #pragma once
 #include "Common.hpp"
 #include "ContainerUtils.hpp"
+#include "Logging.hpp"
 #include "PerfHarness.hpp"
 #include "SystemKey.hpp"
 #include "Time.hpp"
+#include "TraceCapture.hpp"
+#include <cassert>
+#include <exception>
+#include <fmt/std.h>
+#include <ranges>
 
 
 namespace josh {
@@ -25,15 +31,50 @@ struct PerfAssembly
     auto try_get(SystemKey key) const -> const PerfHarness*;
     void collect_all(TimeDeltaNS frame_dt);
 
+    // Returns a view of (SystemKey, PerfHarness) pairs for all instrumented systems.
+    auto view_harnesses() const noexcept -> std::ranges::view auto;
+
+    // Flush the timers of all harnesses right away, without waiting for the
+    // `flush_interval`. Useful to read out the stats at the end of a run.
+    void flush_all();
+
+    // Discard everything recorded since the last flush in all harnesses,
+    // and restart the flush interval. For example, to skip the warmup frames.
+    void reset_all();
+
+    // Starts a headless trace capture that covers the next `num_frames` calls
+    // to `collect_all()`, after which the trace is written to `path` in the
+    // Chrome trace format. This includes the raw segments of all harnesses
+    // and the jobs of all thread pools. See TraceCapture.hpp.
+    //
+    // Restarts the capture if one is already in progress.
+    void capture_trace(usize num_frames, Path path);
+    auto trace_frames_left() const noexcept -> usize { return _trace_frames_left; }
+
     HashMap<SystemKey, PerfHarness> _harnesses;
     TimeDeltaNS                     _until_next_flush = flush_interval;
+    usize                           _trace_frames_left = 0;
+    Path                            _trace_path;
+    void _finish_trace();
 };
 
 
 inline auto PerfAssembly::instrument(SystemKey key, GPUTiming gpu_timing)
     -> PerfHarness&
 {
-    auto [it, was_emplaced] = _harnesses.try_emplace(key, gpu_timing);
+    // Take the qualified typename (ex. "josh::Bloom") and remove the leading namespaces.
+    const auto make_name = [&]() -> String
+    {
+        String pretty = key.type.pretty_name();
+        const uindex last_colon = pretty.find_last_of(':');
+        if (last_colon != String::npos)
+            pretty = pretty.substr(last_colon + 1);
+        if (key.instance_id)
+            pretty += fmt::format("#{}", key.instance_id);
+        return pretty;
+    };
+
+    auto [it, was_emplaced] = _harnesses.try_emplace(key, gpu_timing, make_name());
     auto& harness = it->second;
 
     // NOTE: In case the above did not emplace, we would like
@@ -56,6 +97,12 @@ inline auto PerfAssembly::try_get(SystemKey key) const
     return try_find_value(_harnesses, key);
 }
 
+inline auto PerfAssembly::view_harnesses() const noexcept
+    -> std::ranges::view auto
+{
+    return std::views::all(_harnesses);
+}
+
 inline void PerfAssembly::collect_all(TimeDeltaNS frame_dt)
 {
     bool needs_flush = false;
@@ -83,6 +130,47 @@ inline void PerfAssembly::collect_all(TimeDeltaNS frame_dt)
             for (auto& [segment_id, segment] : harness._segments)
                 segment.flush_all_timers();
     }
+
+    if (_trace_frames_left and not --_trace_frames_left)
+        _finish_trace();
+}
+
+inline void PerfAssembly::flush_all()
+{
+    for (auto& [key, harness] : _harnesses)
+        for (auto& [segment_id, segment] : harness._segments)
+            segment.flush_all_timers();
+    _until_next_flush = flush_interval;
+}
+
+inline void PerfAssembly::reset_all()
+{
+    for (auto& [key, harness] : _harnesses)
+        for (auto& [segment_id, segment] : harness._segments)
+            segment.reset_all_timers();
+    _until_next_flush = flush_interval;
+}
+
+inline void PerfAssembly::capture_trace(usize num_frames, Path path)
+{
+    assert(num_frames > 0);
+    _trace_frames_left = num_frames;
+    _trace_path        = MOVE(path);
+    trace::start_capture();
+}
+
+inline void PerfAssembly::_finish_trace()
+{
+    trace::stop_capture();
+    try
+    {
+        trace::dump_chrome_trace(_trace_path);
+        logstream() << fmt::format("[INFO]: Trace written to {}.\n", _trace_path);
+    }
+    catch (const std::exception& e)
+    {
+        logstream() << fmt::format("[ERROR]: Could not write the trace. Reason: \"{}\".\n", e.what());
+    }
 }
 
 
@@ -9,6 +9,8 @@
 #include "Ranges.hpp"
 #include "StaticRing.hpp"
 #include "Time.hpp"
+#include "TimeHistogram.hpp"
+#include "TraceCapture.hpp"
 #include <ranges>
 
 
@@ -34,10 +36,20 @@ struct PerfHarness
     struct Frame;
     struct Segment;
 
-    PerfHarness(GPUTiming gpu_timing = GPUTiming::Disabled) : _time_gpu(bool(gpu_timing)) {}
+    PerfHarness(GPUTiming gpu_timing = GPUTiming::Disabled, String name = {})
+        : _name(MOVE(name))
+        , _time_gpu(bool(gpu_timing))
+    {}
+
+    // Display name of the harness. Used to label the spans in trace captures.
+    auto name() const noexcept -> const String& { return _name; }
 
     // Begin a new frame and take the corresponding "start" snap.
-    void start_frame();
+    //
+    // Passing GPUTiming::Disabled skips GPU timing for this frame only,
+    // even if the harness is GPU-timed. This must be done if the frame
+    // is recorded on a thread without a GPU context.
+    void start_frame(GPUTiming gpu_timing = GPUTiming::Enabled);
 
     // Take an intermediate snapshot within the frame with a custom name.
     // The name can be anything other that the reserved "start" and "end" identifiers.
@@ -50,6 +62,10 @@ struct PerfHarness
     // Take the available snapshot data from the last frames and
     // use it to update the AggregateTimers of each respective segment.
     //
+    // If a trace is being captured, the raw segments are also recorded
+    // as trace spans: CPU segments on the track of the thread that took
+    // the snaps, and GPU segments, once resolved, on the GPU track.
+    //
     // PRE: Must be called after `end_frame()`.
     void collect_frame();
 
@@ -82,7 +98,8 @@ struct PerfHarness
 
     struct CPUSnap
     {
-        TimePointNS wall_time; // CPU time measured by a wall-clock.
+        TimePointNS    wall_time; // CPU time measured by a wall-clock.
+        trace::TrackID track;     // Trace track of the thread that took the snap.
     };
 
     struct GPUSnap
@@ -134,6 +151,8 @@ struct PerfHarness
         AggregateTimer host_time   = {}; // Not very useful.
         AggregateTimer device_time = {};
         AggregateTimer latency     = {}; // HMM: Is this a timer?
+        TimeHistogram  wall_time_histogram   = {}; // Percentiles and spikes of wall_time.
+        TimeHistogram  device_time_histogram = {}; // Percentiles and spikes of device_time.
         void flush_all_timers();
         void reset_all_timers();
     };
@@ -142,7 +161,9 @@ struct PerfHarness
     // Currently, we'll likely fall over and die in collect_frame().
     // Do we need a new call like `new_frame()`?
 
-    bool                       _time_gpu;                // Whether the GPU needs to be timed this frame.
+    String                     _name;
+    bool                       _time_gpu;                // Whether the GPU needs to be timed.
+    bool                       _gpu_frame       = false; // Whether the GPU is timed in the current frame.
     bool                       _in_frame        = false; // [DEBUG] Tracks if we are within a "frame" or not - start_frame() has been called.
     bool                       _frame_ended     = false; // [DEBUG] Tracks if the end_frame() has been called.
     bool                       _frame_collected = false; // [DEBUG] Tracks if the current frame has been flushed already.
@@ -161,9 +182,10 @@ struct PerfHarness
 };
 
 
-inline void PerfHarness::start_frame()
+inline void PerfHarness::start_frame(GPUTiming gpu_timing)
 {
     assert(not _in_frame);
+    _gpu_frame = _time_gpu and bool(gpu_timing);
     _frames.advance();
     _frames.current().snaps.clear();
     _frame_ended     = false;
@@ -191,10 +213,11 @@ void PerfHarness::take_snap(FixedHashedString<N> name_hs)
 
     CPUSnap cpu_snap = {
         .wall_time = current_time(),
+        .track     = trace::current_track(),
     };
 
     GPUSnap gpu_snap = eval%[&]() -> GPUSnap {
-        if (_time_gpu)
+        if (_gpu_frame)
         {
             const auto host_time = TimeStampNS(glapi::get_current_time());
 
@@ -244,7 +267,9 @@ inline void PerfHarness::collect_frame()
 
     const auto record_cpu = [](Segment& s, Snap& l, Snap& r)
     {
-        s.wall_time.record(r.cpu.wall_time - l.cpu.wall_time);
+        const TimeDeltaNS dt = r.cpu.wall_time - l.cpu.wall_time;
+        s.wall_time          .record(dt);
+        s.wall_time_histogram.record(dt);
     };
 
     const auto record_gpu = [](Segment& s, Snap& l, Snap& r)
@@ -263,10 +288,39 @@ inline void PerfHarness::collect_frame()
         }
 
         s.host_time  .record(r.gpu.host_time        - l.gpu.host_time);
-        s.device_time.record(r.gpu.device_time()    - l.gpu.device_time());
+        const TimeDeltaNS device_dt = r.gpu.device_time() - l.gpu.device_time();
+        s.device_time          .record(device_dt);
+        s.device_time_histogram.record(device_dt);
         s.latency    .record(r.gpu.device_latency());
     };
 
+    const bool tracing = trace::is_capturing();
+
+    const auto trace_name = [this](const Segment& s) -> std::string_view
+    {
+        const bool is_full = &s == &_segments.at(0);
+        return (is_full and not _name.empty()) ? _name : s.name;
+    };
+
+    const auto trace_cpu = [&](Segment& s, Snap& l, Snap& r)
+    {
+        trace::record_span(trace_name(s), "cpu", l.cpu.wall_time, r.cpu.wall_time, l.cpu.track);
+    };
+
+    // The device time is placed on the CPU timeline by offsetting the wall time
+    // of each snap by its latency. Both were taken at the same moment on the host.
+    const auto trace_gpu = [&](Segment& s, Snap& l, Snap& r)
+    {
+        if (not l.gpu.device_time_available() or
+            not r.gpu.device_time_available())
+            return;
+
+        trace::record_span(trace_name(s), "gpu",
+            l.cpu.wall_time + l.gpu.device_latency(),
+            r.cpu.wall_time + r.gpu.device_latency(),
+            trace::gpu_track);
+    };
+
     // The "full" segment is special and is assigned a hash id of 0.
     // This segment represets the entire frame from "start" to "end"
     // and is generally useful to have available.
@@ -280,6 +334,13 @@ inline void PerfHarness::collect_frame()
     for_each_segment(head_snaps, record_cpu);
     record_cpu(full_segment, head_snaps.front(), head_snaps.back());
 
+    if (tracing)
+    {
+        trace_cpu(full_segment, head_snaps.front(), head_snaps.back());
+        if (head_snaps.size() > 2) // Only "start" and "end" otherwise, which is the full segment.
+            for_each_segment(head_snaps, trace_cpu);
+    }
+
     // In the GPU case, we only collect once the full segment has been
     // recorded on the device. Otherwise, going back and trying to untangle
     // which segments already have host time collected, but not device time
@@ -292,6 +353,13 @@ inline void PerfHarness::collect_frame()
     {
         for_each_segment(tail_snaps, record_gpu);
         record_gpu(full_segment, tail_snaps.front(), tail_snaps.back());
+
+        if (tracing)
+        {
+            trace_gpu(full_segment, tail_snaps.front(), tail_snaps.back());
+            if (tail_snaps.size() > 2)
+                for_each_segment(tail_snaps, trace_gpu);
+        }
     }
 
     // HMM: Since the GPU timers are async, it *might* make sense to let us repeatedly
@@ -379,6 +447,8 @@ inline void PerfHarness::Segment::flush_all_timers()
     host_time  .flush();
     device_time.flush();
     latency    .flush();
+    wall_time_histogram  .flush();
+    device_time_histogram.flush();
 }
 
 inline void PerfHarness::Segment::reset_all_timers()
@@ -387,6 +457,8 @@ inline void PerfHarness::Segment::reset_all_timers()
     host_time  .reset();
     device_time.reset();
     latency    .reset();
+    wall_time_histogram  .reset();
+    device_time_histogram.reset();
 }
 
 
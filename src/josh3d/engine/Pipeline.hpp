@@ -3,11 +3,45 @@
 #include "ContainerUtils.hpp"
 #include "HashedString.hpp"
 #include "PipelineStage.hpp"
+#include "Ranges.hpp"
+#include "RenderGraph.hpp"
+#include "StageAccess.hpp"
 #include "SystemKey.hpp"
+#include <functional>
+#include <ranges>
 
 
 namespace josh {
 
+/*
+Dependency graph of the precompute stages derived from their declared StageAccess.
+
+The stages are split into batches at each stage with undeclared access.
+Such a stage acts as a barrier and is executed alone, on the render thread.
+Stages within a concurrent batch only depend on the earlier stages of the same
+batch that they conflict with, and can otherwise run in any order.
+*/
+struct PrecomputeGraph
+{
+    struct Node
+    {
+        SystemKey      key;
+        usize          num_dependencies = 0;
+        Vector<uindex> dependents; // Indices into `nodes`.
+    };
+
+    struct Batch
+    {
+        uindex first;
+        usize  count;
+        bool   concurrent;
+    };
+
+    Vector<Node>  nodes;   // In pipeline order.
+    Vector<Batch> batches; // In pipeline order.
+    StageAccess   access;  // Union of the declared access of all stages.
+};
+
 /*
 Ordered container of PipelineStages segregated by their kind.
 
@@ -25,10 +59,27 @@ struct Pipeline
         HashedID  instance_id = {},
         String    name        = {}) -> SystemKey;
 
+    // Same as above, but with explicitly declared access of the stage.
+    // This overrides the `T::access()` declaration, if any.
+    //
+    // Only used for precompute stages currently, where it permits running
+    // the stage concurrently with the other stages that it does not conflict with.
+    template<typename T>
+    auto push(
+        StageKind   kind,
+        T&&         stage,
+        StageAccess access,
+        HashedID    instance_id = {},
+        String      name        = {}) -> SystemKey;
+
     struct StoredStage
     {
-        String        name;
-        PipelineStage stage;
+        using resources_fn = auto (*)(const PipelineStage&, Extent2I) -> StageResources;
+
+        String                name;
+        PipelineStage         stage;
+        Optional<StageAccess> access;              // Conflicts with everything if not declared.
+        resources_fn          resources = nullptr; // Accesses every transient if not declared.
     };
 
     template<typename T>
@@ -37,19 +88,45 @@ struct Pipeline
 
     auto view(StageKind kind) const noexcept -> Span<const SystemKey>;
 
+    // Graph of all precompute stages.
+    auto precompute_graph() const noexcept -> const PrecomputeGraph& { return _precompute_graph; }
+
+    // The precompute stages split into those that can be deferred
+    // and run on a snapshot of the registry, and those that cannot.
+    // See StageAccess::is_deferrable().
+    auto immediate_precompute_graph() const noexcept -> const PrecomputeGraph& { return _immediate_graph; }
+    auto deferred_precompute_graph()  const noexcept -> const PrecomputeGraph& { return _deferred_graph;  }
+
 
     HashMap<SystemKey, StoredStage> _stages;
     Vector<SystemKey>               _precompute;
     Vector<SystemKey>               _primary;
     Vector<SystemKey>               _postprocess;
     Vector<SystemKey>               _overlay;
+    PrecomputeGraph                 _precompute_graph;
+    PrecomputeGraph                 _immediate_graph;
+    PrecomputeGraph                 _deferred_graph;
+
+    template<typename T>
+    auto _push_any(
+        StageKind             kind,
+        T&&                   stage,
+        Optional<StageAccess> access,
+        HashedID              instance_id,
+        String                name)
+            -> SystemKey;
 
     auto _push_stage(
-        Vector<SystemKey>& list,
-        auto&&             stage,
-        HashedID           instance_id,
-        String             name)
+        Vector<SystemKey>&         list,
+        auto&&                     stage,
+        Optional<StageAccess>      access,
+        StoredStage::resources_fn  resources,
+        HashedID                   instance_id,
+        String                     name)
             -> SystemKey;
+
+    void _rebuild_precompute_graphs();
+    auto _build_precompute_graph(auto&& stage_keys) const -> PrecomputeGraph;
 };
 
 
@@ -76,6 +153,33 @@ auto Pipeline::push(
     HashedID  instance_id,
     String    name)
     -> SystemKey
+{
+    Optional<StageAccess> access;
+    if constexpr (stage_with_declared_access<T>)
+        access = std::remove_cvref_t<T>::access();
+    return _push_any(kind, FORWARD(stage), MOVE(access), instance_id, MOVE(name));
+}
+
+template<typename T>
+auto Pipeline::push(
+    StageKind   kind,
+    T&&         stage,
+    StageAccess access,
+    HashedID    instance_id,
+    String      name)
+    -> SystemKey
+{
+    return _push_any(kind, FORWARD(stage), MOVE(access), instance_id, MOVE(name));
+}
+
+template<typename T>
+auto Pipeline::_push_any(
+    StageKind             kind,
+    T&&                   stage,
+    Optional<StageAccess> access,
+    HashedID              instance_id,
+    String                name)
+    -> SystemKey
 {
     const auto make_stage_name = [](String src) -> String
     {
@@ -104,7 +208,19 @@ auto Pipeline::push(
         }
         panic();
     };
-    return _push_stage(list, FORWARD(stage), instance_id, make_stage_name(name));
+    StoredStage::resources_fn resources = nullptr;
+    if constexpr (stage_with_declared_resources<T>)
+    {
+        resources = [](const PipelineStage& stage, Extent2I main_resolution) -> StageResources
+        {
+            return stage.target_unchecked<std::remove_cvref_t<T>>().resources(main_resolution);
+        };
+    }
+
+    const SystemKey key = _push_stage(list, FORWARD(stage), MOVE(access), resources, instance_id, make_stage_name(name));
+    if (kind == StageKind::Precompute)
+        _rebuild_precompute_graphs();
+    return key;
 }
 
 inline auto Pipeline::view(StageKind kind) const noexcept
@@ -122,17 +238,19 @@ inline auto Pipeline::view(StageKind kind) const noexcept
 
 template<typename T>
 auto Pipeline::_push_stage(
-    Vector<SystemKey>& list,
-    T&&                stage,
-    HashedID           instance_id,
-    String             name)
+    Vector<SystemKey>&        list,
+    T&&                       stage,
+    Optional<StageAccess>     access,
+    StoredStage::resources_fn resources,
+    HashedID                  instance_id,
+    String                    name)
         -> SystemKey
 {
     const SystemKey key = {
         .type        = type_id<T>(),
         .instance_id = instance_id,
     };
-    auto [it, was_emplaced] = _stages.try_emplace(key, MOVE(name), FORWARD(stage));
+    auto [it, was_emplaced] = _stages.try_emplace(key, MOVE(name), FORWARD(stage), MOVE(access), resources);
     if (not was_emplaced)
     {
         // HMM: What do we do? Just return the key as is?
@@ -143,5 +261,67 @@ auto Pipeline::_push_stage(
     return key;
 }
 
+inline void Pipeline::_rebuild_precompute_graphs()
+{
+    const auto is_deferrable = [this](const SystemKey& key)
+    {
+        const auto& access = _stages.at(key).access;
+        return access and access->is_deferrable();
+    };
+
+    _precompute_graph = _build_precompute_graph(_precompute);
+    _immediate_graph  = _build_precompute_graph(_precompute | std::views::filter(std::not_fn(is_deferrable)));
+    _deferred_graph   = _build_precompute_graph(_precompute | std::views::filter(is_deferrable));
+}
+
+inline auto Pipeline::_build_precompute_graph(auto&& stage_keys) const
+    -> PrecomputeGraph
+{
+    PrecomputeGraph graph;
+
+    const auto access_of = [this](const SystemKey& key)
+        -> const Optional<StageAccess>&
+    {
+        return _stages.at(key).access;
+    };
+
+    for (const SystemKey& key : stage_keys)
+    {
+        const uindex idx      = graph.nodes.size();
+        const bool   declared = access_of(key).has_value();
+        graph.nodes.push_back({ .key = key });
+
+        if (declared)
+            graph.access.merge(*access_of(key));
+
+        const bool extends_last =
+            declared and
+            not graph.batches.empty() and
+            graph.batches.back().concurrent;
+
+        if (not extends_last)
+        {
+            graph.batches.push_back({ .first = idx, .count = 1, .concurrent = declared });
+            continue;
+        }
+
+        // Depend on each earlier conflicting stage in the batch. Some of these
+        // edges are redundant, but the batches are tiny, so we don't care.
+        auto& batch = graph.batches.back();
+        for (const uindex prev_idx : irange(batch.first, idx))
+        {
+            auto& prev = graph.nodes[prev_idx];
+            if (access_of(prev.key)->conflicts_with(*access_of(key)))
+            {
+                prev.dependents.push_back(idx);
+                ++graph.nodes[idx].num_dependencies;
+            }
+        }
+        ++batch.count;
+    }
+
+    return graph;
+}
+
 
 } // namespace josh
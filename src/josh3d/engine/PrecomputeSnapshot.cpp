@@ -0,0 +1,34 @@
+#include "PrecomputeSnapshot.hpp"
+#include "Tracy.hpp"
+
+
+namespace josh {
+
+
+void PrecomputeSnapshot::capture(Registry& source, const StageAccess& access)
+{
+    ZS;
+    _access = access;
+
+    // Entities are recreated with the same identifiers, so that
+    // the snapshot components can be matched back on publish.
+    // Only the ones that hold any of the declared components are needed.
+    _registry.clear();
+    for (const auto& c : _access._reads)    c.ops->create_entities(source, _registry);
+    for (const auto& c : _access._writes)   c.ops->create_entities(source, _registry);
+    for (const auto& c : _access._produces) c.ops->create_entities(source, _registry);
+
+    for (const auto& c : _access._reads)    c.ops->copy(source, _registry);
+    for (const auto& c : _access._writes)   c.ops->copy(source, _registry);
+    for (const auto& c : _access._produces) c.ops->copy(source, _registry);
+}
+
+void PrecomputeSnapshot::publish(Registry& destination)
+{
+    ZS;
+    for (const auto& c : _access._produces)
+        c.ops->publish(_registry, destination);
+}
+
+
+} // namespace josh
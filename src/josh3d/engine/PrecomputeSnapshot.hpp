@@ -0,0 +1,38 @@
+#pragma once
+#include "ECS.hpp"
+#include "StageAccess.hpp"
+
+
+namespace josh {
+
+
+/*
+A partial copy of the scene registry that the deferred precompute
+stages run against when the frame is pipelined. See FramePipelining.
+
+Only the components and the active objects declared in the access are
+copied, together with the entities that hold them.
+Once the stages are done, the produced components are published back.
+
+The source registry must not be modified in between the capture and
+the publish, other than through the publish itself. The rendering stages
+only read the registry, so this holds for the duration of the frame.
+*/
+struct PrecomputeSnapshot
+{
+    // Replaces the contents of the snapshot with the entities of
+    // the `source` and all components declared in the `access`.
+    void capture(Registry& source, const StageAccess& access);
+
+    // Replaces the produced components of the last captured access
+    // in the `destination` with the ones from the snapshot.
+    void publish(Registry& destination);
+
+    auto registry() noexcept -> Registry& { return _registry; }
+
+    Registry    _registry;
+    StageAccess _access;
+};
+
+
+} // namespace josh
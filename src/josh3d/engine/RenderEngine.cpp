@@ -11,11 +11,113 @@
 #include "StageContext.hpp"
 #include "Transform.hpp"
 #include "Tracy.hpp"
+#include "async/ThreadPool.hpp"
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/matrix.hpp>
+#include <atomic>
+#include <exception>
+#include <latch>
 
 
 namespace josh {
+namespace {
+
+/*
+Runs a concurrent batch of precompute stages on the `pool` according to
+their dependencies in the graph. Calls `while_waiting` on the calling
+thread in the meantime, then blocks until all stages are done.
+
+Each stage launches its dependents once it is done and it was their
+last remaining dependency. If a stage throws, the remaining stages
+are skipped, and the exception is rethrown on the calling thread.
+*/
+template<typename ExecuteF, typename WhileWaitingF>
+void execute_batch_concurrently(
+    ThreadPool&                   pool,
+    const PrecomputeGraph&        graph,
+    const PrecomputeGraph::Batch& batch,
+    ExecuteF&&                    execute_stage,
+    WhileWaitingF&&               while_waiting)
+{
+    ZS;
+    struct BatchState
+    {
+        ThreadPool&                      pool;
+        const PrecomputeGraph&           graph;
+        ExecuteF&                        execute_stage;
+        uindex                           first;
+        UniquePtr<std::atomic<usize>[]>  num_pending;
+        std::latch                       done;
+        std::atomic<bool>                failed = false;
+        std::exception_ptr               exception;
+
+        void launch(uindex idx)
+        {
+            discard(pool.emplace([this, idx] { run(idx); }));
+        }
+
+        void run(uindex idx)
+        {
+            const auto& node = graph.nodes[idx];
+
+            if (not failed.load(std::memory_order_acquire))
+            {
+                try
+                {
+                    execute_stage(node.key);
+                }
+                catch (...)
+                {
+                    if (not failed.exchange(true, std::memory_order_acq_rel))
+                        exception = std::current_exception();
+                }
+            }
+
+            for (const uindex dependent_idx : node.dependents)
+                if (num_pending[dependent_idx - first].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    launch(dependent_idx);
+
+            // NOTE: Must be last. The state is destroyed as soon as the latch is released.
+            done.count_down();
+        }
+    };
+
+    BatchState state = {
+        .pool          = pool,
+        .graph         = graph,
+        .execute_stage = execute_stage,
+        .first         = batch.first,
+        .num_pending   = std::make_unique<std::atomic<usize>[]>(batch.count),
+        .done          = std::latch(ptrdiff_t(batch.count)),
+    };
+
+    const auto batch_range = irange(batch.first, batch.first + batch.count);
+
+    for (const uindex idx : batch_range)
+        state.num_pending[idx - batch.first].store(graph.nodes[idx].num_dependencies, std::memory_order_relaxed);
+
+    for (const uindex idx : batch_range)
+        if (graph.nodes[idx].num_dependencies == 0)
+            state.launch(idx);
+
+    try
+    {
+        while_waiting();
+    }
+    catch (...)
+    {
+        // The tasks reference the state on this stack frame.
+        state.done.wait();
+        throw;
+    }
+
+    state.done.wait();
+
+    if (state.exception)
+        std::rethrow_exception(state.exception);
+}
+
+} // namespace
 
 
 RenderEngine::RenderEngine(
@@ -64,11 +166,42 @@ void RenderEngine::render(
     StageContext::CommonState common_state = {
         .engine            = *this,
         .runtime           = runtime,
+        .registry          = runtime.registry,
         .primitives        = runtime.primitives,
         .frame_timer       = frame_timer,
         .window_resolution = window_resolution,
     };
 
+    auto execute_stage_on = [&](
+        StageContext::CommonState& state,
+        const SystemKey&           key,
+        GPUTiming                  gpu_timing)
+    {
+        Pipeline::StoredStage* stored = pipeline.try_get(key);
+        assert(stored);
+
+        PerfHarness* perf_harness = runtime.perf_assembly.try_get(key);
+
+        StageContext::PerStageState stage_state = {
+            .perf_harness = perf_harness,
+        };
+
+        const StageContext context = { state, stage_state };
+
+        if (perf_harness)
+            perf_harness->start_frame(gpu_timing);
+
+        (stored->stage)(context);
+
+        if (perf_harness)
+            perf_harness->end_frame();
+    };
+
+    auto execute_stage = [&](const SystemKey& key)
+    {
+        execute_stage_on(common_state, key, GPUTiming::Enabled);
+    };
+
     auto execute_stages = [&](
         auto&           stage_keys,
         const Region2I* viewport = nullptr)
@@ -77,91 +210,180 @@ void RenderEngine::render(
 
         for (auto& key : stage_keys)
         {
-            if (viewport)
-                glapi::set_viewport(*viewport);
+            if (_graph.is_culled(key))
+                continue;
 
-            Pipeline::StoredStage* stored = pipeline.try_get(key);
-            assert(stored);
+            if (const BarrierMask barriers = _graph.barriers_before(key); barriers != BarrierMask{})
+                glapi::memory_barrier(barriers);
 
-            PerfHarness* perf_harness = runtime.perf_assembly.try_get(key);
+            if (viewport)
+                glapi::set_viewport(*viewport);
 
-            StageContext::PerStageState stage_state = {
-                .perf_harness = perf_harness,
-            };
+            execute_stage(key);
+        }
+    };
 
-            const StageContext context = { common_state, stage_state };
+    auto execute_precompute = [&](const PrecomputeGraph& graph)
+    {
+        ZSN("execute_precompute");
 
-            if (perf_harness)
-                perf_harness->start_frame();
+        for (const PrecomputeGraph::Batch& batch : graph.batches)
+        {
+            if (not parallel_precompute or not batch.concurrent or batch.count == 1)
+            {
+                for (const uindex idx : irange(batch.first, batch.first + batch.count))
+                    execute_stage(graph.nodes[idx].key);
+                continue;
+            }
+
+            // Storage creation is not thread-safe, so we assure it upfront.
+            for (const uindex idx : irange(batch.first, batch.first + batch.count))
+                pipeline.try_get(graph.nodes[idx].key)->access->assure_storage(runtime.registry);
+
+            // NOTE: The GPU is never timed off the render thread.
+            execute_batch_concurrently(runtime.async_cradle.task_pool, graph, batch,
+                [&](const SystemKey& key) { execute_stage_on(common_state, key, GPUTiming::Disabled); },
+                [] {});
+        }
+    };
 
-            (stored->stage)(context);
+    // Everything after precompute. Might run concurrently with the deferred precompute.
+    auto execute_rest = [&]()
+    {
+        // NOTE: After the precompute, since that might change what the stages declare.
+        _compile_graph();
+        _graph.realize();
 
-            if (perf_harness)
-                perf_harness->end_frame();
+        // Primary.
+        {
+            const BindGuard bfb = _main_target._back().fbo->bind_draw();
+            glapi::clear_depth_stencil_buffer(bfb, 1.0f, 0);
         }
+
+        // To swapchain backbuffer.
+        glapi::enable(Capability::DepthTesting);
+        execute_stages(pipeline._primary, &main_viewport);
+        glapi::disable(Capability::DepthTesting);
+
+        // Postprocess.
+        _main_target._swap();
+        // To swapchain (swap each draw).
+        execute_stages(pipeline._postprocess, &main_viewport);
+
+        if (not present_to_default_fbo)
+            return;
+
+        // Blit front to default (opt. sRGB)
+        if (enable_srgb_conversion) glapi::enable(Capability::SRGBConversion);
+
+        // FIXME: Currently, the blitting is very limited because of the
+        // severe mismatch of formats between the main target and the
+        // default fbo. Linear filtering does not work, and mismatched
+        // resolutions completely break overlays.
+        _main_target._front().fbo->blit_to(
+            _default_fbo,
+            { {}, main_resolution() }, // Internal rendering resolution.
+            { {}, window_resolution }, // This is technically window size and can technically differ, technically.
+            BufferMask::ColorBit | BufferMask::DepthBit,
+            BlitFilter::Nearest
+        );
+
+        if (enable_srgb_conversion) glapi::disable(Capability::SRGBConversion);
+
+        // There are free frames on the table if you can eliminate
+        // this blit by redirecting last postprocessing draw to the
+        // default framebuffer. The problem is deciding which draw
+        // is "last".
+        //
+        // We can ask each stage to tell us which draw is last, and
+        // complain about perf if it doesn't comply. We run into a problem,
+        // however, if no draw is made in the last stage at all
+        // and are forced to blit anyway.
+        //
+        // The harder approach is to require each stage to be able
+        // to tell us whether it will be drawing anything at all
+        // before the frame even starts (starting from primary stages),
+        // and then expect it to hold true until the end.
+        // This is a difficult requirement because stages can technically
+        // communicate through SharedStorage and the like, but
+        // might be reasonable just as the assumption about stable registry.
+
+        // Overlay.
+        execute_stages(pipeline._overlay, &window_viewport);
     };
 
     // Sweep the belt. This removes all *stale* items from the previous frame.
     belt.sweep();
 
     // Precompute.
-    execute_stages(pipeline._precompute);
+    const PrecomputeGraph& deferred = pipeline.deferred_precompute_graph();
 
-    // Primary.
+    // NOTE: Pipelining runs the deferred stages on the task pool,
+    // which is exactly what disabling the parallel precompute opts out of.
+    const bool pipelined =
+        parallel_precompute and
+        frame_pipelining == FramePipelining::Throughput and
+        not deferred.nodes.empty();
+
+    if (not pipelined)
+    {
+        execute_precompute(pipeline.precompute_graph());
+        execute_rest();
+    }
+    else
     {
-        const BindGuard bfb = _main_target._back().fbo->bind_draw();
-        glapi::clear_depth_stencil_buffer(bfb, 1.0f, 0);
+        execute_precompute(pipeline.immediate_precompute_graph());
+
+        _precompute_snapshot.capture(runtime.registry, deferred.access);
+
+        StageContext::CommonState snapshot_state = {
+            .engine            = *this,
+            .runtime           = runtime,
+            .registry          = _precompute_snapshot.registry(),
+            .primitives        = runtime.primitives,
+            .frame_timer       = frame_timer,
+            .window_resolution = window_resolution,
+        };
+
+        // All deferrable stages have declared access, so they always form a single batch.
+        assert(deferred.batches.size() == 1 and deferred.batches[0].concurrent);
+        execute_batch_concurrently(runtime.async_cradle.task_pool, deferred, deferred.batches[0],
+            [&](const SystemKey& key) { execute_stage_on(snapshot_state, key, GPUTiming::Disabled); },
+            execute_rest);
+
+        // The products are picked up by the next frame.
+        _precompute_snapshot.publish(runtime.registry);
     }
 
-    // To swapchain backbuffer.
-    glapi::enable(Capability::DepthTesting);
-    execute_stages(pipeline._primary, &main_viewport);
-    glapi::disable(Capability::DepthTesting);
-
-    // Postprocess.
-    _main_target._swap();
-    // To swapchain (swap each draw).
-    execute_stages(pipeline._postprocess, &main_viewport);
-
-    // Blit front to default (opt. sRGB)
-    if (enable_srgb_conversion) glapi::enable(Capability::SRGBConversion);
-
-    // FIXME: Currently, the blitting is very limited because of the
-    // severe mismatch of formats between the main target and the
-    // default fbo. Linear filtering does not work, and mismatched
-    // resolutions completely break overlays.
-    _main_target._front().fbo->blit_to(
-        _default_fbo,
-        { {}, main_resolution() }, // Internal rendering resolution.
-        { {}, window_resolution }, // This is technically window size and can technically differ, technically.
-        BufferMask::ColorBit | BufferMask::DepthBit,
-        BlitFilter::Nearest
-    );
-
-    if (enable_srgb_conversion) glapi::disable(Capability::SRGBConversion);
-
-    // There are free frames on the table if you can eliminate
-    // this blit by redirecting last postprocessing draw to the
-    // default framebuffer. The problem is deciding which draw
-    // is "last".
-    //
-    // We can ask each stage to tell us which draw is last, and
-    // complain about perf if it doesn't comply. We run into a problem,
-    // however, if no draw is made in the last stage at all
-    // and are forced to blit anyway.
-    //
-    // The harder approach is to require each stage to be able
-    // to tell us whether it will be drawing anything at all
-    // before the frame even starts (starting from primary stages),
-    // and then expect it to hold true until the end.
-    // This is a difficult requirement because stages can technically
-    // communicate through SharedStorage and the like, but
-    // might be reasonable just as the assumption about stable registry.
+    // Present.
+}
 
-    // Overlay.
-    execute_stages(pipeline._overlay, &window_viewport);
+void RenderEngine::_compile_graph()
+{
+    ZS;
+    Vector<RenderGraph::Pass> passes;
 
-    // Present.
+    const auto push_passes = [&](const Vector<SystemKey>& stage_keys)
+    {
+        for (const SystemKey& key : stage_keys)
+        {
+            const Pipeline::StoredStage* stored = pipeline.try_get(key);
+            assert(stored);
+
+            Optional<StageResources> resources;
+            if (stored->resources)
+                resources = stored->resources(stored->stage, main_resolution());
+
+            passes.push_back({ .key = key, .resources = MOVE(resources) });
+        }
+    };
+
+    push_passes(pipeline._primary);
+    push_passes(pipeline._postprocess);
+    if (present_to_default_fbo)
+        push_passes(pipeline._overlay);
+
+    _graph.compile(MOVE(passes));
 }
 
 void RenderEngine::_update_camera_data(
@@ -10,7 +10,9 @@
 #include "FrameTimer.hpp"
 #include "GLObjects.hpp"
 #include "Pipeline.hpp"
+#include "PrecomputeSnapshot.hpp"
 #include "Region.hpp"
+#include "RenderGraph.hpp"
 #include "Skeleton.hpp"
 #include "StaticRing.hpp"
 
@@ -40,6 +42,26 @@ enum class DSFormat : u32
 };
 JOSH3D_DEFINE_ENUM_EXTRAS(DSFormat, Depth24_Stencil8);
 
+/*
+Controls how the precompute stages are scheduled relative to the rest of the frame.
+
+Latency: All precompute stages run before the primary stages, and their
+results are used in the same frame. This is the traditional sequential frame.
+
+Throughput: The deferred precompute stages (see StageAccess::is_deferrable())
+run on the task pool against a snapshot of the registry, concurrently with
+the primary, postprocess and overlay stages of the current frame. Their products
+are published at the end of the frame and are used in the *next* frame.
+This hides the precompute cost behind the GL submission at the cost
+of one frame of latency for the deferred products (culling, bounds, etc.).
+*/
+enum class FramePipelining : u8
+{
+    Latency,
+    Throughput,
+};
+JOSH3D_DEFINE_ENUM_EXTRAS(FramePipelining, Latency, Throughput);
+
 struct MainTarget
 {
     auto resolution()    const noexcept -> Extent2I  { return _resolution; }
@@ -91,10 +113,27 @@ struct RenderEngine
     // Automatically resize the main target to window size on each call to render().
     bool fit_window_size = true;
 
+    // Blit the final image to the default framebuffer and draw the overlays over it.
+    // Disable when there is no default framebuffer, as with a HeadlessContext.
+    // The final image is then left in the front side of the main target.
+    bool present_to_default_fbo = true;
+
+    // Run precompute stages with declared StageAccess concurrently on the task pool.
+    // If disabled, all precompute stages are run in order on the render thread.
+    bool parallel_precompute = true;
+
+    // Whether the deferrable precompute stages are overlapped with the rest of the frame.
+    // Only takes effect if the `parallel_precompute` is enabled.
+    FramePipelining frame_pipelining = FramePipelining::Latency;
+
     // Rendering stages that get executed on each call to render().
     // Assemble this after creating the engine itself.
     Pipeline pipeline;
 
+    // Transient render targets of the stages with declared StageResources.
+    // Rebuilt from the pipeline on each call to render(), if anything changed.
+    auto render_graph() const noexcept -> const RenderGraph& { return _graph; }
+
     // Communication channel for pipeline stages. The belt is swept
     // in the beginning of the call to `render()`, *before* the pipeline
     // is executed. You are free to peek after.
@@ -114,6 +153,12 @@ struct RenderEngine
 
     MainTarget _main_target; // FIXME: Why is this "private"?
 
+    // Registry copy for the deferred precompute stages when pipelining.
+    PrecomputeSnapshot _precompute_snapshot;
+
+    RenderGraph _graph;
+    void _compile_graph();
+
     // FIXME: This should be configurable, no? Just pass "destination" FBO to render?
     inline static const RawDefaultFramebuffer<GLMutable> _default_fbo = {};
 
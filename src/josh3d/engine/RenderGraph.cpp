@@ -0,0 +1,395 @@
+#include "RenderGraph.hpp"
+#include "Common.hpp"
+#include "Errors.hpp"
+#include "GLAPICore.hpp"
+#include "GLObjectHelpers.hpp"
+#include "GLTextures.hpp"
+#include "Ranges.hpp"
+#include <algorithm>
+
+
+namespace josh {
+namespace {
+
+
+struct StorageClass
+{
+    InternalFormat iformat; // Representative of the view class.
+    usize          bytes_per_texel;
+};
+
+/*
+Textures can only be viewed with a format of the same view class [Table 8.22].
+We allocate the storage with one representative format per class so that
+any two transients in the same class could share it.
+
+Formats outside of the table (depth, stencil, compressed) can only
+be viewed with the exact same format, so they are their own class.
+*/
+auto storage_class_of(InternalFormat iformat) noexcept
+    -> StorageClass
+{
+    using enum InternalFormat;
+    switch (iformat)
+    {
+        case RGBA32F: case RGBA32UI: case RGBA32I:
+            return { RGBA32F, 16 };
+
+        case RGB32F: case RGB32UI: case RGB32I:
+            return { RGB32F, 12 };
+
+        case RGBA16F: case RG32F: case RGBA16UI: case RG32UI: case RGBA16I: case RG32I:
+        case RGBA16: case RGBA16_SNorm:
+            return { RGBA16, 8 };
+
+        case RGB16: case RGB16_SNorm: case RGB16F: case RGB16UI: case RGB16I:
+            return { RGB16, 6 };
+
+        case RG16F: case R11F_G11F_B10F: case R32F: case RGB10_A2UI: case RGBA8UI: case RG16UI:
+        case R32UI: case RGBA8I: case RG16I: case R32I: case RGB10_A2: case RGBA8: case RG16:
+        case RGBA8_SNorm: case RG16_SNorm: case SRGBA8: case RGB9_E5:
+            return { RGBA8, 4 };
+
+        case RGB8: case RGB8_SNorm: case SRGB8: case RGB8UI: case RGB8I:
+            return { RGB8, 3 };
+
+        case R16F: case RG8UI: case R16UI: case RG8I: case R16I: case RG8: case R16:
+        case RG8_SNorm: case R16_SNorm:
+            return { RG8, 2 };
+
+        case R8UI: case R8I: case R8: case R8_SNorm:
+            return { R8, 1 };
+
+        case DepthComponent16:
+            return { iformat, 2 };
+        case Depth32F_Stencil8:
+            return { iformat, 8 };
+
+        default:
+            return { iformat, 4 }; // Good enough for an estimate.
+    }
+}
+
+auto estimate_bytes(const Extent2I& resolution, i32 num_levels, InternalFormat iformat) noexcept
+    -> usize
+{
+    const usize bpt = storage_class_of(iformat).bytes_per_texel;
+    usize total = 0;
+    for (const i32 level : irange(num_levels))
+    {
+        const usize w = std::max(resolution.width  >> level, 1);
+        const usize h = std::max(resolution.height >> level, 1);
+        total += w * h * bpt;
+    }
+    return total;
+}
+
+auto barrier_for(GPUAccess access)
+    -> BarrierMask
+{
+    switch (access)
+    {
+        case GPUAccess::Framebuffer: return BarrierMask::FramebufferBit;
+        case GPUAccess::Sampler:     return BarrierMask::TextureFetchBit;
+        case GPUAccess::Image:       return BarrierMask::ShaderImageAccessBit;
+    }
+    safe_unreachable("Invalid GPUAccess.");
+}
+
+
+} // namespace
+
+
+void RenderGraph::compile(Vector<Pass> passes)
+{
+    if (passes == _passes)
+        return;
+
+    const usize num_passes = passes.size();
+
+    // Find the creator of each transient.
+    // Anything that is not created in the graph is considered external.
+    HashMap<HashedID, uindex> creator_of;
+    for (const auto [i, pass] : enumerate(passes))
+    {
+        if (not pass.resources) continue;
+        for (const auto& creation : pass.resources->_creates)
+        {
+            const auto [it, was_emplaced] = creator_of.try_emplace(creation.id, uindex(i));
+            if (not was_emplaced)
+                throw_fmt("Transient \"{}\" is created by more than one stage.", creation.name);
+        }
+    }
+
+    // Transients can only be used after they are created in the same frame.
+    for (const auto [i, pass] : enumerate(passes))
+    {
+        if (not pass.resources) continue;
+        const auto check_use = [&](const StageResources::Use& use)
+        {
+            const auto it = creator_of.find(use.id);
+            if (it != creator_of.end() and it->second > uindex(i))
+                throw_fmt("Transient with ID {} is used by a stage before it is created.", use.id);
+        };
+        std::ranges::for_each(pass.resources->_reads,  check_use);
+        std::ranges::for_each(pass.resources->_writes, check_use);
+    }
+
+    // Cull the passes in reverse, starting from the ones that write
+    // external resources. Undeclared passes are always live, and could
+    // access any transient created before them.
+    Vector<bool>      live(num_passes, false);
+    HashSet<HashedID> needed;
+    bool              need_all = false;
+
+    const auto is_needed = [&](HashedID id)
+    {
+        return need_all or not creator_of.contains(id) or needed.contains(id);
+    };
+
+    for (const uindex i : irange(num_passes) | reverse)
+    {
+        const Pass& pass = passes[i];
+
+        if (not pass.resources)
+        {
+            live[i]  = true;
+            need_all = true;
+            continue;
+        }
+
+        const StageResources& res = *pass.resources;
+
+        const bool is_live =
+            std::ranges::any_of(res._creates, [&](const auto& c) { return is_needed(c.id); }) or
+            std::ranges::any_of(res._writes,  [&](const auto& w) { return is_needed(w.id); });
+
+        if (not is_live) continue;
+
+        live[i] = true;
+        // NOTE: Writing implies reading, the previous contents are kept.
+        for (const auto& use : res._reads)  needed.insert(use.id);
+        for (const auto& use : res._writes) needed.insert(use.id);
+    }
+
+    // Collect the transients of the live creators and find their lifetimes.
+    Vector<Transient>         transients;
+    HashMap<HashedID, uindex> transient_of;
+
+    for (const auto [i, pass] : enumerate(passes))
+    {
+        if (not live[i] or not pass.resources) continue;
+        for (const auto& creation : pass.resources->_creates)
+        {
+            transient_of.emplace(creation.id, transients.size());
+            transients.push_back({
+                .id         = creation.id,
+                .name       = creation.name,
+                .desc       = creation.desc,
+                .first_pass = uindex(i),
+                .last_pass  = uindex(i),
+                .slot       = {},
+                .view       = {},
+            });
+        }
+    }
+
+    for (const auto [i, pass] : enumerate(passes))
+    {
+        if (not live[i]) continue;
+
+        if (not pass.resources)
+        {
+            for (Transient& t : transients)
+                if (t.first_pass < uindex(i))
+                    t.last_pass = uindex(i);
+            continue;
+        }
+
+        const auto extend = [&](const StageResources::Use& use)
+        {
+            const auto it = transient_of.find(use.id);
+            if (it != transient_of.end())
+                transients[it->second].last_pass = uindex(i);
+        };
+        std::ranges::for_each(pass.resources->_reads,  extend);
+        std::ranges::for_each(pass.resources->_writes, extend);
+    }
+
+    // Only the image stores are incoherent, everything else is synchronized
+    // by the driver. For each resource written through an image, keep track
+    // of the barrier bits issued since, so that each is only issued once.
+    //
+    // A barrier makes *all* previous writes visible, so the issued bits
+    // are accumulated for every pending resource, not just the one accessed.
+    HashMap<SystemKey, CompiledPass> compiled;
+    HashMap<HashedID, BarrierMask>   issued_since_store;
+
+    constexpr auto all_access_bits =
+        BarrierMask::FramebufferBit | BarrierMask::TextureFetchBit | BarrierMask::ShaderImageAccessBit;
+
+    for (const auto [i, pass] : enumerate(passes))
+    {
+        CompiledPass& cpass = compiled[pass.key];
+        cpass.culled = not live[i];
+        if (cpass.culled) continue;
+
+        BarrierMask barriers = {};
+
+        if (not pass.resources)
+        {
+            // Could be anything, be conservative.
+            for (const auto& [id, issued] : issued_since_store)
+                barriers |= all_access_bits & ~issued;
+        }
+        else
+        {
+            const auto require = [&](const StageResources::Use& use)
+            {
+                const auto it = issued_since_store.find(use.id);
+                if (it != issued_since_store.end())
+                    barriers |= barrier_for(use.access) & ~it->second;
+            };
+            std::ranges::for_each(pass.resources->_reads,  require);
+            std::ranges::for_each(pass.resources->_writes, require);
+        }
+
+        for (auto& [id, issued] : issued_since_store)
+            issued |= barriers;
+
+        if (pass.resources)
+            for (const auto& use : pass.resources->_writes)
+                if (use.access == GPUAccess::Image)
+                    issued_since_store[use.id] = {};
+
+        cpass.barriers = barriers;
+    }
+
+    // Greedily assign the transients to slots in the order of creation.
+    // Transients are already sorted by their first pass.
+    Vector<Slot> slots;
+    for (Transient& t : transients)
+    {
+        const InternalFormat storage_iformat = storage_class_of(t.desc.iformat).iformat;
+
+        const auto fits = [&](const Slot& slot)
+        {
+            return
+                slot.resolution == t.desc.resolution and
+                slot.num_levels == t.desc.num_levels and
+                slot.iformat    == storage_iformat   and
+                slot.last_pass  <  t.first_pass;
+        };
+
+        const auto it = std::ranges::find_if(slots, fits);
+        if (it != slots.end())
+        {
+            it->last_pass = t.last_pass;
+            t.slot        = uindex(it - slots.begin());
+        }
+        else
+        {
+            t.slot = slots.size();
+            slots.push_back({
+                .resolution = t.desc.resolution,
+                .num_levels = t.desc.num_levels,
+                .iformat    = storage_iformat,
+                .last_pass  = t.last_pass,
+                .texture    = {},
+            });
+        }
+    }
+
+    // Keep the old textures of the slots that have not changed.
+    for (Slot& slot : slots)
+    {
+        const auto same_storage = [&](const Slot& old)
+        {
+            return
+                old.texture.has_value()          and
+                old.resolution == slot.resolution and
+                old.num_levels == slot.num_levels and
+                old.iformat    == slot.iformat;
+        };
+
+        const auto it = std::ranges::find_if(_slots, same_storage);
+        if (it != _slots.end())
+        {
+            slot.texture = MOVE(it->texture);
+            it->texture.reset();
+        }
+    }
+
+    Stats stats{ .num_passes = num_passes };
+    stats.num_culled     = usize(std::ranges::count(live, false));
+    stats.num_transients = transients.size();
+    stats.num_textures   = slots.size();
+    for (const Transient& t : transients)
+        stats.declared_bytes += estimate_bytes(t.desc.resolution, t.desc.num_levels, t.desc.iformat);
+    for (const Slot& slot : slots)
+        stats.allocated_bytes += estimate_bytes(slot.resolution, slot.num_levels, slot.iformat);
+
+    _passes        = MOVE(passes);
+    _compiled      = MOVE(compiled);
+    _transients    = MOVE(transients);
+    _transient_of  = MOVE(transient_of);
+    _slots         = MOVE(slots);
+    _stats         = stats;
+    _needs_realize = true;
+}
+
+void RenderGraph::realize()
+{
+    if (not _needs_realize)
+        return;
+
+    for (Slot& slot : _slots)
+    {
+        if (not slot.texture)
+        {
+            slot.texture = allocate_texture<TextureTarget::Texture2D>(
+                slot.resolution, slot.iformat, NumLevels{ slot.num_levels });
+        }
+    }
+
+    // NOTE: Views are cheap, and recreating all of them is simpler
+    // than tracking which slot each one used to point to.
+    for (Transient& t : _transients)
+    {
+        t.view = create_texture_view(_slots[t.slot].texture->get(), t.desc.iformat,
+            MipLevel{ 0 }, NumLevels{ t.desc.num_levels });
+    }
+
+    _needs_realize = false;
+}
+
+auto RenderGraph::is_culled(const SystemKey& key) const noexcept
+    -> bool
+{
+    const auto it = _compiled.find(key);
+    return it != _compiled.end() and it->second.culled;
+}
+
+auto RenderGraph::barriers_before(const SystemKey& key) const noexcept
+    -> BarrierMask
+{
+    const auto it = _compiled.find(key);
+    return it != _compiled.end() ? it->second.barriers : BarrierMask{};
+}
+
+auto RenderGraph::transient(HashedID id) const
+    -> RawTexture2D<>
+{
+    const auto it = _transient_of.find(id);
+    if (it == _transient_of.end())
+        panic_fmt("Transient with ID {} is not created by any live stage.", id);
+
+    const Transient& t = _transients[it->second];
+    if (not t.view)
+        panic_fmt("Transient \"{}\" is requested before the graph is realized.", t.name);
+
+    return t.view->get();
+}
+
+
+} // namespace josh
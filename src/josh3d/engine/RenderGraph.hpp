@@ -0,0 +1,243 @@
+#pragma once
+#include "Common.hpp"
+#include "EnumUtils.hpp"
+#include "GLAPICore.hpp"
+#include "GLObjects.hpp"
+#include "GLTextures.hpp"
+#include "HashedString.hpp"
+#include "Region.hpp"
+#include "Scalars.hpp"
+#include "SystemKey.hpp"
+#include <concepts>
+#include <type_traits>
+
+
+/*
+Transient render targets of the RenderEngine and the per-frame graph
+of the stages that create, read and write them.
+
+Instead of each stage owning its render targets for the whole run, the
+stages declare the transients that they need, and the graph figures out
+which stages can be culled, when each transient is alive, and which
+transients can share the same memory.
+
+In OpenGL, the memory can only be shared between the textures through
+texture views, which limits the aliasing to the transients with the same
+resolution, number of levels, and view class of the format [8.18].
+For example, a R11F_G11F_B10F target can alias with a RGBA8 one, but not
+with a RGB8 one. The textures are kept between frames, and are only
+reallocated when the declarations change.
+*/
+namespace josh {
+
+
+/*
+Resources that exist outside of the graph and are never culled.
+Writing any name that is not created by one of the stages has the same effect.
+*/
+constexpr auto resource_main_target = "MainTarget"_hs;
+constexpr auto resource_default_fbo = "DefaultFramebuffer"_hs;
+
+
+/*
+Description of a transient 2D texture.
+*/
+struct TransientDesc
+{
+    Extent2I       resolution;
+    InternalFormat iformat;
+    i32            num_levels = 1;
+
+    auto operator==(const TransientDesc& other) const noexcept -> bool
+    {
+        return
+            resolution == other.resolution and
+            iformat    == other.iformat    and
+            num_levels == other.num_levels;
+    }
+};
+
+
+/*
+How a resource is accessed on the GPU. Determines the memory barriers.
+*/
+enum class GPUAccess : u8
+{
+    Framebuffer, // Attached to a framebuffer: drawn into, blended, depth tested.
+    Sampler,     // Fetched through a texture unit.
+    Image,       // Loaded or stored through an image unit.
+};
+JOSH3D_DEFINE_ENUM_EXTRAS(GPUAccess, Framebuffer, Sampler, Image);
+
+
+/*
+Declared set of resources that a rendering stage creates, reads and writes.
+
+    auto resources(Extent2I main_resolution) const -> StageResources
+    {
+        return StageResources()
+            .creates(AOBuffers::transient_side0, { main_resolution, AOBuffers::iformat })
+            .reads(GBuffer::transient_normals)
+            .reads(resource_main_target);
+    }
+
+Unlike the StageAccess, this is a member function, since what is created
+usually depends on the current settings of the stage. It is requested on
+every frame, so it should be cheap. A disabled stage should declare nothing.
+
+The creator of a transient must fully overwrite or clear it, as its contents
+are undefined at the start of each frame. Writing implies reading, so the
+stages that only add to a transient (ex. geometry into the GBuffer) keep
+its creator alive.
+
+A stage without declared resources is never culled, and is assumed
+to access every transient created before it.
+*/
+struct StageResources
+{
+    template<usize N> auto creates(FixedHashedString<N> name, const TransientDesc& desc) && -> StageResources&&;
+    template<usize N> auto reads  (FixedHashedString<N> name, GPUAccess access = GPUAccess::Sampler)     && -> StageResources&&;
+    template<usize N> auto writes (FixedHashedString<N> name, GPUAccess access = GPUAccess::Framebuffer) && -> StageResources&&;
+
+    struct Creation
+    {
+        HashedID      id;
+        String        name;
+        TransientDesc desc;
+        auto operator==(const Creation&) const noexcept -> bool = default;
+    };
+
+    struct Use
+    {
+        HashedID  id;
+        GPUAccess access;
+        auto operator==(const Use&) const noexcept -> bool = default;
+    };
+
+    Vector<Creation> _creates;
+    Vector<Use>      _reads;
+    Vector<Use>      _writes;
+
+    auto operator==(const StageResources&) const noexcept -> bool = default;
+};
+
+/*
+Stages can declare their resources with a `resources(Extent2I main_resolution)`
+member function. In that case, `Pipeline::push()` will pick it up automatically.
+*/
+template<typename T>
+concept stage_with_declared_resources = requires(const std::remove_cvref_t<T>& stage, Extent2I main_resolution)
+{
+    { stage.resources(main_resolution) } -> std::same_as<StageResources>;
+};
+
+
+template<usize N>
+auto StageResources::creates(FixedHashedString<N> name, const TransientDesc& desc) &&
+    -> StageResources&&
+{
+    _creates.push_back({ .id = name.hash(), .name = name.c_str(), .desc = desc });
+    return MOVE(*this);
+}
+
+template<usize N>
+auto StageResources::reads(FixedHashedString<N> name, GPUAccess access) &&
+    -> StageResources&&
+{
+    _reads.push_back({ .id = name.hash(), .access = access });
+    return MOVE(*this);
+}
+
+template<usize N>
+auto StageResources::writes(FixedHashedString<N> name, GPUAccess access) &&
+    -> StageResources&&
+{
+    _writes.push_back({ .id = name.hash(), .access = access });
+    return MOVE(*this);
+}
+
+
+class RenderGraph
+{
+public:
+    struct Pass
+    {
+        SystemKey                key;
+        Optional<StageResources> resources; // Undeclared if empty.
+        auto operator==(const Pass&) const noexcept -> bool = default;
+    };
+
+    // Rebuild the graph from the `passes` given in the execution order.
+    // Does nothing if the passes are the same as in the last call.
+    //
+    // Throws if two stages create the same transient.
+    void compile(Vector<Pass> passes);
+
+    // (Re)allocate the textures of the transients if the graph has changed.
+    // Textures that are no longer needed are released.
+    void realize();
+
+    // Whether the stage should be skipped, as nothing uses its outputs.
+    // Stages that are not in the graph are never culled.
+    auto is_culled(const SystemKey& key) const noexcept -> bool;
+
+    // Memory barriers that must be issued before the stage is executed.
+    auto barriers_before(const SystemKey& key) const noexcept -> BarrierMask;
+
+    // Texture of the transient created by one of the live stages.
+    // Only valid until the next call to `realize()`.
+    // Panics if there is no such transient.
+    auto transient(HashedID id) const -> RawTexture2D<>;
+
+    struct Stats
+    {
+        usize num_passes      = 0;
+        usize num_culled      = 0;
+        usize num_transients  = 0; // Of the live passes.
+        usize num_textures    = 0; // Actually allocated.
+        usize declared_bytes  = 0; // As if each transient had its own texture.
+        usize allocated_bytes = 0; // After aliasing.
+    };
+
+    // Estimated, not queried from the driver.
+    auto stats() const noexcept -> const Stats& { return _stats; }
+
+private:
+    struct CompiledPass
+    {
+        bool        culled   = false;
+        BarrierMask barriers = {};
+    };
+
+    struct Transient
+    {
+        HashedID        id;
+        String          name;
+        TransientDesc   desc;
+        uindex          first_pass;  // The creator.
+        uindex          last_pass;   // Last live pass that uses it.
+        uindex          slot;        // Into `_slots`.
+        Optional<UniqueTexture2D> view; // Empty until realized.
+    };
+
+    // Storage of the transients with non-overlapping lifetimes.
+    struct Slot
+    {
+        Extent2I        resolution;
+        i32             num_levels;
+        InternalFormat  iformat;     // Representative format of the view class.
+        uindex          last_pass;   // Of the last transient assigned, only used in `compile()`.
+        Optional<UniqueTexture2D> texture; // Empty until realized.
+    };
+
+    Vector<Pass>                     _passes;
+    HashMap<SystemKey, CompiledPass> _compiled;
+    Vector<Transient>                _transients;   // Of the live passes only.
+    HashMap<HashedID, uindex>        _transient_of; // Into `_transients`.
+    Vector<Slot>                     _slots;
+    Stats                            _stats;
+    bool                             _needs_realize = false;
+};
+
+
+} // namespace josh
@@ -1,4 +1,5 @@
 #include "Runtime.hpp"
+#include "ShaderPool.hpp"
 
 
 namespace josh {
@@ -7,7 +8,8 @@ Runtime::Runtime(const RuntimeParams& p)
     : async_cradle(
         p.task_pool_size,
         p.loading_pool_size,
-        p.main_window
+        p.io_pool_size,
+        p.main_context
     )
     , asset_manager(
         async_cradle.loading_pool,
@@ -38,6 +40,7 @@ Runtime::Runtime(const RuntimeParams& p)
         resource_database,
         resource_registry,
         mesh_registry,
+        texture_pool,
         async_cradle
     )
     , resource_unpacker(
@@ -50,6 +53,13 @@ Runtime::Runtime(const RuntimeParams& p)
         p.main_resolution,
         p.main_format
     )
-{}
+{
+    shader_pool().set_offscreen_context(&async_cradle.offscreen_context);
+}
+
+Runtime::~Runtime() noexcept
+{
+    shader_pool().set_offscreen_context(nullptr);
+}
 
 } // namespace josh
@@ -15,9 +15,7 @@
 #include "ResourceUnpacker.hpp"
 #include "SceneImporter.hpp"
 #include "SkeletonStorage.hpp"
-
-
-namespace glfw { class Window; }
+#include "TexturePool.hpp"
 
 
 namespace josh {
@@ -25,12 +23,13 @@ namespace josh {
 
 struct RuntimeParams
 {
-    glfw::Window& main_window;
-    Path          database_root;
-    usize         task_pool_size;
-    usize         loading_pool_size;
-    Extent2I      main_resolution;
-    HDRFormat     main_format;
+    MainContextRef main_context; // Window or a HeadlessContext. Must be current on the calling thread.
+    Path           database_root;
+    usize          task_pool_size;
+    usize          loading_pool_size;
+    usize          io_pool_size;
+    Extent2I       main_resolution;
+    HDRFormat      main_format;
 };
 
 /*
@@ -43,6 +42,7 @@ another. Reordering might lead to locking or segfaults on shutdown.
 struct Runtime
 {
     explicit Runtime(const RuntimeParams& p);
+    ~Runtime() noexcept;
 
     // Primary async contexts used by the engine. Thread pools,
     // offscreen GPU context, "local" main thread context, etc.
@@ -50,6 +50,7 @@ struct Runtime
 
     // Various storage for loaded resources.
     MeshRegistry     mesh_registry;
+    TexturePool      texture_pool;
     SkeletonStorage  skeleton_storage;
     AnimationStorage animation_storage;
 
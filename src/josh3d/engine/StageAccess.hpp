@@ -0,0 +1,306 @@
+#pragma once
+#include "Active.hpp"
+#include "Common.hpp"
+#include "ECS.hpp"
+#include "TypeInfo.hpp"
+#include <algorithm>
+#include <concepts>
+#include <tuple>
+#include <type_traits>
+
+
+namespace josh {
+
+
+/*
+Declared set of registry components that a pipeline stage reads and writes.
+
+Used to figure out which precompute stages can run concurrently.
+Two stages conflict if one of them writes a component that the other
+either reads or writes. Writing implies reading.
+
+    static auto access() -> StageAccess
+    {
+        return StageAccess()
+            .reads<LocalAABB, MTransform>()
+            .produces<AABB>();
+    }
+
+Active objects (see Active.hpp) live in the registry context, not in
+the component storage, and are declared separately with `reads_active<T>()`.
+
+Produced components are a special kind of writes, where the stage fully
+derives the component from its reads on each run. Such components can be
+computed on a snapshot of the registry and then published back. A stage
+that only produces, but does not write, is "deferrable" and can be run
+concurrently with the rest of the frame when pipelining. See FramePipelining.
+
+A stage that declares its access promises to not touch anything
+else in the registry or the engine that might be touched concurrently:
+no other components, no entity creation/destruction, no Belt, no GPU calls.
+A stage without declared access is assumed to conflict with everything.
+*/
+struct StageAccess
+{
+    template<typename ...Ts> auto reads()    && -> StageAccess&&;
+    template<typename ...Ts> auto writes()   && -> StageAccess&&;
+    template<typename ...Ts> auto produces() && -> StageAccess&&;
+
+    // The stage looks up the active object for each of Ts with `get_active<T>()`.
+    template<typename ...Ts> auto reads_active() && -> StageAccess&&;
+
+    auto conflicts_with(const StageAccess& other) const noexcept -> bool;
+    auto is_deferrable() const noexcept -> bool { return _writes.empty(); }
+
+    // Adds all components from the other access that are not declared yet.
+    void merge(const StageAccess& other);
+
+    // Creates the storage for each declared component if it does not exist yet.
+    // Storage creation modifies the registry itself, so it must be done before
+    // any stages are run concurrently.
+    void assure_storage(Registry& registry) const;
+
+    // Type-erased operations on the component storage.
+    struct ComponentOps
+    {
+        void (*assure)         (Registry& registry);
+        void (*create_entities)(Registry& from, Registry& to); // Those of `from` that hold the component, if not in `to` yet.
+        void (*copy)           (Registry& from, Registry& to); // Replaces the whole storage in `to`.
+        void (*publish)        (Registry& from, Registry& to); // Same, but through the signals of `to`.
+    };
+
+    struct Component
+    {
+        TypeIndex           type;
+        const ComponentOps* ops;
+    };
+
+    Vector<Component> _reads;
+    Vector<Component> _writes;
+    Vector<Component> _produces;
+
+    template<typename T>
+    static auto _component() -> Component;
+    template<typename T>
+    static auto _active() -> Component;
+    static auto _contains(const Vector<Component>& list, const TypeIndex& type) noexcept -> bool;
+    static void _merge_into(Vector<Component>& dst, const Vector<Component>& src);
+};
+
+/*
+Stages can declare their access as a static `access()` function.
+In that case, `Pipeline::push()` will pick it up automatically.
+*/
+template<typename T>
+concept stage_with_declared_access = requires
+{
+    { std::remove_cvref_t<T>::access() } -> std::same_as<StageAccess>;
+};
+
+
+namespace detail {
+
+template<typename T>
+void assure_component_storage(Registry& registry)
+{
+    std::ignore = registry.storage<T>();
+}
+
+// NOTE: Keeps the identifiers, so that the components could be matched back.
+inline void create_entity_like(Registry& to, Entity entity)
+{
+    if (not to.valid(entity))
+        std::ignore = to.create(entity);
+}
+
+template<typename T>
+void create_component_entities(Registry& from, Registry& to)
+{
+    const entt::sparse_set& ents = from.storage<T>();
+    for (const Entity entity : ents)
+        create_entity_like(to, entity);
+}
+
+template<typename T>
+void copy_component_storage(Registry& from, Registry& to)
+{
+    const auto&             src  = from.storage<T>();
+    auto&                   dst  = to.storage<T>();
+    const entt::sparse_set& ents = src;
+
+    dst.clear();
+    for (const Entity entity : ents)
+    {
+        if constexpr (std::is_empty_v<T>) dst.emplace(entity);
+        else                              dst.emplace(entity, src.get(entity));
+    }
+}
+
+template<typename T>
+void publish_component_storage(Registry& from, Registry& to)
+{
+    const auto&             src      = from.storage<T>();
+    const entt::sparse_set& produced = src;
+    const entt::sparse_set& existing = to.storage<T>();
+
+    Vector<Entity> stale;
+    for (const Entity entity : existing)
+        if (not produced.contains(entity))
+            stale.push_back(entity);
+    to.remove<T>(stale.begin(), stale.end());
+
+    for (const Entity entity : produced)
+    {
+        if constexpr (std::is_empty_v<T>) to.emplace_or_replace<T>(entity);
+        else                              to.emplace_or_replace<T>(entity, src.get(entity));
+    }
+}
+
+template<typename T>
+constexpr StageAccess::ComponentOps component_ops = {
+    .assure          = &assure_component_storage<T>,
+    .create_entities = &create_component_entities<T>,
+    .copy            = &copy_component_storage<T>,
+    .publish         = &publish_component_storage<T>,
+};
+
+// NOTE: Emplacing into the context is not thread-safe either,
+// and the non-const `get_active()` does that on the first lookup.
+template<typename T>
+void assure_active(Registry& registry)
+{
+    std::ignore = registry.ctx().emplace<ActiveFor<T>>();
+}
+
+template<typename T>
+void create_active_entity(Registry& from, Registry& to)
+{
+    const Entity entity = from.ctx().emplace<ActiveFor<T>>().entity;
+    if (from.valid(entity))
+        create_entity_like(to, entity);
+}
+
+template<typename T>
+void copy_active(Registry& from, Registry& to)
+{
+    to.ctx().insert_or_assign(from.ctx().emplace<ActiveFor<T>>());
+}
+
+template<typename T>
+void publish_nothing(Registry& /*from*/, Registry& /*to*/) {}
+
+template<typename T>
+constexpr StageAccess::ComponentOps active_ops = {
+    .assure          = &assure_active<T>,
+    .create_entities = &create_active_entity<T>,
+    .copy            = &copy_active<T>,
+    .publish         = &publish_nothing<T>,
+};
+
+} // namespace detail
+
+
+template<typename T>
+auto StageAccess::_component()
+    -> Component
+{
+    return {
+        .type = type_id<T>(),
+        .ops  = &detail::component_ops<T>,
+    };
+}
+
+template<typename T>
+auto StageAccess::_active()
+    -> Component
+{
+    return {
+        .type = type_id<detail::ActiveFor<T>>(),
+        .ops  = &detail::active_ops<T>,
+    };
+}
+
+template<typename ...Ts>
+auto StageAccess::reads() &&
+    -> StageAccess&&
+{
+    (_reads.push_back(_component<Ts>()), ...);
+    return MOVE(*this);
+}
+
+template<typename ...Ts>
+auto StageAccess::writes() &&
+    -> StageAccess&&
+{
+    (_writes.push_back(_component<Ts>()), ...);
+    return MOVE(*this);
+}
+
+template<typename ...Ts>
+auto StageAccess::produces() &&
+    -> StageAccess&&
+{
+    (_produces.push_back(_component<Ts>()), ...);
+    return MOVE(*this);
+}
+
+template<typename ...Ts>
+auto StageAccess::reads_active() &&
+    -> StageAccess&&
+{
+    (_reads.push_back(_active<Ts>()), ...);
+    return MOVE(*this);
+}
+
+inline auto StageAccess::_contains(const Vector<Component>& list, const TypeIndex& type) noexcept
+    -> bool
+{
+    return std::ranges::any_of(list, [&](const Component& c) { return c.type == type; });
+}
+
+inline void StageAccess::_merge_into(Vector<Component>& dst, const Vector<Component>& src)
+{
+    for (const Component& c : src)
+        if (not _contains(dst, c.type))
+            dst.push_back(c);
+}
+
+inline auto StageAccess::conflicts_with(const StageAccess& other) const noexcept
+    -> bool
+{
+    const auto touches = [](const StageAccess& access, const TypeIndex& type)
+    {
+        return
+            _contains(access._reads,    type) or
+            _contains(access._writes,   type) or
+            _contains(access._produces, type);
+    };
+
+    const auto writes_into = [&](const StageAccess& lhs, const StageAccess& rhs)
+    {
+        for (const Component& w : lhs._writes)
+            if (touches(rhs, w.type)) return true;
+        for (const Component& p : lhs._produces)
+            if (touches(rhs, p.type)) return true;
+        return false;
+    };
+
+    return writes_into(*this, other) or writes_into(other, *this);
+}
+
+inline void StageAccess::merge(const StageAccess& other)
+{
+    _merge_into(_reads,    other._reads);
+    _merge_into(_writes,   other._writes);
+    _merge_into(_produces, other._produces);
+}
+
+inline void StageAccess::assure_storage(Registry& registry) const
+{
+    for (const Component& c : _reads)    c.ops->assure(registry);
+    for (const Component& c : _writes)   c.ops->assure(registry);
+    for (const Component& c : _produces) c.ops->assure(registry);
+}
+
+
+} // namespace josh
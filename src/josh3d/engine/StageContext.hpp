@@ -9,6 +9,7 @@
 #include "Primitives.hpp"
 #include "RenderEngine.hpp"
 #include "Runtime.hpp"
+#include "TexturePool.hpp"
 
 
 namespace josh {
@@ -26,6 +27,19 @@ struct StageContext
     auto belt()              const noexcept -> Belt&               { return _state.engine.belt;           }
     auto mesh_registry()     const noexcept -> const MeshRegistry& { return _state.runtime.mesh_registry; }
 
+    // The pool is enabled by the stages that draw from it. Thread-safe.
+    auto texture_pool()      const noexcept -> TexturePool&        { return _state.runtime.texture_pool;  }
+
+    // For splitting the CPU-side work of a stage, like culling, across threads.
+    // The stage must wait for all of its tasks before returning.
+    auto task_pool()         const noexcept -> ThreadPool&         { return _state.runtime.async_cradle.task_pool; }
+
+    // Desired LODs fed back to the resource loader. Thread-safe.
+    auto lod_hints()         const noexcept -> LODHints&           { return _state.runtime.resource_loader.lod_hints(); }
+
+    // Desired texture mips fed back to the resource loader. Thread-safe.
+    auto texture_residency() const noexcept -> TextureResidency&   { return _state.runtime.resource_loader.texture_residency(); }
+
     // Take an extra perf snapshot in the middle of the current stage.
     // The name could be anything other than the reserved "start"and "end".
     // If no harness is attached, this is a no-op.
@@ -39,8 +53,11 @@ struct StageContext
     // components defined outside of the stage's purview.
     //
     // This will also be widely used in precompute stages. That is OK.
-    auto mutable_registry()  const noexcept -> Registry&           { return _state.runtime.registry;      }
-    auto registry()          const noexcept -> const Registry&     { return _state.runtime.registry;      }
+    //
+    // NOTE: This is not necessarily the `Runtime::registry`. Deferred precompute
+    // stages are given a snapshot of it instead. See FramePipelining.
+    auto mutable_registry()  const noexcept -> Registry&           { return _state.registry;              }
+    auto registry()          const noexcept -> const Registry&     { return _state.registry;              }
 
     auto primitives()        const noexcept -> const Primitives&   { return _state.primitives;            }
     auto main_resolution()   const noexcept -> Extent2I            { return _state.engine.main_resolution();      }
@@ -54,10 +71,17 @@ struct StageContext
     auto main_back_color_texture()  const noexcept -> RawTexture2D<>        { return _state.engine._main_target.back_color();  }
     auto main_front_color_texture() const noexcept -> RawTexture2D<GLConst> { return _state.engine._main_target.front_color(); }
 
+    // Texture of a transient created by this or an earlier stage in the same frame.
+    // See StageResources. Do not hold onto it across frames, it could be reallocated.
+    template<usize N>
+    auto transient(FixedHashedString<N> name_hs) const -> RawTexture2D<>
+    { return _state.engine._graph.transient(name_hs.hash()); }
+
     struct CommonState
     {
         RenderEngine&     engine;
         Runtime&          runtime;
+        Registry&         registry;
         const Primitives& primitives;
         const FrameTimer& frame_timer;
         Extent2I          window_resolution;
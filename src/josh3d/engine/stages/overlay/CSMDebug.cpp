@@ -1,5 +1,6 @@
 #include "CSMDebug.hpp"
 #include "ECS.hpp"
+#include "Errors.hpp"
 #include "GLAPIBinding.hpp"
 #include "Active.hpp"
 #include "Geometry.hpp"
@@ -13,6 +14,26 @@
 namespace josh {
 
 
+auto CSMDebug::resources(Extent2I) const
+    -> StageResources
+{
+    switch (mode)
+    {
+        case OverlayMode::None:
+            return {};
+        case OverlayMode::Views:
+            return StageResources()
+                .reads(GBuffer::transient_normals)
+                .reads(Cascades::resource_maps)
+                .writes(resource_default_fbo);
+        case OverlayMode::Maps:
+            return StageResources()
+                .reads(Cascades::resource_maps)
+                .writes(resource_default_fbo);
+    }
+    safe_unreachable("Invalid OverlayMode.");
+}
+
 void CSMDebug::operator()(
     OverlayContext context)
 {
@@ -33,6 +33,7 @@ struct CSMDebug
     void select_cascade(uindex desired_cascade_idx) { desired_cascade_idx_ = desired_cascade_idx; }
 
     void operator()(OverlayContext context);
+    auto resources(Extent2I main_resolution) const -> StageResources;
 
 private:
     void draw_views_overlay(OverlayContext context);
@@ -32,6 +32,7 @@ struct GBufferDebug
     OverlayMode mode = OverlayMode::None;
 
     void operator()(OverlayContext context);
+    auto resources(Extent2I main_resolution) const -> StageResources;
 
 private:
     UniqueSampler integer_sampler_ = []{
@@ -81,6 +82,18 @@ inline void GBufferDebug::operator()(
     context.draw_quad_to_default(bsp);
 }
 
+inline auto GBufferDebug::resources(Extent2I) const
+    -> StageResources
+{
+    if (mode == OverlayMode::None) return {};
+    return StageResources()
+        .reads(GBuffer::transient_normals)
+        .reads(GBuffer::transient_albedo)
+        .reads(GBuffer::transient_specular)
+        .reads(IDBuffer::resource_object_id)
+        .writes(resource_default_fbo);
+}
+
 
 
 
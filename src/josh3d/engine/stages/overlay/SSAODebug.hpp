@@ -23,6 +23,7 @@ struct SSAODebug
     OverlayMode mode = OverlayMode::None;
 
     void operator()(OverlayContext context);
+    auto resources(Extent2I main_resolution) const -> StageResources;
 
 private:
     ShaderToken sp_ = shader_pool().get({
@@ -55,5 +56,15 @@ inline void SSAODebug::operator()(
     context.draw_quad_to_default(bsp);
 }
 
+inline auto SSAODebug::resources(Extent2I) const
+    -> StageResources
+{
+    if (mode == OverlayMode::None) return {};
+    return StageResources()
+        .reads(AOBuffers::transient_side0)
+        .reads(AOBuffers::transient_side1)
+        .writes(resource_default_fbo);
+}
+
 
 } // namespace josh::stages::overlay
@@ -30,6 +30,12 @@
 namespace josh {
 
 
+auto SceneOverlays::resources(Extent2I) const
+    -> StageResources
+{
+    return StageResources().writes(resource_default_fbo);
+}
+
 void SceneOverlays::operator()(
     OverlayContext context)
 {
@@ -49,6 +49,7 @@ struct SceneOverlays
     } skeleton_params;
 
     void operator()(OverlayContext context);
+    auto resources(Extent2I main_resolution) const -> StageResources;
 
 private:
     void draw_selected_highlight(OverlayContext context);
@@ -20,14 +20,11 @@ void BloomAW::operator()(
     ZSCGPUN("BloomAW");
     if (not enable_bloom) return;
 
-    // NOTE: Taking half-resolution as the base MIP.
-    const auto [w, h] = context.main_resolution();
-    _resize_texture({ w / 2, h / 2 });
+    chain_resolution_ = _chain_resolution(context.main_resolution());
 
-    // Put an upper cap on the number of levels.
-    const NumLevels max_levels = GLsizei(max_downsample_levels);
-    const NumLevels has_levels = GLsizei(num_available_levels());
-    const NumLevels num_levels = std::min(max_levels, has_levels);
+    const RawTexture2D<> bloom_texture = context.transient(transient_chain);
+
+    const NumLevels num_levels = _chain_num_levels(context.main_resolution());
     const MipLevel  last_lod   = num_levels - 1;
 
     // Downsample.
@@ -40,29 +37,29 @@ void BloomAW::operator()(
 
         sp.uniform("source", 0);
 
-        // First downsample main texture to the bloom_texture_.
+        // First downsample main texture to the bloom_texture.
 
         // Sample from:
         context.main_front_color_texture().bind_to_texture_unit(0);
 
         // Draw to:
-        fbo_->attach_texture_to_color_buffer(bloom_texture_, 0);
-        glapi::set_viewport({ {}, bloom_texture_->get_resolution() });
+        fbo_->attach_texture_to_color_buffer(bloom_texture, 0);
+        glapi::set_viewport({ {}, bloom_texture.get_resolution() });
 
         context.primitives().quad_mesh().draw(bsp, bfb);
 
         // Then progressively downsample further.
-        bloom_texture_->bind_to_texture_unit(0); // Always bound, but we don't sample overlapping LODs.
+        bloom_texture.bind_to_texture_unit(0); // Always bound, but we don't sample overlapping LODs.
 
         for (MipLevel lod = 0; lod < last_lod; ++lod)
         {
             const MipLevel src_lod        = lod;
             const MipLevel dst_lod        = lod + 1;
-            const Extent2I dst_resolution = bloom_texture_->get_resolution(dst_lod);
+            const Extent2I dst_resolution = bloom_texture.get_resolution(dst_lod);
 
             // Sample from:
-            bloom_texture_->set_base_level(src_lod);
-            bloom_texture_->set_max_level (src_lod);
+            bloom_texture.set_base_level(src_lod);
+            bloom_texture.set_max_level (src_lod);
 
             // NOTE: It is not enough to sample only from a single level
             // in the shader using textureLod(), as this results in UB still
@@ -71,7 +68,7 @@ void BloomAW::operator()(
             // works better in this case.
 
             // Draw to:
-            fbo_->attach_texture_to_color_buffer(bloom_texture_, 0, dst_lod);
+            fbo_->attach_texture_to_color_buffer(bloom_texture, 0, dst_lod);
 
             // NOTE: LOD level for attaching a texture is view/storage level,
             // and is not controlled by lod_base and lod_max.
@@ -98,20 +95,20 @@ void BloomAW::operator()(
         glapi::set_blend_factors(BlendFactor::One, BlendFactor::One);
         glapi::set_blend_equation(BlendEquation::FactorAdd);
 
-        bloom_texture_->bind_to_texture_unit(0);
+        bloom_texture.bind_to_texture_unit(0);
 
         for (MipLevel lod = last_lod; lod > 0; --lod)
         {
             const MipLevel src_lod        = lod;
             const MipLevel dst_lod        = lod - 1;
-            const Size2I   dst_resolution = bloom_texture_->get_resolution(dst_lod);
+            const Size2I   dst_resolution = bloom_texture.get_resolution(dst_lod);
 
             // Sample from:
-            bloom_texture_->set_base_level(src_lod);
-            bloom_texture_->set_max_level (src_lod);
+            bloom_texture.set_base_level(src_lod);
+            bloom_texture.set_max_level (src_lod);
 
             // Draw to:
-            fbo_->attach_texture_to_color_buffer(bloom_texture_, 0, dst_lod);
+            fbo_->attach_texture_to_color_buffer(bloom_texture, 0, dst_lod);
 
             glapi::set_viewport({ {}, dst_resolution });
 
@@ -135,9 +132,9 @@ void BloomAW::operator()(
         };
 
         context.main_front_color_texture().bind_to_texture_unit(0);
-        bloom_texture_->bind_to_texture_unit(1);
-        bloom_texture_->set_base_level(0);
-        bloom_texture_->set_max_level (0);
+        bloom_texture.bind_to_texture_unit(1);
+        bloom_texture.set_base_level(0);
+        bloom_texture.set_max_level (0);
 
         sp.uniform("screen_color", 0);
         sp.uniform("bloom_color",  1);
@@ -150,22 +147,44 @@ void BloomAW::operator()(
     context.perf_snap("apply"_hs);
 }
 
+auto BloomAW::resources(Extent2I main_resolution) const
+    -> StageResources
+{
+    if (not enable_bloom) return {};
+
+    const TransientDesc chain_desc = {
+        .resolution = _chain_resolution(main_resolution),
+        .iformat    = InternalFormat::R11F_G11F_B10F,
+        .num_levels = _chain_num_levels(main_resolution),
+    };
+
+    return StageResources()
+        .creates(transient_chain, chain_desc)
+        .reads(resource_main_target)
+        .writes(resource_main_target);
+}
+
 auto BloomAW::num_available_levels() const noexcept
     -> usize
 {
-    return bloom_texture_->get_num_storage_levels();
+    return usize(GLsizei(max_num_levels(chain_resolution_)));
 }
 
-void BloomAW::_resize_texture(Extent2I new_resolution)
+auto BloomAW::_chain_resolution(Extent2I main_resolution) const noexcept
+    -> Extent2I
 {
-    if (new_resolution != bloom_texture_->get_resolution())
-    {
-        bloom_texture_ = {};
-        bloom_texture_->allocate_storage(new_resolution, InternalFormat::R11F_G11F_B10F, max_num_levels(new_resolution));
-    }
+    // NOTE: Taking half-resolution as the base MIP.
+    return { std::max(main_resolution.width / 2, 1), std::max(main_resolution.height / 2, 1) };
 }
 
-
+auto BloomAW::_chain_num_levels(Extent2I main_resolution) const noexcept
+    -> NumLevels
+{
+    // Put an upper cap on the number of levels.
+    const GLsizei max_levels = GLsizei(std::max(max_downsample_levels, usize(1)));
+    const GLsizei has_levels = max_num_levels(_chain_resolution(main_resolution));
+    return NumLevels{ std::min(max_levels, has_levels) };
+}
 
 
 } // namespace josh
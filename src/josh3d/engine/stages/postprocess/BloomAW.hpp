@@ -2,6 +2,7 @@
 #include "GLAPICommonTypes.hpp"
 #include "GLObjects.hpp"
 #include "Region.hpp"
+#include "RenderGraph.hpp"
 #include "StageContext.hpp"
 #include "ShaderPool.hpp"
 #include "VPath.hpp"
@@ -28,12 +29,17 @@ struct BloomAW
     auto num_available_levels() const noexcept -> usize;
 
     void operator()(PostprocessContext context);
+    auto resources(Extent2I main_resolution) const -> StageResources;
+
+    // Mip chain at half the main resolution. Only as many levels as are used.
+    static constexpr auto transient_chain = "BloomAW.Chain"_hs;
 
 private:
     // RenderTarget is too much of a bother for this.
     UniqueFramebuffer fbo_;
-    UniqueTexture2D   bloom_texture_;
-    void _resize_texture(Extent2I resolution);
+    Extent2I          chain_resolution_ = { 1, 1 };
+    auto _chain_resolution(Extent2I main_resolution) const noexcept -> Extent2I;
+    auto _chain_num_levels(Extent2I main_resolution) const noexcept -> NumLevels;
 
     UniqueSampler sampler_ = []{
         UniqueSampler s;
@@ -23,6 +23,7 @@ struct FXAA
     float guess_jump                  = 8.0;
 
     void operator()(PostprocessContext context);
+    auto resources(Extent2I main_resolution) const -> StageResources;
 
 private:
     ShaderToken sp_ = shader_pool().get({
@@ -57,5 +58,14 @@ inline void FXAA::operator()(
     context.draw_quad_and_swap(bsp);
 }
 
+inline auto FXAA::resources(Extent2I) const
+    -> StageResources
+{
+    if (not use_fxaa) return {};
+    return StageResources()
+        .reads(resource_main_target)
+        .writes(resource_main_target);
+}
+
 
 } // namespace josh
@@ -10,6 +10,15 @@
 namespace josh {
 
 
+auto Fog::resources(Extent2I) const
+    -> StageResources
+{
+    if (fog_type == FogType::None) return {};
+    return StageResources()
+        .reads(resource_main_target)
+        .writes(resource_main_target);
+}
+
 void Fog::operator()(
     PostprocessContext context)
 {
@@ -59,6 +59,7 @@ struct Fog
     BarometricFogParams barometric_fog_params = {};
 
     void operator()(PostprocessContext context);
+    auto resources(Extent2I main_resolution) const -> StageResources;
 
 private:
     void draw_uniform_fog(PostprocessContext context);
@@ -16,6 +16,14 @@ HDREyeAdaptation::HDREyeAdaptation(float initial_screen_value)
     set_screen_value(initial_screen_value);
 }
 
+auto HDREyeAdaptation::resources(Extent2I) const
+    -> StageResources
+{
+    return StageResources()
+        .reads(resource_main_target)
+        .writes(resource_main_target);
+}
+
 void HDREyeAdaptation::operator()(PostprocessContext context)
 {
     ZSCGPUN("HDREyeAdaptation");
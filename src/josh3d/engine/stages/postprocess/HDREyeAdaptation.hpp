@@ -51,6 +51,7 @@ struct HDREyeAdaptation
     HDREyeAdaptation(float initial_screen_value = 0.2f);
 
     void operator()(PostprocessContext context);
+    auto resources(Extent2I main_resolution) const -> StageResources;
 
     FrameExposure exposure; // Latest exposure from a few frames back.
 
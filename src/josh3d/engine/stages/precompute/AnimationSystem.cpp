@@ -11,6 +11,15 @@
 namespace josh {
 
 
+auto AnimationSystem::access()
+    -> StageAccess
+{
+    return StageAccess()
+        .reads<SkinnedMe2h>()
+        .writes<PlayingAnimation>()
+        .produces<Pose>();
+}
+
 void AnimationSystem::operator()(
     PrecomputeContext context)
 {
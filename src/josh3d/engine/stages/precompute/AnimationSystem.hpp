@@ -1,4 +1,5 @@
 #pragma once
+#include "StageAccess.hpp"
 #include "StageContext.hpp"
 
 
@@ -13,6 +14,7 @@ This must be reworked later.
 struct AnimationSystem
 {
     void operator()(PrecomputeContext context);
+    static auto access() -> StageAccess;
 };
 
 
@@ -10,6 +10,14 @@
 namespace josh {
 
 
+auto BoundingVolumeResolution::access()
+    -> StageAccess
+{
+    return StageAccess()
+        .reads<LocalAABB, LocalBoundingSphere, MTransform>()
+        .produces<AABB, BoundingSphere>();
+}
+
 void BoundingVolumeResolution::operator()(
     PrecomputeContext context)
 {
@@ -57,6 +57,15 @@ void cull_from_aabbs(
 } // namespace
 
 
+auto FrustumCulling::access()
+    -> StageAccess
+{
+    return StageAccess()
+        .reads<Camera, MTransform, BoundingSphere, AABB>()
+        .reads_active<Camera>()
+        .produces<Visible>();
+}
+
 void FrustumCulling::operator()(
     PrecomputeContext context)
 {
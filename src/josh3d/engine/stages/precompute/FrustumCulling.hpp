@@ -1,4 +1,5 @@
 #pragma once
+#include "StageAccess.hpp"
 #include "StageContext.hpp"
 
 
@@ -8,6 +9,7 @@ namespace josh {
 struct FrustumCulling
 {
     void operator()(PrecomputeContext context);
+    static auto access() -> StageAccess;
 };
 
 
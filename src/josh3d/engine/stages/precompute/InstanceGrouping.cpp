@@ -0,0 +1,106 @@
+#include "InstanceGrouping.hpp"
+#include "DrawHelpers.hpp"
+#include "ECS.hpp"
+#include "Ranges.hpp"
+#include "StageContext.hpp"
+#include "Transform.hpp"
+#include "components/AlphaTested.hpp"
+#include "components/StaticMesh.hpp"
+#include "components/Visible.hpp"
+#include "Tracy.hpp"
+
+
+namespace josh {
+
+
+void group_instances(
+    const Registry&             registry,
+    InstanceGroups&             out_groups,
+    InstanceGrouping::_Scratch& scratch)
+{
+    ZS;
+    using Key = InstanceGrouping::_Scratch::Key;
+
+    scratch.group_of_key .clear();
+    scratch.groups       .clear();
+    scratch.group_atested.clear();
+    scratch.group_of     .clear();
+    scratch.entities     .clear();
+
+    // First, assign each entity to a group and count the instances.
+    // This keeps the hash lookups to one per entity.
+    for (const Entity entity : registry.view<Visible, StaticMesh, MTransform>())
+    {
+        const auto& mesh = registry.get<StaticMesh>(entity);
+
+        // Zeros for the defaults, so that this does not depend on the GPU.
+        Array<u32, 3> textures  = { 0, 0, 0 };
+        float         specpower = 0.f;
+        override_material({ registry, entity }, textures, specpower);
+
+        const Key key = {
+            .mesh     = mesh.lods.cur().value,
+            .textures = textures,
+            .atested  = registry.all_of<AlphaTested>(entity),
+        };
+
+        const auto [it, was_emplaced] = scratch.group_of_key.try_emplace(key, u32(scratch.groups.size()));
+        if (was_emplaced)
+        {
+            scratch.groups.push_back({
+                .mesh     = mesh.lods.cur(),
+                .textures = textures,
+                .first    = 0,
+                .count    = 0,
+            });
+            scratch.group_atested.push_back(key.atested);
+        }
+
+        ++scratch.groups[it->second].count;
+        scratch.group_of.push_back(it->second);
+        scratch.entities.push_back(entity);
+    }
+
+    // Then lay out the groups contiguously, opaque first...
+    u32 offset = 0;
+    for (const bool atested : { false, true })
+    {
+        for (const uindex i : irange(scratch.groups.size()))
+        {
+            if (scratch.group_atested[i] != atested) continue;
+            auto& group = scratch.groups[i];
+            group.first = offset;
+            offset     += group.count;
+            group.count = 0; // Reused as the fill cursor below.
+        }
+    }
+
+    // ...and scatter the instances into them, which restores the counts.
+    out_groups.instances.resize(scratch.entities.size());
+    for (const uindex i : irange(scratch.entities.size()))
+    {
+        auto& group = scratch.groups[scratch.group_of[i]];
+        out_groups.instances[group.first + group.count++] = scratch.entities[i];
+    }
+
+    out_groups.opaque .clear();
+    out_groups.atested.clear();
+    for (const uindex i : irange(scratch.groups.size()))
+    {
+        auto& out = scratch.group_atested[i] ? out_groups.atested : out_groups.opaque;
+        out.push_back(scratch.groups[i]);
+    }
+}
+
+
+void InstanceGrouping::operator()(
+    PrecomputeContext context)
+{
+    ZSN("InstanceGrouping");
+    if (not enabled) return;
+    group_instances(context.registry(), groups, _scratch);
+    context.belt().put_ref(groups);
+}
+
+
+} // namespace josh
@@ -0,0 +1,111 @@
+#pragma once
+#include "Common.hpp"
+#include "ECS.hpp"
+#include "Scalars.hpp"
+#include "StageContext.hpp"
+#include "components/StaticMesh.hpp"
+#include <boost/container_hash/hash.hpp>
+
+
+namespace josh {
+
+
+/*
+Visible static meshes that share the same mesh LOD and the same material
+textures, and so can be drawn with a single instanced draw.
+
+Texture ids are the GL ids of diffuse, specular and normal, in that order,
+same as in `override_material()`. A zero id stands for the default texture.
+*/
+struct InstanceGroup
+{
+    StaticMeshID  mesh;
+    Array<u32, 3> textures;
+    u32           first; // Index of the first instance in `InstanceGroups::instances`.
+    u32           count; // Number of instances.
+};
+
+/*
+Primary output of the InstanceGrouping stage.
+
+Each group is a contiguous range of `instances`. The groups come in
+the order of the first appearance of their mesh and material in the
+iteration, and the instances within a group keep that order too.
+*/
+struct InstanceGroups
+{
+    Vector<InstanceGroup> opaque;
+    Vector<InstanceGroup> atested;
+    Vector<Entity>        instances; // For both opaque and alpha-tested groups.
+
+    auto num_instances() const noexcept -> usize { return instances.size(); }
+    auto num_groups()    const noexcept -> usize { return opaque.size() + atested.size(); }
+};
+
+
+/*
+Groups the Visible StaticMesh entities by their current LOD and material,
+so that repeated meshes (foliage, props, etc.) can be drawn instanced.
+
+Since this puts the product on the Belt, the access is not declared, and
+it cannot run concurrently with other precompute stages. It must run after
+the FrustumCulling, otherwise it will group the previous frame's visible set.
+
+Only the InstancedMDI strategy of the DeferredGeometry consumes the groups,
+so this is disabled by default and must be enabled together with it.
+*/
+struct InstanceGrouping
+{
+    // Nothing is grouped or put on the Belt while disabled.
+    bool enabled = false;
+
+    void operator()(PrecomputeContext context);
+
+    InstanceGroups groups;
+
+    // Reused between frames.
+    struct _Scratch
+    {
+        struct Key
+        {
+            u64           mesh;
+            Array<u32, 3> textures;
+            bool          atested;
+            auto operator==(const Key&) const noexcept -> bool = default;
+        };
+
+        struct KeyHash
+        {
+            auto operator()(const Key& key) const noexcept -> usize
+            {
+                usize seed = 0;
+                boost::hash_combine(seed, key.mesh);
+                boost::hash_range(seed, key.textures.begin(), key.textures.end());
+                boost::hash_combine(seed, key.atested);
+                return seed;
+            }
+        };
+
+        HashMap<Key, u32, KeyHash> group_of_key;   // Index into `groups`.
+        Vector<InstanceGroup>      groups;         // All groups, before the split into opaque and alpha-tested.
+        Vector<bool>               group_atested;
+        Vector<u32>                group_of;       // Per-entity group index.
+        Vector<Entity>             entities;
+    };
+
+    _Scratch _scratch;
+};
+
+
+/*
+The grouping itself, exposed for testing and benchmarking.
+
+Does not touch the GPU, only reads the registry.
+*/
+void group_instances(
+    const Registry&             registry,
+    InstanceGroups&             out_groups,
+    InstanceGrouping::_Scratch& scratch);
+
+
+} // namespace josh
@@ -0,0 +1,120 @@
+#include "LODSelection.hpp"
+#include "Active.hpp"
+#include "BoundingSphere.hpp"
+#include "Camera.hpp"
+#include "ECS.hpp"
+#include "LODHints.hpp"
+#include "LODPack.hpp"
+#include "StageContext.hpp"
+#include "Transform.hpp"
+#include "components/DesiredLOD.hpp"
+#include "components/SkinnedMesh.hpp"
+#include "components/StaticMesh.hpp"
+#include "Tracy.hpp"
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+
+namespace josh {
+namespace {
+
+/*
+Continuous LOD from the screen size. Integer values are the boundaries.
+*/
+auto lod_from_screen_size(float screen_size, float full_detail_screen_size, float lod_bias) noexcept
+    -> float
+{
+    if (screen_size <= 0.f) return std::numeric_limits<float>::infinity();
+    return std::log2(full_detail_screen_size / screen_size) + lod_bias;
+}
+
+/*
+The LOD `k` covers the continuous LOD in (k - 1, k], and is kept
+until the continuous LOD leaves that range by more than the `hysteresis`.
+*/
+auto pick_lod(float lod_f, u8 prev_lod, u8 max_lod, float hysteresis) noexcept
+    -> u8
+{
+    const float lo = float(prev_lod) - 1.f - hysteresis;
+    const float hi = float(prev_lod) + hysteresis;
+    if (lod_f > lo and lod_f <= hi) return prev_lod;
+    return u8(std::clamp(std::ceil(lod_f), 0.f, float(max_lod)));
+}
+
+} // namespace
+
+
+auto LODSelection::access()
+    -> StageAccess
+{
+    // NOTE: The LODHints are touched too, but those are thread-safe.
+    return StageAccess()
+        .reads<Camera, MTransform, BoundingSphere>()
+        .reads_active<Camera>()
+        .writes<StaticMesh, SkinnedMe2h, DesiredLOD>();
+}
+
+void LODSelection::operator()(
+    PrecomputeContext context)
+{
+    ZSN("LODSelection");
+    auto& registry = context.mutable_registry();
+
+    const auto camera = get_active<Camera, MTransform>(std::as_const(registry));
+    if (not camera) return;
+
+    const vec3  cam_pos      = camera.get<MTransform>().decompose_position();
+    const float tan_half_fov = std::tan(camera.get<Camera>().get_params().fovy_rad / 2.f);
+
+    _requests.clear();
+
+    const auto select = [&](Entity entity, auto& mesh)
+    {
+        auto& lods = mesh.lods;
+        using pack_type = std::remove_cvref_t<decltype(lods)>;
+
+        u8 desired = 0;
+        if (const auto* sphere = registry.try_get<BoundingSphere>(entity))
+        {
+            // Inside the sphere is as close as it gets, always LOD 0.
+            const float distance    = glm::distance(cam_pos, sphere->position);
+            const float screen_size = distance > sphere->radius ?
+                sphere->radius / (distance * tan_half_fov) : std::numeric_limits<float>::infinity();
+
+            const float lod_f = lod_from_screen_size(screen_size, full_detail_screen_size, lod_bias);
+
+            auto& desired_lod = registry.get_or_emplace<DesiredLOD>(entity);
+            desired_lod.lod = pick_lod(lod_f, desired_lod.lod, pack_type::max_num_lods - 1, hysteresis);
+            desired = desired_lod.lod;
+        }
+
+        lods.cur_lod = std::clamp(desired, lods.min_lod, lods.max_lod);
+
+        // Only the resources still streaming in need the requests.
+        if (desired < lods.min_lod and mesh.usage.has_usage())
+        {
+            const auto [it, was_emplaced] = _requests.try_emplace(mesh.usage.value().uuid, desired);
+            if (not was_emplaced) it->second = std::min(it->second, desired);
+        }
+    };
+
+    for (auto [entity, mesh] : registry.view<StaticMesh>().each())
+        select(entity, mesh);
+
+    for (auto [entity, mesh] : registry.view<SkinnedMe2h>().each())
+        select(entity, mesh);
+
+    LODHints& lod_hints = context.lod_hints();
+    lod_hints.set_enabled(request_lods);
+    if (request_lods)
+    {
+        for (const auto& [uuid, lod] : _requests)
+            lod_hints.request(uuid, lod);
+    }
+}
+
+
+} // namespace josh
@@ -0,0 +1,46 @@
+#pragma once
+#include "Common.hpp"
+#include "Scalars.hpp"
+#include "StageAccess.hpp"
+#include "StageContext.hpp"
+#include "UUID.hpp"
+
+
+namespace josh {
+
+
+/*
+Picks the current LOD of each mesh from its projected size on screen.
+
+The screen size is the diameter of the BoundingSphere as seen from the
+active Camera, as a fraction of the screen height. LOD 0 is used for
+anything at least `full_detail_screen_size` large, and each next LOD
+is used for half the size of the previous one.
+
+The picked LOD is kept in the DesiredLOD component and only changes once
+the size moves past the LOD boundary by `hysteresis` of a LOD step. This
+avoids the popping back and forth near the boundaries.
+
+The `cur_lod` of the mesh is then the desired LOD limited to what is loaded.
+If the desired LOD is finer than that, it is requested from the ResourceLoader
+through the LODHints, so that the streamed meshes only load as fine a LOD as
+is actually needed. Meshes without a BoundingSphere request the finest LOD.
+
+Must run after the BoundingVolumeResolution and before anything that
+uses `lods.cur()`, like the InstanceGrouping.
+*/
+struct LODSelection
+{
+    float full_detail_screen_size = 0.5f;
+    float hysteresis              = 0.2f;  // Fraction of a LOD step, [0, 1).
+    float lod_bias                = 0.f;   // Positive is coarser.
+    bool  request_lods            = true;  // Feed the desired LODs back to the loader.
+
+    void operator()(PrecomputeContext context);
+    static auto access() -> StageAccess;
+
+    HashMap<UUID, u8> _requests; // Reused between frames.
+};
+
+
+} // namespace josh
@@ -0,0 +1,82 @@
+#include "MipSelection.hpp"
+#include "Active.hpp"
+#include "BoundingSphere.hpp"
+#include "Camera.hpp"
+#include "ECS.hpp"
+#include "StageContext.hpp"
+#include "TextureResidency.hpp"
+#include "Transform.hpp"
+#include "components/Materials.hpp"
+#include "Tracy.hpp"
+#include <glm/geometric.hpp>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+
+namespace josh {
+
+
+auto MipSelection::access()
+    -> StageAccess
+{
+    // NOTE: The TextureResidency is touched too, but that is thread-safe.
+    return StageAccess()
+        .reads<Camera, MTransform, BoundingSphere, MaterialPhong>()
+        .reads_active<Camera>();
+}
+
+void MipSelection::operator()(
+    PrecomputeContext context)
+{
+    ZSN("MipSelection");
+    const auto& registry = context.registry();
+
+    TextureResidency& residency = context.texture_residency();
+    residency.set_enabled(stream_mips);
+    if (not stream_mips) return;
+
+    const auto camera = get_active<Camera, MTransform>(registry);
+    if (not camera) return;
+
+    const vec3  cam_pos      = camera.get<MTransform>().decompose_position();
+    const float tan_half_fov = std::tan(camera.get<Camera>().get_params().fovy_rad / 2.f);
+    const float screen_px    = float(context.main_resolution().height);
+
+    _demands.clear();
+
+    const auto demand = [&](const ResourceUsage& usage, float pixels)
+    {
+        if (not usage.has_usage()) return;
+        const auto [it, was_emplaced] = _demands.try_emplace(usage.value().uuid, pixels);
+        if (not was_emplaced) it->second = std::max(it->second, pixels);
+    };
+
+    for (auto [entity, mtl] : registry.view<MaterialPhong>().each())
+    {
+        // Inside the sphere is as close as it gets, always the finest mip.
+        float pixels = std::numeric_limits<float>::infinity();
+        if (const auto* sphere = registry.try_get<BoundingSphere>(entity))
+        {
+            const float distance = glm::distance(cam_pos, sphere->position);
+            if (distance > sphere->radius)
+                pixels = screen_px * sphere->radius / (distance * tan_half_fov);
+        }
+
+        pixels /= texel_density;
+
+        demand(mtl.diffuse_usage,  pixels);
+        demand(mtl.normal_usage,   pixels);
+        demand(mtl.specular_usage, pixels);
+    }
+
+    residency.set_budget(budget_bytes);
+    for (const auto& [uuid, pixels] : _demands)
+        residency.demand(uuid, pixels, mip_bias);
+    residency.update();
+
+    stats = residency.stats();
+}
+
+
+} // namespace josh
@@ -0,0 +1,42 @@
+#pragma once
+#include "Common.hpp"
+#include "StageAccess.hpp"
+#include "StageContext.hpp"
+#include "TextureResidency.hpp"
+#include "UUID.hpp"
+
+
+namespace josh {
+
+
+/*
+Demands the texture mips of each material from its projected size on screen,
+so that the streamed textures only keep as fine a mip as is actually visible.
+
+The projected size is the diameter of the BoundingSphere as seen from the
+active Camera, in pixels of the main resolution. The texture is assumed to
+be mapped across that diameter once, which `texel_density` can adjust for
+the tiled textures. Materials without a BoundingSphere demand the finest mip.
+
+The demands are fed to the TextureResidency of the ResourceLoader, which then
+picks the mips to stream in or to drop under the `budget_bytes`.
+
+Must run after the BoundingVolumeResolution.
+*/
+struct MipSelection
+{
+    float mip_bias      = 0.f;                 // Positive is coarser.
+    float texel_density = 1.f;                 // Times the texture is repeated across the object.
+    usize budget_bytes  = usize(512) << 20;    // Estimated, see TextureResidency.
+    bool  stream_mips   = false;               // Feed the demands back to the loader.
+
+    TextureResidency::Stats stats = {};        // As of the last update.
+
+    void operator()(PrecomputeContext context);
+    static auto access() -> StageAccess;
+
+    HashMap<UUID, float> _demands; // Screen pixels. Reused between frames.
+};
+
+
+} // namespace josh
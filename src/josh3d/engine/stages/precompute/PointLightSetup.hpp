@@ -1,5 +1,6 @@
 #pragma once
 #include "EnumUtils.hpp"
+#include "StageAccess.hpp"
 #include "StageContext.hpp"
 #include "LightCasters.hpp"
 #include "BoundingSphere.hpp"
@@ -25,10 +26,21 @@ struct PointLightSetup
     float radiosity_threshold = 0.005f;
 
     void operator()(PrecomputeContext context);
+    static auto access() -> StageAccess;
 };
 JOSH3D_DEFINE_ENUM_EXTRAS(PointLightSetup::Strategy, FixedRadius, RadiosityThreshold);
 
 
+inline auto PointLightSetup::access()
+    -> StageAccess
+{
+    // NOTE: Only writes the spheres of the lights. The meshes have theirs
+    // set by the loaders, so this is not a product of the stage alone.
+    return StageAccess()
+        .reads<PointLight>()
+        .writes<LocalBoundingSphere>();
+}
+
 inline void PointLightSetup::operator()(
     PrecomputeContext context)
 {
@@ -20,6 +20,7 @@ void resolve_transforms_recursive(
             const MTransform child_local_mtf = child_handle.get_or_emplace<Transform>().mtransform();
             const MTransform child_mtf       = node_mtf * child_local_mtf;
             child_handle.emplace_or_replace<MTransform>(child_mtf);
+            child_handle.emplace_or_replace<AffineTransform>(AffineTransform::from_model(child_mtf.model()));
 
             resolve_transforms_recursive(child_handle, child_mtf);
         }
@@ -29,6 +30,15 @@ void resolve_transforms_recursive(
 } // namespace
 
 
+auto TransformResolution::access()
+    -> StageAccess
+{
+    return StageAccess()
+        .reads<AsParent, AsChild>()
+        .writes<Transform>()
+        .produces<MTransform, AffineTransform>();
+}
+
 void TransformResolution::operator()(
     PrecomputeContext context)
 {
@@ -50,6 +60,7 @@ void TransformResolution::operator()(
         const Handle     root_handle = { registry, root_entity  };
         const MTransform root_mtf    = transform.mtransform();
         root_handle.emplace_or_replace<MTransform>(root_mtf);
+        root_handle.emplace_or_replace<AffineTransform>(AffineTransform::from_model(root_mtf.model()));
 
         // Then go down to children and update their transforms.
         resolve_transforms_recursive(root_handle, root_mtf);
@@ -1,4 +1,5 @@
 #pragma once
+#include "StageAccess.hpp"
 #include "StageContext.hpp"
 
 
@@ -14,12 +15,16 @@ transformation, possibly, in relation to a parent node, while
 the `MTransform` component is used to represent the final world-matrix
 with the transforms chained from the root of the scene-graph.
 
+Each MTransform also gets an AffineTransform with the same world matrix
+in the compact form, and its normal matrix, for the stages to upload.
+
 TODO: I'm not really sure if this should be a precompute stage, or
 existence of MTransforms is just part of the contract in displaying the entities.
 */
 struct TransformResolution
 {
     void operator()(PrecomputeContext context);
+    static auto access() -> StageAccess;
 };
 
 
@@ -14,9 +14,11 @@
 #include "LightCasters.hpp"
 #include "MeshRegistry.hpp"
 #include "MeshStorage.hpp"
+#include "NumericLimits.hpp"
 #include "Ranges.hpp"
 #include "StageContext.hpp"
 #include "Scalars.hpp"
+#include "ScopeExit.hpp"
 #include "components/StaticMesh.hpp"
 #include "UploadBuffer.hpp"
 #include "VertexFormats.hpp"
@@ -26,7 +28,11 @@
 #include "Transform.hpp"
 #include "UniformTraits.hpp"
 #include "components/ShadowCasting.hpp"
+#include "components/Stationary.hpp"
+#include "StationaryCasters.hpp"
 #include "Tracy.hpp"
+#include "async/Future.hpp"
+#include "async/ThreadPool.hpp"
 #include <algorithm>
 #include <ranges>
 #include <span>
@@ -270,40 +276,93 @@ void fit_cascade_views_to_camera(
     }
 }
 
-void cull_per_cascade(
-    Span<const CascadeView> views,
-    Span<CascadeDrawState>  drawstates,
-    const Registry&         registry)
-{
-    ZS;
-    assert(views.size() != 0);
-    assert(views.size() == drawstates.size());
-    const usize num_cascades = views.size();
+/*
+Planes of one frustum in the SoA layout, padded to a full vector width.
 
-    // Reset all lists first.
-    for (auto& drawstate : drawstates)
+Testing an AABB against all planes is then a handful of straight-line loops
+without branches, that the compiler can turn into wide SIMD instructions.
+The math is the same as in the `is_fully_*_of()` from the GeometryCollision.
+*/
+struct FrustumPlanesSoA
+{
+    static constexpr usize width = 8;
+
+    // The padding planes are never in front of anything,
+    // and so never affect either of the tests.
+    alignas(32) float nx [width] = {};
+    alignas(32) float ny [width] = {};
+    alignas(32) float nz [width] = {};
+    alignas(32) float anx[width] = {}; // abs(nx), and so on.
+    alignas(32) float any[width] = {};
+    alignas(32) float anz[width] = {};
+    alignas(32) float d  [width] = { vmax<float>, vmax<float>, vmax<float>, vmax<float>,
+                                     vmax<float>, vmax<float>, vmax<float>, vmax<float> };
+
+    static auto from(const FrustumPlanes& frustum) noexcept
+        -> FrustumPlanesSoA
     {
-        drawstate.drawlist_atested     .clear();
-        drawstate.drawlist_opaque .clear();
+        FrustumPlanesSoA result;
+        const Plane planes[] = {
+            frustum.near(), frustum.far(),    frustum.left(),
+            frustum.right(), frustum.bottom(), frustum.top(),
+        };
+        for (const uindex i : irange(std::size(planes)))
+        {
+            const Plane& plane = planes[i];
+            result.nx [i] = plane.normal.x;
+            result.ny [i] = plane.normal.y;
+            result.nz [i] = plane.normal.z;
+            result.anx[i] = glm::abs(plane.normal.x);
+            result.any[i] = glm::abs(plane.normal.y);
+            result.anz[i] = glm::abs(plane.normal.z);
+            result.d  [i] = plane.closest_distance;
+        }
+        return result;
     }
 
-    /*
-    Some things that improve the culling:
-
-        1. Test if the object is fully inside of one of the inner cascades.
-           If so, discard from drawing it as part of the outer cascade.
+    bool is_fully_outside(const vec3& midpoint, const vec3& half_extents) const noexcept
+    {
+        bool outside = false;
+        for (usize i = 0; i < width; ++i)
+        {
+            const float dist = nx[i] * midpoint.x + ny[i] * midpoint.y + nz[i] * midpoint.z - d[i];
+            const float ext  = anx[i] * half_extents.x + any[i] * half_extents.y + anz[i] * half_extents.z;
+            outside |= (dist - ext > 0.f);
+        }
+        return outside;
+    }
 
-        2. Compute texel size for each cascade and discard objects with AABB
-           extents smaller than that. (Needs texel size stored).
-           NOTE: "Second largest extent" should be a good heuristic.
+    bool is_fully_inside(const vec3& midpoint, const vec3& half_extents) const noexcept
+    {
+        bool inside = true;
+        for (usize i = 0; i < width; ++i)
+        {
+            const float dist = nx[i] * midpoint.x + ny[i] * midpoint.y + nz[i] * midpoint.z - d[i];
+            const float ext  = anx[i] * half_extents.x + any[i] * half_extents.y + anz[i] * half_extents.z;
+            inside &= (dist + ext < 0.f);
+        }
+        return inside;
+    }
+};
 
-        3. Using texel size, create "padded" frusti, to support cascade blending.
-           Adjust culling according to the padded frustum. This is conservative
-           and will result in more draw calls, since both inner and outer cascade
-           need to draw an object if it is in the "blend region".
-    */
+using CacheMode = CascadedShadowMapping::_CacheMode;
 
-    for (const Entity entity : registry.view<MTransform, StaticMesh, AABB>())
+struct CascadeCullParams
+{
+    float            tx_scale;
+    CacheMode        cache;
+    FrustumPlanesSoA full;
+    FrustumPlanesSoA padded;
+};
+
+void cull_entities_into(
+    Span<const CascadeCullParams>      cascades,
+    const Registry&                    registry,
+    Span<const Entity>                 entities,
+    CascadedShadowMapping::_CullLists& out_lists)
+{
+    ZS;
+    for (const Entity entity : entities)
     {
         const CHandle handle = { registry, entity };
         const auto& aabb = handle.get<AABB>();
@@ -324,51 +383,192 @@ void cull_per_cascade(
         //
         using std::min, std::max;
 
-        const vec3 extents = aabb.extents();
+        const vec3 extents      = aabb.extents();
+        const vec3 half_extents = extents * 0.5f;
+        const vec3 midpoint     = aabb.midpoint();
 
         const float median_extent =
             max(min(extents.x, extents.y), min(max(extents.x, extents.y), extents.z));
 
-        // TODO: Is there really not a better way?
-        using memptr_type = decltype(&CascadeDrawState::drawlist_atested);
+        const bool is_atested =
+            has_tag<AlphaTested>(handle) and has_component<MaterialPhong>(handle);
 
-        const auto test_cascades_and_output_into = [&](memptr_type out_list_mptr)
-        {
-            // We abuse the fact that the cascades are stored in order
-            // from smallest to largest, where the outer cascades
-            // always fully contain the inner ones.
-            //
-            // If the inner cascades "volume" completely obscures an object from
-            // the outer cascade, then we don't render that object to the
-            // outer cascade, since it will be sampled from the inner anyway.
-
-            for (const uindex i : irange(num_cascades))
-            {
-                const auto& view      = views     [i];
-                auto&       drawstate = drawstates[i];
-                auto&       drawlist  = drawstate.*out_list_mptr;
+        const bool is_stationary = has_tag<Stationary>(handle);
 
-                if (view.tx_scale.x > median_extent)
-                    break; // Too small, discard.
+        auto& drawlists        = is_atested ? out_lists.atested        : out_lists.opaque;
+        auto& static_drawlists = is_atested ? out_lists.static_atested : out_lists.static_opaque;
 
-                const auto& padded_frustum = view.frustum_padded_world;
-                const auto& full_frustum   = view.frustum_world;
+        // We abuse the fact that the cascades are stored in order
+        // from smallest to largest, where the outer cascades
+        // always fully contain the inner ones.
+        //
+        // If the inner cascades "volume" completely obscures an object from
+        // the outer cascade, then we don't render that object to the
+        // outer cascade, since it will be sampled from the inner anyway.
+        bool covered_by_inner = false;
+        for (const uindex i : irange(cascades.size()))
+        {
+            const auto& cascade = cascades[i];
 
-                if (is_fully_inside_of(aabb, padded_frustum))
+            if (cascade.tx_scale > median_extent)
+                break; // Too small, discard.
+
+            // The inner cascades move with the camera while the cached ones
+            // stay, so the coverage by the inner cascades cannot be relied on.
+            if (is_stationary and cascade.cache != CacheMode::None)
+            {
+                if (cascade.cache == CacheMode::Redraw and
+                    not cascade.full.is_fully_outside(midpoint, half_extents))
                 {
-                    drawlist.emplace_back(entity);
-                    break;
+                    static_drawlists[i].emplace_back(entity);
                 }
+                continue;
+            }
+
+            if (covered_by_inner)
+                continue;
+
+            if (cascade.padded.is_fully_inside(midpoint, half_extents))
+            {
+                drawlists[i].emplace_back(entity);
+                covered_by_inner = true;
+                if (not is_stationary) break; // Only the cached cascades could be left.
+                continue;
+            }
+
+            if (not cascade.full.is_fully_outside(midpoint, half_extents))
+                drawlists[i].emplace_back(entity);
+        }
+    }
+}
+
+/*
+Some things that improve the culling:
+
+    1. Test if the object is fully inside of one of the inner cascades.
+       If so, discard from drawing it as part of the outer cascade.
+
+    2. Compute texel size for each cascade and discard objects with AABB
+       extents smaller than that. (Needs texel size stored).
+       NOTE: "Second largest extent" should be a good heuristic.
+
+    3. Using texel size, create "padded" frusti, to support cascade blending.
+       Adjust culling according to the padded frustum. This is conservative
+       and will result in more draw calls, since both inner and outer cascade
+       need to draw an object if it is in the "blend region".
+
+If the `task_pool` is not null, the entities are split into contiguous chunks,
+one per task, each with its own draw lists. The lists are then concatenated
+in the chunk order, so the result is the same as if culled on one thread.
+*/
+void cull_per_cascade(
+    Span<const CascadeView>                          views,
+    Span<CascadeDrawState>                           drawstates,
+    Span<const CascadedShadowMapping::_CascadeCache> caches,
+    const Registry&                                  registry,
+    ThreadPool*                                      task_pool,
+    usize                                            min_entities_per_task,
+    Vector<Entity>&                                  entities,
+    Vector<CascadedShadowMapping::_CullLists>&       lists)
+{
+    ZS;
+    assert(views.size() != 0);
+    assert(views.size() == drawstates.size());
+    assert(views.size() == caches.size());
+    const usize num_cascades = views.size();
+
+    Vector<CascadeCullParams> cascades; cascades.reserve(num_cascades);
+    for (const uindex i : irange(num_cascades))
+    {
+        const auto& view = views[i];
+        cascades.push_back({
+            .tx_scale = view.tx_scale.x,
+            .cache    = caches[i].mode,
+            .full     = FrustumPlanesSoA::from(view.frustum_world),
+            .padded   = FrustumPlanesSoA::from(view.frustum_padded_world),
+        });
+    }
+
+    entities.clear();
+    for (const Entity entity : registry.view<MTransform, StaticMesh, AABB>())
+        entities.push_back(entity);
+
+    const usize num_tasks = eval%[&]() -> usize {
+        if (not task_pool) return 1;
+        const usize max_tasks = task_pool->num_threads() + 1; // +1 for this thread.
+        return std::clamp(entities.size() / std::max(min_entities_per_task, usize(1)), usize(1), max_tasks);
+    };
+
+    lists.resize(num_tasks);
+    for (auto& task_lists : lists)
+    {
+        for (auto* per_cascade : { &task_lists.opaque, &task_lists.atested,
+                                   &task_lists.static_opaque, &task_lists.static_atested })
+        {
+            per_cascade->resize(num_cascades);
+            for (auto& list : *per_cascade) list.clear();
+        }
+    }
+
+    const auto chunk_of = [&](uindex task_idx) -> Span<const Entity>
+    {
+        const usize first = entities.size() *  task_idx      / num_tasks;
+        const usize last  = entities.size() * (task_idx + 1) / num_tasks;
+        return Span<const Entity>(entities).subspan(first, last - first);
+    };
+
+    {
+        Vector<Future<void>> futures; futures.reserve(num_tasks - 1);
+
+        // The tasks reference the locals of this frame. Do not leave while they are running.
+        // The results are extracted below, so skip the futures that were moved from by then.
+        ON_SCOPE_FAIL([&]{
+            for (const auto& future : futures)
+                if (not future.is_moved_from()) future.wait_for_result();
+        });
+
+        for (const uindex task_idx : irange(1, num_tasks))
+        {
+            futures.push_back(task_pool->emplace([&, task_idx]
+            {
+                cull_entities_into(cascades, registry, chunk_of(task_idx), lists[task_idx]);
+            }));
+        }
+
+        cull_entities_into(cascades, registry, chunk_of(0), lists[0]);
+
+        // Wait for all before rethrowing any, the rest would still be running otherwise.
+        for (const auto& future : futures)
+            future.wait_for_result();
+
+        for (auto& future : futures)
+            get_result(MOVE(future));
+    }
+
+    for (const uindex i : irange(num_cascades))
+    {
+        auto& drawstate = drawstates[i];
+
+        drawstate.cached = caches[i].mode != CacheMode::None;
 
-                if (not is_fully_outside_of(aabb, full_frustum))
-                    drawlist.emplace_back(entity);
+        const auto merge_into = [&](Vector<Entity>& drawlist, Vector<Vector<Entity>> CascadedShadowMapping::_CullLists::* per_cascade)
+        {
+            // Swapping with the first chunk recycles the allocations of both.
+            using std::swap;
+            swap(drawlist, (lists[0].*per_cascade)[i]);
+
+            for (const uindex task_idx : irange(1, num_tasks))
+            {
+                const auto& list = (lists[task_idx].*per_cascade)[i];
+                drawlist.insert(drawlist.end(), list.begin(), list.end());
             }
         };
 
-        if (has_tag<AlphaTested>(handle) and has_component<MaterialPhong>(handle))
-            test_cascades_and_output_into(&CascadeDrawState::drawlist_atested);
-        else
-            test_cascades_and_output_into(&CascadeDrawState::drawlist_opaque);
+        using CullLists = CascadedShadowMapping::_CullLists;
+        merge_into(drawstate.drawlist_opaque,         &CullLists::opaque);
+        merge_into(drawstate.drawlist_atested,        &CullLists::atested);
+        merge_into(drawstate.drawlist_static_opaque,  &CullLists::static_opaque);
+        merge_into(drawstate.drawlist_static_atested, &CullLists::static_atested);
     }
 }
 
@@ -411,6 +611,8 @@ void CascadedShadowMapping::operator()(
     // Do the shadowmapping pass.
     if (strategy == Strategy::SinglepassGS)
     {
+        // The cache is not kept up-to-date by this strategy.
+        _cache.clear();
         cascades.draw_lists_active = false;
         _draw_all_cascades_with_geometry_shader(context);
     }
@@ -419,7 +621,10 @@ void CascadedShadowMapping::operator()(
         strategy == Strategy::PerCascadeCullingMDI)
     {
         cascades.draw_lists_active = true;
-        cull_per_cascade(cascades.views, cascades.drawstates, registry);
+        _update_cache(registry, cam_position, light_dir);
+        cull_per_cascade(cascades.views, cascades.drawstates, _cache, registry,
+            parallel_culling ? &context.task_pool() : nullptr, min_entities_per_task,
+            _cull_entities, _cull_lists);
         // NOTE: Will select single or MDI based on the enum value.
         _draw_with_culling_per_cascade(context);
     }
@@ -431,6 +636,89 @@ void CascadedShadowMapping::operator()(
     context.belt().put_ref(cascades);
 }
 
+void CascadedShadowMapping::_update_cache(
+    const Registry& registry,
+    const vec3&     cam_position,
+    const vec3&     light_dir)
+{
+    ZS;
+    auto& maps = cascades.maps;
+    const usize num_cascades = cascades.views.size();
+
+    if (not cache_stationary or not has_stationary_casters(registry))
+    {
+        _cache.clear();
+        _cache.resize(num_cascades);
+        return;
+    }
+
+    // Everything is invalidated if the static maps are reallocated...
+    if (_static_maps->get_resolution()         != maps.resolution() or
+        _static_maps->get_num_array_elements() != maps.num_cascades())
+    {
+        _static_maps = {};
+        _static_maps->allocate_storage(maps.resolution(), maps.num_cascades(), CascadeMaps::iformat);
+        _cache.clear();
+    }
+
+    // ...or if any of the stationary casters have changed.
+    const usize fingerprint = stationary_casters_fingerprint(registry);
+    if (fingerprint != _stationary_fingerprint)
+    {
+        _stationary_fingerprint = fingerprint;
+        _cache.clear();
+    }
+
+    const usize num_cached       = usize(std::clamp(num_cached_cascades, 0, i32(num_cascades)));
+    const usize first_cached_idx = num_cascades - num_cached;
+
+    _cache.resize(num_cascades);
+
+    for (const uindex i : irange(num_cascades))
+    {
+        auto& cache = _cache[i];
+        auto& view  = cascades.views[i];
+
+        if (i < first_cached_idx)
+        {
+            cache = {};
+            continue;
+        }
+
+        const bool still_valid = eval%[&]{
+            if (not cache.view)                 return false;
+            if (cache.light_dir != light_dir)   return false;
+
+            // Splits, resolution or the camera frustum have changed.
+            const auto& cached = *cache.view;
+            if (cached.width  != view.width  or cached.height != view.height or
+                cached.z_near != view.z_near or cached.z_far  != view.z_far)
+            {
+                return false;
+            }
+
+            const float drift_tx = glm::distance(cam_position, cache.cam_position) / view.tx_scale.x;
+            return drift_tx <= max_cache_drift_tx;
+        };
+
+        if (still_valid)
+        {
+            // Hold the cascade in place, as it was drawn.
+            view       = *cache.view;
+            cache.mode = _CacheMode::Reuse;
+        }
+        else
+        {
+            cache = {
+                .mode         = _CacheMode::Redraw,
+                .view         = view,
+                .cam_position = cam_position,
+                .light_dir    = light_dir,
+            };
+        }
+    }
+}
+
 
 namespace {
 
@@ -580,7 +868,7 @@ void CascadedShadowMapping::_draw_all_cascades_with_geometry_shader(
 namespace {
 
 /*
-Requires that each entity in `entities` has MTransform and StaticMesh.
+Requires that each entity in `entities` has AffineTransform and StaticMesh.
 
 Assumes that projection and view uniforms are already set.
 */
@@ -590,7 +878,7 @@ void multidraw_opaque_meshes(
     const MeshRegistry&                 mesh_registry,
     const Registry&                     registry,
     std::ranges::input_range auto&&     entities,
-    UploadBuffer<mat4>&                 world_mats,
+    UploadBuffer<mat3x4>&               world_mats,
     UploadBuffer<MDICommand>&           mdi_buffer)
 {
     const auto* storage = mesh_registry.storage_for<VertexStatic>();
@@ -600,7 +888,7 @@ void multidraw_opaque_meshes(
     const BindGuard bva = storage->vertex_array().bind();
 
     auto get_mesh_id   = [&](Entity e) -> decltype(auto) { return registry.get<StaticMesh>(e).lods.cur(); };
-    auto get_world_mat = [&](Entity e) -> decltype(auto) { return registry.get<MTransform>(e).model();  };
+    auto get_world_mat = [&](Entity e) -> decltype(auto) { return registry.get<AffineTransform>(e).rows; };
 
     // Prepare world matrices for all drawable objects.
     world_mats.restage(entities | transform(get_world_mat));
@@ -614,7 +902,7 @@ void multidraw_opaque_meshes(
         entities | transform(get_mesh_id), mdi_buffer);
 }
 /*
-Requires that each entity in `entities` has MaterialPhong, MTransform and StaticMesh.
+Requires that each entity in `entities` has MaterialPhong, AffineTransform and StaticMesh.
 
 Assumes that projection and view uniforms are already set.
 */
@@ -624,7 +912,7 @@ void multidraw_atested_meshes(
     const MeshRegistry&                 mesh_registry,
     const Registry&                     registry,
     std::ranges::input_range auto&&     entities,
-    UploadBuffer<mat4>&                 instance_data,
+    UploadBuffer<mat3x4>&               instance_data,
     UploadBuffer<MDICommand>&           mdi_buffer)
 {
     const auto* storage = mesh_registry.storage_for<VertexStatic>();
@@ -650,7 +938,7 @@ void multidraw_atested_meshes(
 
     const auto push_instance = [&](Entity e)
     {
-        instance_data.stage_one(registry.get<MTransform>(e).model());
+        instance_data.stage_one(registry.get<AffineTransform>(e).rows);
         tex_units    .push_back(registry.get<MaterialPhong>(e).diffuse->id());
         mesh_ids     .push_back(registry.get<StaticMesh>(e).lods.cur());
     };
@@ -699,22 +987,20 @@ void CascadedShadowMapping::_draw_with_culling_per_cascade(
     glapi::set_viewport({ {}, maps.resolution() });
     glapi::enable(Capability::DepthTesting);
 
-    for (const uindex cascade_idx : irange(num_cascades()))
+    // Draws a pair of opaque and alpha-tested lists into the bound layer.
+    const auto draw_drawlists = [&](
+        const CascadeView&                  view,
+        BindToken<Binding::DrawFramebuffer> bfb,
+        const Vector<Entity>&               drawlist_opaque,
+        const Vector<Entity>&               drawlist_atested,
+        CascadeDrawState&                   drawstate)
     {
-        const Layer cascade_layer = i32(cascade_idx);
-        const auto& view          = cascades.views[cascade_idx];
-        auto&       drawstate     = cascades.drawstates[cascade_idx];
-
         const auto set_common_uniforms = [&](RawProgram<> sp)
         {
             sp.uniform("projection", view.proj_mat);
             sp.uniform("view",       view.view_mat);
         };
 
-        // Attach layer-by-layer.
-        _fbo->attach_texture_layer_to_depth_buffer(maps.textures(), cascade_layer);
-        const BindGuard bfb = _fbo->bind_draw();
-
         // Draw opaque.
         if (enable_face_culling)
         {
@@ -730,14 +1016,14 @@ void CascadedShadowMapping::_draw_with_culling_per_cascade(
         {
             const RawProgram<> sp = _sp_opaque_per_cascade;
             set_common_uniforms(sp);
-            draw_opaque_meshes(sp, bfb, mesh_registry, registry, drawstate.drawlist_opaque);
+            draw_opaque_meshes(sp, bfb, mesh_registry, registry, drawlist_opaque);
         }
         else if (strategy == Strategy::PerCascadeCullingMDI)
         {
             const RawProgram<> sp = _sp_opaque_mdi;
             set_common_uniforms(sp);
             multidraw_opaque_meshes(sp, bfb, mesh_registry, registry,
-                drawstate.drawlist_opaque, drawstate.world_mats_opaque, _mdi_buffer);
+                drawlist_opaque, drawstate.world_mats_opaque, _mdi_buffer);
         }
 
         // Draw AlphaTested.
@@ -747,15 +1033,49 @@ void CascadedShadowMapping::_draw_with_culling_per_cascade(
         {
             const RawProgram<> sp = _sp_atested_per_cascade;
             set_common_uniforms(sp);
-            draw_atested_meshes(sp, bfb, mesh_registry, registry, drawstate.drawlist_atested);
+            draw_atested_meshes(sp, bfb, mesh_registry, registry, drawlist_atested);
         }
         else if (strategy == Strategy::PerCascadeCullingMDI)
         {
             const RawProgram<> sp = _sp_atested_mdi;
             set_common_uniforms(sp);
             multidraw_atested_meshes(sp, bfb, mesh_registry, registry,
-                drawstate.drawlist_atested, drawstate.world_mats_atested, _mdi_buffer);
+                drawlist_atested, drawstate.world_mats_atested, _mdi_buffer);
         }
+    };
+
+    for (const uindex cascade_idx : irange(num_cascades()))
+    {
+        const Layer cascade_layer = i32(cascade_idx);
+        const auto& view          = cascades.views[cascade_idx];
+        auto&       drawstate     = cascades.drawstates[cascade_idx];
+        const auto  cache_mode    = _cache[cascade_idx].mode;
+
+        // The Stationary casters of the cached cascades are drawn into the static
+        // maps only when invalidated. Each frame, the static layer is copied into
+        // the cascade first, and the rest of the casters are drawn on top.
+        if (cache_mode == _CacheMode::Redraw)
+        {
+            // Rare enough to clear one layer at a time.
+            _fbo->attach_texture_layer_to_depth_buffer(_static_maps.get(), cascade_layer);
+            _fbo->clear_depth(1.f);
+            const BindGuard bfb = _fbo->bind_draw();
+            draw_drawlists(view, bfb, drawstate.drawlist_static_opaque, drawstate.drawlist_static_atested, drawstate);
+        }
+
+        if (cache_mode != _CacheMode::None)
+        {
+            const Extent2I resolution = maps.resolution();
+            const i32      layer_idx  = i32(cascade_idx);
+            _static_maps->copy_image_region_to({ 0, 0, layer_idx }, { resolution.width, resolution.height, 1 },
+                maps.textures(), { 0, 0, layer_idx });
+        }
+
+        // Attach layer-by-layer.
+        _fbo->attach_texture_layer_to_depth_buffer(maps.textures(), cascade_layer);
+        const BindGuard bfb = _fbo->bind_draw();
+
+        draw_drawlists(view, bfb, drawstate.drawlist_opaque, drawstate.drawlist_atested, drawstate);
     }
 }
 
@@ -1,4 +1,5 @@
 #pragma once
+#include "Common.hpp"
 #include "DrawHelpers.hpp"
 #include "ECS.hpp"
 #include "EnumUtils.hpp"
@@ -64,8 +65,16 @@ struct CascadeDrawState
 {
     Vector<Entity>     drawlist_atested;   // Alpha-tested.
     Vector<Entity>     drawlist_opaque;    //
-    UploadBuffer<mat4> world_mats_atested; // Filled out if multidraw is enabled.
-    UploadBuffer<mat4> world_mats_opaque;  // "
+    UploadBuffer<mat3x4> world_mats_atested; // Filled out if multidraw is enabled. See AffineTransform.
+    UploadBuffer<mat3x4> world_mats_opaque;  // "
+
+    // If true, the Stationary casters are drawn from the static cache,
+    // and the draw lists above only contain the other casters.
+    bool           cached = false;
+    // Stationary casters of a cached cascade. Only filled out
+    // on the frames where the static cache is redrawn.
+    Vector<Entity> drawlist_static_atested;
+    Vector<Entity> drawlist_static_opaque;
 };
 
 struct CascadeMaps
@@ -98,6 +107,9 @@ Primary output type. Collection of useful info about the cascades.
 */
 struct Cascades
 {
+    // Not a transient, since the stationary casters are cached across frames.
+    static constexpr auto resource_maps = "Cascades.Maps"_hs;
+
     CascadeMaps              maps;
     Vector<CascadeView>      views;
     Vector<CascadeDrawState> drawstates;
@@ -153,9 +165,29 @@ struct CascadedShadowMapping
     // Size of the blending region in texel space of each inner cascade.
     float blend_size_inner_tx      = 50.f;
 
+    // Split the per-cascade culling across the task pool.
+    // Each task gets at least `min_entities_per_task` meshes,
+    // so small scenes are still culled inline on the calling thread.
+    bool  parallel_culling      = true;
+    usize min_entities_per_task = 2048;
+
+    // Keep the depth of the Stationary casters of the outer cascades in a separate
+    // cache, and only draw the other casters on top every frame. This is only
+    // supported by the per-cascade culling strategies.
+    //
+    // Since the cascades follow the camera, a cached cascade is instead held in place
+    // until the camera drifts away by more than `max_cache_drift_tx` of its texels.
+    // It is also redrawn when the light turns, or any of the stationary casters change.
+    //
+    // Nothing is cached or held in place while no entity is tagged Stationary.
+    bool  cache_stationary    = true;
+    i32   num_cached_cascades = 2;    // Counted from the outermost.
+    float max_cache_drift_tx  = 32.f; // Coverage at the edges of a held cascade is reduced by up to this much.
+
     CascadedShadowMapping(i32 side_resolution = 2048, i32 num_desired_cascades = 5);
 
     void operator()(PrimaryContext context);
+    auto resources(Extent2I) const -> StageResources { return StageResources().writes(Cascades::resource_maps); }
 
     // Primary output of this stage.
     Cascades cascades;
@@ -163,6 +195,33 @@ struct CascadedShadowMapping
 
     UniqueFramebuffer _fbo;
 
+    // Draw lists of each culling task, merged into the drawstates in order.
+    // Kept around to reuse the allocations between frames.
+    struct _CullLists
+    {
+        Vector<Vector<Entity>> opaque;         // Per cascade.
+        Vector<Vector<Entity>> atested;        // Per cascade.
+        Vector<Vector<Entity>> static_opaque;  // Per cascade.
+        Vector<Vector<Entity>> static_atested; // Per cascade.
+    };
+    Vector<Entity>     _cull_entities;
+    Vector<_CullLists> _cull_lists;
+
+    enum class _CacheMode { None, Reuse, Redraw };
+
+    struct _CascadeCache
+    {
+        _CacheMode            mode = _CacheMode::None; // For the current frame.
+        Optional<CascadeView> view;                    // View that the static layer was drawn with.
+        vec3                  cam_position = {};       // At the time of the draw.
+        vec3                  light_dir    = {};       // "
+    };
+    Vector<_CascadeCache> _cache;                      // Per cascade.
+    UniqueTexture2DArray  _static_maps;                // Same layout as the maps. Only the Stationary casters.
+    usize                 _stationary_fingerprint = 0;
+
+    void _update_cache(const Registry& registry, const vec3& cam_position, const vec3& light_dir);
+
     auto _allowed_num_cascades(i32 desired_num) const noexcept -> i32;
 
     void _draw_all_cascades_with_geometry_shader(PrimaryContext context);
@@ -4,31 +4,45 @@
 #include "Ranges.hpp"
 #include "UploadBuffer.hpp"
 #include "stages/primary/GBufferStorage.hpp"
+#include "stages/precompute/InstanceGrouping.hpp"
 #include "GLAPICore.hpp"
 #include "GLProgram.hpp"
 #include "MeshStorage.hpp"
 #include "components/StaticMesh.hpp"
 #include "UniformTraits.hpp"
 #include "components/AlphaTested.hpp"
+#include "components/Materials.hpp"
 #include "Transform.hpp"
 #include "StageContext.hpp"
-#include "Transform.hpp"
 #include "DefaultTextures.hpp"
 #include "components/Visible.hpp"
+#include "TexturePool.hpp"
 #include "Tracy.hpp"
 
 
 namespace josh {
 
 
+auto DeferredGeometry::resources(Extent2I) const
+    -> StageResources
+{
+    return GBuffer::geometry_writes();
+}
+
 void DeferredGeometry::operator()(
     PrimaryContext context)
 {
     ZSCGPUN("StaticGeometry");
+
+    // Only pool the textures if we are going to draw from the pool.
+    context.texture_pool().set_enabled(strategy == Strategy::PooledMDI);
+
     switch (strategy)
     {
         case Strategy::DrawPerMesh: return _draw_single(context);
         case Strategy::BatchedMDI:  return _draw_batched(context);
+        case Strategy::InstancedMDI: return _draw_instanced(context);
+        case Strategy::PooledMDI:    return _draw_pooled(context);
     }
 }
 
@@ -85,7 +99,7 @@ void DeferredGeometry::_draw_single(PrimaryContext context)
         for (auto [entity, mesh, world_mtf] : view.each())
         {
             sp.uniform(model_loc,        world_mtf.model());
-            sp.uniform(normal_model_loc, world_mtf.normal_model());
+            sp.uniform(normal_model_loc, registry.get<AffineTransform>(entity).normal_model);
             sp.uniform(object_id_loc,    entt::to_integral(entity));
 
             apply_materials(entity, sp, shininess_loc);
@@ -128,6 +142,34 @@ void DeferredGeometry::_draw_batched(PrimaryContext context)
     auto view_opaque  = registry.view<Visible, StaticMesh, MTransform>(entt::exclude<AlphaTested>);
     auto view_atested = registry.view<Visible, AlphaTested, StaticMesh, MTransform>();
 
+    thread_local Vector<Entity> entities;
+
+    const auto draw = [&](RawProgram<> sp, auto view)
+    {
+        const BindGuard bsp = sp.use();
+        entities.assign(view.begin(), view.end());
+        _multidraw_batched(registry, *mesh_storage, bva, bsp, bfb, entities);
+    };
+
+    // Opaque. Can be backface culled.
+    if (backface_culling) glapi::enable(Capability::FaceCulling);
+    else                  glapi::disable(Capability::FaceCulling);
+
+    draw(_sp_batched_opaque, view_opaque);
+
+    // Alpha-Tested. No backface culling even if requested.
+    glapi::disable(Capability::FaceCulling);
+    draw(_sp_batched_atested, view_atested);
+}
+
+void DeferredGeometry::_multidraw_batched(
+    const Registry&                     registry,
+    const MeshStorage<VertexStatic>&    mesh_storage,
+    BindToken<Binding::VertexArray>     bva,
+    BindToken<Binding::Program>         bsp,
+    BindToken<Binding::DrawFramebuffer> bfb,
+    Span<const Entity>                  entities)
+{
     const usize batch_size = max_batch_size();
     const usize num_units  = _max_texture_units();
 
@@ -143,74 +185,296 @@ void DeferredGeometry::_draw_batched(PrimaryContext context)
         globals::default_normal_texture().id(),
     };
 
-    const auto draw = [&](RawProgram<> sp, auto view)
+    const auto sp = RawProgram<>::from_id(bsp.id());
+    const Location samplers_loc = sp.get_uniform_location("samplers");
+    sp.set_uniform_intv(samplers_loc, i32(samplers.size()), samplers.data());
+
+    _instance_data.clear();
+    uindex draw_id = 0;
+
+    const auto push_instance = [&](Entity e, const AffineTransform& atf)
+    {
+        auto tex_ids   = default_ids;
+        auto specpower = 128.f;
+        override_material({ registry, e }, tex_ids, specpower);
+
+        _instance_data.stage_one({
+            .model_rows   = atf.rows,
+            .normal_model = atf.normal_model,
+            .object_id    = to_entity(e),
+            .specpower    = specpower,
+        });
+
+        tex_units[draw_id * 3 + 0] = tex_ids[0];
+        tex_units[draw_id * 3 + 1] = tex_ids[1];
+        tex_units[draw_id * 3 + 2] = tex_ids[2];
+    };
+
+    const auto draw_staged_and_reset = [&]()
+    {
+        glapi::bind_texture_units(tex_units);
+        _instance_data.bind_to_ssbo_index(0);
+
+        // NOTE: Interestingly, we have the Entity already stored in the
+        // instance buffer, so we can just look it up from there no problem.
+        const auto get_mesh_id = [&](const InstanceDataGPU& data)
+        {
+            return registry.get<StaticMesh>(Entity(data.object_id)).lods.cur();
+        };
+
+        multidraw_indirect_from_storage(mesh_storage, bva, bsp, bfb,
+            _instance_data.view_staged() | transform(get_mesh_id), _mdi_buffer);
+
+        _instance_data.clear();
+        draw_id = 0;
+    };
+
+    // The draw loop.
+    for (const Entity e : entities)
+    {
+        push_instance(e, registry.get<AffineTransform>(e));
+
+        // If we overflow the batch, then multidraw and reset.
+        if (++draw_id >= batch_size)
+            draw_staged_and_reset();
+    }
+    if (draw_id) draw_staged_and_reset(); // Don't forget the tail.
+}
+
+void DeferredGeometry::_draw_instanced(PrimaryContext context)
+{
+    const auto& registry     = context.registry();
+    const auto* mesh_storage = context.mesh_registry().storage_for<VertexStatic>();
+    auto*       gbuffer      = context.belt().try_get<GBuffer>();
+    const auto* groups       = context.belt().try_get<InstanceGroups>();
+
+    if (not mesh_storage) return;
+    if (not gbuffer)      return;
+    if (not groups)       return _draw_batched(context);
+
+    // The instanced variants are compiled in the background, don't stall on them.
+    if (not _sp_instanced_opaque.is_ready() or not _sp_instanced_atested.is_ready())
+        return _draw_batched(context);
+
+    const BindGuard bcam = context.bind_camera_ubo();
+    const BindGuard bfb  = gbuffer->bind_draw();
+    const BindGuard bva  = mesh_storage->vertex_array().bind();
+
+    glapi::set_viewport({ {}, gbuffer->resolution() });
+
+    const usize batch_size = max_batch_size();
+    const usize num_units  = _max_texture_units();
+
+    // NOTE: Resizing, not reserving.
+    thread_local Vector<u32> tex_units; tex_units.resize(num_units);
+    thread_local Vector<InstancedDraw<VertexStatic>> draws;
+
+    const Span<const i32> samplers = build_irange_tls_array(num_units);
+
+    const Array<u32, 3> default_ids = {
+        globals::default_diffuse_texture().id(),
+        globals::default_specular_texture().id(),
+        globals::default_normal_texture().id(),
+    };
+
+    const auto draw = [&](RawProgram<> sp, Span<const InstanceGroup> batch_groups)
     {
         const BindGuard bsp = sp.use();
 
         const Location samplers_loc = sp.get_uniform_location("samplers");
         sp.set_uniform_intv(samplers_loc, i32(samplers.size()), samplers.data());
 
+        // Each multidraw command is one group, and so the number of groups
+        // per multidraw is limited by the texture units, same as in batched.
+        // The number of instances in each group is not limited at all.
+        for (uindex batch_begin = 0; batch_begin < batch_groups.size(); batch_begin += batch_size)
+        {
+            const auto batch = batch_groups.subspan(batch_begin,
+                std::min(batch_size, batch_groups.size() - batch_begin));
+
+            _instance_data.clear();
+            draws.clear();
+
+            for (const auto [draw_id, group] : enumerate(batch))
+            {
+                const auto base_instance = u32(_instance_data.num_staged());
+
+                for (const Entity e : Span(groups->instances).subspan(group.first, group.count))
+                {
+                    // The textures are the same for the whole group, but specpower is not part of the key.
+                    auto tex_ids   = default_ids;
+                    auto specpower = 128.f;
+                    override_material({ registry, e }, tex_ids, specpower);
+
+                    const auto& atf = registry.get<AffineTransform>(e);
+                    _instance_data.stage_one({
+                        .model_rows   = atf.rows,
+                        .normal_model = atf.normal_model,
+                        .object_id    = to_entity(e),
+                        .specpower    = specpower,
+                    });
+                }
+
+                for (const uindex k : irange(3))
+                    tex_units[draw_id * 3 + k] = group.textures[k] ? group.textures[k] : default_ids[k];
+
+                draws.push_back({
+                    .mesh_id       = group.mesh,
+                    .num_instances = group.count,
+                    .base_instance = base_instance,
+                });
+            }
+
+            glapi::bind_texture_units(tex_units);
+            _instance_data.bind_to_ssbo_index(0);
+
+            multidraw_indirect_instanced_from_storage(*mesh_storage, bva, bsp, bfb, draws, _mdi_buffer);
+        }
+    };
+
+    // Opaque. Can be backface culled.
+    if (backface_culling) glapi::enable(Capability::FaceCulling);
+    else                  glapi::disable(Capability::FaceCulling);
+
+    draw(_sp_instanced_opaque, groups->opaque);
+
+    // Alpha-Tested. No backface culling even if requested.
+    glapi::disable(Capability::FaceCulling);
+    draw(_sp_instanced_atested, groups->atested);
+}
+
+void DeferredGeometry::_draw_pooled(PrimaryContext context)
+{
+    const auto& registry     = context.registry();
+    const auto& texture_pool = context.texture_pool();
+    const auto* mesh_storage = context.mesh_registry().storage_for<VertexStatic>();
+    auto*       gbuffer      = context.belt().try_get<GBuffer>();
+
+    if (not mesh_storage) return;
+    if (not gbuffer)      return;
+
+    // The pooled variants are compiled in the background, don't stall on them.
+    if (not _sp_pooled_opaque.is_ready() or not _sp_pooled_atested.is_ready())
+        return _draw_batched(context);
+
+    const BindGuard bcam = context.bind_camera_ubo();
+    const BindGuard bfb  = gbuffer->bind_draw();
+    const BindGuard bva  = mesh_storage->vertex_array().bind();
+
+    glapi::set_viewport({ {}, gbuffer->resolution() });
+
+    auto view_opaque  = registry.view<Visible, StaticMesh, AffineTransform>(entt::exclude<AlphaTested>);
+    auto view_atested = registry.view<Visible, AlphaTested, StaticMesh, AffineTransform>();
+
+    constexpr u32 no_page = -1; // Same as in the shader.
+
+    thread_local Vector<MeshID<VertexStatic>> mesh_ids;
+    thread_local Vector<Entity>               fallback;
+
+    const Span<const i32> samplers = build_irange_tls_array(TexturePool::max_pages);
+
+    const Array<u32, 3> default_ids = {
+        globals::default_diffuse_texture().id(),
+        globals::default_specular_texture().id(),
+        globals::default_normal_texture().id(),
+    };
+
+    // Returns false if any of the textures is neither pooled nor one of the defaults.
+    const auto set_pooled = [&](PooledMaterialGPU& out, const MaterialPhong& mtl)
+        -> bool
+    {
+        const auto set_one = [&](uindex k, const SharedConstTexture2D& texture, const SharedTextureLease& lease)
+            -> bool
+        {
+            if (not lease) return texture->id() == default_ids[k];
+            const PoolLocation location = lease->location();
+            out.pages[k]    = location.page;
+            out.layers[k]   = location.layer;
+            out.min_lods[k] = float(GLint(lease->base_level()));
+            return true;
+        };
+        return
+            set_one(0, mtl.diffuse,  mtl.diffuse_lease)  and
+            set_one(1, mtl.specular, mtl.specular_lease) and
+            set_one(2, mtl.normal,   mtl.normal_lease);
+    };
+
+    const auto draw = [&](RawProgram<> sp_pooled, RawProgram<> sp_batched, auto view)
+    {
         _instance_data.clear();
-        uindex draw_id = 0;
+        _material_data.clear();
+        mesh_ids.clear();
+        fallback.clear();
 
-        const auto push_instance = [&](Entity e, const MTransform& mtf)
+        // Only bind the pages that are referenced. Pages with no leases yet
+        // could still be in the middle of being created on another context.
+        Array<u32, TexturePool::max_pages> page_units = {};
+
+        for (auto [e, mesh, atf] : view.each())
         {
-            auto tex_ids   = default_ids;
-            auto specpower = 128.f;
-            override_material({ registry, e }, tex_ids, specpower);
+            PooledMaterialGPU material = {
+                .pages    = uvec4(no_page),
+                .layers   = uvec4(0),
+                .min_lods = vec4(0.f),
+            };
+            float specpower = 128.f;
+
+            if (const auto* mtl = registry.try_get<MaterialPhong>(e))
+            {
+                if (not set_pooled(material, *mtl))
+                {
+                    fallback.push_back(e);
+                    continue;
+                }
+                specpower = mtl->specpower;
+            }
+
+            for (const uindex k : irange(3))
+                if (const u32 page = material.pages[k]; page != no_page)
+                    page_units[page] = texture_pool.page_texture(page).id();
 
             _instance_data.stage_one({
-                .model        = mtf.model(),
-                .normal_model = mtf.normal_model(),
+                .model_rows   = atf.rows,
+                .normal_model = atf.normal_model,
                 .object_id    = to_entity(e),
                 .specpower    = specpower,
             });
+            _material_data.stage_one(material);
+            mesh_ids.push_back(mesh.lods.cur());
+        }
 
-            tex_units[draw_id * 3 + 0] = tex_ids[0];
-            tex_units[draw_id * 3 + 1] = tex_ids[1];
-            tex_units[draw_id * 3 + 2] = tex_ids[2];
-        };
-
-        const auto draw_staged_and_reset = [&]()
+        // Everything in the pool goes into a single multidraw.
+        if (not mesh_ids.empty())
         {
-            glapi::bind_texture_units(tex_units);
-            _instance_data.bind_to_ssbo_index(0);
+            const BindGuard bsp = sp_pooled.use();
 
-            // NOTE: Interestingly, we have the Entity already stored in the
-            // instance buffer, so we can just look it up from there no problem.
-            const auto get_mesh_id = [&](const InstanceDataGPU& data)
-            {
-                return view.template get<StaticMesh>(Entity(data.object_id)).lods.cur();
-            };
+            const Location samplers_loc = sp_pooled.get_uniform_location("pool_pages");
+            sp_pooled.set_uniform_intv(samplers_loc, i32(samplers.size()), samplers.data());
 
-            multidraw_indirect_from_storage(*mesh_storage, bva, bsp, bfb,
-                _instance_data.view_staged() | transform(get_mesh_id), _mdi_buffer);
+            glapi::bind_texture_units(page_units);
+            _instance_data.bind_to_ssbo_index(0);
+            _material_data.bind_to_ssbo_index(1);
 
-            _instance_data.clear();
-            draw_id = 0;
-        };
+            multidraw_indirect_from_storage(*mesh_storage, bva, bsp, bfb, mesh_ids, _mdi_buffer);
+        }
 
-        // The draw loop.
-        for (auto [e, mesh, mtf] : view.each())
+        // The rest is drawn the old way.
+        if (not fallback.empty())
         {
-            push_instance(e, mtf);
-
-            // If we overflow the batch, then multidraw and reset.
-            if (++draw_id >= batch_size)
-                draw_staged_and_reset();
+            const BindGuard bsp = sp_batched.use();
+            _multidraw_batched(registry, *mesh_storage, bva, bsp, bfb, fallback);
         }
-        if (draw_id) draw_staged_and_reset(); // Don't forget the tail.
     };
 
     // Opaque. Can be backface culled.
     if (backface_culling) glapi::enable(Capability::FaceCulling);
     else                  glapi::disable(Capability::FaceCulling);
 
-    draw(_sp_batched_opaque, view_opaque);
+    draw(_sp_pooled_opaque, _sp_batched_opaque, view_opaque);
 
     // Alpha-Tested. No backface culling even if requested.
     glapi::disable(Capability::FaceCulling);
-    draw(_sp_batched_atested, view_atested);
+    draw(_sp_pooled_atested, _sp_batched_atested, view_atested);
 }
 
 auto DeferredGeometry::_max_texture_units() const noexcept
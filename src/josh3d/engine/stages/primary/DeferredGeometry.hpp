@@ -3,9 +3,12 @@
 #include "DrawHelpers.hpp"
 #include "EnumUtils.hpp"
 #include "GPULayout.hpp"
+#include "MeshStorage.hpp"
 #include "StageContext.hpp"
 #include "ShaderPool.hpp"
+#include "TexturePool.hpp"
 #include "UploadBuffer.hpp"
+#include "VertexFormats.hpp"
 #include "VPath.hpp"
 
 
@@ -18,16 +21,20 @@ struct DeferredGeometry
     {
         DrawPerMesh, // Naive single draw call for each mesh, rebinding everything between.
         BatchedMDI,  // Batched multidraws, limited by the number of texture units.
+        InstancedMDI, // Batched multidraws of instance groups from the InstanceGrouping stage.
+        PooledMDI,    // Single multidraw for all materials in the TexturePool, batched for the rest.
         // Bindless, // HAHHAHAHAHAHAH, go patch renderdoc.
     };
 
     Strategy strategy         = Strategy::DrawPerMesh;
     bool     backface_culling = true;
 
-    // Max number of meshes per multidraw in Batched mode.
+    // Max number of meshes per multidraw in Batched mode,
+    // or max number of instance groups in Instanced mode.
     auto max_batch_size() const noexcept -> u32;
 
     void operator()(PrimaryContext context);
+    auto resources(Extent2I main_resolution) const -> StageResources;
 
 
     void _draw_single(PrimaryContext context);
@@ -44,8 +51,8 @@ struct DeferredGeometry
 
     struct InstanceDataGPU
     {
-        alignas(std430::align_vec4)  mat4   model;
-        alignas(std430::align_vec4)  mat3x4 normal_model;
+        alignas(std430::align_vec4)  mat3x4 model_rows;   // See AffineTransform.
+        alignas(std430::align_vec4)  mat3x4 normal_model; // mat3 padded to std430.
         alignas(std430::align_uint)  u32    object_id;
         alignas(std430::align_float) float  specpower;
     };
@@ -57,6 +64,16 @@ struct DeferredGeometry
     auto _max_texture_units() const noexcept -> u32;
     void _draw_batched(PrimaryContext context);
 
+    // Draws the `entities` in batches of `max_batch_size()`.
+    // The program must be in use, and the camera UBO bound.
+    void _multidraw_batched(
+        const Registry&                     registry,
+        const MeshStorage<VertexStatic>&    mesh_storage,
+        BindToken<Binding::VertexArray>     bva,
+        BindToken<Binding::Program>         bsp,
+        BindToken<Binding::DrawFramebuffer> bfb,
+        Span<const Entity>                  entities);
+
     ShaderToken _sp_batched_opaque = shader_pool().get({
         .vert = VPath("src/shaders/dfrg_static_dsn_batched.vert"),
         .frag = VPath("src/shaders/dfrg_static_dsn_batched.frag")},
@@ -69,8 +86,49 @@ struct DeferredGeometry
         ProgramDefines()
             .define("MAX_TEXTURE_UNITS", max_frag_texture_units())
             .define("ENABLE_ALPHA_TESTING", 1));
+
+    // Falls back to batched if there are no InstanceGroups on the Belt.
+    void _draw_instanced(PrimaryContext context);
+
+    ShaderToken _sp_instanced_opaque = shader_pool().get({
+        .vert = VPath("src/shaders/dfrg_static_dsn_instanced.vert"),
+        .frag = VPath("src/shaders/dfrg_static_dsn_batched.frag")},
+        ProgramDefines()
+            .define("MAX_TEXTURE_UNITS", max_frag_texture_units()));
+
+    ShaderToken _sp_instanced_atested = shader_pool().get({
+        .vert = VPath("src/shaders/dfrg_static_dsn_instanced.vert"),
+        .frag = VPath("src/shaders/dfrg_static_dsn_batched.frag")},
+        ProgramDefines()
+            .define("MAX_TEXTURE_UNITS", max_frag_texture_units())
+            .define("ENABLE_ALPHA_TESTING", 1));
+
+    // Falls back to batched for the meshes with materials outside of the pool.
+    void _draw_pooled(PrimaryContext context);
+
+    struct PooledMaterialGPU
+    {
+        alignas(std430::align_uvec4) uvec4 pages;    // Diffuse, specular, normal, unused.
+        alignas(std430::align_uvec4) uvec4 layers;
+        alignas(std430::align_vec4)  vec4  min_lods;
+    };
+
+    UploadBuffer<PooledMaterialGPU> _material_data;
+
+    ShaderToken _sp_pooled_opaque = shader_pool().get({
+        .vert = VPath("src/shaders/dfrg_static_dsn_batched.vert"),
+        .frag = VPath("src/shaders/dfrg_static_dsn_pooled.frag")},
+        ProgramDefines()
+            .define("MAX_POOL_PAGES", TexturePool::max_pages));
+
+    ShaderToken _sp_pooled_atested = shader_pool().get({
+        .vert = VPath("src/shaders/dfrg_static_dsn_batched.vert"),
+        .frag = VPath("src/shaders/dfrg_static_dsn_pooled.frag")},
+        ProgramDefines()
+            .define("MAX_POOL_PAGES", TexturePool::max_pages)
+            .define("ENABLE_ALPHA_TESTING", 1));
 };
-JOSH3D_DEFINE_ENUM_EXTRAS(DeferredGeometry::Strategy, DrawPerMesh, BatchedMDI);
+JOSH3D_DEFINE_ENUM_EXTRAS(DeferredGeometry::Strategy, DrawPerMesh, BatchedMDI, InstancedMDI, PooledMDI);
 
 
 } // namespace josh
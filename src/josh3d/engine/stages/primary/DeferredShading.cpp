@@ -70,10 +70,36 @@ auto get_active_dlight_or_default(const Registry& registry)
 } // namespace
 
 
+auto DeferredShading::resources(Extent2I) const
+    -> StageResources
+{
+    auto resources = StageResources()
+        .reads(GBuffer::transient_normals)
+        .reads(GBuffer::transient_albedo)
+        .reads(GBuffer::transient_specular)
+        .reads(PointShadows::resource_maps)
+        .reads(Cascades::resource_maps)
+        .writes(resource_main_target);
+
+    // Either side could end up being the occlusion, depending on the number of swaps.
+    if (use_ambient_occlusion)
+    {
+        resources = MOVE(resources)
+            .reads(AOBuffers::transient_side0)
+            .reads(AOBuffers::transient_side1);
+    }
+
+    return resources;
+}
+
 void DeferredShading::operator()(
     PrimaryContext context)
 {
     ZSCGPUN("DeferredShading");
+    csm_views_buf_          .advance();
+    plights_with_shadow_buf_.advance();
+    plights_no_shadow_buf_  .advance();
+
     if (auto* csm = context.belt().try_get<Cascades>())
         update_cascade_buffer(*csm);
 
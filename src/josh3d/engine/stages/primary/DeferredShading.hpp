@@ -5,7 +5,7 @@
 #include "GLObjects.hpp"
 #include "LightsGPU.hpp"
 #include "ShaderPool.hpp"
-#include "UploadBuffer.hpp"
+#include "StreamingBuffer.hpp"
 #include "VPath.hpp"
 
 
@@ -45,11 +45,12 @@ struct DeferredShading
     float plight_fade_start_fraction = 0.75f; // [0, 1] in fraction of bounding radius.
 
     void operator()(PrimaryContext context);
+    auto resources(Extent2I main_resolution) const -> StageResources;
 
 private:
-    UploadBuffer<PointLightBoundedGPU> plights_with_shadow_buf_;
-    UploadBuffer<PointLightBoundedGPU> plights_no_shadow_buf_;
-    UploadBuffer<CascadeViewGPU>       csm_views_buf_;
+    StreamingBuffer<PointLightBoundedGPU> plights_with_shadow_buf_;
+    StreamingBuffer<PointLightBoundedGPU> plights_no_shadow_buf_;
+    StreamingBuffer<CascadeViewGPU>       csm_views_buf_;
 
     void update_point_light_buffers(const Registry& registry);
     void update_cascade_buffer(const Cascades& csm);
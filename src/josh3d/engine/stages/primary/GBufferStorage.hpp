@@ -4,6 +4,7 @@
 #include "GLObjects.hpp"
 #include "GLTextures.hpp"
 #include "Region.hpp"
+#include "RenderGraph.hpp"
 #include "StageContext.hpp"
 #include "Tracy.hpp"
 
@@ -18,6 +19,10 @@ The "*" denotes textures that are not owned by the GBuffer.
     Albedo    [1] RGB8       // [0, 1] "linear" color.
     Specular  [2] R8         // [0, 1] specular factor.
     ObjectID* [3] R32UI      // [0, UINT_MAX], shared from IDBuffer.
+
+Normals, Albedo and Specular are transients of the RenderGraph, so they only
+exist while some live stage still uses them. Stages that draw into the GBuffer
+should declare writes to them, and stages that sample it should declare reads.
 */
 struct GBuffer
 {
@@ -40,39 +45,60 @@ struct GBuffer
     static constexpr u32  slot_specular    = 2;
     static constexpr u32  slot_object_id   = 3;
 
+    static constexpr auto transient_normals  = "GBuffer.Normals"_hs;
+    static constexpr auto transient_albedo   = "GBuffer.Albedo"_hs;
+    static constexpr auto transient_specular = "GBuffer.Specular"_hs;
+
+    // Declares the writes of a stage that draws the geometry into the GBuffer.
+    // This includes the depth of the main target and the ObjectID of the IDBuffer.
+    static auto geometry_writes(StageResources resources = {}) -> StageResources;
+
     // HMM: This could *technically* be 0, but it's hard to imagine why.
     // The worse case is when this is dangling instead. This shouldn't
     // happen within a frame, until a new frame starts so it's all OK
     // I guess, but we need to formalize this a bit.
     RawTexture2D<>    _depth;
-    UniqueTexture2D   _normals;
-    UniqueTexture2D   _albedo;
-    UniqueTexture2D   _specular;
+    RawTexture2D<>    _normals;
+    RawTexture2D<>    _albedo;
+    RawTexture2D<>    _specular;
     RawTexture2D<>    _object_id;
     Extent2I          _resolution = { 0, 0 };
     UniqueFramebuffer _fbo;
 
-    void _resize(Extent2I new_resolution);
+    void _reset_targets(Extent2I resolution, RawTexture2D<> normals, RawTexture2D<> albedo, RawTexture2D<> specular);
     void _reset_depth(RawTexture2D<> new_depth);
     void _reset_object_id(RawTexture2D<> new_object_id);
 };
 
-inline void GBuffer::_resize(Extent2I new_resolution)
+inline void GBuffer::_reset_targets(
+    Extent2I       resolution,
+    RawTexture2D<> normals,
+    RawTexture2D<> albedo,
+    RawTexture2D<> specular)
 {
-    if (_resolution == new_resolution) return;
-    _resolution = new_resolution;
-    _normals  = {};
-    _albedo   = {};
-    _specular = {};
-    _normals ->allocate_storage(_resolution, iformat_normals);
-    _albedo  ->allocate_storage(_resolution, iformat_albedo);
-    _specular->allocate_storage(_resolution, iformat_specular);
+    // NOTE: Always reattaching, since the names could be recycled
+    // by the driver when the graph recreates the views.
+    _resolution = resolution;
+    _normals    = normals;
+    _albedo     = albedo;
+    _specular   = specular;
     _fbo->attach_texture_to_color_buffer(_normals,  slot_normals);
     _fbo->attach_texture_to_color_buffer(_albedo,   slot_albedo);
     _fbo->attach_texture_to_color_buffer(_specular, slot_specular);
     _fbo->specify_color_buffers_for_draw(slot_normals, slot_albedo, slot_specular, slot_object_id);
 }
 
+inline auto GBuffer::geometry_writes(StageResources resources)
+    -> StageResources
+{
+    return MOVE(resources)
+        .writes(transient_normals)
+        .writes(transient_albedo)
+        .writes(transient_specular)
+        .writes(IDBuffer::resource_object_id)
+        .writes(resource_main_target);
+}
+
 inline void GBuffer::_reset_depth(RawTexture2D<> new_depth)
 {
     _depth = new_depth;
@@ -88,13 +114,14 @@ inline void GBuffer::_reset_object_id(RawTexture2D<> new_object_id)
 
 
 /*
-Provides the storage for the GBuffer and clears it on each pass.
+Creates the transients of the GBuffer and clears them on each pass.
 
 Place it before any other stages that draw into the GBuffer.
 */
 struct GBufferStorage
 {
     void operator()(PrimaryContext context);
+    auto resources(Extent2I main_resolution) const -> StageResources;
 
     GBuffer gbuffer;
 };
@@ -104,7 +131,10 @@ inline void GBufferStorage::operator()(
     PrimaryContext context)
 {
     ZSCGPUN("GBufferStorage");
-    gbuffer._resize(context.main_resolution());
+    gbuffer._reset_targets(context.main_resolution(),
+        context.transient(GBuffer::transient_normals),
+        context.transient(GBuffer::transient_albedo),
+        context.transient(GBuffer::transient_specular));
     gbuffer._reset_depth(context.main_depth_texture());
     if (auto* idbuffer = context.belt().try_get<IDBuffer>())
         gbuffer._reset_object_id(idbuffer->object_id_texture());
@@ -118,5 +148,14 @@ inline void GBufferStorage::operator()(
     context.belt().put_ref(gbuffer);
 }
 
+inline auto GBufferStorage::resources(Extent2I main_resolution) const
+    -> StageResources
+{
+    return StageResources()
+        .creates(GBuffer::transient_normals,  { main_resolution, GBuffer::iformat_normals  })
+        .creates(GBuffer::transient_albedo,   { main_resolution, GBuffer::iformat_albedo   })
+        .creates(GBuffer::transient_specular, { main_resolution, GBuffer::iformat_specular });
+}
+
 
 } // namespace josh::stages::primary
@@ -1,8 +1,10 @@
 #pragma once
 #include "GLObjects.hpp"
 #include "GLTextures.hpp"
+#include "IDPicker.hpp"
 #include "StageContext.hpp"
 #include "Region.hpp"
+#include "RenderGraph.hpp"
 #include "Tracy.hpp"
 
 
@@ -20,6 +22,9 @@ struct IDBuffer
     static constexpr auto iformat_object_id = InternalFormat::R32UI;
     static constexpr u32  slot_object_id    = 0; // In the internal FBO, this is rarely used.
 
+    // Not a transient, since the IDPicker reads it back over the next frames.
+    static constexpr auto resource_object_id = "IDBuffer.ObjectID"_hs;
+
     UniqueTexture2D   _object_id;
     UniqueFramebuffer _fbo;
     void _resize(Extent2I new_resolution);
@@ -37,13 +42,18 @@ inline void IDBuffer::_resize(Extent2I new_resolution)
 /*
 Provides the storage for the ObjectID, resizes and clears it on each pass.
 
+Also owns the IDPicker for asynchronous reads of the IDBuffer,
+and resolves its pending picks on each pass. Both are put on the belt.
+
 Place it before any other stages that draw into the IDBuffer.
 */
 struct IDBufferStorage
 {
     void operator()(PrimaryContext context);
+    auto resources(Extent2I) const -> StageResources { return StageResources().writes(IDBuffer::resource_object_id); }
 
     IDBuffer idbuffer;
+    IDPicker picker;
 };
 
 
@@ -51,6 +61,8 @@ inline void IDBufferStorage::operator()(
     PrimaryContext context)
 {
     ZSCGPUN("IDBufferStorage");
+    picker.resolve_available();
+
     idbuffer._resize(context.main_resolution());
 
     const BindGuard bfbo = idbuffer.bind_draw();
@@ -60,6 +72,7 @@ inline void IDBufferStorage::operator()(
     glapi::clear_color_buffer(bfbo, 0, RGBAUI{ .r=null_color });
 
     context.belt().put_ref(idbuffer);
+    context.belt().put_ref(picker);
 }
 
 
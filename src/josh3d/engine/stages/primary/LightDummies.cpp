@@ -17,12 +17,22 @@
 
 namespace josh {
 
+auto LightDummies::resources(Extent2I) const
+    -> StageResources
+{
+    if (not display) return {};
+    return StageResources()
+        .writes(IDBuffer::resource_object_id)
+        .writes(resource_main_target);
+}
+
 void LightDummies::operator()(PrimaryContext context)
 {
     ZSCGPUN("LightDummies");
     if (not display) return;
 
     _relink_attachments(context);
+    _plight_params.advance();
     _restage_plight_params(context.registry());
 
     const auto num_plights = GLsizei(_plight_params.num_staged());
@@ -3,7 +3,7 @@
 #include "GLObjects.hpp"
 #include "ShaderPool.hpp"
 #include "StageContext.hpp"
-#include "UploadBuffer.hpp"
+#include "StreamingBuffer.hpp"
 #include "VPath.hpp"
 
 
@@ -17,6 +17,7 @@ struct LightDummies
     bool  attenuate_color = true;
 
     void operator()(PrimaryContext context);
+    auto resources(Extent2I main_resolution) const -> StageResources;
 
     struct PLightParamsGPU
     {
@@ -26,7 +27,7 @@ struct LightDummies
         alignas(std430::align_uint)  uint  id;
     };
 
-    UploadBuffer<PLightParamsGPU> _plight_params;
+    StreamingBuffer<PLightParamsGPU> _plight_params;
     UniqueFramebuffer             _fbo;
 
     void _restage_plight_params(const Registry& registry);
@@ -15,13 +15,83 @@
 #include "Transform.hpp"
 #include "LightCasters.hpp"
 #include "components/Visible.hpp"
+#include "components/Stationary.hpp"
+#include "AABB.hpp"
+#include "StationaryCasters.hpp"
 #include "ECS.hpp"
+#include "Ranges.hpp"
 #include "Tracy.hpp"
 #include <glm/gtc/constants.hpp>
 #include <tracy/Tracy.hpp>
+#include <algorithm>
 
 
 namespace josh {
+namespace {
+
+void set_light_uniforms(RawProgram<> sp, const PointShadowView& view, uindex cubemap_id)
+{
+    // HMM: This could certainly be sent over UBO, but we are *far*
+    // from this being the primary bottleneck.
+    const Location views_loc = sp.get_uniform_location("views");
+    sp.set_uniform_mat4v(views_loc, 6, false, value_ptr(view.view_mats[0]));
+
+    sp.uniform("projection", view.proj_mat);
+    sp.uniform("cubemap_id", i32(cubemap_id));
+    sp.uniform("z_far",      view.z_far);
+}
+
+bool is_in_range(const AABB& aabb, const vec3& light_pos, float radius)
+{
+    const vec3 closest = glm::clamp(light_pos, aabb.lbb, aabb.rtf);
+    const vec3 delta   = closest - light_pos;
+    return glm::dot(delta, delta) <= radius * radius;
+}
+
+// Conservative: entities without an AABB are assumed to be in range.
+bool is_in_range_of(const Registry& registry, Entity entity, const vec3& light_pos, float radius)
+{
+    const auto* aabb = registry.try_get<AABB>(entity);
+    if (not aabb) return true;
+    return is_in_range(*aabb, light_pos, radius);
+}
+
+constexpr u8 all_faces = 0b111111;
+
+/*
+Faces of the cubemap around the light that can see any part of the AABB.
+Bits are in the order of the view matrices: +X, -X, +Y, -Y, +Z, -Z.
+
+The frustum of each face is bounded by 4 planes through the light, each
+at 45 degrees between the face axis and one of the other two axes. Each
+plane only involves two axes, so the farthest extent of the box along the
+plane normal is a sum of the extents along those axes.
+
+Conservative, same as testing each plane separately.
+*/
+auto cube_face_mask(const AABB& aabb, const vec3& light_pos) noexcept
+    -> u8
+{
+    const vec3 lo = aabb.lbb - light_pos;
+    const vec3 hi = aabb.rtf - light_pos;
+
+    u8 mask = 0;
+    for (const int axis : irange(3))
+    {
+        const int b = (axis + 1) % 3;
+        const int c = (axis + 2) % 3;
+
+        // How far along the face axis the box must reach to be inside all 4 planes.
+        // Never behind the light, even if the box straddles the side planes.
+        const float threshold = std::max({ 0.f, lo[b], -hi[b], lo[c], -hi[c] });
+
+        if (+hi[axis] >= threshold) mask |= u8(1 << (2 * axis + 0));
+        if (-lo[axis] >= threshold) mask |= u8(1 << (2 * axis + 1));
+    }
+    return mask;
+}
+
+} // namespace
 
 
 PointShadowMapping::PointShadowMapping(i32 side_resolution)
@@ -37,7 +107,16 @@ void PointShadowMapping::operator()(
     ZSCGPUN("PSM");
     prepare_point_shadows(context.registry());
 
-    map_point_shadows(context);
+    if (cache_stationary and has_stationary_casters(context.registry()))
+    {
+        map_point_shadows_cached(context);
+    }
+    else
+    {
+        // The static cache is not kept up-to-date while disabled.
+        cache_slots_.clear();
+        map_point_shadows(context);
+    }
 
     context.belt().put_ref(point_shadows);
 }
@@ -119,106 +198,241 @@ void PointShadowMapping::map_point_shadows(
 
     glapi::clear_depth_buffer(bfb, 1.f);
 
-    const auto set_per_light_uniforms = [&](RawProgram<> sp, uindex cubemap_id)
+    for (const uindex cubemap_idx : irange(num_cubes()))
+        draw_casters(bfb, mesh_registry, registry, cubemap_idx, Casters::All);
+}
+
+void PointShadowMapping::map_point_shadows_cached(
+    PrimaryContext context)
+{
+    ZoneScoped;
+
+    const auto& registry      = context.registry();
+    const auto& mesh_registry = context.mesh_registry();
+    auto& maps = point_shadows.maps;
+
+    const i32 num_cubes = maps.num_cubes();
+    if (num_cubes == 0)
+        return;
+
+    const Extent2I resolution = maps.resolution();
+
+    // Everything is invalidated if the cache is reallocated...
+    if (static_cubemaps_->get_resolution() != resolution or
+        static_cubemaps_->get_num_array_elements() != num_cubes)
+    {
+        static_cubemaps_ = {};
+        static_cubemaps_->allocate_storage(resolution, num_cubes, PointShadowMaps::iformat);
+        cache_slots_.clear();
+    }
+
+    // ...or if any of the stationary casters have changed.
+    const usize fingerprint = stationary_casters_fingerprint(registry);
+    if (fingerprint != stationary_fingerprint_)
+    {
+        stationary_fingerprint_ = fingerprint;
+        cache_slots_.clear();
+    }
+
+    cache_slots_.resize(usize(num_cubes));
+
+    // Then per-light, if the light has moved or another light took the slot.
+    for (const uindex i : irange(num_cubes))
     {
-        const auto& view = point_shadows.views[cubemap_id];
+        const Entity light    = point_shadows.entities[i];
+        const auto&  view     = point_shadows.views[i];
+        const vec3   position = registry.get<MTransform>(light).decompose_position();
+        auto&        slot     = cache_slots_[i];
+
+        if (slot.light != light or slot.position != position or slot.z_far != view.z_far)
+        {
+            slot = {
+                .light    = light,
+                .position = position,
+                .z_far    = view.z_far,
+            };
+        }
+    }
 
-        // HMM: This could certainly be sent over UBO, but we are *far*
-        // from this being the primary bottleneck.
-        const Location views_loc = sp.get_uniform_location("views");
-        sp.set_uniform_mat4v(views_loc, 6, false, value_ptr(view.view_mats[0]));
+    // The moving casters are only drawn into the lights that they can reach.
+    Vector<bool> has_dynamic(usize(num_cubes));
+    for (const Entity entity : registry.view<StaticMesh, MTransform>(entt::exclude<Stationary>))
+        for (const uindex i : irange(num_cubes))
+            if (not has_dynamic[i] and is_in_range_of(registry, entity, cache_slots_[i].position, cache_slots_[i].z_far))
+                has_dynamic[i] = true;
 
-        sp.uniform("projection", view.proj_mat);
-        sp.uniform("cubemap_id", i32(cubemap_id));
-        sp.uniform("z_far",      view.z_far);
+    glapi::set_viewport({ {}, resolution });
+
+    // The cubemap array is indexed by layer-faces, 6 per light.
+    const auto light_region = [&](uindex cubemap_idx) -> Region3I
+    {
+        return { { 0, 0, i32(cubemap_idx) * 6 }, { resolution.width, resolution.height, 6 } };
     };
 
-    // Alpha-tested.
+    // Redraw the stationary casters where invalidated.
     {
-        const RawProgram<> sp  = sp_with_alpha_;
-        const BindGuard    bsp = sp.use();
+        fbo_->attach_texture_to_depth_buffer(static_cubemaps_.get());
+        const BindGuard bfb = fbo_->bind_draw();
 
-        for (const uindex cubemap_idx : irange(num_cubes()))
+        for (const uindex i : irange(num_cubes))
         {
-            set_per_light_uniforms(sp, cubemap_idx);
-            draw_all_world_geometry_with_alpha_test(bsp, bfb, mesh_registry, registry);
+            auto& slot = cache_slots_[i];
+            if (slot.static_valid) continue;
+
+            const float far_depth = 1.f;
+            static_cubemaps_->fill_image_region(light_region(i),
+                PixelDataFormat::DepthComponent, PixelDataType::Float, &far_depth);
+
+            draw_casters(bfb, mesh_registry, registry, i, Casters::Stationary);
+            slot.static_valid     = true;
+            slot.output_is_static = false;
         }
     }
 
-    // Opaque.
+    // Then composite the moving casters on top of a copy of the cache.
     {
-        const RawProgram<> sp  = sp_no_alpha_;
-        const BindGuard    bsp = sp.use();
+        fbo_->attach_texture_to_depth_buffer(maps.cubemaps());
+        const BindGuard bfb = fbo_->bind_draw();
 
-        for (const uindex cubemap_idx : irange(num_cubes()))
+        for (const uindex i : irange(num_cubes))
         {
-            set_per_light_uniforms(sp, cubemap_idx);
-            draw_all_world_geometry_no_alpha_test(bsp, bfb, mesh_registry, registry);
+            auto& slot = cache_slots_[i];
+
+            // If nothing moves in range, last frame's output is still good.
+            if (slot.output_is_static and not has_dynamic[i])
+                continue;
+
+            const Region3I region = light_region(i);
+            static_cubemaps_->copy_image_region_to(region.offset, region.extent, maps.cubemaps(), region.offset);
+
+            if (has_dynamic[i])
+                draw_casters(bfb, mesh_registry, registry, i, Casters::Dynamic);
+
+            slot.output_is_static = not has_dynamic[i];
         }
     }
 }
 
-void PointShadowMapping::draw_all_world_geometry_no_alpha_test(
-    BindToken<Binding::Program>         bsp,
-    BindToken<Binding::DrawFramebuffer> bfb,
-    const MeshRegistry&                 mesh_registry,
-    const Registry&                     registry)
+void PointShadowMapping::cull_casters(
+    const Registry& registry,
+    uindex          cubemap_idx,
+    Casters         casters)
 {
-    // Assumes that projection and view are already set.
-    const auto* storage = mesh_registry.storage_for<VertexStatic>();
-    if (not storage) return;
-
-    const BindGuard bva = storage->vertex_array().bind();
-
-    const RawProgram<> sp = sp_no_alpha_;
+    ZS;
+    const vec3  light_pos = registry.get<MTransform>(point_shadows.entities[cubemap_idx]).decompose_position();
+    const float z_far     = point_shadows.views[cubemap_idx].z_far;
 
-    // TODO: Could easily multidraw this.
-    const auto draw_from_view = [&](auto view)
+    const auto cull_into = [&](Vector<CasterDraw>& drawlist, auto view)
     {
-        const Location model_loc = sp.get_uniform_location("model");
-        for (const auto [entity, mesh, world_mtf] : view.each())
+        drawlist.clear();
+        for (const Entity entity : view)
         {
-            sp.uniform(model_loc, world_mtf.model());
-            draw_one_from_storage(*storage, bva, bsp, bfb, mesh.lods.cur());
+            // Conservative: entities without an AABB are drawn into every face.
+            u8 face_mask = all_faces;
+            if (const auto* aabb = registry.try_get<AABB>(entity))
+            {
+                if (not is_in_range(*aabb, light_pos, z_far)) continue;
+                if (cull_faces) face_mask = cube_face_mask(*aabb, light_pos);
+            }
+            drawlist.push_back({ .entity = entity, .face_mask = face_mask });
         }
     };
 
     // TODO: Opaque should be a tag assigned to all entities that do *not*
     // have AlphaTested or Transparent. Otherwise we are doing negative filtering.
 
-    draw_from_view(registry.view<StaticMesh, MTransform>(entt::exclude<AlphaTested>));
+    switch (casters)
+    {
+        case Casters::All:
+            cull_into(drawlist_opaque_,  registry.view<StaticMesh, MTransform>(entt::exclude<AlphaTested>));
+            cull_into(drawlist_atested_, registry.view<AlphaTested, StaticMesh, MTransform>());
+            break;
+        case Casters::Stationary:
+            cull_into(drawlist_opaque_,  registry.view<Stationary, StaticMesh, MTransform>(entt::exclude<AlphaTested>));
+            cull_into(drawlist_atested_, registry.view<AlphaTested, Stationary, StaticMesh, MTransform>());
+            break;
+        case Casters::Dynamic:
+            cull_into(drawlist_opaque_,  registry.view<StaticMesh, MTransform>(entt::exclude<AlphaTested, Stationary>));
+            cull_into(drawlist_atested_, registry.view<AlphaTested, StaticMesh, MTransform>(entt::exclude<Stationary>));
+            break;
+    }
 }
 
-void PointShadowMapping::draw_all_world_geometry_with_alpha_test(
-    BindToken<Binding::Program>         bsp,
+void PointShadowMapping::draw_casters(
     BindToken<Binding::DrawFramebuffer> bfb,
     const MeshRegistry&                 mesh_registry,
-    const Registry&                     registry)
+    const Registry&                     registry,
+    uindex                              cubemap_idx,
+    Casters                             casters)
 {
-
-    // Assumes that projection and view are already set.
     const auto* storage = mesh_registry.storage_for<VertexStatic>();
     if (not storage) return;
 
+    cull_casters(registry, cubemap_idx, casters);
+
+    const auto& view = point_shadows.views[cubemap_idx];
     const BindGuard bva = storage->vertex_array().bind();
 
-    // TODO: Could be a simple place to try batch-draws.
-    const RawProgram<> sp = sp_with_alpha_;
-    sp.uniform("material.diffuse", 0);
+    const auto get_mesh_id = [&](const CasterDraw& draw) -> decltype(auto)
+    {
+        return registry.get<StaticMesh>(draw.entity).lods.cur();
+    };
 
-    auto meshes_with_alpha_view = registry.view<AlphaTested, StaticMesh, MTransform>();
+    const auto get_draw_data = [&](const CasterDraw& draw) -> DrawGPU
+    {
+        return { .model_rows = registry.get<AffineTransform>(draw.entity).rows, .face_mask = draw.face_mask };
+    };
 
-    const Location model_loc = sp.get_uniform_location("model");
-    for (auto [e, mesh, world_mtf]
-        : meshes_with_alpha_view.each())
+    // Opaque. All at once.
+    if (not drawlist_opaque_.empty())
     {
-        if (auto* mtl = registry.try_get<MaterialPhong>(e))
-            mtl->diffuse->bind_to_texture_unit(0);
-        else
-            globals::default_diffuse_texture().bind_to_texture_unit(0);
+        const RawProgram<> sp  = sp_no_alpha_;
+        const BindGuard    bsp = sp.use();
+        set_light_uniforms(sp, view, cubemap_idx);
+
+        draw_data_.restage(drawlist_opaque_ | transform(get_draw_data));
+        draw_data_.bind_to_ssbo_index(0);
+
+        multidraw_indirect_from_storage(*storage, bva, bsp, bfb,
+            drawlist_opaque_ | transform(get_mesh_id), mdi_buffer_);
+    }
 
-        sp.uniform(model_loc, world_mtf.model());
-        draw_one_from_storage(*storage, bva, bsp, bfb, mesh.lods.cur());
+    // AlphaTested. In batches limited by the number of texture units.
+    if (not drawlist_atested_.empty())
+    {
+        const RawProgram<> sp  = sp_with_alpha_;
+        const BindGuard    bsp = sp.use();
+        set_light_uniforms(sp, view, cubemap_idx);
+
+        const usize batch_size = max_frag_texture_units();
+
+        const Span<const i32> samplers = build_irange_tls_array(batch_size);
+        sp.set_uniform_intv(sp.get_uniform_location("samplers"), i32(samplers.size()), samplers.data());
+
+        draw_data_.restage(drawlist_atested_ | transform(get_draw_data));
+
+        thread_local Vector<u32> tex_units;
+
+        for (usize batch_offset = 0; batch_offset < drawlist_atested_.size(); batch_offset += batch_size)
+        {
+            const usize count = std::min(batch_size, drawlist_atested_.size() - batch_offset);
+            const auto  batch = Span<const CasterDraw>(drawlist_atested_).subspan(batch_offset, count);
+
+            tex_units.clear();
+            for (const CasterDraw& draw : batch)
+            {
+                if (const auto* mtl = registry.try_get<MaterialPhong>(draw.entity))
+                    tex_units.push_back(mtl->diffuse->id());
+                else
+                    tex_units.push_back(globals::default_diffuse_texture().id());
+            }
+
+            glapi::bind_texture_units(tex_units);
+            draw_data_.bind_range_to_ssbo_index({ .offset=batch_offset, .count=count }, 0);
+
+            multidraw_indirect_from_storage(*storage, bva, bsp, bfb,
+                batch | transform(get_mesh_id), mdi_buffer_);
+        }
     }
 }
 
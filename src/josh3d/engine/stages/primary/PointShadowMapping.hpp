@@ -1,11 +1,14 @@
 #pragma once
+#include "DrawHelpers.hpp"
 #include "ECS.hpp"
 #include "GLAPIBinding.hpp"
 #include "GLObjects.hpp"
 #include "GLTextures.hpp"
+#include "GPULayout.hpp"
 #include "MeshRegistry.hpp"
 #include "StageContext.hpp"
 #include "ShaderPool.hpp"
+#include "UploadBuffer.hpp"
 #include "VPath.hpp"
 
 
@@ -53,6 +56,9 @@ struct PointShadowView
 
 struct PointShadows
 {
+    // Not a transient, since the stationary casters are cached across frames.
+    static constexpr auto resource_maps = "PointShadows.Maps"_hs;
+
     PointShadowMaps         maps;
     Vector<Entity>          entities; // List of source point light entities. Same order as maps and views.
     Vector<PointShadowView> views;    // Same order as maps.
@@ -69,40 +75,95 @@ struct PointShadowMapping
 
     PointShadowMapping(i32 side_resolution = 1024);
 
+    // Keep the depth of the Stationary casters of each light in a separate cache,
+    // and only draw the other casters on top every frame. The cache of a light is
+    // redrawn when the light moves, or when any of the stationary casters change.
+    //
+    // Lights that have no moving casters in range cost only a few comparisons.
+    // Nothing is cached while no entity is tagged Stationary.
+    bool cache_stationary = true;
+
+    // Skip the faces of the cubemap that a caster cannot reach.
+    // The casters out of range of the light are always skipped.
+    bool cull_faces = true;
+
     void operator()(PrimaryContext context);
+    auto resources(Extent2I) const -> StageResources { return StageResources().writes(PointShadows::resource_maps); }
 
     PointShadows point_shadows;
 
 private:
     UniqueFramebuffer fbo_;
 
+    // Which casters to draw.
+    enum class Casters
+    {
+        All,
+        Stationary,
+        Dynamic, // All but Stationary.
+    };
+
+    // State of the cached depth of one light. Same order as the maps.
+    struct CacheSlot
+    {
+        Entity light            = nullent;
+        vec3   position         = {};
+        float  z_far            = {};
+        bool   static_valid     = false; // Stationary casters are drawn into the static cubemap.
+        bool   output_is_static = false; // Output cubemap is a copy of the static one, nothing else.
+    };
+
+    UniqueCubemapArray static_cubemaps_; // Same layout as the maps, but only the Stationary casters.
+    Vector<CacheSlot>  cache_slots_;
+    usize              stationary_fingerprint_ = 0;
+
     void map_point_shadows(PrimaryContext context);
+    void map_point_shadows_cached(PrimaryContext context);
 
     void prepare_point_shadows(const Registry& registry);
 
-    void draw_all_world_geometry_with_alpha_test(
-        BindToken<Binding::Program>         bound_sp,
-        BindToken<Binding::DrawFramebuffer> bound_fbo,
-        const MeshRegistry&                 mesh_registry,
-        const Registry&                     registry);
+    // One caster that survived the culling against a light.
+    struct CasterDraw
+    {
+        Entity entity;
+        u8     face_mask; // Bit per face, same order as the view matrices.
+    };
+
+    struct DrawGPU
+    {
+        alignas(std430::align_vec4) mat3x4 model_rows; // See AffineTransform.
+        alignas(std430::align_uint) u32    face_mask;
+    };
+
+    Vector<CasterDraw>       drawlist_opaque_;  // Reused between lights.
+    Vector<CasterDraw>       drawlist_atested_; // "
+    UploadBuffer<DrawGPU>    draw_data_;
+    UploadBuffer<MDICommand> mdi_buffer_;
+
+    // Cull the casters against the light and its faces into the drawlists.
+    void cull_casters(const Registry& registry, uindex cubemap_idx, Casters casters);
 
-    void draw_all_world_geometry_no_alpha_test(
-        BindToken<Binding::Program>         bound_sp,
+    // Cull, then draw the casters into the cubemap of one light with MDI.
+    // Sets the uniforms of the light itself.
+    void draw_casters(
         BindToken<Binding::DrawFramebuffer> bound_fbo,
         const MeshRegistry&                 mesh_registry,
-        const Registry&                     registry);
+        const Registry&                     registry,
+        uindex                              cubemap_idx,
+        Casters                             casters);
 
     ShaderToken sp_with_alpha_ = shader_pool().get({
-        .vert = VPath("src/shaders/depth_cubemap.vert"),
-        .geom = VPath("src/shaders/depth_cubemap_array.geom"),
-        .frag = VPath("src/shaders/depth_cubemap.frag")},
+        .vert = VPath("src/shaders/depth_cubemap_mdi.vert"),
+        .geom = VPath("src/shaders/depth_cubemap_array_mdi.geom"),
+        .frag = VPath("src/shaders/depth_cubemap_mdi.frag")},
         ProgramDefines()
-            .define("ENABLE_ALPHA_TESTING", 1));
+            .define("ENABLE_ALPHA_TESTING", 1)
+            .define("MAX_TEXTURE_UNITS", max_frag_texture_units()));
 
     ShaderToken sp_no_alpha_ = shader_pool().get({
-        .vert = VPath("src/shaders/depth_cubemap.vert"),
-        .geom = VPath("src/shaders/depth_cubemap_array.geom"),
-        .frag = VPath("src/shaders/depth_cubemap.frag")});
+        .vert = VPath("src/shaders/depth_cubemap_mdi.vert"),
+        .geom = VPath("src/shaders/depth_cubemap_array_mdi.geom"),
+        .frag = VPath("src/shaders/depth_cubemap_mdi.frag")});
 };
 
 
@@ -56,7 +56,9 @@ void SSAO::operator()(PrimaryContext context)
     const Extent2I source_resolution = gbuffer->resolution();
     const Extent2I target_resolution = scaled_resolution(source_resolution, resolution_divisor);
 
-    aobuffers._resize(target_resolution);
+    aobuffers._reset(target_resolution,
+        context.transient(AOBuffers::transient_side0),
+        context.transient(AOBuffers::transient_side1));
 
     const Extent2I noise_resolution = noise_texture_resolution();
 
@@ -110,8 +112,8 @@ void SSAO::operator()(PrimaryContext context)
         const BindGuard bsp = sp.use();
 
         const MultibindGuard bound_state = {
-            aobuffers._front().texture->bind_to_texture_unit(0),
-            _blur_sampler->             bind_to_texture_unit(0),
+            aobuffers._front().texture.bind_to_texture_unit(0),
+            _blur_sampler->            bind_to_texture_unit(0),
         };
 
         _fbo->attach_texture_to_color_buffer(aobuffers._back().texture, 0);
@@ -149,7 +151,7 @@ void SSAO::operator()(PrimaryContext context)
             {
                 sp.uniform("blur_dim", blur_dim);
 
-                aobuffers._front().texture->bind_to_texture_unit(0);
+                aobuffers._front().texture.bind_to_texture_unit(0);
                 _fbo->attach_texture_to_color_buffer(aobuffers._back().texture, 0);
 
                 const BindGuard bfb = _fbo->bind_draw();
@@ -162,6 +164,20 @@ void SSAO::operator()(PrimaryContext context)
     context.belt().put_ref(aobuffers);
 }
 
+auto SSAO::resources(Extent2I main_resolution) const
+    -> StageResources
+{
+    if (not enable_sampling) return {};
+
+    const Extent2I resolution = scaled_resolution(main_resolution, resolution_divisor);
+
+    return StageResources()
+        .creates(AOBuffers::transient_side0, { resolution, AOBuffers::iformat })
+        .creates(AOBuffers::transient_side1, { resolution, AOBuffers::iformat })
+        .reads(GBuffer::transient_normals)
+        .reads(resource_main_target); // Depth.
+}
+
 void SSAO::regenerate_kernel(usize n, float deflection_rad)
 {
     std::normal_distribution<float>       gaussian_dist;
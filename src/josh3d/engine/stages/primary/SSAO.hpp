@@ -5,6 +5,7 @@
 #include "GLObjects.hpp"
 #include "GLTextures.hpp"
 #include "Region.hpp"
+#include "RenderGraph.hpp"
 #include "ShaderPool.hpp"
 #include "StaticRing.hpp"
 #include "UniformTraits.hpp"
@@ -30,28 +31,28 @@ struct AOBuffers
 
     static constexpr auto iformat = InternalFormat::R8;
 
+    // Both sides are transients of the RenderGraph created by the SSAO stage.
+    static constexpr auto transient_side0 = "AOBuffers.Side0"_hs;
+    static constexpr auto transient_side1 = "AOBuffers.Side1"_hs;
+
     struct Side
     {
-        UniqueTexture2D texture;
+        RawTexture2D<> texture;
     };
 
     Extent2I            _resolution = { 0, 0 };
     StaticRing<Side, 2> _swapchain;
-    void _resize(Extent2I new_resolution);
+    void _reset(Extent2I resolution, RawTexture2D<> side0, RawTexture2D<> side1);
     auto _front() noexcept -> Side& { return _swapchain.current(); }
     auto _back()  noexcept -> Side& { return _swapchain.next(); }
     void _swap()  noexcept          { _swapchain.advance(); }
 };
 
-inline void AOBuffers::_resize(Extent2I new_resolution)
+inline void AOBuffers::_reset(Extent2I resolution, RawTexture2D<> side0, RawTexture2D<> side1)
 {
-    if (_resolution == new_resolution) return;
-    _resolution = new_resolution;
-    for (Side& side : _swapchain.storage)
-    {
-        side.texture = {};
-        side.texture->allocate_storage(_resolution, iformat);
-    }
+    _resolution = resolution;
+    _swapchain.storage[0].texture = side0;
+    _swapchain.storage[1].texture = side1;
 }
 
 /*
@@ -115,6 +116,7 @@ struct SSAO
         usize    blur_kernel_limb_size    = 2);
 
     void operator()(PrimaryContext context);
+    auto resources(Extent2I main_resolution) const -> StageResources;
 
     AOBuffers aobuffers;
 
@@ -5,6 +5,7 @@
 #include "GLAPICore.hpp"
 #include "MeshStorage.hpp"
 #include "StageContext.hpp"
+#include "Transform.hpp"
 #include "UniformTraits.hpp"
 #include "components/SkinnedMesh.hpp"
 #include "components/AlphaTested.hpp"
@@ -18,6 +19,12 @@
 namespace josh {
 
 
+auto SkinnedGeometry::resources(Extent2I) const
+    -> StageResources
+{
+    return GBuffer::geometry_writes();
+}
+
 void SkinnedGeometry::operator()(
     PrimaryContext context)
 {
@@ -35,6 +42,9 @@ void SkinnedGeometry::operator()(
 
     glapi::set_viewport({ {}, gbuffer->resolution() });
 
+    // Each skinned mesh gets its own batch of matrices within the frame.
+    _skinning_mats.advance();
+
     // FIXME: Negative filtering. Replace with Opaque tag or Not<AlphaTested> flag.
 
     auto view_opaque  = registry.view<Visible, MTransform, SkinnedMe2h, Pose>(entt::exclude<AlphaTested>);
@@ -72,7 +82,7 @@ void SkinnedGeometry::operator()(
         for (auto [entity, world_mtf, skinned_mesh, pose] : view.each())
         {
             sp.uniform(model_loc,        world_mtf.model());
-            sp.uniform(normal_model_loc, world_mtf.normal_model());
+            sp.uniform(normal_model_loc, registry.get<AffineTransform>(entity).normal_model);
             sp.uniform(object_id_loc,    entt::to_integral(entity));
 
             apply_materials(entity, sp, shininess_loc);
@@ -1,6 +1,6 @@
 #pragma once
 #include "Math.hpp"
-#include "UploadBuffer.hpp"
+#include "StreamingBuffer.hpp"
 #include "StageContext.hpp"
 #include "ShaderPool.hpp"
 #include "VPath.hpp"
@@ -14,6 +14,7 @@ struct SkinnedGeometry
     bool backface_culling = true;
 
     void operator()(PrimaryContext);
+    auto resources(Extent2I main_resolution) const -> StageResources;
 
 
     // FIXME: There should be a pool of poses uploaded by the
@@ -21,7 +22,7 @@ struct SkinnedGeometry
     // by some integral SkeletonID as an index into a sparse set.
     // Or something like that. This would allow us to multidraw
     // skinned meshes.
-    UploadBuffer<mat4> _skinning_mats;
+    StreamingBuffer<mat4> _skinning_mats;
 
     ShaderToken _sp_opaque = shader_pool().get({
         .vert = VPath("src/shaders/dfrg_skinned.vert"),
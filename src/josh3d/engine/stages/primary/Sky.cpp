@@ -21,6 +21,13 @@
 namespace josh {
 
 
+auto Sky::resources(Extent2I) const
+    -> StageResources
+{
+    if (sky_type == SkyType::None) return {};
+    return StageResources().writes(resource_main_target);
+}
+
 void Sky::operator()(PrimaryContext context)
 {
     ZSCGPUN("Sky");
@@ -30,6 +30,7 @@ struct Sky
     ProceduralSkyParams procedural_sky_params = {};
 
     void operator()(PrimaryContext context);
+    auto resources(Extent2I main_resolution) const -> StageResources;
 
 private:
     // TODO: Surely there are better ways, right?
@@ -13,6 +13,12 @@
 namespace josh {
 
 
+auto TerrainGeometry::resources(Extent2I) const
+    -> StageResources
+{
+    return GBuffer::geometry_writes();
+}
+
 void TerrainGeometry::operator()(
     PrimaryContext context)
 {
@@ -36,7 +42,7 @@ void TerrainGeometry::operator()(
         chunk.heightmap->bind_to_texture_unit(0);
 
         sp.uniform("model",        world_mtf.model());
-        sp.uniform("normal_model", world_mtf.normal_model());
+        sp.uniform("normal_model", registry.get<AffineTransform>(entity).normal_model);
         sp.uniform("object_id",    entt::to_integral(entity));
         sp.uniform("test_color",   0);
 
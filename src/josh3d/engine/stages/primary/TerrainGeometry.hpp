@@ -10,6 +10,7 @@ namespace josh {
 struct TerrainGeometry
 {
     void operator()(PrimaryContext context);
+    auto resources(Extent2I main_resolution) const -> StageResources;
 
     ShaderToken _sp = shader_pool().get({
         .vert = VPath("src/shaders/dfrg_terrain.vert"),
@@ -1,7 +1,10 @@
 #pragma once
+#include "CategoryCasts.hpp"
 #include "Common.hpp"
+#include "Scalars.hpp"
 #include <boost/interprocess/mapped_region.hpp>
 #include <boost/interprocess/file_mapping.hpp>
+#include <cassert>
 
 
 namespace josh {
@@ -13,6 +16,62 @@ using MappedRegion = boost::interprocess::mapped_region;
 using FileMapping = boost::interprocess::file_mapping;
 
 
+/*
+A view into a subrange of a MappedRegion that shares ownership of the region.
+
+This lets multiple resources be handed out of a single long-lived mapping
+(see pak archives in ResourceDatabase) without an extra open/mmap/munmap
+per resource. The region is unmapped when the last view is destroyed.
+
+Can be constructed from a uniquely owned MappedRegion, in which case
+it views the whole region and nothing is shared.
+
+Mimics the relevant subset of the MappedRegion interface.
+*/
+class MappedView
+{
+public:
+    MappedView() = default;
+
+    // Take ownership of a whole region.
+    MappedView(MappedRegion&& mregion)
+        : region_{ make_shared<MappedRegion>(MOVE(mregion)) }
+        , offset_{ 0 }
+        , size_  { region_->get_size() }
+    {}
+
+    // Share ownership of an existing region, viewing only `[offset_bytes, offset_bytes + size_bytes)`.
+    MappedView(SharedPtr<MappedRegion> region, usize offset_bytes, usize size_bytes)
+        : region_{ MOVE(region) }
+        , offset_{ offset_bytes }
+        , size_  { size_bytes   }
+    {
+        assert(region_);
+        assert(offset_ + size_ <= region_->get_size());
+    }
+
+    auto get_address() const noexcept -> void*  { return region_ ? (ubyte*)region_->get_address() + offset_ : nullptr; }
+    auto get_size()    const noexcept -> usize  { return size_;   }
+    auto get_offset()  const noexcept -> usize  { return offset_; } // Offset into the shared region.
+
+    // Flush a range of the view. Offset is relative to the start of the view.
+    // Size of 0 means "until the end of the view", just like for the MappedRegion.
+    auto flush(usize offset_bytes = 0, usize size_bytes = 0, bool async = true)
+        -> bool
+    {
+        if (!region_) return false;
+        assert(offset_bytes <= size_);
+        if (!size_bytes) size_bytes = size_ - offset_bytes;
+        return region_->flush(offset_ + offset_bytes, size_bytes, async);
+    }
+
+private:
+    SharedPtr<MappedRegion> region_;
+    usize                offset_{};
+    usize                size_  {};
+};
+
+
 template<typename T = byte>
 auto to_span(MappedRegion& mregion) noexcept
     -> Span<T>
@@ -28,6 +87,21 @@ auto to_span(MappedRegion&& mregion) noexcept
     -> Span<T>
 = delete;
 
+template<typename T = byte>
+auto to_span(MappedView& mview) noexcept
+    -> Span<T>
+{ return { (T*)mview.get_address(), mview.get_size() }; }
+
+template<typename T = byte>
+auto to_span(const MappedView& mview) noexcept
+    -> Span<const T>
+{ return { (const T*)mview.get_address(), mview.get_size() }; }
+
+template<typename T = byte>
+auto to_span(MappedView&& mview) noexcept
+    -> Span<T>
+= delete;
+
 
 
 
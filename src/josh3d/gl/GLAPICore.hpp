@@ -13,6 +13,8 @@
 #include <chrono>
 #include <cassert>
 #include <span>
+#include <string>
+#include <string_view>
 
 
 namespace josh {
@@ -77,6 +79,101 @@ inline auto get_current_time()
     return std::chrono::nanoseconds(detail::get_integer64(gl::GL_TIMESTAMP));
 }
 
+/*
+Wraps `glGetString` with `name = GL_VENDOR`.
+*/
+inline auto get_vendor_string()
+    -> std::string
+{
+    return reinterpret_cast<const char*>(gl::glGetString(gl::GL_VENDOR));
+}
+
+/*
+Wraps `glGetString` with `name = GL_RENDERER`.
+*/
+inline auto get_renderer_string()
+    -> std::string
+{
+    return reinterpret_cast<const char*>(gl::glGetString(gl::GL_RENDERER));
+}
+
+/*
+Wraps `glGetString` with `name = GL_VERSION`.
+
+Usually contains the driver version after the GL version.
+*/
+inline auto get_version_string()
+    -> std::string
+{
+    return reinterpret_cast<const char*>(gl::glGetString(gl::GL_VERSION));
+}
+
+/*
+Wraps `glGetIntegerv` with `pname = GL_NUM_PROGRAM_BINARY_FORMATS`.
+
+Zero if the implementation cannot retrieve the program binaries at all.
+*/
+inline auto get_num_program_binary_formats()
+    -> GLint
+{
+    return detail::get_integer(gl::GL_NUM_PROGRAM_BINARY_FORMATS);
+}
+
+/*
+Wraps `glGetIntegerv` with `pname = GL_NUM_EXTENSIONS` and `glGetStringi` with `name = GL_EXTENSIONS`.
+
+Linear in the number of extensions, so don't call this in a hot loop.
+*/
+inline auto has_extension(std::string_view name)
+    -> bool
+{
+    const GLint num_extensions = detail::get_integer(gl::GL_NUM_EXTENSIONS);
+    for (GLint i = 0; i < num_extensions; ++i)
+    {
+        const auto* extension = reinterpret_cast<const char*>(gl::glGetStringi(gl::GL_EXTENSIONS, GLuint(i)));
+        if (name == extension) return true;
+    }
+    return false;
+}
+
+} // namespace glapi
+
+
+/*
+SECTION: Parallel Shader Compilation [KHR_parallel_shader_compile].
+
+Not core, but widely supported either as the KHR or the ARB extension.
+*/
+namespace glapi {
+
+/*
+Whether either `GL_KHR_parallel_shader_compile` or `GL_ARB_parallel_shader_compile` is supported.
+
+If it is, the compilation and linking do not block until the status
+is queried, and `GL_COMPLETION_STATUS` can be polled without blocking.
+*/
+inline auto supports_parallel_shader_compile()
+    -> bool
+{
+    return has_extension("GL_KHR_parallel_shader_compile") or
+           has_extension("GL_ARB_parallel_shader_compile");
+}
+
+/*
+Wraps `glMaxShaderCompilerThreadsKHR` or `glMaxShaderCompilerThreadsARB`, whichever is supported.
+
+The `count` of `0xFFFFFFFF` lets the implementation pick the number of threads.
+
+PRE: `supports_parallel_shader_compile()`.
+*/
+inline void set_max_shader_compiler_threads(GLuint count)
+{
+    if (has_extension("GL_KHR_parallel_shader_compile"))
+        gl::glMaxShaderCompilerThreadsKHR(count);
+    else
+        gl::glMaxShaderCompilerThreadsARB(count);
+}
+
 } // namespace glapi
 
 
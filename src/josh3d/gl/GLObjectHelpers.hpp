@@ -207,6 +207,56 @@ inline constexpr auto max_num_levels(const Size3I& resolution)
 }
 
 
+/*
+Creates a new texture that shares the storage of the `origin`, reinterpreting
+it with a different `internal_format` and/or a subrange of its mip levels.
+
+The formats must be of the same view class (ex. RGBA8 and R32UI) [8.18].
+
+PRE: The `origin` has immutable storage.
+*/
+[[nodiscard]]
+inline auto create_texture_view(
+    RawTexture2D<GLConst> origin,
+    InternalFormat        internal_format,
+    MipLevel              first_level = MipLevel{ 0 },
+    NumLevels             num_levels  = NumLevels{ 1 })
+        -> UniqueTexture2D
+{
+    // NOTE: The view must be a name that was never bound to any target,
+    // so the glCreateTextures() that the GLAllocator uses would not work here.
+    GLuint id;
+    gl::glGenTextures(1, &id);
+    gl::glTextureView(id, gl::GL_TEXTURE_2D, origin.id(), enum_cast<GLenum>(internal_format),
+        GLuint(first_level), GLuint(num_levels), 0, 1);
+    return UniqueTexture2D::take_ownership(RawTexture2D<>::from_id(id));
+}
+
+/*
+Creates a new 2D texture that shares the storage of a single `layer` of the `origin` array.
+
+The view can be sampled, uploaded to and attached as a regular 2D texture,
+and has its own sampler and base level state independent of the `origin`.
+
+PRE: The `origin` has immutable storage.
+*/
+[[nodiscard]]
+inline auto create_texture_view(
+    RawTexture2DArray<GLConst> origin,
+    GLuint                     layer,
+    InternalFormat             internal_format,
+    MipLevel                   first_level = MipLevel{ 0 },
+    NumLevels                  num_levels  = NumLevels{ 1 })
+        -> UniqueTexture2D
+{
+    GLuint id;
+    gl::glGenTextures(1, &id);
+    gl::glTextureView(id, gl::GL_TEXTURE_2D, origin.id(), enum_cast<GLenum>(internal_format),
+        GLuint(first_level), GLuint(num_levels), layer, 1);
+    return UniqueTexture2D::take_ownership(RawTexture2D<>::from_id(id));
+}
+
+
 /*
     // Overload for `Texture[1|2|3]D`, `Cubemap`.
     void allocate_storage(
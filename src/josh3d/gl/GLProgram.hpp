@@ -304,6 +304,18 @@ struct Program
         return is_success == gl::GL_TRUE;
     }
 
+    // Wraps `glGetProgramiv` with `pname = GL_COMPLETION_STATUS_KHR`.
+    // Does not block, unlike the query of `GL_LINK_STATUS`.
+    //
+    // PRE: `glapi::supports_parallel_shader_compile()`.
+    auto has_completed_linking() const
+        -> bool
+    {
+        GLboolean is_complete;
+        gl::glGetProgramiv(self_id(), gl::GL_COMPLETION_STATUS_KHR, &is_complete);
+        return is_complete == gl::GL_TRUE;
+    }
+
     // Wraps `glValidateProgram` followed by `glGetProgramiv` with `pname = GL_VALIDATE_STATUS`.
     // Returns `true` if the program is valid according to `glValidateProgram`, `false` otherwise.
     auto validate() const
@@ -330,6 +342,42 @@ struct Program
         return log;
     }
 
+    // Wraps `glProgramParameteri` with `pname = GL_PROGRAM_BINARY_RETRIEVABLE_HINT`.
+    // Must be set before linking for `get_binary()` to be reliable.
+    void set_binary_retrievable_hint(bool retrievable) const requires mt::is_mutable
+    {
+        gl::glProgramParameteri(self_id(), gl::GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+            retrievable ? GLint(gl::GL_TRUE) : GLint(gl::GL_FALSE));
+    }
+
+    // Wraps `glGetProgramiv` with `pname = GL_PROGRAM_BINARY_LENGTH`.
+    auto get_binary_length() const
+        -> GLsizei
+    {
+        GLint length;
+        gl::glGetProgramiv(self_id(), gl::GL_PROGRAM_BINARY_LENGTH, &length);
+        return length;
+    }
+
+    // Wraps `glGetProgramBinary`.
+    // Returns the implementation-specific format of the binary written to `data`.
+    //
+    // PRE: `size` is at least `get_binary_length()`.
+    auto get_binary(void* data, GLsizei size) const
+        -> GLenum
+    {
+        GLenum format;
+        gl::glGetProgramBinary(self_id(), size, nullptr, &format, data);
+        return format;
+    }
+
+    // Wraps `glProgramBinary`.
+    // The binary can be rejected, check `has_linked_successfully()` after.
+    void set_binary(GLenum format, const void* data, GLsizei length) const requires mt::is_mutable
+    {
+        gl::glProgramBinary(self_id(), format, data, length);
+    }
+
     // Wraps `glGetProgramiv` with `pname = GL_ATTACHED_SHADERS`.
     auto get_num_attached_shaders() const
         -> GLint
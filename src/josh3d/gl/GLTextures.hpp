@@ -2024,6 +2024,27 @@ struct ImageOperations_Download
         _download_image_region_into(region, pptr::format, pptr::type, dst_buf, MipLevel{ 0 });
     }
 
+    // Wraps `glGetTextureSubImage` with `pixels` interpreted as the `offset`
+    // into the buffer bound to GL_PIXEL_PACK_BUFFER.
+    //
+    // Unlike downloading into client memory, this does not wait for the GPU.
+    // The data lands in the buffer once the preceding commands complete,
+    // use a fence to find out when.
+    void download_image_region_into_buffer(
+        const tt::region_type&              region,
+        PixelDataFormat                     format,
+        PixelDataType                       type,
+        BindToken<Binding::PixelPackBuffer> bound_pack_buffer,
+        OffsetBytes                         offset,
+        GLsizei                             max_size_bytes,
+        MipLevel                            level = MipLevel{ 0 }) const noexcept
+            requires tt::has_lod
+    {
+        assert(bound_pack_buffer.id() == glapi::get_bound_id(Binding::PixelPackBuffer));
+        _download_image_region_raw(region, format, type,
+            max_size_bytes, reinterpret_cast<void*>(offset.value), level);
+    }
+
 private:
 
     template<typename T>
@@ -2033,6 +2054,17 @@ private:
         PixelDataType          type,
         std::span<T>           dst_buf,
         MipLevel               level) const noexcept
+    {
+        _download_image_region_raw(region, format, type, dst_buf.size_bytes(), dst_buf.data(), level);
+    }
+
+    void _download_image_region_raw(
+        const tt::region_type& region,
+        PixelDataFormat        format,
+        PixelDataType          type,
+        GLsizei                buf_size_bytes,
+        void*                  pixels,
+        MipLevel               level) const noexcept
     {
         auto download = [&, this] (
             const Index3I& offset,
@@ -2043,8 +2075,8 @@ private:
                 offset.x,     offset.y,      offset.z,
                 extent.width, extent.height, extent.depth,
                 enum_cast<GLenum>(format), enum_cast<GLenum>(type),
-                dst_buf.size_bytes(),
-                dst_buf.data()
+                buf_size_bytes,
+                pixels
             );
         };
         auto& offset = region.offset;
@@ -291,6 +291,8 @@ void ImGuiApplicationAssembly::_draw_widgets()
             {
                 auto& engine = runtime.renderer;
                 ImGui::Checkbox("RGB -> sRGB", &engine.enable_srgb_conversion);
+                ImGui::Checkbox("Parallel Precompute", &engine.parallel_precompute);
+                ImGui::EnumCombo("Frame Pipelining", &engine.frame_pipelining);
 
                 // TODO: Reintroduce a way to pause measurements once that's supported.
 
@@ -23,6 +23,7 @@
 #include "components/AlphaTested.hpp"
 #include "components/Visible.hpp"
 #include "components/ShadowCasting.hpp"
+#include "components/Stationary.hpp"
 #include "components/Animation.hpp"
 #include "Tags.hpp"
 #include "Filesystem.hpp"
@@ -465,6 +466,13 @@ inline auto ShadowCastingHandleWidget(Handle light_handle)
     return TagCheckbox<ShadowCasting>("Shadow", light_handle);
 }
 
+// Stationary meshes are cached by the shadow mapping stages.
+inline auto StationaryHandleWidget(Handle mesh_handle)
+    -> bool
+{
+    return TagCheckbox<Stationary>("Stationary", mesh_handle);
+}
+
 inline auto DirectionalLightWidget(DirectionalLight& dlight)
     -> bool
 {
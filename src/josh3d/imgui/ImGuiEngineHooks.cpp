@@ -51,6 +51,26 @@ void ImGuiEngineHooks::display(UIContext& ui)
                     ImGui::Text("%.2fms", dt.to_seconds<float>() * 1e3f);
                 };
 
+                // Only the p99 is shown, the rest of the distribution is in the tooltip.
+                const auto text_percentiles = [&](const TimeHistogram::State& h)
+                {
+                    text_duration_ms(h.p99);
+                    if (ImGui::IsItemHovered())
+                    {
+                        ImGui::SetTooltip(
+                            "p50:   %.2fms\n"
+                            "p90:   %.2fms\n"
+                            "p99:   %.2fms\n"
+                            "p99.9: %.2fms\n"
+                            "Spikes: %zu/%zu",
+                            h.p50 .to_seconds<float>() * 1e3f,
+                            h.p90 .to_seconds<float>() * 1e3f,
+                            h.p99 .to_seconds<float>() * 1e3f,
+                            h.p999.to_seconds<float>() * 1e3f,
+                            h.spikes, h.count);
+                    }
+                };
+
                 const auto segment_table = [&]()
                 {
                     const auto table_flags =
@@ -75,6 +95,9 @@ void ImGuiEngineHooks::display(UIContext& ui)
                         ImGui::TableNextColumn();
                         text_duration_ms(s.wall_time.current().mean);
 
+                        ImGui::TableNextColumn();
+                        text_percentiles(s.wall_time_histogram.current());
+
                         ImGui::BeginDisabled(not perf_harness->is_gpu_timed());
 
                         ImGui::TableNextColumn();
@@ -83,13 +106,16 @@ void ImGuiEngineHooks::display(UIContext& ui)
                         ImGui::TableNextColumn();
                         text_duration_ms(s.device_time.current().mean);
 
+                        ImGui::TableNextColumn();
+                        text_percentiles(s.device_time_histogram.current());
+
                         ImGui::TableNextColumn();
                         text_duration_ms(s.latency.current().mean);
 
                         ImGui::EndDisabled();
                     };
 
-                    if (ImGui::BeginTable("Segments", 6, table_flags))
+                    if (ImGui::BeginTable("Segments", 8, table_flags))
                     {
                         DEFER(ImGui::EndTable());
 
@@ -99,8 +125,10 @@ void ImGuiEngineHooks::display(UIContext& ui)
                         ImGui::TableSetupColumn("From");
                         ImGui::TableSetupColumn("To");
                         ImGui::TableSetupColumn("CPU");
+                        ImGui::TableSetupColumn("CPU p99");
                         ImGui::TableSetupColumn("GPU Host", ImGuiTableColumnFlags_DefaultHide);
                         ImGui::TableSetupColumn("GPU Device");
+                        ImGui::TableSetupColumn("GPU p99");
                         ImGui::TableSetupColumn("Latency");
                         ImGui::TableHeadersRow();
 
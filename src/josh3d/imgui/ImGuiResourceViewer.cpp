@@ -133,6 +133,7 @@ void ImGuiResourceViewer::display(UIContext& ui)
     {
         ImGui::EnumCombo("Texture Encoding", &import_texture_params.encoding);
         ImGui::Checkbox("Generate Mipmaps", &import_texture_params.generate_mips);
+        ImGui::EnumCombo("Mipmap Filter", &import_texture_params.mip_filter);
         if (ImGui::Button("Import")) try_import_thing(import_texture_params);
         ImGui::TreePop();
     }
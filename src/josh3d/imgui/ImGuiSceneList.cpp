@@ -20,6 +20,8 @@
 #include "UIContext.hpp"
 #include "Selected.hpp"
 #include "components/ShadowCasting.hpp"
+#include "components/StaticMesh.hpp"
+#include "components/Stationary.hpp"
 #include <entt/entity/entity.hpp>
 #include <entt/entity/fwd.hpp>
 #include <exception>
@@ -111,6 +113,26 @@ void display_item_popup(
 
     ImGui::Separator();
 
+    // Imported models usually either move as a whole or not at all.
+    // NOTE: Only tags, the scene list itself does not iterate those.
+    if (ImGui::MenuItem("Mark Stationary (Subtree)"))
+    {
+        traverse_subtree_preorder(handle, [](Handle node)
+        {
+            if (has_component<StaticMesh>(node)) set_tag<Stationary>(node);
+        });
+    }
+
+    if (ImGui::MenuItem("Unmark Stationary (Subtree)"))
+    {
+        traverse_subtree_preorder(handle, [](Handle node)
+        {
+            unset_tag<Stationary>(node);
+        });
+    }
+
+    ImGui::Separator();
+
     if (ImGui::MenuItem("Destroy"))
     {
         signals.destroy.target           = handle.entity();
@@ -6,6 +6,7 @@
 #include "LightCasters.hpp"
 #include "components/Materials.hpp"
 #include "components/SkinnedMesh.hpp"
+#include "components/StaticMesh.hpp"
 #include "Transform.hpp"
 #include "Selected.hpp"
 #include <entt/entity/entity.hpp>
@@ -38,6 +39,9 @@ void ImGuiSelected::display(UIContext& ui)
         if (has_component<MaterialPhong>(handle))
             imgui::MaterialsWidget(handle);
 
+        if (has_component<StaticMesh>(handle))
+            imgui::StationaryHandleWidget(handle);
+
         if (has_component<SkinnedMesh>(handle))
             imgui::AnimationsWidget(handle);
 
@@ -3,6 +3,9 @@
 
 
 JOSH3D_SIMPLE_STAGE_HOOK(PointLightSetup)
+JOSH3D_SIMPLE_STAGE_HOOK(LODSelection)
+JOSH3D_SIMPLE_STAGE_HOOK(MipSelection)
+JOSH3D_SIMPLE_STAGE_HOOK(InstanceGrouping)
 JOSH3D_SIMPLE_STAGE_HOOK(CascadedShadowMapping)
 JOSH3D_SIMPLE_STAGE_HOOK(DeferredGeometry)
 JOSH3D_SIMPLE_STAGE_HOOK(DeferredShading)
@@ -3,6 +3,9 @@
 #include "detail/SimpleStageHookMacro.hpp"
 // IWYU pragma: begin_keep
 #include "stages/precompute/PointLightSetup.hpp"
+#include "stages/precompute/LODSelection.hpp"
+#include "stages/precompute/MipSelection.hpp"
+#include "stages/precompute/InstanceGrouping.hpp"
 // IWYU pragma: end_keep
 #include <imgui.h>
 
@@ -25,3 +28,39 @@ JOSH3D_SIMPLE_STAGE_HOOK_BODY(PointLightSetup)
             0.1f, 0.00001f, 10000.f, "%.5f", ImGuiSliderFlags_Logarithmic);
     }
 }
+
+JOSH3D_SIMPLE_STAGE_HOOK_BODY(LODSelection)
+{
+    ImGui::SliderFloat("Full Detail Screen Size", &stage.full_detail_screen_size,
+        0.01f, 2.f, "%.3f", ImGuiSliderFlags_Logarithmic);
+    ImGui::SliderFloat("Hysteresis", &stage.hysteresis, 0.f, 0.95f, "%.2f");
+    ImGui::SliderFloat("LOD Bias",   &stage.lod_bias,  -4.f, 4.f,   "%.2f");
+    ImGui::Checkbox("Request LODs from Loader", &stage.request_lods);
+}
+
+JOSH3D_SIMPLE_STAGE_HOOK_BODY(MipSelection)
+{
+    ImGui::Checkbox("Stream Mips", &stage.stream_mips);
+    ImGui::SliderFloat("Mip Bias",      &stage.mip_bias,      -4.f,  4.f,   "%.2f");
+    ImGui::SliderFloat("Texel Density", &stage.texel_density,  0.1f, 100.f, "%.2f", ImGuiSliderFlags_Logarithmic);
+
+    int budget_mib = int(stage.budget_bytes >> 20);
+    if (ImGui::SliderInt("Budget, MiB", &budget_mib, 16, 8192, "%d", ImGuiSliderFlags_Logarithmic))
+        stage.budget_bytes = usize(budget_mib) << 20;
+
+    const auto& stats = stage.stats;
+    ImGui::Text("Tracked: %zu", stats.num_tracked);
+    ImGui::Text("Resident: %.1f MiB, Target: %.1f MiB",
+        double(stats.resident_bytes) / double(1 << 20),
+        double(stats.target_bytes)   / double(1 << 20));
+}
+
+JOSH3D_SIMPLE_STAGE_HOOK_BODY(InstanceGrouping)
+{
+    ImGui::Checkbox("Enabled", &stage.enabled);
+    ImGui::TextDisabled("Only consumed by the InstancedMDI geometry strategy.");
+
+    ImGui::BeginDisabled(not stage.enabled);
+    ImGui::Text("Groups: %zu, Instances: %zu", stage.groups.num_groups(), stage.groups.num_instances());
+    ImGui::EndDisabled();
+}
@@ -53,6 +53,23 @@ JOSH3D_SIMPLE_STAGE_HOOK_BODY(CascadedShadowMapping)
     ImGui::EnumListBox("Faces to Cull", &stage.faces_to_cull, 0);
     ImGui::EndDisabled();
 
+    ImGui::SeparatorText("Per-Cascade Culling");
+
+    ImGui::Checkbox("Parallel Culling", &stage.parallel_culling);
+    ImGui::BeginDisabled(not stage.parallel_culling);
+    ImGui::SliderScalar("Min Entities per Task", &stage.min_entities_per_task,
+        usize(64), usize(65536), {}, ImGuiSliderFlags_Logarithmic);
+    ImGui::EndDisabled();
+
+    ImGui::SeparatorText("Stationary Caster Cache");
+
+    ImGui::Checkbox("Cache Stationary", &stage.cache_stationary);
+    ImGui::BeginDisabled(not stage.cache_stationary);
+    ImGui::SliderScalar("Num Cached Cascades", &stage.num_cached_cascades, 0, stage.max_cascades());
+    ImGui::SliderFloat("Max Drift, tx", &stage.max_cache_drift_tx,
+        1.f, 1024.f, "%.1f", ImGuiSliderFlags_Logarithmic);
+    ImGui::EndDisabled();
+
     ImGui::Separator();
 
     ImGui::BeginDisabled(not stage.cascades.draw_lists_active);
@@ -104,8 +121,13 @@ JOSH3D_SIMPLE_STAGE_HOOK_BODY(DeferredGeometry)
 {
     ImGui::Checkbox("Backface Culling", &stage.backface_culling);
     ImGui::EnumListBox("Strategy", &stage.strategy);
-    if (stage.strategy == josh::DeferredGeometry::Strategy::BatchedMDI)
+    if (stage.strategy == josh::DeferredGeometry::Strategy::BatchedMDI or
+        stage.strategy == josh::DeferredGeometry::Strategy::InstancedMDI)
         ImGui::Text("Max Batch Size: %u", stage.max_batch_size());
+    if (stage.strategy == josh::DeferredGeometry::Strategy::InstancedMDI)
+        ImGui::TextDisabled("Requires the InstanceGrouping stage to be enabled.\nFalls back to BatchedMDI otherwise.");
+    if (stage.strategy == josh::DeferredGeometry::Strategy::PooledMDI)
+        ImGui::Text("Max Fallback Batch Size: %u", stage.max_batch_size());
 }
 
 JOSH3D_SIMPLE_STAGE_HOOK_BODY(DeferredShading)
@@ -153,6 +175,9 @@ JOSH3D_SIMPLE_STAGE_HOOK_BODY(PointShadowMapping)
     {
         stage.resize_maps(side_resolution);
     }
+
+    ImGui::Checkbox("Cache Stationary", &stage.cache_stationary);
+    ImGui::Checkbox("Cull Faces",       &stage.cull_faces);
 }
 
 JOSH3D_SIMPLE_STAGE_HOOK_BODY(Sky)
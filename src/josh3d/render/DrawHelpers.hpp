@@ -200,6 +200,57 @@ void multidraw_indirect_from_storage(
     );
 }
 
+/*
+Parameters of one command in an instanced MDI call.
+*/
+template<typename VertexT>
+struct InstancedDraw
+{
+    MeshID<VertexT> mesh_id;
+    u32             num_instances;
+    u32             base_instance;
+};
+
+/*
+Same as `multidraw_indirect_from_storage()`, but each command draws
+`num_instances` instances of the mesh starting from the `base_instance`.
+
+The shader is expected to index the per-instance data with
+`gl_BaseInstance + gl_InstanceID`, which requires GLSL 4.60.
+
+PRE: `bva` must be refer to the `storage.vertex_array()`.
+*/
+template<typename VertexT>
+void multidraw_indirect_instanced_from_storage(
+    const MeshStorage<VertexT>&         storage,
+    BindToken<Binding::VertexArray>     bva,
+    BindToken<Binding::Program>         bsp,
+    BindToken<Binding::DrawFramebuffer> bfb,
+    std::ranges::input_range auto&&     instanced_draws,
+    UploadBuffer<MDICommand>&           mdi_buffer)
+{
+    assert(storage.vertex_array().id() == bva.id());
+    const auto get_cmd = [&](const InstancedDraw<VertexT>& draw)
+        -> MDICommand
+    {
+        MDICommand cmd = storage.query_one_indirect(draw.mesh_id);
+        cmd.instance_count = draw.num_instances;
+        cmd.base_instance  = draw.base_instance;
+        return cmd;
+    };
+    mdi_buffer.restage(instanced_draws | transform(get_cmd));
+    if (mdi_buffer.num_staged() == 0) return;
+    const BindGuard bmdi = mdi_buffer.bind_to_indirect_draw();
+    glapi::multidraw_elements_indirect(
+        bva, bsp, bfb, bmdi,
+        storage.primitive_type(),
+        storage.element_type(),
+        i32(mdi_buffer.num_staged()),
+        0, // Byte Offset
+        0  // Byte Stride
+    );
+}
+
 /*
 PRE: `bva` must be refer to the `storage.vertex_array()`.
 */
@@ -0,0 +1,51 @@
+#pragma once
+#include "ECS.hpp"
+#include "EnumUtils.hpp"
+#include "Scalars.hpp"
+#include "Transform.hpp"
+#include "components/AlphaTested.hpp"
+#include "components/Stationary.hpp"
+#include "components/StaticMesh.hpp"
+#include <boost/container_hash/hash.hpp>
+
+
+namespace josh {
+
+
+// Whether any entity is tagged Stationary at all. The caching stages
+// skip their cache entirely otherwise, there is nothing to cache.
+inline auto has_stationary_casters(const Registry& registry) noexcept
+    -> bool
+{
+    const auto stationary = registry.view<Stationary>();
+    return stationary.begin() != stationary.end();
+}
+
+
+/*
+Fingerprint of the set of Stationary shadow casters and their state.
+
+The shadow mapping stages compare this between frames to tell if their
+static caches are still valid. It changes whenever a stationary mesh is
+added, removed, moved, or switches its LOD or alpha-testing.
+
+This is a pass over the stationary meshes, hashing a matrix per entity,
+which is still much cheaper than drawing them into a shadow map.
+*/
+inline auto stationary_casters_fingerprint(const Registry& registry) noexcept
+    -> usize
+{
+    usize seed = 0;
+    for (const auto [entity, mesh, mtf] : registry.view<Stationary, StaticMesh, MTransform>().each())
+    {
+        boost::hash_combine(seed, to_underlying(entity));
+        boost::hash_combine(seed, mesh.lods.cur().value);
+        boost::hash_combine(seed, registry.all_of<AlphaTested>(entity));
+        const float* model = &mtf.model()[0][0];
+        boost::hash_range(seed, model, model + 16);
+    }
+    return seed;
+}
+
+
+} // namespace josh
@@ -0,0 +1,314 @@
+#pragma once
+#include "Common.hpp"
+#include "CommonConcepts.hpp"
+#include "ContainerUtils.hpp"
+#include "GLAPIBinding.hpp"
+#include "GLAPICommonTypes.hpp"
+#include "GLAPILimits.hpp"
+#include "GLBuffers.hpp"
+#include "GLFenceSync.hpp"
+#include "GLMutability.hpp"
+#include "GLObjectHelpers.hpp"
+#include "GLObjects.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <numeric>
+#include <ranges>
+
+
+namespace josh {
+
+
+/*
+Persistently-mapped alternative to the UploadBuffer for the same usage pattern,
+but where the data is written directly into the GPU-visible memory instead of
+being staged in a Vector and then uploaded again.
+
+The buffer is split into `num_regions` regions, one per frame in flight.
+Each frame writes only into its own region, and the region is guarded by
+a fence once the frame is done with it, so that the CPU does not overwrite
+the data that the GPU might still be reading.
+
+Within a frame, the region is a linear allocator of "batches". A batch is
+what is currently staged and what will be bound. Clearing or restaging
+starts a new batch after the previous one, instead of overwriting it,
+so that the draws that were already submitted still see their data.
+
+    buf.advance(); // Once per frame, before any staging.
+    for (...)
+    {
+        buf.restage(data);
+        buf.bind_to_ssbo_index(0);
+        draw(...);
+    }
+
+The region grows to fit all batches of a frame, reallocating the whole buffer
+if needed. Reallocation is not permitted while other threads hold claims,
+hence the `reserve()` and `claim()` pair for concurrent writers:
+
+    buf.clear();
+    buf.reserve(num_total);                     // On the GL thread.
+    ... auto [range, elems] = buf.claim(count); // On any thread.
+    ... // Wait for the writers.
+    buf.bind_to_ssbo_index(0);                  // On the GL thread.
+
+The mapping is coherent, so there's no need to flush anything, but the writes
+from other threads must happen-before the GL calls that read the data.
+
+NOTE: The staged data cannot be viewed back, the mapping is write-only
+and is likely write-combined. Use the UploadBuffer if that is needed.
+
+NOTE: Binding as the indirect draw/dispatch buffer is not supported,
+since the commands of the batch do not start at the beginning of the buffer.
+*/
+template<trivially_copyable T>
+class StreamingBuffer
+{
+public:
+    static constexpr usize num_regions = 3;
+
+    StreamingBuffer() = default;
+
+    // Begin a new frame by rotating to the next region.
+    // Will wait for the GPU to finish reading that region if needed.
+    //
+    // All draws that use the staged data of the current
+    // frame must be submitted before this is called.
+    void advance();
+
+    // Start a new empty batch.
+    void clear();
+
+    // Get the number of elements in the current batch.
+    auto num_staged() const noexcept -> NumElems { return NumElems(head_ - batch_begin_); }
+
+    // Start a new batch and stage new data.
+    auto restage(std::ranges::range auto&& r) -> ElemRange;
+
+    // Stage new data by appending to the current batch.
+    auto stage(std::ranges::range auto&& r) -> ElemRange;
+
+    // Stage a single element by appending to the current batch.
+    auto stage_one(const T& value) -> ElemRange;
+
+    // Make room for at least `num_elements` more elements in the current batch.
+    // Must be called before handing out concurrent claims.
+    void reserve(NumElems num_elements);
+
+    struct Claim
+    {
+        ElemRange range; // Relative to the beginning of the batch.
+        Span<T>   elems; // Write-only.
+    };
+
+    // Append `count` uninitialized elements to the current batch and return them for writing.
+    // Can be called from any thread concurrently with other claims, but not with anything else.
+    //
+    // PRE: Enough space must have been reserved with `reserve()` beforehand.
+    [[nodiscard]] auto claim(NumElems count) -> Claim;
+
+    // Bind the current batch to the `index`.
+    auto bind_to_ssbo_index(u32 index)
+        -> BindToken<BindingI::ShaderStorageBuffer>;
+
+    // Bind the `range` of the current batch to the `index`.
+    auto bind_range_to_ssbo_index(const ElemRange& range, u32 index)
+        -> BindToken<BindingI::ShaderStorageBuffer>;
+
+private:
+    UniqueBuffer<T> buffer_;
+    Span<T>         mapped_;               // Whole buffer, all regions.
+    usize           region_capacity_ = 0;  // In elements.
+    usize           region_          = 0;  // Index of the current region.
+    usize           batch_begin_     = 0;  // In elements, relative to the region.
+    usize           head_            = 0;  // In elements, relative to the region. Atomic for claims.
+    usize           align_elems_     = 0;  // Batch offsets must be multiples of this for binding.
+
+    Array<Optional<UniqueFenceSync>, num_regions> fences_;
+
+    auto region_base() const noexcept -> usize { return region_ * region_capacity_; }
+    auto batch_base()  const noexcept -> usize { return region_base() + batch_begin_; }
+    auto align_up(usize num_elements) noexcept -> usize;
+    void ensure_room(usize num_elements);
+    void grow(usize min_region_capacity);
+};
+
+
+template<trivially_copyable T>
+void StreamingBuffer<T>::advance()
+{
+    if (region_capacity_)
+    {
+        fences_[region_] = create_fence();
+        region_ = (region_ + 1) % num_regions;
+
+        if (auto& fence = fences_[region_])
+        {
+            using namespace std::chrono_literals;
+            SyncWaitResult result;
+            do result = (*fence)->flush_and_wait_for(1s);
+            while (result == SyncWaitResult::TimeoutExpired);
+            fence.reset();
+        }
+    }
+
+    batch_begin_ = 0;
+    head_        = 0;
+}
+
+template<trivially_copyable T>
+auto StreamingBuffer<T>::align_up(usize num_elements) noexcept
+    -> usize
+{
+    if (not align_elems_)
+    {
+        // Smallest number of elements that spans a multiple of the binding alignment.
+        const usize align_bytes = glapi::get_limit(LimitI::ShaderStorageBufferOffsetAlignment);
+        align_elems_ = align_bytes / std::gcd(align_bytes, sizeof(T));
+    }
+    return (num_elements + align_elems_ - 1) / align_elems_ * align_elems_;
+}
+
+template<trivially_copyable T>
+void StreamingBuffer<T>::clear()
+{
+    // The new batch must not overlap the previous one, since
+    // that could still be used by the draws submitted this frame.
+    batch_begin_ = std::min(align_up(head_), region_capacity_);
+    head_        = batch_begin_;
+}
+
+template<trivially_copyable T>
+void StreamingBuffer<T>::ensure_room(usize num_elements)
+{
+    if (head_ + num_elements > region_capacity_)
+        grow(num_staged() + num_elements);
+}
+
+template<trivially_copyable T>
+void StreamingBuffer<T>::grow(usize min_region_capacity)
+{
+    const usize amortized    = region_capacity_ + region_capacity_ / 2;
+    const usize new_capacity = align_up(std::max({ amortized, min_region_capacity, usize(64) }));
+
+    UniqueBuffer<T> new_buffer;
+    new_buffer->allocate_storage(NumElems(new_capacity * num_regions), {
+        .mode        = StorageMode::StaticServer,
+        .mapping     = PermittedMapping::Write,
+        .persistence = PermittedPersistence::PersistentCoherent,
+    });
+
+    const Span<T> new_mapped = new_buffer->map_for_write({
+        .pending_ops = PendingOperations::DoNotSynchronize,
+        .persistence = Persistence::PersistentCoherent,
+    });
+
+    // Carry over only the current batch. The previous batches of this frame
+    // are already bound by the submitted draws and remain in the old buffer.
+    // Its deletion is deferred by GL until the GPU is done with it.
+    const usize num_carried = num_staged();
+    const usize new_base    = region_ * new_capacity;
+    if (num_carried)
+        std::memcpy(new_mapped.data() + new_base, mapped_.data() + batch_base(), num_carried * sizeof(T));
+
+    buffer_          = MOVE(new_buffer);
+    mapped_          = new_mapped;
+    region_capacity_ = new_capacity;
+    batch_begin_     = 0;
+    head_            = num_carried;
+
+    // Other regions of the new buffer were never used by the GPU.
+    for (auto& fence : fences_)
+        fence.reset();
+}
+
+template<trivially_copyable T>
+auto StreamingBuffer<T>::restage(std::ranges::range auto&& r)
+    -> ElemRange
+{
+    clear();
+    return stage(FORWARD(r));
+}
+
+template<trivially_copyable T>
+auto StreamingBuffer<T>::stage(std::ranges::range auto&& r)
+    -> ElemRange
+{
+    const auto old_end = OffsetElems(num_staged());
+
+    if constexpr (std::ranges::sized_range<decltype(r)>)
+    {
+        const usize count = std::ranges::size(r);
+        ensure_room(count);
+        std::ranges::copy(r, mapped_.data() + region_base() + head_);
+        head_ += count;
+    }
+    else
+    {
+        for (const T& value : r)
+            discard(stage_one(value));
+    }
+
+    return { old_end, NumElems(num_staged() - old_end.value) };
+}
+
+template<trivially_copyable T>
+auto StreamingBuffer<T>::stage_one(const T& value)
+    -> ElemRange
+{
+    const auto old_end = OffsetElems(num_staged());
+    ensure_room(1);
+    mapped_[region_base() + head_] = value;
+    ++head_;
+    return { old_end, 1 };
+}
+
+template<trivially_copyable T>
+void StreamingBuffer<T>::reserve(NumElems num_elements)
+{
+    ensure_room(usize(num_elements.value));
+}
+
+template<trivially_copyable T>
+auto StreamingBuffer<T>::claim(NumElems count)
+    -> Claim
+{
+    const usize num    = usize(count.value);
+    const usize offset = std::atomic_ref(head_).fetch_add(num, std::memory_order_relaxed);
+    assert(offset + num <= region_capacity_ && "Not enough space reserved for the claim.");
+    return {
+        .range = { OffsetElems(offset - batch_begin_), count },
+        .elems = mapped_.subspan(region_base() + offset, num),
+    };
+}
+
+template<trivially_copyable T>
+auto StreamingBuffer<T>::bind_to_ssbo_index(u32 index)
+    -> BindToken<BindingI::ShaderStorageBuffer>
+{
+    return bind_range_to_ssbo_index({ OffsetElems{ 0 }, num_staged() }, index);
+}
+
+template<trivially_copyable T>
+auto StreamingBuffer<T>::bind_range_to_ssbo_index(const ElemRange& range, u32 index)
+    -> BindToken<BindingI::ShaderStorageBuffer>
+{
+    assert(range.offset + range.count <= num_staged());
+
+    if (range.count)
+    {
+        const auto offset = OffsetElems(batch_base() + usize(range.offset.value));
+        return buffer_->template bind_range_to_index<BufferTargetI::ShaderStorage>(offset, range.count, index);
+    }
+    else
+    {
+        // TODO: Same scuffed unbinding as in the UploadBuffer.
+        return RawBuffer<T, GLMutable>::from_id(0).template bind_to_index<BufferTargetI::ShaderStorage>(index);
+    }
+}
+
+
+} // namespace josh
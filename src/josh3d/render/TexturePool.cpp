@@ -0,0 +1,173 @@
+#include "TexturePool.hpp"
+#include "GLObjectHelpers.hpp"
+#include "GLTextures.hpp"
+#include "Ranges.hpp"
+#include <algorithm>
+#include <cassert>
+
+
+namespace josh {
+namespace {
+
+
+// Returns 0 for the formats that are not supported by the pool.
+auto bytes_per_texel(InternalFormat iformat) noexcept
+    -> usize
+{
+    switch (iformat)
+    {
+        using enum InternalFormat;
+        case R8:                   return 1;
+        case RG8:                  return 2;
+        case RGB8:  case SRGB8:    return 4; // Padded by most drivers.
+        case RGBA8: case SRGBA8:   return 4;
+        default:                   return 0;
+    }
+}
+
+auto estimate_layer_bytes(const Extent2I& resolution, GLsizei num_levels, usize bpt) noexcept
+    -> usize
+{
+    usize total = 0;
+    for (const GLsizei level : irange(num_levels))
+    {
+        const usize w = std::max(resolution.width  >> level, 1);
+        const usize h = std::max(resolution.height >> level, 1);
+        total += w * h * bpt;
+    }
+    return total;
+}
+
+
+} // namespace
+
+
+TexturePool::TexturePool(const Params& params)
+    : _params(params)
+{
+    assert(_params.min_page_layers >= 1);
+    assert(_params.max_page_layers >= _params.min_page_layers);
+    _pages.reserve(max_pages);
+}
+
+TexturePool::Lease::~Lease() noexcept
+{
+    _pool._release(_location);
+}
+
+auto TexturePool::try_allocate(
+    const Extent2I& resolution,
+    InternalFormat  iformat,
+    NumLevels       num_levels)
+        -> Optional<Allocation>
+{
+    if (not is_enabled()) return nullopt;
+
+    const usize bpt = bytes_per_texel(iformat);
+    if (not bpt) return nullopt;
+
+    const usize layer_bytes    = estimate_layer_bytes(resolution, GLsizei(num_levels), bpt);
+    const usize layers_by_size = _params.max_page_bytes / layer_bytes;
+    if (layers_by_size < 2) return nullopt;
+
+    const auto is_same_kind = [&](const Page& page)
+    {
+        return
+            page.resolution == resolution and
+            page.iformat    == iformat    and
+            page.num_levels == GLsizei(num_levels);
+    };
+
+    const auto lock = std::scoped_lock(_mutex);
+
+    u32 page_id  = 0;
+    u32 layer_id = 0;
+
+    const auto it = std::ranges::find_if(_pages, [&](const Page& page)
+    {
+        return is_same_kind(page) and not page.free_layers.empty();
+    });
+
+    if (it != _pages.end())
+    {
+        page_id  = u32(it - _pages.begin());
+        layer_id = it->free_layers.back();
+        it->free_layers.pop_back();
+    }
+    else
+    {
+        if (_pages.size() == max_pages)
+            return nullopt;
+
+        // Each new page of the same kind is twice as large as the last one.
+        const usize num_same_kind = usize(std::ranges::count_if(_pages, is_same_kind));
+        const usize num_layers    = std::min({
+            usize(_params.min_page_layers) << std::min(num_same_kind, usize(16)),
+            usize(_params.max_page_layers),
+            layers_by_size,
+        });
+
+        auto texture = allocate_texture<TextureTarget::Texture2DArray>(
+            resolution, GLsizei(num_layers), iformat, num_levels);
+        texture->set_sampler_min_mag_filters(MinFilter::LinearMipmapLinear, MagFilter::Linear);
+
+        // Layers are handed out from the back, so reverse the order to start from 0.
+        Vector<u32> free_layers;
+        free_layers.reserve(num_layers);
+        for (const u32 layer : irange(u32(num_layers)) | reverse)
+            free_layers.push_back(layer);
+
+        page_id  = u32(_pages.size());
+        layer_id = free_layers.back();
+        free_layers.pop_back();
+
+        _pages.push_back({
+            .resolution  = resolution,
+            .iformat     = iformat,
+            .num_levels  = GLsizei(num_levels),
+            .num_layers  = u32(num_layers),
+            .layer_bytes = layer_bytes,
+            .free_layers = MOVE(free_layers),
+            .texture     = MOVE(texture),
+        });
+
+        _num_pages.store(u32(_pages.size()), std::memory_order_release);
+    }
+
+    const PoolLocation location = { .page = page_id, .layer = layer_id };
+
+    return Allocation{
+        .view  = create_texture_view(_pages[page_id].texture.get(), layer_id, iformat, MipLevel{ 0 }, num_levels),
+        .lease = SharedLease(new Lease(*this, location, MipLevel{ 0 })),
+    };
+}
+
+auto TexturePool::page_texture(u32 page) const noexcept
+    -> RawTexture2DArray<GLConst>
+{
+    assert(page < num_pages());
+    return _pages[page].texture.get();
+}
+
+void TexturePool::_release(PoolLocation location) noexcept
+{
+    const auto lock = std::scoped_lock(_mutex);
+    _pages[location.page].free_layers.push_back(location.layer);
+}
+
+auto TexturePool::stats() const
+    -> Stats
+{
+    const auto lock = std::scoped_lock(_mutex);
+    Stats stats{ .num_pages = _pages.size() };
+    for (const Page& page : _pages)
+    {
+        stats.num_layers      += page.num_layers;
+        stats.num_leased      += page.num_layers - page.free_layers.size();
+        stats.allocated_bytes += page.num_layers * page.layer_bytes;
+    }
+    return stats;
+}
+
+
+} // namespace josh
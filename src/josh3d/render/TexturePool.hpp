@@ -0,0 +1,165 @@
+#pragma once
+#include "Common.hpp"
+#include "GLAPICommonTypes.hpp"
+#include "GLObjects.hpp"
+#include "GLTextures.hpp"
+#include "Region.hpp"
+#include "Scalars.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+
+namespace josh {
+
+
+/*
+Location of a texture in the TexturePool.
+*/
+struct PoolLocation
+{
+    u32 page;
+    u32 layer;
+};
+
+
+/*
+Storage for the material textures packed into the layers of a few large
+2D array textures, called pages. Each page holds textures of the same
+resolution, format and number of levels.
+
+Drawing with textures from the pool only requires binding the pages,
+not every texture individually, so a single multidraw can cover any number
+of materials, as long as the number of pages fits the texture units.
+
+Each texture is allocated as a layer of a page, and is exposed as a regular
+2D texture through a texture view, so the code that does not know about
+the pool can keep using it as before. The layer is owned by a Lease, and is
+returned to the pool when the last Lease is gone, which normally happens
+together with the TextureResource that holds it.
+
+Pages are never reallocated or released, the pool only grows up to `max_pages`.
+The pages of the same kind grow geometrically, starting from `min_page_layers`.
+
+Only the uncompressed 8-bit formats of the material textures are supported.
+Everything else is rejected and must be allocated outside of the pool.
+
+The pool is disabled by default, and rejects every allocation, since the pages
+reserve the layers up-front and that is only worth it if something draws from
+them. The renderer enables it when it does. The textures allocated before that
+stay outside of the pool.
+
+NOTE: The pool must outlive all of its Leases.
+*/
+class TexturePool
+{
+public:
+    // Limited by the minimum number of texture units guaranteed by GL.
+    static constexpr u32 max_pages = 16;
+
+    struct Params
+    {
+        u32   min_page_layers = 8;         // Layers in the first page of each kind.
+        u32   max_page_layers = 256;       // Pages of the same kind do not grow beyond this.
+        usize max_page_bytes  = 256 << 20; // Textures that do not fit at least 2 layers are rejected.
+    };
+
+    explicit TexturePool(const Params& params = {});
+
+    // Enable or disable new allocations from the pool. Existing Leases are not affected.
+    // Thread-safe.
+    void set_enabled(bool enabled) noexcept { _enabled.store(enabled, std::memory_order_relaxed); }
+    auto is_enabled() const noexcept -> bool { return _enabled.load(std::memory_order_relaxed); }
+
+    /*
+    Ownership of a single layer in one of the pages.
+    */
+    class Lease
+    {
+    public:
+        auto location() const noexcept -> PoolLocation { return _location; }
+
+        // Lowest mip level that has valid contents. Levels below it must not be sampled.
+        // Loaders that stream the mips in are expected to update this after fencing.
+        auto base_level() const noexcept -> MipLevel { return MipLevel{ _base_level.load(std::memory_order_acquire) }; }
+        void set_base_level(MipLevel level) noexcept { _base_level.store(GLint(level), std::memory_order_release); }
+
+        Lease(const Lease&)            = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() noexcept;
+
+    private:
+        friend TexturePool;
+        Lease(TexturePool& pool, PoolLocation location, MipLevel base_level)
+            : _pool(pool), _location(location), _base_level(GLint(base_level))
+        {}
+
+        TexturePool&       _pool;
+        PoolLocation       _location;
+        std::atomic<GLint> _base_level;
+    };
+
+    using SharedLease = std::shared_ptr<Lease>;
+
+    struct Allocation
+    {
+        UniqueTexture2D view;  // Of the layer, covering all levels.
+        SharedLease     lease; // Base level is 0.
+    };
+
+    // Allocate a layer for a texture with the specified storage.
+    // Returns nullopt if the pool is disabled, the storage is not supported
+    // or all pages are taken.
+    //
+    // The contents of the layer are undefined. The caller is expected to upload
+    // to the returned view and fence before sharing it with other contexts.
+    //
+    // Thread-safe. Must be called with a GPU context current.
+    [[nodiscard]]
+    auto try_allocate(
+        const Extent2I& resolution,
+        InternalFormat  iformat,
+        NumLevels       num_levels)
+            -> Optional<Allocation>;
+
+    // Number of pages allocated so far. Only grows.
+    auto num_pages() const noexcept -> u32 { return _num_pages.load(std::memory_order_acquire); }
+
+    // PRE: `page < num_pages()`.
+    auto page_texture(u32 page) const noexcept -> RawTexture2DArray<GLConst>;
+
+    struct Stats
+    {
+        usize num_pages       = 0;
+        usize num_layers      = 0; // Across all pages.
+        usize num_leased      = 0;
+        usize allocated_bytes = 0; // Estimated.
+    };
+
+    auto stats() const -> Stats;
+
+private:
+    struct Page
+    {
+        Extent2I             resolution;
+        InternalFormat       iformat;
+        GLsizei              num_levels;
+        u32                  num_layers;
+        usize                layer_bytes;
+        Vector<u32>          free_layers;
+        UniqueTexture2DArray texture;
+    };
+
+    Params             _params;
+    mutable std::mutex _mutex;         // Guards page creation and the free lists.
+    Vector<Page>       _pages;         // Reserved to `max_pages` and never reallocated.
+    std::atomic<u32>   _num_pages = 0; // Published after each page is created.
+    std::atomic<bool>  _enabled   = false;
+
+    void _release(PoolLocation location) noexcept;
+};
+
+using SharedTextureLease = TexturePool::SharedLease;
+
+
+} // namespace josh
@@ -0,0 +1,20 @@
+#pragma once
+#include "Scalars.hpp"
+
+
+namespace josh {
+
+
+/*
+LOD picked by the LODSelection stage from the projected screen size,
+before it is limited to the LODs that are actually loaded.
+
+Kept between frames, since the next pick depends on it for hysteresis.
+*/
+struct DesiredLOD
+{
+    u8 lod = 0;
+};
+
+
+} // namespace josh
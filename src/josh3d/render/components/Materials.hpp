@@ -2,6 +2,7 @@
 #include "GLObjects.hpp"
 #include "Resource.hpp"
 #include "Scalars.hpp"
+#include "TexturePool.hpp"
 
 
 namespace josh {
@@ -29,6 +30,12 @@ struct MaterialPhong
     ResourceUsage        normal_usage   = {};
     ResourceUsage        specular_usage = {};
 
+    // Layers of the textures in the TexturePool. Null for the textures
+    // that are not pooled, including the global defaults.
+    SharedTextureLease   diffuse_lease  = {};
+    SharedTextureLease   normal_lease   = {};
+    SharedTextureLease   specular_lease = {};
+
     // TODO: No idea how, but this is better be "moved outside" somehow.
     uintptr              aba_tag = {};
 };
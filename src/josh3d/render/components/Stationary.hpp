@@ -0,0 +1,17 @@
+#pragma once
+
+
+namespace josh {
+
+
+/*
+Per-mesh tag component that promises that the mesh rarely moves or changes.
+
+Shadow mapping stages cache the depth of stationary casters per light,
+and only draw the rest every frame. Moving a stationary mesh is still
+allowed, but invalidates the caches of all the lights.
+*/
+struct Stationary {};
+
+
+} // namespace josh
@@ -0,0 +1,187 @@
+#include "ProgramBinaryCache.hpp"
+#include "Common.hpp"
+#include "EnumUtils.hpp"
+#include "GLAPICore.hpp"
+#include "Logging.hpp"
+#include "Scalars.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+
+namespace josh {
+namespace {
+
+// Bump if the layout of the file or the key contents change.
+constexpr u64 format_version = 1;
+
+// "J3DPRGB" and the version.
+constexpr u64 file_magic = 0x4A33'4450'5247'4200 | format_version;
+
+struct FileHeader
+{
+    u64 magic;
+    u64 check;
+    u32 format; // Implementation-specific, as returned by `glGetProgramBinary`.
+    u32 length; // Of the binary that follows the header.
+};
+
+/*
+FNV-1a, but the two streams start from different offsets, which makes them
+different enough for the `check` to catch an accidental collision of the `hash`.
+
+Not cryptographic. The cache directory is assumed to not be tampered with.
+*/
+struct KeyHasher
+{
+    u64 hash  = 0xCBF2'9CE4'8422'2325;
+    u64 check = 0x6C62'272E'07BB'0142;
+
+    void update(const void* data, usize size) noexcept
+    {
+        constexpr u64 prime = 0x0000'0100'0000'01B3;
+        const auto* bytes = static_cast<const ubyte*>(data);
+        for (const ubyte byte : Span(bytes, size))
+        {
+            hash  = (hash  ^ byte) * prime;
+            check = (check ^ byte) * prime;
+        }
+    }
+
+    void update(StrView str) noexcept
+    {
+        // Length first, so that the concatenations of different strings differ.
+        const u64 length = str.size();
+        update(&length, sizeof(length));
+        update(str.data(), str.size());
+    }
+
+    void update(u64 value) noexcept { update(&value, sizeof(value)); }
+};
+
+} // namespace
+
+
+auto ProgramBinaryCache::is_supported()
+    -> bool
+{
+    return glapi::get_num_program_binary_formats() > 0;
+}
+
+ProgramBinaryCache::ProgramBinaryCache(Path directory)
+    : _directory{ MOVE(directory) }
+    , _driver{ fmt::format("{}\n{}\n{}",
+        glapi::get_vendor_string(), glapi::get_renderer_string(), glapi::get_version_string()) }
+{}
+
+auto ProgramBinaryCache::make_key(Span<const Stage> stages) const
+    -> ProgramBinaryKey
+{
+    SmallVector<Stage, 2> sorted{ stages.begin(), stages.end() };
+    std::ranges::sort(sorted, {}, [](const Stage& stage) { return to_underlying(stage.target); });
+
+    KeyHasher hasher;
+    hasher.update(format_version);
+    hasher.update(_driver);
+    for (const Stage& stage : sorted)
+    {
+        hasher.update(u64(to_underlying(stage.target)));
+        hasher.update(stage.source);
+    }
+    return { .hash = hasher.hash, .check = hasher.check };
+}
+
+auto ProgramBinaryCache::_path_of(const ProgramBinaryKey& key) const
+    -> Path
+{
+    return _directory / fmt::format("{:016x}.bin", key.hash);
+}
+
+auto ProgramBinaryCache::try_load(const ProgramBinaryKey& key) const
+    -> Optional<UniqueProgram>
+{
+    const Path path = _path_of(key);
+
+    Vector<ubyte> binary;
+    FileHeader    header;
+    bool          is_valid = false;
+    {
+        std::ifstream file{ path, std::ios::binary };
+        if (not file) return nullopt; // Plain miss.
+
+        if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) and
+            header.magic == file_magic and
+            header.check == key.check)
+        {
+            binary.resize(header.length);
+            is_valid = bool(file.read(reinterpret_cast<char*>(binary.data()), std::streamsize(binary.size())));
+        }
+    }
+
+    if (not is_valid)
+    {
+        erase(key);
+        return nullopt;
+    }
+
+    UniqueProgram program;
+    program->set_binary(static_cast<GLenum>(header.format), binary.data(), GLsizei(binary.size()));
+
+    // The driver is free to reject the binary for any reason, not only on updates.
+    if (not program->has_linked_successfully())
+    {
+        erase(key);
+        return nullopt;
+    }
+
+    return program;
+}
+
+void ProgramBinaryCache::store(const ProgramBinaryKey& key, RawProgram<GLConst> program) const
+{
+    const GLsizei length = program.get_binary_length();
+    if (length <= 0) return;
+
+    Vector<ubyte> binary(usize(length));
+    const GLenum format = program.get_binary(binary.data(), length);
+
+    const FileHeader header = {
+        .magic  = file_magic,
+        .check  = key.check,
+        .format = static_cast<u32>(format),
+        .length = u32(length),
+    };
+
+    // Write to a temporary first, so that a partially written
+    // file is never picked up by this or another instance.
+    const Path path     = _path_of(key);
+    Path       tmp_path = path;
+    tmp_path += ".tmp";
+
+    bool written = false;
+    {
+        std::ofstream file{ tmp_path, std::ios::binary | std::ios::trunc };
+        written =
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header)) and
+            file.write(reinterpret_cast<const char*>(binary.data()), std::streamsize(binary.size()));
+    }
+
+    std::error_code ec;
+    if (written) std::filesystem::rename(tmp_path, path, ec);
+
+    if (not written or ec)
+    {
+        logstream() << "[PROGRAM BINARY CACHE]: Failed to store " << path << ".\n";
+        std::filesystem::remove(tmp_path, ec);
+    }
+}
+
+void ProgramBinaryCache::erase(const ProgramBinaryKey& key) const
+{
+    std::error_code ec;
+    std::filesystem::remove(_path_of(key), ec);
+}
+
+
+} // namespace josh
@@ -0,0 +1,79 @@
+#pragma once
+#include "Common.hpp"
+#include "GLAPITargets.hpp"
+#include "GLMutability.hpp"
+#include "GLObjects.hpp"
+#include "Scalars.hpp"
+
+
+/*
+On-disk cache of the linked program binaries.
+
+Skips the compilation and linking of the programs that were already
+built by the same driver in a previous run. The entries are keyed by
+the fully preprocessed source of each stage, so the edits to any of the
+included files, or a different set of defines, simply miss the cache.
+*/
+namespace josh {
+
+
+/*
+Identifies a program binary in the cache.
+
+The `hash` names the file, the `check` is an independent hash of the same
+contents stored inside the file, so that a collision of one is detected.
+*/
+struct ProgramBinaryKey
+{
+    u64 hash;
+    u64 check;
+    auto operator==(const ProgramBinaryKey&) const noexcept -> bool = default;
+};
+
+
+class ProgramBinaryCache
+{
+public:
+    // Whether the current GL implementation supports any program binary formats.
+    // If not, the cache will never hit, and should not be created.
+    static auto is_supported() -> bool;
+
+    // The `directory` must exist, see `ShaderPool::enable_binary_cache()`.
+    // Queries the driver strings, so must be created with the GL context current.
+    explicit ProgramBinaryCache(Path directory);
+
+    struct Stage
+    {
+        ShaderTarget target;
+        StrView      source; // After resolving the includes and inserting the defines.
+    };
+
+    // Key for the program linked from the `stages`, in any order.
+    // Also depends on the vendor, renderer and driver version.
+    auto make_key(Span<const Stage> stages) const -> ProgramBinaryKey;
+
+    // Try to load a linked program from the cache.
+    // Returns nullopt on a miss, or if the entry was rejected by the driver,
+    // in which case the stale entry is erased.
+    auto try_load(const ProgramBinaryKey& key) const -> Optional<UniqueProgram>;
+
+    // Store the binary of a linked `program` under the `key`.
+    // Replaces the existing entry, if any. Failures are logged and otherwise ignored.
+    //
+    // PRE: The `program` was linked with `set_binary_retrievable_hint(true)`.
+    void store(const ProgramBinaryKey& key, RawProgram<GLConst> program) const;
+
+    // Erase the entry under `key`, if any.
+    void erase(const ProgramBinaryKey& key) const;
+
+    auto directory() const noexcept -> const Path& { return _directory; }
+
+private:
+    Path   _directory;
+    String _driver; // Vendor, renderer and version strings.
+
+    auto _path_of(const ProgramBinaryKey& key) const -> Path;
+};
+
+
+} // namespace josh
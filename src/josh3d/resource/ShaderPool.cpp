@@ -4,16 +4,22 @@
 #include "Components.hpp"
 #include "ContainerUtils.hpp"
 #include "Filesystem.hpp"
+#include "GLAPICore.hpp"
 #include "GLMutability.hpp"
 #include "GLObjects.hpp"
 #include "GLProgram.hpp"
+#include "KitchenSink.hpp"
 #include "ObjectLifecycle.hpp"
+#include "OffscreenContext.hpp"
+#include "ProgramBinaryCache.hpp"
 #include "ReadFile.hpp"
+#include "Ranges.hpp"
 #include "Scalars.hpp"
 #include "SceneGraph.hpp"
 #include "ShaderBuilder.hpp"
 #include "ShaderSource.hpp"
 #include "Logging.hpp"
+#include "async/Future.hpp"
 #include "detail/ShaderWatcher.hpp"
 #include <entt/entt.hpp>
 #include <cassert>
@@ -22,6 +28,7 @@
 #include <optional>
 #include <sstream>
 #include <utility>
+#include <variant>
 
 
 namespace josh {
@@ -50,6 +57,8 @@ ProgramID:
         for "amortized" lookup on repeated get() calls on a pool;
     - Optionally contains ProgramDefines to indicate program-wide
         macro definitions.
+    - Optionally contains ProgramBinaryKey if the binary cache
+        is enabled, so that the stale entry can be erased on reload.
 
 PrimaryID:
     - Have ShaderTarget to identify the stage. One file per-stage,
@@ -160,6 +169,69 @@ struct std::hash<josh::ProgramName>
 namespace josh {
 
 
+namespace {
+
+/*
+This is the intermediate state used for loading, but it also
+somewhat resembles the structure as it appears later in the registry.
+*/
+
+struct PrimaryDesc
+{
+    File                     file;
+    std::unordered_set<File> included;
+};
+
+struct ProgramDesc
+{
+    ProgramDefines                                defines;
+    std::unordered_map<ShaderTarget, PrimaryDesc> primaries;
+};
+
+struct PreprocessedShader
+{
+    ShaderTarget target;
+    Path         path;   // Of the primary file, for error reporting.
+    ShaderSource source; // With includes resolved and defines inserted.
+};
+
+/*
+Program with the compilation and linking issued, but not necessarily complete.
+*/
+struct CompilingProgram
+{
+    UniqueProgram        program;
+    Vector<UniqueShader> shaders; // Same order as the PreprocessedShader list it was started from.
+};
+
+/*
+An in-flight compilation of a Program.
+
+For the initial compilation there is no UniqueProgram on the entity yet.
+For reloads, the previous UniqueProgram stays in use until this completes.
+*/
+struct PendingProgram
+{
+    Vector<PreprocessedShader> shaders; // Kept for error reporting.
+    Optional<ProgramBinaryKey> key;     // To store the binary under once linked, if the cache is enabled.
+    Variant<
+        CompilingProgram,               // Compiled in the current context.
+        Future<UniqueProgram>           // Compiled in the offscreen context.
+    >                          compiling;
+};
+
+/*
+The initial compilation of a Program failed, and there is no previous
+program to fall back to. Rethrown on every access until a reload succeeds.
+*/
+struct FailedProgram
+{
+    std::exception_ptr exception;
+};
+
+} // namespace
+
+
 class ShaderPoolImpl
 {
 public:
@@ -172,12 +244,35 @@ public:
     bool supports_hot_reload() const noexcept;
     void hot_reload();
     void force_reload();
+    void update();
+
+    auto enable_binary_cache(Path directory) -> bool;
+    void disable_binary_cache() noexcept;
+    bool has_binary_cache() const noexcept;
+
+    void set_offscreen_context(OffscreenContext* offscreen_context) noexcept;
+    auto num_pending() const noexcept -> usize;
 
 private:
     ShaderWatcher                   watcher_; // I'm a watcher.
     Registry                        registry_;
     HashMap<ProgramName, ProgramID> program_map_;
-    void sweep_reload_marked();
+    Optional<ProgramBinaryCache>    binary_cache_;
+    OffscreenContext*               offscreen_context_ = nullptr;
+    bool                            parallel_compile_  = false;
+    void sweep_reload_marked(bool use_cached);
+
+    // Start the compilation of the `program`, or take it from the binary cache.
+    // Replaces the previous PendingProgram, if any.
+    void begin_load(Handle program, Vector<PreprocessedShader> shaders, bool use_cached);
+    // Whether the PendingProgram can be finished without blocking.
+    auto is_load_complete(CHandle program) const -> bool;
+    // Wait for the PendingProgram, and replace the UniqueProgram if succeeded.
+    void finish_load(Handle program);
+    // Install the new program object.
+    void complete_load(Handle program, UniqueProgram new_program, const Optional<ProgramBinaryKey>& key);
+    // Resolve the current program object, waiting for the initial compilation if needed.
+    auto resolve(ProgramID program) -> UniqueProgram&;
 };
 
 namespace {
@@ -202,43 +297,32 @@ ShaderPoolImpl::ShaderPoolImpl()
 {
     registry_.on_construct<WatchedFile>().connect<&start_watching>();
     registry_.on_destroy  <WatchedFile>().connect<&stop_watching> ();
+
+    // Let the driver compile and link in its own threads.
+    if (glapi::supports_parallel_shader_compile())
+    {
+        glapi::set_max_shader_compiler_threads(0xFFFFFFFF);
+        parallel_compile_ = true;
+    }
 }
 
 
 namespace {
 
-/*
-This is the intermediate state used for loading, but it also
-somewhat resembles the structure as it appears later in the registry.
-*/
-
-struct PrimaryDesc
-{
-    File                     file;
-    std::unordered_set<File> included;
-};
-
-struct ProgramDesc
-{
-    ProgramDefines                                defines;
-    std::unordered_map<ShaderTarget, PrimaryDesc> primaries;
-};
-
-
 /*
 Expects the program description with the list of primiaries,
 but without includes. Will set the includes of the primaries
 after this call.
 
-Returns a compiled program and the updated list of
-includes for the primaries.
+Returns the final sources of each stage, ready for compilation.
 
-Throws if the compilation/linking failed for any reason.
+Throws if any of the files could not be read.
 */
-[[nodiscard]] auto load_and_compile_program(ProgramDesc& inout_program)
-    -> UniqueProgram
+[[nodiscard]] auto preprocess_program(ProgramDesc& inout_program)
+    -> Vector<PreprocessedShader>
 {
-    UniqueProgram program_obj;
+    Vector<PreprocessedShader> shaders;
+    shaders.reserve(inout_program.primaries.size());
 
     for (auto& [target, primary] : inout_program.primaries)
     {
@@ -296,42 +380,237 @@ Throws if the compilation/linking failed for any reason.
             }
         }
 
-        // Okay, cool, now we get to actually compile the shader from primary source.
+        shaders.push_back({ .target = target, .path = file_path, .source = MOVE(source) });
+    }
 
+    return shaders;
+}
+
+/*
+Issues the compilation of each shader and the linking of the program.
+
+Does not block if the implementation supports parallel compilation,
+otherwise the driver might still defer some of the work until the status
+is queried in `finish_compile_program()`.
+
+If `retrievable`, the binary of the linked program can be stored in the cache.
+*/
+[[nodiscard]] auto begin_compile_program(Span<const PreprocessedShader> shaders, bool retrievable)
+    -> CompilingProgram
+{
+    CompilingProgram compiling;
+
+    if (retrievable)
+        compiling.program->set_binary_retrievable_hint(true);
+
+    compiling.shaders.reserve(shaders.size());
+    for (const auto& [target, file_path, source] : shaders)
+    {
         auto shader_obj = UniqueShader(target);
 
         shader_obj->set_source(source.text_view());
         shader_obj->compile();
 
+        // NOTE: Not querying the compile status here, that would block.
+        // If any of the shaders fail to compile, linking will fail too.
+        compiling.program->attach_shader(shader_obj);
+        compiling.shaders.push_back(MOVE(shader_obj));
+    }
+
+    compiling.program->link();
+
+    return compiling;
+}
+
+/*
+Blocks until the compilation and linking are complete.
+
+Throws if the compilation/linking failed for any reason.
+*/
+[[nodiscard]] auto finish_compile_program(CompilingProgram compiling, Span<const PreprocessedShader> shaders)
+    -> UniqueProgram
+{
+    assert(compiling.shaders.size() == shaders.size());
+
+    // Report the compilation errors first, they are more useful than the linking ones.
+    for (const uindex i : irange(shaders.size()))
+    {
+        const auto& shader_obj = compiling.shaders[i];
+        const auto& shader     = shaders[i];
         if (not shader_obj->has_compiled_successfully())
         {
             auto info_log = shader_obj->get_info_log();
             throw ShaderCompilationFailure(
-                fmt::format("{}\n{}\n{}", file_path.string(), info_log, source.text_view()),
-                { info_log, target });
+                fmt::format("{}\n{}\n{}", shader.path.string(), info_log, shader.source.text_view()),
+                { info_log, shader.target });
         }
-
-        program_obj->attach_shader(shader_obj);
-
-        // NOTE: `shader_obj` is discarded here. This is okay, it's only marked
-        // for deletion by the API, but will persist until the program is destroyed.
     }
 
-    program_obj->link();
-
-    if (not program_obj->has_linked_successfully())
+    if (not compiling.program->has_linked_successfully())
     {
         // TODO: This should display more info.
-        auto info_log = program_obj->get_info_log();
+        auto info_log = compiling.program->get_info_log();
         throw ProgramLinkingFailure(info_log, { info_log });
     }
 
-    return program_obj;
+    // NOTE: The shaders are discarded here. This is okay, they are only marked
+    // for deletion by the API, but will persist until the program is destroyed.
+    return MOVE(compiling.program);
 }
 
 } // namespace
 
 
+void ShaderPoolImpl::begin_load(Handle program, Vector<PreprocessedShader> shaders, bool use_cached)
+{
+    Optional<ProgramBinaryKey> key;
+
+    if (binary_cache_)
+    {
+        SmallVector<ProgramBinaryCache::Stage, 2> stages;
+        for (const PreprocessedShader& shader : shaders)
+            stages.push_back({ .target = shader.target, .source = shader.source.text_view() });
+
+        key = binary_cache_->make_key(stages);
+
+        if (use_cached)
+        {
+            if (Optional<UniqueProgram> cached = binary_cache_->try_load(*key))
+            {
+                program.remove<PendingProgram>(); // Supersedes any in-flight compilation.
+                complete_load(program, MOVE(*cached), key);
+                return;
+            }
+        }
+    }
+
+    const bool retrievable = key.has_value();
+
+    // With parallel compilation the current context is preferred, since
+    // the driver spreads the work over its own threads. The offscreen context
+    // only gets this off the frame, but compiles one program at a time.
+    if (offscreen_context_ and not parallel_compile_)
+    {
+        auto [future, promise] = make_future_promise_pair<UniqueProgram>();
+
+        auto task = [shaders, retrievable, promise=MOVE(promise)]() mutable
+        {
+            try
+            {
+                UniqueProgram program_obj =
+                    finish_compile_program(begin_compile_program(shaders, retrievable), shaders);
+
+                // The program object is shared with the main context, but
+                // the main context must not observe it before it is complete.
+                glapi::finish();
+
+                set_result(MOVE(promise), MOVE(program_obj));
+            }
+            catch (...)
+            {
+                set_exception(MOVE(promise), std::current_exception());
+            }
+        };
+
+        discard(offscreen_context_->emplace(MOVE(task)));
+
+        program.emplace_or_replace<PendingProgram>(MOVE(shaders), key, MOVE(future));
+    }
+    else
+    {
+        CompilingProgram compiling = begin_compile_program(shaders, retrievable);
+        program.emplace_or_replace<PendingProgram>(MOVE(shaders), key, MOVE(compiling));
+    }
+}
+
+auto ShaderPoolImpl::is_load_complete(CHandle program) const
+    -> bool
+{
+    const auto& pending = program.get<PendingProgram>();
+
+    if (const auto* future = std::get_if<Future<UniqueProgram>>(&pending.compiling))
+        return is_ready(*future);
+
+    // Without the parallel compilation, there's no way to tell if the
+    // driver has finished, so this might block when finishing.
+    const auto& compiling = std::get<CompilingProgram>(pending.compiling);
+    return not parallel_compile_ or compiling.program->has_completed_linking();
+}
+
+void ShaderPoolImpl::finish_load(Handle program)
+{
+    PendingProgram pending = MOVE(program.get<PendingProgram>());
+    program.remove<PendingProgram>();
+
+    try
+    {
+        UniqueProgram new_program = eval%[&]{
+            if (auto* future = std::get_if<Future<UniqueProgram>>(&pending.compiling))
+                return get_result(MOVE(*future));
+            return finish_compile_program(MOVE(std::get<CompilingProgram>(pending.compiling)), pending.shaders);
+        };
+
+        // NOTE: The cache could have been disabled in the meantime.
+        if (binary_cache_ and pending.key)
+            binary_cache_->store(*pending.key, new_program);
+
+        complete_load(program, MOVE(new_program), binary_cache_ ? pending.key : nullopt);
+    }
+    catch (const std::exception& e)
+    {
+        if (has_component<UniqueProgram>(program))
+        {
+            // Keep using the previous program, the next reload might fix it.
+            logstream() << "[SHADER RELOAD FAILED]: " << e.what() << '\n';
+        }
+        else
+        {
+            logstream() << "[SHADER COMPILATION FAILED]: " << e.what() << '\n';
+            program.emplace_or_replace<FailedProgram>(std::current_exception());
+        }
+    }
+}
+
+void ShaderPoolImpl::complete_load(Handle program, UniqueProgram new_program, const Optional<ProgramBinaryKey>& key)
+{
+    // The old cache entry is unreachable if any of the sources changed,
+    // erase it so that the stale binaries do not pile up on disk.
+    if (const auto* old_key = program.try_get<ProgramBinaryKey>())
+    {
+        if (binary_cache_ and key != *old_key)
+            binary_cache_->erase(*old_key);
+    }
+
+    if (key) program.emplace_or_replace<ProgramBinaryKey>(*key);
+    else     program.remove<ProgramBinaryKey>();
+
+    program.emplace_or_replace<UniqueProgram>(MOVE(new_program));
+    program.remove<FailedProgram>();
+}
+
+auto ShaderPoolImpl::resolve(ProgramID program_id)
+    -> UniqueProgram&
+{
+    const Handle program = { registry_, program_id };
+
+    // Most of the time the program is already there. Either it was
+    // compiled before, or a reload is in-flight and the previous
+    // program is used in the meantime.
+    if (auto* program_obj = program.try_get<UniqueProgram>())
+        return *program_obj;
+
+    // Otherwise, this is the first use, and we have nothing to
+    // fall back to. Wait for the initial compilation to finish.
+    if (has_component<PendingProgram>(program))
+        finish_load(program);
+
+    if (const auto* failed = program.try_get<FailedProgram>())
+        std::rethrow_exception(failed->exception);
+
+    return program.get<UniqueProgram>();
+}
+
+
 auto ShaderPoolImpl::get(const ProgramFiles& files)
     -> ShaderToken
 {
@@ -374,10 +653,13 @@ auto ShaderPoolImpl::get(const ProgramFiles& files, const ProgramDefines& define
     if (files.frag) { program_desc.primaries.emplace(ShaderTarget::Fragment,       PrimaryDesc{ .file = *files.frag, .included = {} }); }
     if (files.comp) { program_desc.primaries.emplace(ShaderTarget::Compute,        PrimaryDesc{ .file = *files.comp, .included = {} }); }
 
-    UniqueProgram new_program_obj = load_and_compile_program(program_desc);
+    // Only the preprocessing is done here, which can fail if any files are missing.
+    // The compilation is started asynchronously and is only waited on during
+    // the first use of the program, or in the `update()`, whichever comes first.
+    Vector<PreprocessedShader> shaders = preprocess_program(program_desc);
 
 
-    // If the load/compilation/linking succeded, unpack the description
+    // If the preprocessing succeded, unpack the description
     // into the registry, and install the watches.
 
     auto& registry = registry_;
@@ -385,7 +667,6 @@ auto ShaderPoolImpl::get(const ProgramFiles& files, const ProgramDefines& define
 
     new_program.emplace<ProgramName>(MOVE(program_name));
     new_program.emplace<ProgramDefines>(defines);
-    new_program.emplace<UniqueProgram>(MOVE(new_program_obj));
 
     for (const auto& [target, primary_desc] : program_desc.primaries)
     {
@@ -404,6 +685,8 @@ auto ShaderPoolImpl::get(const ProgramFiles& files, const ProgramDefines& define
         }
     }
 
+    begin_load(new_program, MOVE(shaders), true);
+
     // Cache the program entity for this combination of stages/defines.
     //
     // The associated entity never changes for the given program name,
@@ -421,7 +704,7 @@ auto ShaderPoolImpl::supports_hot_reload() const noexcept
     return ShaderWatcher::actually_works;
 }
 
-void ShaderPoolImpl::sweep_reload_marked()
+void ShaderPoolImpl::sweep_reload_marked(bool use_cached)
 {
     auto& registry = registry_;
 
@@ -450,12 +733,14 @@ void ShaderPoolImpl::sweep_reload_marked()
             });
         }
 
+        Vector<PreprocessedShader> shaders;
         try
         {
-            // Load/compile/link the new program. *This can easily fail*.
-            // If it succeeds, we replace the current program object and
-            // proceed to resetting the structure in the registry.
-            program_handle.get<UniqueProgram>() = load_and_compile_program(program_desc);
+            // Reload and preprocess the sources. This can fail if the includes are broken.
+            // If it succeeds, we start compiling the new program, and proceed to resetting
+            // the structure in the registry. The current program object stays in use
+            // until the new one has finished compiling.
+            shaders = preprocess_program(program_desc);
         }
         catch (const std::exception& e)
         {
@@ -464,18 +749,23 @@ void ShaderPoolImpl::sweep_reload_marked()
             continue;
         }
 
+        begin_load(program_handle, MOVE(shaders), use_cached);
+
         // We don't need to reset everything here.
         //
         // What stays:
         //  - ProgramName, ProgramDefines
         //  - List of Primary Files and their Targets
+        //  - UniqueProgram, until the PendingProgram completes
         //
         // What gets reset:
-        //  - UniqueProgram (already done above)
+        //  - PendingProgram (already done above)
         //  - All secondary (include) files are destroyed
         //  - All watches of secondaries are destroyed too
         //  - Secondaries and their watches are created anew
         //
+        // The includes are updated even if the compilation fails later,
+        // so that fixing any of them would trigger another reload.
 
         for (const Handle primary : view_child_handles(program_handle))
         {
@@ -516,37 +806,96 @@ void ShaderPoolImpl::hot_reload()
         Handle root = get_root_handle(handle);
 
         // Roots are always Programs.
-        assert(has_component<UniqueProgram>(root));
+        assert(has_component<ProgramName>(root));
 
         root.emplace_or_replace<MarkedForReload>();
     };
 
-    // Then sweep.
-    sweep_reload_marked();
+    // Then sweep. The modified programs will miss the binary cache anyway.
+    sweep_reload_marked(true);
 }
 
 void ShaderPoolImpl::force_reload()
 {
     // Just mark all roots for reload and then sweep.
-    for (const auto program : registry_.view<UniqueProgram>())
+    for (const auto program : registry_.view<ProgramName>())
     {
         const Handle handle = { registry_, program };
         handle.emplace_or_replace<MarkedForReload>();
     }
 
-    sweep_reload_marked();
+    // Bypass the binary cache, the point of a forced reload is to recompile.
+    sweep_reload_marked(false);
+}
+
+void ShaderPoolImpl::update()
+{
+    Vector<ProgramID> completed;
+
+    for (const ProgramID program : registry_.view<PendingProgram>())
+    {
+        if (is_load_complete({ registry_, program }))
+            completed.push_back(program);
+    }
+
+    for (const ProgramID program : completed)
+        finish_load({ registry_, program });
 }
 
-auto ShaderToken::get() const noexcept
+auto ShaderPoolImpl::enable_binary_cache(Path directory)
+    -> bool
+{
+    if (not ProgramBinaryCache::is_supported())
+        return false;
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) return false;
+
+    binary_cache_.emplace(MOVE(directory));
+    return true;
+}
+
+void ShaderPoolImpl::disable_binary_cache() noexcept
+{
+    binary_cache_.reset();
+    registry_.clear<ProgramBinaryKey>();
+}
+
+bool ShaderPoolImpl::has_binary_cache() const noexcept
+{
+    return binary_cache_.has_value();
+}
+
+void ShaderPoolImpl::set_offscreen_context(OffscreenContext* offscreen_context) noexcept
+{
+    // NOTE: The in-flight offscreen compilations hold on to their own
+    // futures, so they can still be finished after the context is detached.
+    offscreen_context_ = offscreen_context;
+}
+
+auto ShaderPoolImpl::num_pending() const noexcept
+    -> usize
+{
+    return registry_.view<PendingProgram>().size();
+}
+
+auto ShaderToken::get() const
     -> RawProgram<GLConst>
 {
-    return pool_->registry_.get<UniqueProgram>(id_);
+    return pool_->resolve(id_);
 }
 
-auto ShaderToken::get() noexcept
+auto ShaderToken::get()
     -> RawProgram<GLMutable>
 {
-    return pool_->registry_.get<UniqueProgram>(id_);
+    return pool_->resolve(id_);
+}
+
+auto ShaderToken::is_ready() const noexcept
+    -> bool
+{
+    return has_component<UniqueProgram>(CHandle{ pool_->registry_, id_ });
 }
 
 /*
@@ -589,6 +938,39 @@ void ShaderPool::force_reload()
     pimpl_->force_reload();
 }
 
+void ShaderPool::update()
+{
+    pimpl_->update();
+}
+
+auto ShaderPool::num_pending() const noexcept
+    -> usize
+{
+    return pimpl_->num_pending();
+}
+
+void ShaderPool::set_offscreen_context(OffscreenContext* offscreen_context) noexcept
+{
+    pimpl_->set_offscreen_context(offscreen_context);
+}
+
+auto ShaderPool::enable_binary_cache(Path directory)
+    -> bool
+{
+    return pimpl_->enable_binary_cache(MOVE(directory));
+}
+
+void ShaderPool::disable_binary_cache() noexcept
+{
+    pimpl_->disable_binary_cache();
+}
+
+auto ShaderPool::has_binary_cache() const noexcept
+    -> bool
+{
+    return pimpl_->has_binary_cache();
+}
+
 
 thread_local Optional<ShaderPool> thread_local_shader_pool_;
 
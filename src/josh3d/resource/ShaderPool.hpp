@@ -17,6 +17,7 @@ namespace josh {
 
 class ShaderPool;
 class ShaderPoolImpl;
+class OffscreenContext;
 
 
 /*
@@ -35,15 +36,24 @@ TODO: We should probably have a `shader_pool().get(token)`
 interface instead of the current `token.get()`.
 The latter is "more convenient" but it hides the "immediate"
 nature of tokens and deviates from how we treat other ID handles.
+
+The programs are compiled asynchronously, so the first `get()`
+might block until the initial compilation is done. After that, it never
+blocks, and returns the previous program while a reload is in-flight.
+Throws the compilation error if the initial compilation failed.
 */
 class ShaderToken
 {
 public:
-    auto get()       noexcept -> RawProgram<GLMutable>;
-    auto get() const noexcept -> RawProgram<GLConst>;
+    auto get()       -> RawProgram<GLMutable>;
+    auto get() const -> RawProgram<GLConst>;
+
+    operator RawProgram<GLMutable> ()       { return get(); }
+    operator RawProgram<GLConst>   () const { return get(); }
 
-    operator RawProgram<GLMutable> ()       noexcept { return get(); }
-    operator RawProgram<GLConst>   () const noexcept { return get(); }
+    // Whether `get()` would return without blocking.
+    // Use to fall back to another program until this one is compiled.
+    auto is_ready() const noexcept -> bool;
 
 private:
     using ProgramID = entt::entity;
@@ -142,6 +152,9 @@ class ShaderPool
 public:
     // Get or create a shader program associated with the specified
     // set of `program_files`, and return a `ShaderToken` connected to it.
+    //
+    // Only the sources are loaded here, the compilation is started
+    // asynchronously. Will throw if any of the files could not be read.
     [[nodiscard]] auto get(const ProgramFiles& program_files) -> ShaderToken;
 
     // Get or create a shader program associated with the specified
@@ -152,6 +165,7 @@ public:
     auto supports_hot_reload() const noexcept -> bool;
 
     // Lazily reload and recompile modified shaders and it's users only.
+    // The previous programs stay in use until the `update()` swaps in the new ones.
     // Will throw if hot reloading is not supported.
     void hot_reload();
 
@@ -161,6 +175,34 @@ public:
     // WARNING: Very slow, don't call every frame.
     void force_reload();
 
+    // Swap in the programs that have finished compiling. Does not block.
+    // Failures are logged, the previous programs are kept in that case.
+    //
+    // Call once per frame.
+    void update();
+
+    // Number of programs with the compilation in-flight.
+    auto num_pending() const noexcept -> usize;
+
+    // Compile the programs in the `offscreen_context` instead of the current one.
+    // Only used if the driver does not support parallel shader compilation,
+    // otherwise the driver already compiles in the background.
+    //
+    // Pass nullptr to detach before the `offscreen_context` is destroyed.
+    void set_offscreen_context(OffscreenContext* offscreen_context) noexcept;
+
+    // Enable the on-disk cache of the linked program binaries in `directory`.
+    // Subsequent loads of the programs with the same preprocessed sources, defines
+    // and driver will skip compilation. Hot reloading misses and replaces the entries
+    // of the modified programs. Forced reloading bypasses the cache and overwrites them.
+    //
+    // Creates the `directory` if it does not exist. Returns false and does nothing
+    // if the driver does not support program binaries, or the `directory` could not
+    // be created.
+    auto enable_binary_cache(Path directory) -> bool;
+    void disable_binary_cache() noexcept;
+    auto has_binary_cache() const noexcept -> bool;
+
     ShaderPool();
     ~ShaderPool();
 
@@ -3,6 +3,7 @@
 #include "EnumUtils.hpp"
 #include "Errors.hpp"
 #include "Scalars.hpp"
+#include <cassert>
 #include <cmath>
 #include <glm/gtc/packing.hpp>
 #include <limits>
@@ -288,6 +289,24 @@ struct ElementsMutableView
     constexpr operator ElementsView() const noexcept { return { bytes, element_count, stride, element }; }
 };
 
+/*
+View of `count` elements starting from the element at index `first`.
+Useful for splitting work on large views into chunks.
+
+PRE: `first + count <= view.element_count`.
+*/
+inline auto subview(const ElementsView& view, uindex first, usize count) noexcept
+    -> ElementsView
+{
+    assert(first + count <= view.element_count);
+    return {
+        .bytes         = static_cast<const ubyte*>(view.bytes) + first * view.stride,
+        .element_count = count,
+        .stride        = view.stride,
+        .element       = view.element,
+    };
+}
+
 #define _JOSH3D_EACH_ELEMENT_VEC1(type) JOSH3D_EACH_ELEMENT_X(type, vec1)
 #define _JOSH3D_EACH_ELEMENT_VEC2(type) JOSH3D_EACH_ELEMENT_X(type, vec2)
 #define _JOSH3D_EACH_ELEMENT_VEC3(type) JOSH3D_EACH_ELEMENT_X(type, vec3)
@@ -0,0 +1,79 @@
+#include "LODHints.hpp"
+#include <mutex>
+
+
+namespace josh {
+
+
+void LODHints::set_enabled(bool enabled)
+{
+    const std::scoped_lock lk{ mutex_ };
+    enabled_ = enabled;
+    if (not enabled_)
+    {
+        for (auto& [uuid, entry] : entries_)
+            _release_parked(entry, no_request);
+    }
+}
+
+auto LODHints::is_enabled() const
+    -> bool
+{
+    const std::scoped_lock lk{ mutex_ };
+    return enabled_;
+}
+
+void LODHints::request(const UUID& uuid, u8 lod)
+{
+    const std::scoped_lock lk{ mutex_ };
+    if (const auto it = entries_.find(uuid); it != entries_.end())
+    {
+        Entry& entry = it->second;
+        if (lod < entry.finest)
+        {
+            entry.finest = lod;
+            _release_parked(entry, lod);
+        }
+    }
+}
+
+auto LODHints::until_finer_than(const UUID& uuid, u8 lod)
+    -> Future<void>
+{
+    auto [future, promise] = make_future_promise_pair<void>();
+
+    const std::scoped_lock lk{ mutex_ };
+    Entry& entry = entries_[uuid];
+    if (not enabled_ or entry.finest < lod)
+        set_result(MOVE(promise));
+    else
+        entry.parked.push_back({ lod, MOVE(promise) });
+
+    return MOVE(future);
+}
+
+void LODHints::forget(const UUID& uuid)
+{
+    const std::scoped_lock lk{ mutex_ };
+    if (const auto it = entries_.find(uuid); it != entries_.end())
+    {
+        _release_parked(it->second, no_request);
+        entries_.erase(it);
+    }
+}
+
+void LODHints::_release_parked(Entry& entry, u8 requested_lod)
+{
+    std::erase_if(entry.parked, [&](Parked& parked)
+    {
+        if (requested_lod < parked.lod or requested_lod == no_request)
+        {
+            set_result(MOVE(parked.promise));
+            return true;
+        }
+        return false;
+    });
+}
+
+
+} // namespace josh
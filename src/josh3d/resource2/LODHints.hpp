@@ -0,0 +1,85 @@
+#pragma once
+#include "Common.hpp"
+#include "Scalars.hpp"
+#include "UUID.hpp"
+#include "async/Future.hpp"
+#include <mutex>
+
+
+namespace josh {
+
+
+/*
+Finest LODs of the resources that were requested by the renderer so far.
+
+This lets the loaders that stream the LODs incrementally, coarse to fine,
+only load as fine a LOD as is actually needed, and then park until
+something finer is requested, instead of always loading everything.
+
+Lower LOD index is finer, 0 is the finest.
+
+Only the resources that are still being streamed in are tracked. A loader
+starts tracking its resource by parking on it for the first time, and must
+`forget()` it once it is done, one way or another. The requests for the
+resources that are not tracked are dropped, the renderer repeats them
+every frame anyway.
+
+The hints are disabled by default, in which case nothing is parked and
+the resources are loaded fully. Whoever requests the LODs should enable
+the hints, and disable them again before draining the tasks on shutdown,
+as otherwise the parked loaders would never finish.
+
+Thread-safe.
+*/
+class LODHints
+{
+public:
+    // When disabled, all parked loaders are released
+    // and `until_finer_than()` is always ready.
+    void set_enabled(bool enabled);
+    auto is_enabled() const -> bool;
+
+    // Request the LODs down to `lod` for the resource. Releases the
+    // loader parked on a coarser LOD. The requests only ever get finer,
+    // since the loaded LODs are not evicted either way.
+    //
+    // Does nothing if the resource is not tracked.
+    void request(const UUID& uuid, u8 lod);
+
+    static constexpr u8 no_request = u8(-1);
+
+    // Get a future that becomes ready once a LOD finer than `lod`
+    // is requested for the resource, or the hints are disabled.
+    // Starts tracking the resource if not tracked yet.
+    //
+    // Called by the loaders after each loaded LOD.
+    [[nodiscard]] auto until_finer_than(const UUID& uuid, u8 lod) -> Future<void>;
+
+    // Stop tracking the resource and release its parked loader.
+    // Called by the loaders once they finish or fail.
+    void forget(const UUID& uuid);
+
+private:
+    struct Parked
+    {
+        u8            lod;
+        Promise<void> promise;
+    };
+
+    struct Entry
+    {
+        u8             finest = no_request;
+        Vector<Parked> parked;
+    };
+
+    mutable std::mutex   mutex_;
+    bool                 enabled_ = false;
+    HashMap<UUID, Entry> entries_;
+
+    // Release the loaders parked on a LOD coarser than the `requested_lod`.
+    // Releases all of them if the `requested_lod` is `no_request`.
+    static void _release_parked(Entry& entry, u8 requested_lod);
+};
+
+
+} // namespace josh
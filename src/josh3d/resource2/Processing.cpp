@@ -224,69 +224,101 @@ auto pack_attributes_static(
     const ElementsView& tangents)
         -> Vector<VertexStatic>
 {
-    const usize vertex_count = positions.element_count;
-    Vector<VertexStatic> verts; verts.reserve(vertex_count);
+    auto verts = Vector<VertexStatic>(positions.element_count);
+    pack_attributes_static_into(verts, positions, uvs, normals, tangents);
+    return verts;
+}
+
+auto pack_attributes_skinned(
+    const ElementsView& positions,
+    const ElementsView& uvs,
+    const ElementsView& normals,
+    const ElementsView& tangents,
+    const ElementsView& joint_ids,
+    const ElementsView& joint_ws)
+        -> Vector<VertexSkinned>
+{
+    auto verts = Vector<VertexSkinned>(positions.element_count);
+    pack_attributes_skinned_into(verts, positions, uvs, normals, tangents, joint_ids, joint_ws);
+    return verts;
+}
+
+auto pack_indices(const ElementsView& indices_view)
+    -> Vector<u32>
+{
+    auto indices = Vector<u32>(indices_view.element_count);
+    pack_indices_into(indices, indices_view);
+    return indices;
+}
+
+void pack_indices_into(
+    Span<u32>           dst,
+    const ElementsView& indices_view,
+    uindex              first)
+{
+    const ElementsMutableView dst_view = {
+        .bytes         = dst.data(),
+        .element_count = dst.size(),
+        .stride        = sizeof(u32),
+        .element       = element_u32vec1,
+    };
+
+    const ElementsView src_view = subview(indices_view, first, dst.size());
+
+    const usize written_count = copy_convert_elements(dst_view, src_view);
+
+    assert(dst.size() == written_count);
+}
+
+void pack_attributes_static_into(
+    Span<VertexStatic>  dst,
+    const ElementsView& positions,
+    const ElementsView& uvs,
+    const ElementsView& normals,
+    const ElementsView& tangents,
+    uindex              first)
+{
+    assert(first + dst.size() <= positions.element_count);
 
     // HMM: If we had all normalized conversions, *including*
     // normalized-to-normalized, we could do this with 4 calls
     // to copy_convert_elements(), which should hypothetically
     // be a little bit faster.
 
-    for (const uindex i : irange(vertex_count))
+    for (const uindex j : irange(dst.size()))
     {
+        const uindex i = first + j;
         const vec3 pos     = copy_convert_one_element<vec3>(positions, i);
         const vec2 uv      = copy_convert_one_element<vec2>(uvs,       i);
         const vec3 normal  = copy_convert_one_element<vec3>(normals,   i);
         const vec3 tangent = copy_convert_one_element<vec3>(tangents,  i);
-        verts.push_back(VertexStatic::pack(pos, uv, normal, tangent));
+        dst[j] = VertexStatic::pack(pos, uv, normal, tangent);
     }
-
-    return verts;
 }
 
-auto pack_attributes_skinned(
+void pack_attributes_skinned_into(
+    Span<VertexSkinned> dst,
     const ElementsView& positions,
     const ElementsView& uvs,
     const ElementsView& normals,
     const ElementsView& tangents,
     const ElementsView& joint_ids,
-    const ElementsView& joint_ws)
-        -> Vector<VertexSkinned>
+    const ElementsView& joint_ws,
+    uindex              first)
 {
-    const usize vertex_count = positions.element_count;
-    Vector<VertexSkinned> verts; verts.reserve(vertex_count);
+    assert(first + dst.size() <= positions.element_count);
 
-    for (const uindex i : irange(vertex_count))
+    for (const uindex j : irange(dst.size()))
     {
+        const uindex i = first + j;
         const vec3  pos     = copy_convert_one_element<vec3> (positions, i);
         const vec2  uv      = copy_convert_one_element<vec2> (uvs,       i);
         const vec3  normal  = copy_convert_one_element<vec3> (normals,   i);
         const vec3  tangent = copy_convert_one_element<vec3> (tangents,  i);
         const uvec4 joints  = copy_convert_one_element<uvec4>(joint_ids, i);
         const vec4  joint_w = copy_convert_one_element<vec4> (joint_ws,  i);
-        verts.push_back(VertexSkinned::pack(pos, uv, normal, tangent, joints, joint_w));
+        dst[j] = VertexSkinned::pack(pos, uv, normal, tangent, joints, joint_w);
     }
-
-    return verts;
-}
-
-auto pack_indices(const ElementsView& indices_view)
-    -> Vector<u32>
-{
-    auto indices = Vector<u32>(indices_view.element_count);
-
-    const ElementsMutableView dst = {
-        .bytes         = indices.data(),
-        .element_count = indices.size(),
-        .stride        = sizeof(u32),
-        .element       = element_u32vec1,
-    };
-
-    const usize written_count = copy_convert_elements(dst, indices_view);
-
-    assert(indices_view.element_count == written_count);
-
-    return indices;
 }
 
 auto compute_aabb(const ElementsView& positions)
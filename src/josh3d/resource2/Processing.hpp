@@ -7,6 +7,10 @@
 #include "Elements.hpp"
 #include "ExternalScene.hpp"
 #include "VertexFormats.hpp"
+#include "async/CoroCore.hpp"
+#include "async/Coroutines.hpp"
+#include <algorithm>
+#include <cassert>
 
 
 /*
@@ -130,6 +134,82 @@ auto pack_attributes_skinned(
     const ElementsView& joint_weights)
         -> Vector<VertexSkinned>;
 
+/*
+Chunked variants of the packing functions above. These pack elements
+`[first, first + dst.size())` of the source views into `dst`, so that
+packing of a single large mesh can be split across multiple threads.
+
+PRE: Views must be valid. Their element counts should match.
+PRE: `first + dst.size()` must not exceed the element count of the views.
+*/
+void pack_indices_into(
+    Span<u32>           dst,
+    const ElementsView& indices,
+    uindex              first = 0);
+
+void pack_attributes_static_into(
+    Span<VertexStatic>  dst,
+    const ElementsView& positions,
+    const ElementsView& uvs,
+    const ElementsView& normals,
+    const ElementsView& tangents,
+    uindex              first = 0);
+
+void pack_attributes_skinned_into(
+    Span<VertexSkinned> dst,
+    const ElementsView& positions,
+    const ElementsView& uvs,
+    const ElementsView& normals,
+    const ElementsView& tangents,
+    const ElementsView& joint_ids,
+    const ElementsView& joint_weights,
+    uindex              first = 0);
+
+namespace detail {
+template<executor E, typename F>
+auto run_chunk_on(E& executor, const F& fn, uindex first, usize size)
+    -> Job<>
+{
+    co_await reschedule_to(executor);
+    fn(first, size);
+}
+} // namespace detail
+
+/*
+Splits the index range `[0, count)` into chunks of at most `chunk_size`
+and calls `fn(first, size)` for each chunk on the `executor`, concurrently.
+
+If the range fits into a single chunk, `fn` is called inline on the current thread.
+Otherwise, the execution resumes on the thread that completed the last chunk.
+
+Will propagate the first exception thrown from `fn`, after all chunks are done.
+
+PRE: `chunk_size > 0`.
+*/
+template<executor E, typename F>
+[[nodiscard]]
+auto for_each_chunk_on(E& executor, usize count, usize chunk_size, F fn)
+    -> Job<>
+{
+    assert(chunk_size > 0);
+
+    if (count <= chunk_size)
+    {
+        fn(uindex(0), count);
+        co_return;
+    }
+
+    // NOTE: The `fn` stays in this frame and is referenced by each chunk.
+    Vector<Job<>> chunk_jobs; chunk_jobs.reserve((count + chunk_size - 1) / chunk_size);
+    for (uindex first = 0; first < count; first += chunk_size)
+    {
+        const usize size = std::min(chunk_size, count - first);
+        chunk_jobs.push_back(detail::run_chunk_on(executor, fn, first, size));
+    }
+
+    co_await until_all_succeed(chunk_jobs);
+}
+
 /*
 NOTE: This is more expensive than doing it directly on an array
 of values, since we have to do conversions.
@@ -8,9 +8,11 @@
 #include "Ranges.hpp"
 #include "Resource.hpp"
 #include "Errors.hpp"
+#include "ScopeExit.hpp"
 #include "async/ThreadsafeQueue.hpp"
 #include "UUID.hpp"
 #include <algorithm>
+#include <bit>
 #include <boost/interprocess/exceptions.hpp>
 #include <boost/interprocess/file_mapping.hpp>
 #include <boost/interprocess/mapped_region.hpp>
@@ -20,6 +22,7 @@
 #include <cstdio>
 #include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
@@ -33,6 +36,7 @@ namespace bip = boost::interprocess;
 ResourceDatabase::ResourceDatabase(const Path& database_root)
     : database_root_ { canonical(database_root) }
     , table_filepath_{ database_root_ / "resources.jdb" }
+    , contents_filepath_{ database_root_ / "contents.jdb" }
 {
     if (not is_directory(database_root_))
         throw_fmt("Specified database root \"{}\" is not an existing directory.", database_root_);
@@ -93,11 +97,73 @@ ResourceDatabase::ResourceDatabase(const Path& database_root)
                 if (not was_emplaced)
                     throw RuntimeError("TODO: Congrats, you got a duplicate UUID! No idea what to do with it yet.");
                 ++(path_uses_[path.view()]);
+
+                if (row.flags & Packed)
+                    _open_archive(path);
             }
         }
 
         mapped_file_.advise(MappedRegion::advice_random);
     }
+
+    _load_contents();
+}
+
+void ResourceDatabase::_load_contents()
+{
+    static_assert(sizeof(ContentRecord) == 40);
+
+    usize num_records = 0;
+    {
+        std::ifstream file{ contents_filepath_, std::ios::binary };
+        ContentRecord record;
+        while (file.read(reinterpret_cast<char*>(&record), sizeof(record)))
+        {
+            ++num_records;
+            const auto* entry = try_find(table_, record.uuid);
+            if (entry and _row_ptr(entry->second)->type == record.type)
+                contents_.insert_or_assign(record.hash, record.uuid); // Later records win.
+        }
+    }
+
+    // Compact if anything was dropped or replaced. Write to a temporary
+    // first, so that the index is never left partially written.
+    if (num_records != contents_.size())
+    {
+        Path tmp_path = contents_filepath_;
+        tmp_path += ".tmp";
+
+        bool written = true;
+        {
+            std::ofstream file{ tmp_path, std::ios::binary | std::ios::trunc };
+            for (const auto& [hash, uuid] : contents_)
+            {
+                const ContentRecord record = {
+                    .hash       = hash,
+                    .uuid       = uuid,
+                    .type       = _row_ptr(table_.at(uuid))->type,
+                    ._reserved0 = {},
+                };
+                written = written and file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+            }
+            written = written and file.flush();
+        }
+
+        std::error_code ec;
+        if (written) std::filesystem::rename(tmp_path, contents_filepath_, ec);
+
+        if (not written or ec)
+        {
+            // Not fatal, the stale records are dropped again on the next load.
+            logstream() << fmt::format("[WARNING]: Could not compact the content index \"{}\".\n", contents_filepath_);
+            std::filesystem::remove(tmp_path, ec);
+        }
+    }
+
+    const auto mode = std::ios::binary | std::ios::app; // ab
+
+    if (not contents_filebuf_.open(contents_filepath_, mode))
+        throw_fmt("Cannot open content index file \"{}\".", contents_filepath_);
 }
 
 auto ResourceDatabase::_num_rows() const noexcept
@@ -148,6 +214,34 @@ void ResourceDatabase::_bump_version() noexcept
     ++state_version_;
 }
 
+auto ResourceDatabase::_open_archive(const ResourcePath& path)
+    -> const SharedPtr<MappedRegion>&
+{
+    if (auto* kv = try_find(archives_, path.view()))
+        return kv->second;
+
+    const Path full_path = root() / path.view();
+    auto fmapping = FileMapping(full_path.c_str(), bip::read_write);
+    auto mregion  = MappedRegion(fmapping, bip::read_write);
+
+    if (mregion.get_size() < sizeof(PakHeader))
+        throw_fmt("Pak archive \"{}\" is too small to contain a header.", full_path);
+
+    const auto& header = *std::launder(reinterpret_cast<const PakHeader*>(mregion.get_address()));
+
+    if (header.magic != PakHeader::expected_magic)
+        throw_fmt("Pak archive \"{}\" has invalid magic.", full_path);
+
+    if (header.version != PakHeader::expected_version)
+        throw_fmt("Pak archive \"{}\" has unsupported version {}.", full_path, header.version);
+
+    // Resources are accessed in arbitrary order, readahead would only waste IO.
+    mregion.advise(MappedRegion::advice_random);
+
+    const auto it = archives_.emplace(String(path.view()), make_shared<MappedRegion>(MOVE(mregion))).first;
+    return it->second;
+}
+
 void ResourceDatabase::_new_entry(
     const UUID&         uuid,
     ResourceType        type,
@@ -220,13 +314,22 @@ auto ResourceDatabase::type_of(const UUID& uuid) const
 }
 
 auto ResourceDatabase::try_map_resource(const UUID& uuid)
-    -> MappedRegion
+    -> MappedView
 {
     const auto rlock = std::shared_lock(state_mutex_);
     if (const auto* kv = try_find(table_, uuid))
     {
         const row_id row_id = kv->second;
         const Row&   row    = *_row_ptr(row_id);
+
+        if (row.flags & Packed)
+        {
+            // All archives are opened on construction or repack, so this must exist.
+            const auto* archive = try_find(archives_, row.filepath.view());
+            assert(archive);
+            return MappedView{ archive->second, row.offset_bytes, row.size_bytes };
+        }
+
         Path filepath = database_root_ / row.filepath.view();
         auto fmapping = FileMapping(filepath.c_str(), bip::read_write);
         return MappedRegion{ fmapping, bip::read_write, ptrdiff_t(row.offset_bytes), row.size_bytes };
@@ -235,7 +338,7 @@ auto ResourceDatabase::try_map_resource(const UUID& uuid)
 }
 
 auto ResourceDatabase::map_resource(const UUID& uuid)
-    -> MappedRegion
+    -> MappedView
 {
     auto mregion = try_map_resource(uuid);
     if (!mregion.get_address())
@@ -243,6 +346,43 @@ auto ResourceDatabase::map_resource(const UUID& uuid)
     return mregion;
 }
 
+auto ResourceDatabase::find_by_content(ResourceType type, const ContentHash& hash) const
+    -> Optional<UUID>
+{
+    const auto rlock = std::shared_lock(state_mutex_);
+    if (const auto* kv = try_find(contents_, hash))
+    {
+        const UUID& uuid = kv->second;
+        if (const auto* entry = try_find(table_, uuid))
+        {
+            if (_row_ptr(entry->second)->type == type)
+                return uuid;
+        }
+    }
+    return nullopt;
+}
+
+void ResourceDatabase::record_content(const UUID& uuid, const ContentHash& hash)
+{
+    const auto wlock = std::unique_lock(state_mutex_);
+    const auto* entry = try_find(table_, uuid);
+    if (not entry) return;
+
+    const ContentRecord record = {
+        .hash       = hash,
+        .uuid       = uuid,
+        .type       = _row_ptr(entry->second)->type,
+        ._reserved0 = {},
+    };
+
+    contents_.insert_or_assign(hash, uuid);
+
+    // The in-memory index is still valid if this fails, only the next session would miss.
+    const auto num_written = contents_filebuf_.sputn(reinterpret_cast<const char*>(&record), sizeof(record));
+    if (num_written != sizeof(record) or contents_filebuf_.pubsync() != 0)
+        logstream() << fmt::format("[WARNING]: Could not append to the content index \"{}\".\n", contents_filepath_);
+}
+
 void ResourceDatabase::update()
 {
     while (Optional uuid = remove_queue_.try_lock_and_try_pop())
@@ -466,6 +606,198 @@ auto ResourceDatabase::generate_resource(
     };
 }
 
+namespace {
+
+[[nodiscard]]
+constexpr auto align_up(usize value, usize alignment) noexcept
+    -> usize
+{
+    assert(std::has_single_bit(alignment));
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+auto ResourceDatabase::repack(const RepackParams& params)
+    -> RepackStats
+{
+    assert(std::has_single_bit(params.alignment));
+
+    const auto wlock = std::unique_lock(state_mutex_);
+
+    RepackStats stats;
+
+    Vector<row_id> loose_rows;
+    for (const row_id row_id : table_ | std::views::values)
+        if (not (_row_ptr(row_id)->flags & Packed))
+            loose_rows.emplace_back(row_id);
+
+    // Grouping by type keeps similar resources close together in the
+    // archives, and sorting by path puts the resources imported together
+    // next to each other. Both are likely to be loaded together too.
+    std::ranges::sort(loose_rows, [&](row_id lhs, row_id rhs)
+    {
+        const Row& l = *_row_ptr(lhs);
+        const Row& r = *_row_ptr(rhs);
+        if (l.type != r.type) return l.type < r.type;
+        return l.filepath.view() < r.filepath.view();
+    });
+
+    const usize data_offset = align_up(sizeof(PakHeader), params.alignment);
+
+    Vector<PakEntry> directory;
+    Vector<Path>     unused_files;
+    usize            version = 0;
+    const usize      version_limit = 1000;
+
+    for (usize batch_begin = 0; batch_begin < loose_rows.size();)
+    {
+        // Lay out the archive. At least one resource per archive.
+        directory.clear();
+        usize batch_end = batch_begin;
+        usize cursor    = data_offset;
+        while (batch_end < loose_rows.size())
+        {
+            const Row&  row    = *_row_ptr(loose_rows[batch_end]);
+            const usize offset = align_up(cursor, params.alignment);
+
+            if (batch_end != batch_begin and offset + row.size_bytes > params.max_archive_size)
+                break;
+
+            directory.push_back({
+                .uuid         = row.uuid,
+                .type         = row.type,
+                ._reserved0   = {},
+                .offset_bytes = offset,
+                .size_bytes   = row.size_bytes,
+            });
+
+            cursor = offset + row.size_bytes;
+            ++batch_end;
+        }
+
+        const auto  batch            = Span<const row_id>(loose_rows).subspan(batch_begin, batch_end - batch_begin);
+        const usize directory_offset = align_up(cursor, alignof(PakEntry));
+        const usize archive_size     = directory_offset + directory.size() * sizeof(PakEntry);
+
+        // Create the archive file. Same "no overwriting" rules as in generate_resource().
+        ResourcePath pak_path;
+        Path         full_path;
+        while (true)
+        {
+            if (version >= version_limit)
+                throw_fmt("Too many pak archives in the database \"{}\".", root());
+
+            pak_path  = path_from_hint({ .directory = "paks", .name = "pak", .extension = "jpak" }, version++);
+            full_path = root() / pak_path.view();
+
+            if (path_uses_.contains(pak_path.view())) continue;
+
+            std::filesystem::create_directories(full_path.parent_path());
+            if (std::FILE* file = std::fopen(full_path.c_str(), "wbx"))
+            {
+                std::fclose(file);
+                break;
+            }
+        }
+
+        // Nothing refers to the archive until the rows are redirected below.
+        // If writing it fails midway, remove it instead of leaving an orphan.
+        MappedRegion mregion;
+        {
+            ON_SCOPE_FAIL([&]{
+                mregion = {};
+                std::error_code ec;
+                std::filesystem::remove(full_path, ec);
+            });
+
+            std::filesystem::resize_file(full_path, archive_size);
+
+            auto fmapping = FileMapping(full_path.c_str(), bip::read_write);
+            mregion       = MappedRegion(fmapping, bip::read_write);
+            auto dst      = (ubyte*)mregion.get_address();
+            mregion.advise(MappedRegion::advice_sequential);
+
+            // Copy the resource data.
+            for (const auto [row_id, entry] : zip(batch, directory))
+            {
+                const Row&  row      = *_row_ptr(row_id);
+                const Path  src_path = root() / row.filepath.view();
+                const auto  src_fmap = FileMapping(src_path.c_str(), bip::read_only);
+                auto        src      = MappedRegion(src_fmap, bip::read_only, ptrdiff(row.offset_bytes), row.size_bytes);
+                src.advise(MappedRegion::advice_sequential);
+                std::memcpy(dst + entry.offset_bytes, src.get_address(), entry.size_bytes);
+            }
+
+            // Write the directory and the header.
+            std::memcpy(dst + directory_offset, directory.data(), directory.size() * sizeof(PakEntry));
+
+            const PakHeader header = {
+                .magic            = PakHeader::expected_magic,
+                .version          = PakHeader::expected_version,
+                .alignment        = params.alignment,
+                .num_entries      = directory.size(),
+                .directory_offset = directory_offset,
+            };
+            std::memcpy(dst, &header, sizeof(PakHeader));
+
+            // The archive must be fully on disk before any row is redirected to it.
+            if (not mregion.flush(0, 0, false))
+                throw_fmt("Failed to flush pak archive \"{}\".", full_path);
+        }
+
+        mregion.advise(MappedRegion::advice_random);
+
+        // Redirect the rows to the archive.
+        for (const auto [row_id, entry] : zip(batch, directory))
+        {
+            Row& row = *_row_ptr(row_id);
+
+            const auto it = path_uses_.find(row.filepath.view());
+            assert(it != path_uses_.end());
+            if (--(it->second) == 0)
+            {
+                unused_files.emplace_back(root() / row.filepath.view());
+                path_uses_.erase(it);
+            }
+
+            row.flags        |= Packed;
+            row.filepath      = pak_path;
+            row.offset_bytes  = entry.offset_bytes;
+            row.size_bytes    = entry.size_bytes;
+            _flush_row(row_id);
+
+            ++(path_uses_[pak_path.view()]);
+
+            stats.num_bytes_packed += entry.size_bytes;
+        }
+
+        archives_.emplace(String(pak_path.view()), make_shared<MappedRegion>(MOVE(mregion)));
+
+        stats.num_resources_packed += batch.size();
+        stats.num_archives_created += 1;
+
+        // Loose files are removed only after the rows have been flushed.
+        // Existing mappings of them stay valid, at least on POSIX.
+        for (const Path& path : unused_files)
+        {
+            std::error_code ec;
+            if (std::filesystem::remove(path, ec))
+                ++stats.num_files_removed;
+            else
+                logstream() << fmt::format("[WARNING]: Could not remove packed file \"{}\". Reason: \"{}\".\n", path, ec.message());
+        }
+        unused_files.clear();
+
+        batch_begin = batch_end;
+    }
+
+    if (stats.num_resources_packed)
+        _bump_version();
+
+    return stats;
+}
+
 auto ResourceDatabase::_try_unlink_record(const UUID& uuid)
     -> UnlinkResult
 {
@@ -492,7 +824,13 @@ auto ResourceDatabase::_try_unlink_record(const UUID& uuid)
         result.remaining_path_uses = --(it->second); // Decrements.
 
         if (result.remaining_path_uses == 0)
+        {
+            // Outstanding views still keep the mapping alive, if any.
+            if (row->flags & Packed)
+                if (const auto ait = archives_.find(db_path); ait != archives_.end())
+                    archives_.erase(ait);
             path_uses_.erase(it);
+        }
     }
     empty_rows_.emplace(row_id);
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "Common.hpp"
+#include "ContentHash.hpp"
 #include "FileMapping.hpp"
 #include "Filesystem.hpp"
 #include "Resource.hpp"
@@ -44,6 +45,88 @@ struct ResourceLocation
     explicit operator bool() const noexcept { return file.length; }
 };
 
+/*
+Pak archives bundle many resources into a single large file.
+
+Each resource is placed at an offset aligned to `alignment`
+(page-sized by default), so that the views into a single long-lived
+mapping of the archive are just as good as individually mapped files.
+
+The archive is self-describing: a directory of all contained entries
+is stored after the resource data. The database table remains the
+authoritative source of locations, the directory is there for
+inspection and recovery.
+
+ImHex Pattern:
+
+struct PakHeader {
+    char magic[4];
+    u32  version;
+    u64  alignment;
+    u64  num_entries;
+    u64  directory_offset;
+};
+
+struct PakEntry {
+    u8  uuid[16];
+    u32 resource_type;
+    u32 _reserved0;
+    u64 offset_bytes;
+    u64 size_bytes;
+};
+
+PakHeader header @ 0x0;
+PakEntry  directory[header.num_entries] @ header.directory_offset;
+*/
+struct PakHeader
+{
+    static constexpr Array<char, 4> expected_magic   = { 'J', 'P', 'A', 'K' };
+    static constexpr u32            expected_version = 0;
+
+    Array<char, 4> magic;
+    u32            version;
+    u64            alignment;
+    u64            num_entries;
+    u64            directory_offset;
+};
+
+struct PakEntry
+{
+    UUID         uuid;
+    ResourceType type;
+    u32          _reserved0;
+    u64          offset_bytes;
+    u64          size_bytes;
+};
+
+/*
+A single record of the content index of the database,
+see `ResourceDatabase::record_content()`.
+
+The index is an append-only sidecar file next to the table.
+Records of the resources that no longer exist are dropped,
+and the file is compacted when the database is opened.
+
+ImHex Pattern:
+
+struct ContentRecord {
+    u64 hash_lo;
+    u64 hash_hi;
+    u8  uuid[16];
+    u32 resource_type;
+    u32 _reserved0;
+};
+
+ContentRecord records[sizeof($)/40] @ 0x0;
+*/
+struct ContentRecord
+{
+    ContentHash  hash;
+    UUID         uuid;
+    ResourceType type;
+    u32          _reserved0;
+};
+
 /*
 This class controls a central resource database that consists of:
 
@@ -52,6 +135,13 @@ This class controls a central resource database that consists of:
 
 for a given resource root.
 
+Resources can either be stored as "loose" files, one resource per
+file, or "packed" into larger pak archives (see PakHeader). Newly
+generated resources are always loose, the `repack()` consolidates
+them into archives. Each archive is mapped once and kept mapped
+for the lifetime of the database, the resources are handed out
+as views into that mapping.
+
 The table is a binary file with fixed-width rows describing
 a relationship between an asset's UUID and the location on
 the filesystem. The paths are always relative to the
@@ -95,6 +185,11 @@ public:
         u64          size_bytes;   // Size of the resource data in the file. HMM: Could be u32.
     };
 
+    enum RowFlags : u8
+    {
+        Packed = 1 << 0, // Resource is stored in a pak archive.
+    };
+
     // Must be periodically called from the main thread.
     void update();
 
@@ -117,15 +212,18 @@ public:
 
     // Opens a mapping to the resource with the specified uuid.
     // Will return an empty mapping if the specified resource does not exist.
+    //
+    // For packed resources no new mapping is created, instead the returned
+    // view shares the mapping of the whole archive.
     [[nodiscard]]
     auto try_map_resource(const UUID& uuid)
-        -> MappedRegion;
+        -> MappedView;
 
     // Opens a mapping to the resource with the specified uuid.
     // Will throw RuntimeError if the specified resource does not exist.
     [[nodiscard]]
     auto map_resource(const UUID& uuid)
-        -> MappedRegion;
+        -> MappedView;
 
     struct GeneratedResource
     {
@@ -180,6 +278,49 @@ public:
     auto try_remove_resource(const UUID& uuid)
         -> RemoveResourceOutcome;
 
+    struct RepackParams
+    {
+        usize max_archive_size = 1024 * 1024 * 1024; // Resources larger than this will get an archive of their own.
+        usize alignment        = 4096;               // Alignment of each resource in the archive. Must be a power of 2.
+    };
+
+    struct RepackStats
+    {
+        usize num_resources_packed = 0;
+        usize num_archives_created = 0;
+        usize num_files_removed    = 0;
+        usize num_bytes_packed     = 0;
+    };
+
+    // Consolidates all loose resources into pak archives.
+    // Already packed resources are left as-is.
+    //
+    // The table rows are redirected to the archives, and the loose
+    // files are removed once they are no longer referenced.
+    // Existing mappings of the loose files remain valid.
+    //
+    // Takes an exclusive lock for the whole duration. This can take a while.
+    auto repack(const RepackParams& params = {})
+        -> RepackStats;
+
+    // Find a resource of the specified type that was previously recorded
+    // with the same content hash. Returns nullopt if there is no such
+    // resource, or if it was removed since.
+    //
+    // Importers use this to reuse identical resources instead of creating
+    // duplicates. Two concurrent imports of the same content can still
+    // both miss and create a resource each. That is harmless, the last
+    // recorded one is found from then on.
+    auto find_by_content(ResourceType type, const ContentHash& hash) const
+        -> Optional<UUID>;
+
+    // Record that the resource was created from the content with the specified hash.
+    // The hash must cover everything that affects the resource, import parameters included.
+    //
+    // Replaces the previous record with the same hash, if any.
+    // Does nothing if no such UUID in the database.
+    void record_content(const UUID& uuid, const ContentHash& hash);
+
     // Schedule the resource for removal later, during the update().
     // This is safe to use from any thread, and is the recommended
     // way to dispose of resources that failed construction for any reason.
@@ -204,9 +345,12 @@ private:
     Path         database_root_;
     Path         table_filepath_;
 
-    std::filebuf table_filebuf_;  // Keep open to be able to resize the file.
-    FileMapping  file_mapping_;   // To quickly remap the file.
-    MappedRegion mapped_file_;    // Read/write to file through this.
+    Path         contents_filepath_;
+
+    std::filebuf table_filebuf_;    // Keep open to be able to resize the file.
+    std::filebuf contents_filebuf_; // Append-only, see ContentRecord.
+    FileMapping  file_mapping_;     // To quickly remap the file.
+    MappedRegion mapped_file_;      // Read/write to file through this.
 
     using row_id = uindex;
 
@@ -222,6 +366,14 @@ private:
     HashMap<String, usize, string_hash, std::equal_to<>>
                               path_uses_;
 
+    // Map: Path -> Mapping of the whole archive. Long-lived, packed resources are views into these.
+    HashMap<String, SharedPtr<MappedRegion>, string_hash, std::equal_to<>>
+                              archives_;
+
+    // Map: Content Hash -> UUID. Might refer to the resources that were removed since.
+    HashMap<ContentHash, UUID>
+                              contents_;
+
     // Integer that represents database state. Every update increments the state version.
     u64                       state_version_{};
 
@@ -240,6 +392,12 @@ private:
     void _flush_row(row_id row_id);
     void _bump_version() noexcept;
 
+    // Read the content index, drop stale records, and reopen it for appending.
+    void _load_contents();
+
+    // Returns the archive mapping, opening it if not yet open.
+    auto _open_archive(const ResourcePath& path) -> const SharedPtr<MappedRegion>&;
+
     // Create a new entry, possibly resizing the table. No checks are made. Version is not updated.
     void _new_entry(
         const UUID&         uuid,
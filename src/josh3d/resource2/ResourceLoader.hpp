@@ -1,10 +1,13 @@
 #pragma once
 #include "AsyncCradle.hpp"
 #include "ContainerUtils.hpp"
+#include "LODHints.hpp"
 #include "Resource.hpp"
 #include "ResourceDatabase.hpp"
 #include "ResourceRegistry.hpp"
 #include "MeshRegistry.hpp"
+#include "TexturePool.hpp"
+#include "TextureResidency.hpp"
 
 
 namespace josh {
@@ -33,11 +36,13 @@ public:
         ResourceDatabase& resource_database,
         ResourceRegistry& resource_registry,
         MeshRegistry&     mesh_registry, // FIXME: Must be in a generic context instead.
+        TexturePool&      texture_pool,  // FIXME: Same.
         AsyncCradleRef    async_cradle
     )
         : resource_database_(resource_database)
         , resource_registry_(resource_registry)
         , mesh_registry_    (mesh_registry)
+        , texture_pool_     (texture_pool)
         , cradle_           (async_cradle)
     {}
 
@@ -76,12 +81,23 @@ public:
     auto load(UUID uuid)
         -> Job<PublicResource<TypeV>>;
 
+    // Desired LODs reported back by the renderer. Consulted by
+    // the loaders that stream LODs incrementally. Disabled by default.
+    auto lod_hints() noexcept -> LODHints& { return lod_hints_; }
+
+    // Mips demanded by the renderer and the memory budget for them.
+    // Consulted by the texture loader. Disabled by default.
+    auto texture_residency() noexcept -> TextureResidency& { return texture_residency_; }
+
 private:
     friend ResourceLoaderContext;
     ResourceDatabase& resource_database_;
     ResourceRegistry& resource_registry_;
     MeshRegistry&     mesh_registry_;
+    TexturePool&      texture_pool_;
     AsyncCradleRef    cradle_;
+    LODHints          lod_hints_;
+    TextureResidency  texture_residency_;
 
     using key_type    = ResourceType;
     using loader_func = UniqueFunction<Job<>(ResourceLoaderContext, UUID)>;
@@ -99,12 +115,17 @@ public:
     // Basic helpers.
     auto& resource_database()  noexcept { return self_.resource_database_;         }
     auto& thread_pool()        noexcept { return self_.cradle_.loading_pool;       }
+    auto& io_context()         noexcept { return self_.cradle_.io_context;         }
     auto& offscreen_context()  noexcept { return self_.cradle_.offscreen_context;  }
     auto& completion_context() noexcept { return self_.cradle_.completion_context; }
     auto& local_context()      noexcept { return self_.cradle_.local_context;      }
 
     // FIXME: This should be part of generic context in the loader.
     auto& mesh_registry()      noexcept { return self_.mesh_registry_; }
+    auto& texture_pool()       noexcept { return self_.texture_pool_;  }
+
+    auto& lod_hints()          noexcept { return self_.lod_hints_; }
+    auto& texture_residency()  noexcept { return self_.texture_residency_; }
 
     // Create a new resource in the registry associated with the specified uuid
     // and resume the awaiters expecting the current epoch.
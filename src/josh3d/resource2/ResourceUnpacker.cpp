@@ -6,13 +6,13 @@
 namespace josh {
 
 
-auto ResourceUnpacker::_unpack(const key_type& key, UUID uuid, AnyRef destination)
+auto ResourceUnpacker::_unpack(const key_type& key, UUID uuid, AnyRef destination, TaskPriority priority)
     -> Job<>
 {
     if (auto* unpacker = try_find_value(dispatch_table_, key))
     {
         // FIXME: Something about const-correctness is amiss here. Likely because of UniqueFunction.
-        return (*unpacker)(ResourceUnpackerContext(*this), uuid, destination);
+        return (*unpacker)(ResourceUnpackerContext(*this, priority), uuid, destination);
     }
     else
     {
@@ -2,6 +2,7 @@
 #include "AnyRef.hpp"
 #include "CommonConcepts.hpp"
 #include "AsyncCradle.hpp"
+#include "async/LocalContext.hpp"
 #include "async/TaskCounterGuard.hpp"
 #include "Resource.hpp"
 #include "ResourceDatabase.hpp"
@@ -64,11 +65,13 @@ public:
         of_signature<Job<>(ResourceUnpackerContext, UUID, DestinationT)> UnpackerF>
     void register_unpacker(UnpackerF&& f);
 
+    // The `priority` applies to the parts of unpacking done in the local context.
     template<ResourceType TypeV, typename DestinationT>
-    auto unpack(UUID uuid, DestinationT destination) -> Job<>;
+    auto unpack(UUID uuid, DestinationT destination, TaskPriority priority = TaskPriority::Normal) -> Job<>;
 
+    // The `priority` applies to the parts of unpacking done in the local context.
     template<typename DestinationT>
-    auto unpack_any(UUID uuid, DestinationT destination) -> Job<>;
+    auto unpack_any(UUID uuid, DestinationT destination, TaskPriority priority = TaskPriority::Normal) -> Job<>;
 
 private:
     friend ResourceUnpackerContext;
@@ -83,7 +86,7 @@ private:
 
     dtable_type dispatch_table_;
 
-    auto _unpack(const key_type& key, UUID uuid, AnyRef destination) -> Job<>;
+    auto _unpack(const key_type& key, UUID uuid, AnyRef destination, TaskPriority priority) -> Job<>;
 };
 
 class ResourceUnpackerContext
@@ -95,25 +98,31 @@ public:
     auto& offscreen_context()  noexcept { return self_.cradle_.offscreen_context;  }
     auto& completion_context() noexcept { return self_.cradle_.completion_context; }
     auto& task_counter()       noexcept { return self_.cradle_.task_counter;       }
-    auto& local_context()      noexcept { return self_.cradle_.local_context;      }
+    auto& local_context()      noexcept { return local_context_;                   } // Submits with the priority of this context.
     // TODO: Should we instead expose only the relevant unpack_*_to() functions?
     auto& unpacker()           noexcept { return self_;                            }
 
+    // Priority of this unpacking in the local context.
+    // Pass it down when unpacking dependent resources.
+    auto priority() const noexcept -> TaskPriority { return local_context_.priority(); }
+
     // FIXME: This should not exists, but it has to for now because some unpackers
     // spawn child unpacking tasks directly instead of going through the interface.
     // This is because they do not have respective unpackers defined for their subtasks
     // and would simply fail otherwise.
     [[nodiscard]]
-    auto child_context() const noexcept -> ResourceUnpackerContext { return { self_ }; }
+    auto child_context() const noexcept -> ResourceUnpackerContext { return { self_, priority() }; }
 
 private:
     friend ResourceUnpacker;
-    ResourceUnpackerContext(ResourceUnpacker& self)
+    ResourceUnpackerContext(ResourceUnpacker& self, TaskPriority priority)
         : self_(self)
+        , local_context_(self_.cradle_.local_context.with_priority(priority))
         , task_guard_(self_.cradle_.task_counter)
     {}
-    ResourceUnpacker& self_;
-    SingleTaskGuard   task_guard_;
+    ResourceUnpacker&       self_;
+    PrioritizedLocalContext local_context_;
+    SingleTaskGuard         task_guard_;
 };
 
 
@@ -138,20 +147,20 @@ void ResourceUnpacker::register_unpacker(UnpackerF&& f)
 }
 
 template<ResourceType TypeV, typename DestinationT>
-auto ResourceUnpacker::unpack(UUID uuid, DestinationT destination)
+auto ResourceUnpacker::unpack(UUID uuid, DestinationT destination, TaskPriority priority)
     -> Job<>
 {
     const key_type key = { .resource_type=TypeV, .destination_type=type_id<DestinationT>() };
-    return _unpack(key, uuid, AnyRef(destination));
+    return _unpack(key, uuid, AnyRef(destination), priority);
 }
 
 template<typename DestinationT>
-auto ResourceUnpacker::unpack_any(UUID uuid, DestinationT destination)
+auto ResourceUnpacker::unpack_any(UUID uuid, DestinationT destination, TaskPriority priority)
     -> Job<>
 {
     const auto type = resource_database_.type_of(uuid);
     const key_type key = { .resource_type=type, .destination_type=type_id<DestinationT>() };
-    return _unpack(key, uuid, AnyRef(destination));
+    return _unpack(key, uuid, AnyRef(destination), priority);
 }
 
 
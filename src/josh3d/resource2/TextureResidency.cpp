@@ -0,0 +1,224 @@
+#include "TextureResidency.hpp"
+#include "Ranges.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <mutex>
+
+
+namespace josh {
+
+
+auto TextureResidency::Entry::bytes_from(u8 mip) const noexcept
+    -> usize
+{
+    usize total = 0;
+    for (const u8 i : irange(mip, num_mips()))
+        total += mip_bytes[i];
+    return total;
+}
+
+void TextureResidency::set_enabled(bool enabled)
+{
+    const std::scoped_lock lk{ mutex_ };
+    enabled_ = enabled and not stopped_;
+    if (not enabled_)
+    {
+        for (auto& [uuid, entry] : entries_)
+            _release_parked(entry, true);
+    }
+}
+
+auto TextureResidency::is_enabled() const
+    -> bool
+{
+    const std::scoped_lock lk{ mutex_ };
+    return enabled_;
+}
+
+void TextureResidency::stop()
+{
+    const std::scoped_lock lk{ mutex_ };
+    stopped_ = true;
+    enabled_ = false;
+    for (auto& [uuid, entry] : entries_)
+        _release_parked(entry, true);
+}
+
+auto TextureResidency::is_stopped() const
+    -> bool
+{
+    const std::scoped_lock lk{ mutex_ };
+    return stopped_;
+}
+
+void TextureResidency::set_budget(usize budget_bytes)
+{
+    const std::scoped_lock lk{ mutex_ };
+    budget_ = budget_bytes;
+}
+
+auto TextureResidency::budget() const
+    -> usize
+{
+    const std::scoped_lock lk{ mutex_ };
+    return budget_;
+}
+
+void TextureResidency::track(const UUID& uuid, const Extent2I& resolution, Span<const usize> mip_bytes)
+{
+    assert(not mip_bytes.empty());
+    const u8 num_mips = u8(mip_bytes.size());
+    const u8 coarsest = num_mips - 1;
+
+    const std::scoped_lock lk{ mutex_ };
+    entries_.insert_or_assign(uuid, Entry{
+        .mip_bytes    = { mip_bytes.begin(), mip_bytes.end() },
+        .max_extent   = float(std::max(resolution.width, resolution.height)),
+        .resident     = num_mips,
+        .demanded     = coarsest,
+        .target       = coarsest,
+        .frame_demand = coarsest,
+    });
+}
+
+void TextureResidency::forget(const UUID& uuid)
+{
+    const std::scoped_lock lk{ mutex_ };
+    if (const auto it = entries_.find(uuid); it != entries_.end())
+    {
+        _release_parked(it->second, true);
+        entries_.erase(it);
+    }
+}
+
+void TextureResidency::set_resident(const UUID& uuid, u8 mip)
+{
+    const std::scoped_lock lk{ mutex_ };
+    if (const auto it = entries_.find(uuid); it != entries_.end())
+        it->second.resident = mip;
+}
+
+auto TextureResidency::target(const UUID& uuid) const
+    -> u8
+{
+    const std::scoped_lock lk{ mutex_ };
+    if (not enabled_) return 0;
+    if (const auto it = entries_.find(uuid); it != entries_.end())
+        return it->second.target;
+    return 0;
+}
+
+auto TextureResidency::until_target_differs(const UUID& uuid, u8 resident_mip)
+    -> Future<void>
+{
+    auto [future, promise] = make_future_promise_pair<void>();
+
+    const std::scoped_lock lk{ mutex_ };
+    const auto it = entries_.find(uuid);
+    if (not enabled_ or it == entries_.end() or it->second.target != resident_mip)
+        set_result(MOVE(promise));
+    else
+        it->second.parked.push_back({ resident_mip, MOVE(promise) });
+
+    return MOVE(future);
+}
+
+void TextureResidency::demand(const UUID& uuid, float screen_pixels, float mip_bias)
+{
+    const std::scoped_lock lk{ mutex_ };
+    if (const auto it = entries_.find(uuid); it != entries_.end())
+    {
+        Entry& entry = it->second;
+        const u8 coarsest = entry.num_mips() - 1;
+
+        // Round down to the finer mip, so that there is never less than a texel per pixel.
+        const float mip_f = screen_pixels > 0.f ?
+            std::log2(entry.max_extent / screen_pixels) + mip_bias : float(coarsest);
+        const u8    mip   = u8(std::clamp(std::floor(mip_f), 0.f, float(coarsest)));
+
+        // NOTE: The frame demand is reset to the coarsest mip on each update.
+        entry.frame_demand = std::min(entry.frame_demand, mip);
+        entry.was_demanded = true;
+    }
+}
+
+void TextureResidency::update()
+{
+    const std::scoped_lock lk{ mutex_ };
+
+    if (not enabled_)
+    {
+        for (auto& [uuid, entry] : entries_)
+            entry.was_demanded = false;
+        return;
+    }
+
+    // Keep everything that is already resident first, then drop what is not
+    // demanded, starting from the textures with the most bytes to spare.
+    usize          total_bytes = 0;
+    Vector<Entry*> droppable;
+
+    for (auto& [uuid, entry] : entries_)
+    {
+        const u8 coarsest = entry.num_mips() - 1;
+        entry.demanded     = entry.was_demanded ? entry.frame_demand : coarsest;
+        entry.frame_demand = coarsest;
+        entry.was_demanded = false;
+
+        entry.target = std::min(entry.demanded, entry.resident);
+        total_bytes += entry.bytes_from(entry.target);
+
+        if (entry.target < entry.demanded)
+            droppable.push_back(&entry);
+    }
+
+    if (total_bytes > budget_)
+    {
+        const auto excess_bytes = [](const Entry* entry)
+        {
+            return entry->bytes_from(entry->target) - entry->bytes_from(entry->demanded);
+        };
+
+        std::ranges::sort(droppable, std::ranges::greater{}, excess_bytes);
+
+        for (Entry* entry : droppable)
+        {
+            if (total_bytes <= budget_) break;
+            total_bytes  -= excess_bytes(entry);
+            entry->target = entry->demanded;
+        }
+    }
+
+    for (auto& [uuid, entry] : entries_)
+        _release_parked(entry);
+}
+
+auto TextureResidency::stats() const
+    -> Stats
+{
+    const std::scoped_lock lk{ mutex_ };
+    Stats stats{ .num_tracked = entries_.size(), .budget_bytes = budget_ };
+    for (const auto& [uuid, entry] : entries_)
+    {
+        stats.resident_bytes += entry.bytes_from(entry.resident);
+        stats.target_bytes   += entry.bytes_from(entry.target);
+    }
+    return stats;
+}
+
+void TextureResidency::_release_parked(Entry& entry, bool release_all)
+{
+    std::erase_if(entry.parked, [&](Parked& parked)
+    {
+        if (release_all or parked.resident != entry.target)
+        {
+            set_result(MOVE(parked.promise));
+            return true;
+        }
+        return false;
+    });
+}
+
+
+} // namespace josh
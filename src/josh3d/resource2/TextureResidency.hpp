@@ -0,0 +1,132 @@
+#pragma once
+#include "Common.hpp"
+#include "Scalars.hpp"
+#include "Region.hpp"
+#include "UUID.hpp"
+#include "async/Future.hpp"
+#include <mutex>
+
+
+namespace josh {
+
+
+/*
+Resident mips of the streamed textures, the mips demanded by the renderer,
+and a memory budget that decides which of the resident mips can be dropped.
+
+Every frame, the renderer reports how large each texture appears on screen
+with `demand()`, and calls `update()` once all demands are in. The demanded
+mip is the one with about a texel per pixel.
+This picks a target mip for each texture:
+
+    - If the demand is finer than what is resident, the texture is streamed up.
+    - If the demand is coarser, the resident mips are kept while the total
+      fits the budget. Otherwise, the textures with the most bytes resident
+      above their demand are dropped to the demanded mip first.
+
+Textures that are not demanded in a frame are not seen by anyone,
+and are demanded at their coarsest mip.
+
+The loaders park after each step until the target of their texture differs
+from what is resident, then reallocate the storage for the new range of mips.
+
+Lower mip index is finer, 0 is the finest.
+
+Disabled by default, in which case the target is always mip 0, and the textures
+are loaded fully. Whoever demands the mips should enable the residency.
+
+Before draining the tasks on shutdown, the residency must be stopped. Unlike
+disabling it, this lets the loaders exit with whatever is already resident,
+instead of streaming every texture up to mip 0 first.
+
+Thread-safe.
+*/
+class TextureResidency
+{
+public:
+    // When disabled, all parked loaders are released and every target is 0.
+    void set_enabled(bool enabled);
+    auto is_enabled() const -> bool;
+
+    // Disable the residency for good and release all parked loaders.
+    // The loaders are expected to check `is_stopped()` and exit early.
+    void stop();
+    auto is_stopped() const -> bool;
+
+    // Only drops the mips on the next `update()`.
+    void set_budget(usize budget_bytes);
+    auto budget() const -> usize;
+
+    // Start tracking a texture with the resolution of mip 0 and the approximate
+    // sizes of each mip. Nothing is resident until `set_resident()` is called.
+    void track(const UUID& uuid, const Extent2I& resolution, Span<const usize> mip_bytes);
+
+    // Stop tracking the texture and release its parked loader.
+    void forget(const UUID& uuid);
+
+    // Report the finest mip that is now resident.
+    void set_resident(const UUID& uuid, u8 mip);
+
+    // Finest mip that the loader should make resident. Always 0 if disabled.
+    auto target(const UUID& uuid) const -> u8;
+
+    // Get a future that becomes ready once the target of the texture
+    // is different from the `resident_mip`, or the residency is disabled.
+    [[nodiscard]] auto until_target_differs(const UUID& uuid, u8 resident_mip) -> Future<void>;
+
+    // Request the mips needed to cover `screen_pixels` across the texture this frame.
+    // Positive `mip_bias` is coarser. The finest request wins. Requests for the
+    // textures that are not tracked are ignored.
+    void demand(const UUID& uuid, float screen_pixels, float mip_bias = 0.f);
+
+    // Pick the new targets from the demands of this frame and the budget,
+    // and release the loaders parked on a different target. Resets the demands.
+    void update();
+
+    struct Stats
+    {
+        usize num_tracked    = 0;
+        usize resident_bytes = 0;
+        usize target_bytes   = 0;
+        usize budget_bytes   = 0;
+    };
+
+    auto stats() const -> Stats;
+
+    static constexpr usize default_budget = usize(1) << 30;
+
+private:
+    struct Parked
+    {
+        u8            resident;
+        Promise<void> promise;
+    };
+
+    struct Entry
+    {
+        SmallVector<usize, 16> mip_bytes;
+        float                  max_extent;   // Of mip 0, in texels.
+        u8                     resident;     // Number of mips if nothing is resident yet.
+        u8                     demanded;     // As of the last update.
+        u8                     target;
+        u8                     frame_demand; // Accumulated until the next update.
+        bool                   was_demanded = false;
+        Vector<Parked>         parked;
+
+        auto num_mips() const noexcept -> u8 { return u8(mip_bytes.size()); }
+        auto bytes_from(u8 mip) const noexcept -> usize;
+    };
+
+    mutable std::mutex   mutex_;
+    bool                 enabled_ = false;
+    bool                 stopped_ = false;
+    usize                budget_  = default_budget;
+    HashMap<UUID, Entry> entries_;
+
+    // Release the loaders parked on a mip other than the target.
+    // Releases all of them if `release_all` is true.
+    static void _release_parked(Entry& entry, bool release_all = false);
+};
+
+
+} // namespace josh
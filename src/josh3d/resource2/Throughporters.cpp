@@ -6,6 +6,7 @@
 #include "async/CompletionContext.hpp"
 #include "async/CoroCore.hpp"
 #include "async/Coroutines.hpp"
+#include "async/InflightBudget.hpp"
 #include "Components.hpp"
 #include "ECS.hpp"
 #include "Elements.hpp"
@@ -18,6 +19,7 @@
 #include "ImageData.hpp"
 #include "ImageProperties.hpp"
 #include "LightCasters.hpp"
+#include "Logging.hpp"
 #include "components/Materials.hpp"
 #include "MeshRegistry.hpp"
 #include "MeshStorage.hpp"
@@ -27,6 +29,7 @@
 #include "SceneGraph.hpp"
 #include "SkeletalAnimation.hpp"
 #include "SkeletonStorage.hpp"
+#include "Time.hpp"
 #include "components/SkinnedMesh.hpp"
 #include "components/StaticMesh.hpp"
 #include "Transform.hpp"
@@ -34,7 +37,10 @@
 #include "detail/CGLTF.hpp"
 #include "components/AlphaTested.hpp"
 #include <glbinding/gl/functions.h>
+#include <fmt/core.h>
 #include <stb_image.h>
+#include <atomic>
+#include <concepts>
 #include <ranges>
 
 
@@ -121,11 +127,132 @@ auto await_base_image_then_create_texture_view(
     co_return view;
 }
 
+/*
+Cumulative time spent in each phase of mesh processing, summed over
+all meshes and chunks of a single throughport. Since meshes are processed
+concurrently, the totals can exceed the wall-clock time of the whole import.
+*/
+struct MeshPhaseTimings
+{
+    std::atomic<i64> budget_wait_ns  = 0;
+    std::atomic<i64> validate_ns     = 0;
+    std::atomic<i64> pack_indices_ns = 0;
+    std::atomic<i64> pack_verts_ns   = 0;
+    std::atomic<i64> upload_ns       = 0;
+};
+
+void add_time_since(std::atomic<i64>& total_ns, TimePointNS since) noexcept
+{
+    total_ns.fetch_add((current_time() - since).count(), std::memory_order_relaxed);
+}
+
+/*
+State shared by all mesh jobs of a single throughport.
+Must outlive every mesh job that references it.
+*/
+struct MeshImportState
+{
+    InflightBudget      budget;
+    usize               chunk_size;
+    MeshPhaseTimings    timings;
+    std::atomic<usize>  num_meshes   = 0;
+    std::atomic<usize>  packed_bytes = 0;
+
+    MeshImportState(usize max_inflight_bytes, usize chunk_size)
+        : budget    (max_inflight_bytes)
+        , chunk_size(std::max(chunk_size, usize(1)))
+    {}
+};
+
+template<typename VertexT>
+auto pack_chunked_and_upload_mesh(
+    const esr::Mesh& mesh,
+    MeshImportState& state,
+    MeshRegistry&    mesh_registry,
+    AsyncCradleRef   async)
+        -> Job<MeshID<VertexT>>
+{
+    constexpr bool is_skinned = std::same_as<VertexT, VertexSkinned>;
+
+    const esr::MeshAttributes& a       = mesh.attributes;
+    MeshPhaseTimings&          timings = state.timings;
+
+    TimePointNS t0 = current_time();
+    if constexpr (is_skinned) validate_attributes_skinned(a);
+    else                      validate_attributes_static (a);
+    add_time_since(timings.validate_ns, t0);
+
+    const usize num_verts    = a.positions.element_count;
+    const usize num_elems    = a.indices.element_count;
+    const usize packed_bytes = num_verts * sizeof(VertexT) + num_elems * sizeof(u32);
+
+    // The reservation is held until the packed data is freed at the end of this job,
+    // which is after the staging buffers are created in the upload.
+    t0 = current_time();
+    BudgetReservation reservation = state.budget.reserve(packed_bytes);
+    co_await async.completion_context.until_ready(reservation);
+    co_await reschedule_to(async.loading_pool);
+    add_time_since(timings.budget_wait_ns, t0);
+
+    auto indices = Vector<u32>(num_elems);
+    auto verts   = Vector<VertexT>(num_verts);
+
+    auto pack_indices_chunk = [&](uindex first, usize size)
+    {
+        const TimePointNS start = current_time();
+        pack_indices_into(Span<u32>(indices).subspan(first, size), a.indices, first);
+        add_time_since(timings.pack_indices_ns, start);
+    };
+
+    auto pack_verts_chunk = [&](uindex first, usize size)
+    {
+        const TimePointNS start = current_time();
+        const auto dst = Span<VertexT>(verts).subspan(first, size);
+        if constexpr (is_skinned)
+            pack_attributes_skinned_into(dst, a.positions, a.uvs, a.normals, a.tangents, a.joint_ids, a.joint_ws, first);
+        else
+            pack_attributes_static_into(dst, a.positions, a.uvs, a.normals, a.tangents, first);
+        add_time_since(timings.pack_verts_ns, start);
+    };
+
+    // NOTE: Small meshes are packed inline, since the chunking would only add overhead.
+    Job<> pack_jobs[] = {
+        for_each_chunk_on(async.loading_pool, num_elems, state.chunk_size, pack_indices_chunk),
+        for_each_chunk_on(async.loading_pool, num_verts, state.chunk_size, pack_verts_chunk),
+    };
+    co_await until_all_succeed(pack_jobs);
+
+    t0 = current_time();
+    MeshID<VertexT> mesh_id = {};
+    if constexpr (is_skinned)
+        mesh_id = co_await upload_skinned_mesh(verts, indices, mesh_registry, async);
+    else
+        mesh_id = co_await upload_static_mesh(verts, indices, mesh_registry, async);
+    add_time_since(timings.upload_ns, t0);
+
+    state.num_meshes  .fetch_add(1,            std::memory_order_relaxed);
+    state.packed_bytes.fetch_add(packed_bytes, std::memory_order_relaxed);
+
+    co_return mesh_id;
+}
+
+void log_mesh_import_state(const MeshImportState& state)
+{
+    const auto ms = [](const std::atomic<i64>& ns) { return double(ns.load()) * 1e-6; };
+    const MeshPhaseTimings& t = state.timings;
+    logstream() << fmt::format(
+        "[INFO]: Throughported {} meshes, {:.2f} MiB packed. Time per phase, summed over threads: "
+        "budget wait {:.2f}ms, validate {:.2f}ms, pack indices {:.2f}ms, pack vertices {:.2f}ms, upload {:.2f}ms.\n",
+        state.num_meshes.load(), double(state.packed_bytes.load()) / double(1024 * 1024),
+        ms(t.budget_wait_ns), ms(t.validate_ns), ms(t.pack_indices_ns), ms(t.pack_verts_ns), ms(t.upload_ns));
+}
+
 // NOTE: Infer the concrete type of the vertex from the esr::Mesh itself.
 JOSH3D_DERIVE_TYPE(MeshJob, Job<MeshID<>>);
 
 auto pack_and_upload_mesh_data(
     const esr::Mesh& mesh,
+    MeshImportState& state,
     MeshRegistry&    mesh_registry,
     AsyncCradleRef   async)
         -> MeshJob
@@ -134,42 +261,16 @@ auto pack_and_upload_mesh_data(
 
     if (mesh.format == VertexFormat::Skinned)
     {
-        validate_attributes_skinned(mesh.attributes);
-
-        Vector<u32> indices =
-            pack_indices(mesh.attributes.indices);
-
-        Vector<VertexSkinned> verts =
-            pack_attributes_skinned(
-                mesh.attributes.positions,
-                mesh.attributes.uvs,
-                mesh.attributes.normals,
-                mesh.attributes.tangents,
-                mesh.attributes.joint_ids,
-                mesh.attributes.joint_ws);
-
         const MeshID<VertexSkinned> mesh_id =
-            co_await upload_skinned_mesh(verts, indices, mesh_registry, async);
+            co_await pack_chunked_and_upload_mesh<VertexSkinned>(mesh, state, mesh_registry, async);
 
         co_return mesh_id;
     }
 
     if (mesh.format == VertexFormat::Static)
     {
-        validate_attributes_static(mesh.attributes);
-
-        Vector<u32> indices =
-            pack_indices(mesh.attributes.indices);
-
-        Vector<VertexStatic> verts =
-            pack_attributes_static(
-                mesh.attributes.positions,
-                mesh.attributes.uvs,
-                mesh.attributes.normals,
-                mesh.attributes.tangents);
-
         const MeshID<VertexStatic> mesh_id =
-            co_await upload_static_mesh(verts, indices, mesh_registry, async);
+            co_await pack_chunked_and_upload_mesh<VertexStatic>(mesh, state, mesh_registry, async);
 
         co_return mesh_id;
     }
@@ -626,9 +727,14 @@ auto throughport_external_scene(
 #endif
 
     // Start loading the meshes in the meantime.
+    //
+    // Each mesh is its own job, and large meshes are further split into chunks,
+    // but the packed data is bounded by the budget in the `mesh_state`.
+    MeshImportState mesh_state{ params.max_inflight_bytes, params.mesh_chunk_size };
+
     for (auto [mesh_id, mesh] : scene.view<esr::Mesh>().each())
         scene.emplace<MeshJob>(mesh_id,
-            pack_and_upload_mesh_data(mesh, context.mesh_registry, async));
+            pack_and_upload_mesh_data(mesh, mesh_state, context.mesh_registry, async));
 
     // Load skeletons and animations.
     for (auto [skin_id, skin] : scene.view<esr::Skin>().each())
@@ -653,7 +759,17 @@ auto throughport_external_scene(
         scene.emplace<SceneJob>(scene_id,
             assemble_and_unpack_scene(scene_, scene, dst_entity, context.registry, async));
 
-    co_await until_all_succeed(scene.storage<SceneJob>());
+    // NOTE: Not propagating the scene job failures just yet. Every mesh job
+    // references the `mesh_state` in this frame, including the meshes not
+    // referenced by any node, so all of them must finish before we can unwind.
+    co_await until_all_ready(scene.storage<SceneJob>());
+    co_await async.completion_context.until_all_ready(scene.storage<MeshJob>());
+
+    log_mesh_import_state(mesh_state);
+
+    // Now rethrow the first failure, if any.
+    for (const SceneJob& scene_job : scene.storage<SceneJob>())
+        scene_job.get_result();
 }
 
 auto throughport_scene_gltf(
@@ -668,25 +784,20 @@ auto throughport_scene_gltf(
 
     co_await reschedule_to(async.loading_pool);
 
-    const cgltf_options options = {};
-    cgltf_data*         gltf    = {};
-    cgltf_result        result  = {};
-
-    result = cgltf_parse_file(&options, path.c_str(), &gltf);
-    if (result != cgltf_result_success)
-        throw_fmt<GLTFParseError>("Failed to parse gltf file {}, reason {}.", path, enum_string(result));
-
-    const auto _owner = unique_data_ptr(gltf);
+    // The .glb binary chunk and external buffers are mapped, not read,
+    // so the element views in the scene point straight into the files.
+    MappedGLTF gltf = parse_and_map_gltf(path);
 
-    result = cgltf_load_buffers(&options, gltf, path.c_str());
-    if (result != cgltf_result_success)
-        throw_fmt<GLTFParseError>("Failed to load gltf buffers of {}, reason {}.", path, enum_string(result));
+    esr::ExternalScene scene = to_external_scene(*gltf.data, path.parent_path());
 
-    esr::ExternalScene scene = to_external_scene(*gltf, path.parent_path());
+    // The scene owns the data it views, as the throughport_external_scene() requests.
+    scene.ctx().emplace<MappedGLTF>(MOVE(gltf));
 
     const ESRThroughportParams esr_params = {
-        .generate_mips = params.generate_mips,
-        .unitarization = params.unitarization,
+        .generate_mips      = params.generate_mips,
+        .unitarization      = params.unitarization,
+        .mesh_chunk_size    = params.mesh_chunk_size,
+        .max_inflight_bytes = params.max_inflight_bytes,
     };
 
     co_await throughport_external_scene(MOVE(scene), dst_entity, esr_params, context);
@@ -34,13 +34,20 @@ struct ThroughportContext
 
 struct ESRThroughportParams
 {
-    bool          generate_mips = true; // FIXME: Completely ignored. Remove?
-    Unitarization unitarization = Unitarization::InsertDummy; // Unitarization will alway be performed, but the algorithm can be customized.
+    bool          generate_mips      = true; // FIXME: Completely ignored. Remove?
+    Unitarization unitarization      = Unitarization::InsertDummy; // Unitarization will alway be performed, but the algorithm can be customized.
+    usize         mesh_chunk_size    = 64 * 1024;         // Meshes with more vertices/indices than this are packed in parallel chunks of this size.
+    usize         max_inflight_bytes = 256 * 1024 * 1024; // Budget for packed mesh data waiting for upload. Bounds peak memory on huge scenes.
 };
 
 /*
 ExternalScene-based throughporter.
 
+Meshes are packed concurrently on the loading pool, and very large meshes
+are additionally split into chunks. The amount of packed data that is held
+before the upload is bounded by `params.max_inflight_bytes`. The time spent
+in each phase of mesh processing is reported to the log once done.
+
 If `dst_entity` is not null, the scene(s) will be attached to it,
 otherwise the scene will be emplaced directly into the `context.registry`.
 
@@ -58,8 +65,10 @@ auto throughport_external_scene(
 
 struct GLTFThroughportParams
 {
-    bool          generate_mips = true;
-    Unitarization unitarization = Unitarization::InsertDummy;
+    bool          generate_mips      = true;
+    Unitarization unitarization      = Unitarization::InsertDummy;
+    usize         mesh_chunk_size    = 64 * 1024;
+    usize         max_inflight_bytes = 256 * 1024 * 1024;
 };
 
 /*
@@ -1,4 +1,5 @@
 #include "Common.hpp"
+#include "ContentHash.hpp"
 #include "ResourceFiles.hpp"
 #include "Resources.hpp"
 #include "GLAPICore.hpp"
@@ -19,6 +20,7 @@
 #include "memory/MallocSupport.hpp"
 #include "TextureHelpers.hpp"
 #include "ImageData.hpp"
+#include "MipChain.hpp"
 #include <fmt/format.h>
 #include <spng.h>
 
@@ -129,105 +131,66 @@ auto encode_texture_async_bc7(
     // TODO
 }
 
-auto pick_mip_internal_format(usize num_channels)
-    -> InternalFormat
-{
-    switch (num_channels)
-    {
-        case 3: return InternalFormat::RGB8;
-        case 4: return InternalFormat::RGBA8;
-        default: break;
-    }
-    panic();
-}
-
-auto pick_mip_data_format(usize num_channels)
-    -> PixelDataFormat
+[[nodiscard]]
+auto downsample_mip_rows_async(
+    AssetImporterContext&  context,
+    ImageView<const ubyte> src,
+    ImageView<ubyte>       dst,
+    const MipChainParams&  params,
+    usize                  row_begin,
+    usize                  row_end)
+        -> Job<>
 {
-    switch (num_channels)
-    {
-        case 3: return PixelDataFormat::RGB;
-        case 4: return PixelDataFormat::RGBA;
-        default: break;
-    }
-    panic();
+    co_await reschedule_to(context.thread_pool());
+    downsample_mip_rows(src, dst, params, row_begin, row_end);
 }
 
 [[nodiscard]]
 auto generate_mips(
     AssetImporterContext&             context,
-    SmallVector<ImageData<ubyte>, 1>& mips)
+    SmallVector<ImageData<ubyte>, 1>& mips,
+    const MipChainParams&             params)
         -> Job<>
 {
     const auto resolution0  = Extent2I(mips[0].resolution());
     const auto num_channels = mips[0].num_channels();
     const auto num_mips     = max_num_levels(resolution0);
-    const auto iformat      = pick_mip_internal_format(num_channels);
-    const auto format       = pick_mip_data_format(num_channels);
-    const auto type         = PixelDataType::UByte;
     mips.reserve(num_mips);
 
-    // We use the GPU context to generate the mips. We could also do it ourselves
-    // or use a custom shader or whatever. For now the glGenerateMipmap() will do.
-    co_await reschedule_to(context.offscreen_context());
-
-    UniqueTexture2D texture;
-    texture->allocate_storage(resolution0, iformat, num_mips);
-    texture->upload_image_region(
-        { {}, resolution0 },
-        format,
-        type,
-        mips[0].data(),
-        MipLevel(0)
-    );
-    texture->generate_mipmaps();
-
-    // NOTE: Suspending on a fence here.
-    //
-    // Not sure if the barrier is needed, since mipmap generation *can* be considered
-    // a rendering operation, although it is never explicitly specified as such.
-    //
-    // 7.13.2: "TEXTURE_UPDATE_BARRIER_BIT: Writes to a texture via Tex(Sub)Image*, ClearTex*Image,
-    // CopyTex*, or CompressedTex*, and reads via GetTexImage after the barrier will not
-    // execute until all shader writes initiated prior to the barrier complete."
-    glapi::memory_barrier(BarrierMask::TextureUpdateBit);
-
-    if (const auto fence = create_fence(); not is_ready(fence))
-        co_await context.completion_context().until_ready_on(context.offscreen_context(), fence);
-
-    // NOTE: This is important to make sure we can read the image data
-    // back into the arbitrary aligned buffers. Otherwise some reads
-    // could fail with INVALID_OPERATION as the buffer would be too small
-    // to fit the alignment padding.
-    //
-    // See "OpenGL 4.6, ch. 8.4.4.1, eq. (8.2)" for how the alignment
-    // affetcs the computed storage buffer extents.
-    //
-    // See "OpenGL 4.6, ch. 18.2.2, table 18.1" for a list of packing
-    // parameters and their defaults.
-    //
-    // I have no clue why alignment of 4 was chosen as the default,
-    // this is the kind of rotten idea that will trip everyone
-    // at least once.
-    glapi::set_pixel_pack_alignment(1);
+    // Each level depends on the previous one, but the rows of a level do not,
+    // so each level is split into bands of rows across the loading pool.
+    // This also keeps the source rows of each band hot in the cache.
+    constexpr usize pixels_per_band = 64 * 1024;
 
+    SmallVector<Job<>, 16> band_jobs;
     for (const uindex mip_id : irange(1, num_mips))
     {
-        const auto mip_level  = MipLevel(int(mip_id));
-        const auto resolution = texture->get_resolution(mip_level);
-        // TODO: Could probably do the allocation *off* of the GPU context.
-        // But need to precompute the resoluton ahead of time that way.
-        // Too lazy right now.
-        ImageData<byte> image = { Extent2S(resolution), num_channels };
-
-        texture->download_image_region_into(
-            { {}, resolution },
-            format,
-            type,
-            to_span(image),
-            mip_level
-        );
-        mips.emplace_back(MOVE(image));
+        const auto& src = mips[mip_id - 1];
+        ImageData<ubyte> dst = { next_mip_resolution(src.resolution()), num_channels };
+
+        const usize dst_w         = dst.resolution().width;
+        const usize dst_h         = dst.resolution().height;
+        const usize rows_per_band = std::max(pixels_per_band / dst_w, usize(1));
+
+        if (rows_per_band >= dst_h)
+        {
+            // Not worth the trip through the pool.
+            downsample_mip_rows(src, dst, params, 0, dst_h);
+        }
+        else
+        {
+            band_jobs.clear();
+            for (usize row_begin = 0; row_begin < dst_h; row_begin += rows_per_band)
+            {
+                const usize row_end = std::min(row_begin + rows_per_band, dst_h);
+                band_jobs.emplace_back(downsample_mip_rows_async(context, src, dst, params, row_begin, row_end));
+            }
+            co_await until_all_ready(band_jobs);
+            co_await reschedule_to(context.thread_pool());
+            for (auto& job : band_jobs) job.get_result(); // Propagate exceptions, if any.
+        }
+
+        mips.emplace_back(MOVE(dst));
     }
 }
 
@@ -255,8 +218,34 @@ auto import_texture(
     mips.emplace_back(load_image_data_from_file<ubyte>(File(path), 3, 4));
     const usize num_channels = mips[0].num_channels();
 
+    // Identical images imported with identical params produce identical files.
+    // Reuse the existing resource, if any, before doing the expensive part.
+    const ResourceType resource_type = TextureFile::resource_type;
+    const ContentHash  content_hash  = eval%[&]{
+        const auto& image = mips[0];
+        ContentHasher hasher;
+        hasher.update_value(resource_type);
+        hasher.update_value(u64(image.resolution().width));
+        hasher.update_value(u64(image.resolution().height));
+        hasher.update_value(u64(num_channels));
+        hasher.update_value(params.encoding);
+        hasher.update_value(params.colorspace);
+        hasher.update_value(u8(params.generate_mips));
+        hasher.update_value(params.mip_filter);
+        hasher.update(image.data(), image.size_bytes());
+        return hasher.digest();
+    };
+
+    if (const Optional existing = context.resource_database().find_by_content(resource_type, content_hash))
+        co_return *existing;
+
     if (params.generate_mips) {
-        co_await generate_mips(context, mips);
+        const MipChainParams mip_params = {
+            .filter         = params.mip_filter,
+            .srgb           = params.colorspace == Colorspace::sRGB,
+            .alpha_weighted = true,
+        };
+        co_await generate_mips(context, mips, mip_params);
         co_await reschedule_to(context.thread_pool());
     }
 
@@ -322,8 +311,7 @@ auto import_texture(
         .mip_specs    = mip_specs,
     };
 
-    const usize        file_size     = TextureFile::required_size(args);
-    const ResourceType resource_type = TextureFile::resource_type;
+    const usize file_size = TextureFile::required_size(args);
 
     auto [uuid, mregion] = context.resource_database().generate_resource(resource_type, path_hint, file_size);
 
@@ -337,6 +325,8 @@ auto import_texture(
         std::ranges::copy(src_bytes, dst_bytes.begin());
     }
 
+    context.resource_database().record_content(uuid, content_hash);
+
     co_return uuid;
 }
 
@@ -4,6 +4,7 @@
 #include "ContainerUtils.hpp"
 #include "async/CoroCore.hpp"
 #include "async/Coroutines.hpp"
+#include "async/IOContext.hpp"
 #include "GLAPIBinding.hpp"
 #include "GLBuffers.hpp"
 #include "GLObjectHelpers.hpp"
@@ -21,6 +22,7 @@
 #include "ResourceLoader.hpp"
 #include "Errors.hpp"
 #include "Scalars.hpp"
+#include "ScopeExit.hpp"
 #include "SkeletalAnimation.hpp"
 #include "UUID.hpp"
 #include "VertexFormats.hpp"
@@ -56,6 +58,38 @@ auto next_lod_range(u8 cur_lod, u8 num_lods)
     return { lod, end };
 }
 
+/*
+Byte ranges of the vertex and element data of the specified LODs.
+*/
+template<typename MeshFileT>
+auto lod_bytes(const MeshFileT& file, std::ranges::range auto&& lod_ids)
+    -> SmallVector<Span<const ubyte>, 4>
+{
+    SmallVector<Span<const ubyte>, 4> result;
+    for (const auto lod_id : lod_ids)
+    {
+        result.emplace_back(file.lod_verts_bytes(lod_id));
+        result.emplace_back(file.lod_elems_bytes(lod_id));
+    }
+    return result;
+}
+
+/*
+Hint the OS to start reading the LODs that come after `cur_lod`,
+so that they would be in memory by the time we get to them.
+*/
+template<typename MeshFileT>
+void advise_next_lods(const MeshFileT& file, u8 cur_lod, u8 num_lods)
+{
+    if (cur_lod == 0) return;
+    const auto [beg_lod, end_lod] = next_lod_range(cur_lod, num_lods);
+    for (const auto lod_id : irange(beg_lod, end_lod))
+    {
+        IOContext::advise_willneed(file.lod_verts_bytes(lod_id));
+        IOContext::advise_willneed(file.lod_elems_bytes(lod_id));
+    }
+}
+
 struct StagingBuffers
 {
     UniqueUntypedBuffer verts;
@@ -123,6 +157,9 @@ try
     const u8 num_lods   = header.num_lods;
     u8       cur_lod    = num_lods;
     bool     first_time = true;
+
+    // The hints are only kept while streaming, see LODHints.
+    DEFER(context.lod_hints().forget(uuid));
     do
     {
         // FIXME: This is overall pretty bad as it waits on a previous
@@ -133,11 +170,16 @@ try
         // TODO: Could we make it possible to load LODs out-of-order? It's just
         // a small bitfield indicating availability, scanning that is very cheap.
 
+        const auto [beg_lod, end_lod] = next_lod_range(cur_lod, num_lods);
+        const auto lod_ids            = reverse(irange(beg_lod, end_lod));
+
+        // Fault-in the data on the IO threads, the offscreen context should not wait on the disk.
+        co_await context.io_context().until_all_resident_on(context.thread_pool(), lod_bytes(file, lod_ids));
+        advise_next_lods(file, beg_lod, num_lods);
+
         co_await reschedule_to(context.offscreen_context());
 
         staged_lods.clear();
-        const auto [beg_lod, end_lod] = next_lod_range(cur_lod, num_lods);
-        const auto lod_ids            = reverse(irange(beg_lod, end_lod));
         for (const auto lod_id : lod_ids)
             staged_lods.emplace_back(stage_lod(file.lod_verts_bytes(lod_id), file.lod_elems_bytes(lod_id)));
 
@@ -147,6 +189,12 @@ try
 
         upload_lods(context.mesh_registry().ensure_storage_for<VertexStatic>(), lod_pack, lod_ids, staged_lods);
 
+        // Only the LODs from here to the coarsest are available.
+        // Default to the finest of those, LODSelection can pick another.
+        lod_pack.max_lod = num_lods - 1;
+        lod_pack.min_lod = beg_lod;
+        lod_pack.cur_lod = beg_lod;
+
         // Fence the upload from the main context, await in the offscreen.
         // TODO: Does this need to flush? What if it auto-flushes on fence creation?
         // That would actually be even worse. We probably want to avoid that...
@@ -177,6 +225,12 @@ try
         }
 
         cur_lod = beg_lod;
+
+        // Park until something finer than what we have is requested.
+        // Always ready if the hints are not enabled.
+        if (cur_lod != 0)
+            co_await context.completion_context().until_ready_on(context.thread_pool(),
+                context.lod_hints().until_finer_than(uuid, cur_lod));
     }
     while (cur_lod != 0);
 }
@@ -205,13 +259,21 @@ try
     const u8 num_lods   = header.num_lods;
     u8       cur_lod    = num_lods;
     bool     first_time = true;
+
+    // The hints are only kept while streaming, see LODHints.
+    DEFER(context.lod_hints().forget(uuid));
     do
     {
+        const auto [beg_lod, end_lod] = next_lod_range(cur_lod, num_lods);
+        const auto lod_ids            = reverse(irange(beg_lod, end_lod));
+
+        // Fault-in the data on the IO threads, the offscreen context should not wait on the disk.
+        co_await context.io_context().until_all_resident_on(context.thread_pool(), lod_bytes(file, lod_ids));
+        advise_next_lods(file, beg_lod, num_lods);
+
         co_await reschedule_to(context.offscreen_context());
 
         staged_lods.clear();
-        const auto [beg_lod, end_lod] = next_lod_range(cur_lod, num_lods);
-        const auto lod_ids            = reverse(irange(beg_lod, end_lod));
         for (const auto lod_id : lod_ids)
             staged_lods.emplace_back(stage_lod(file.lod_verts_bytes(lod_id), file.lod_elems_bytes(lod_id)));
 
@@ -220,6 +282,12 @@ try
 
         upload_lods(context.mesh_registry().ensure_storage_for<VertexSkinned>(), lod_pack, lod_ids, staged_lods);
 
+        // Only the LODs from here to the coarsest are available.
+        // Default to the finest of those, LODSelection can pick another.
+        lod_pack.max_lod = num_lods - 1;
+        lod_pack.min_lod = beg_lod;
+        lod_pack.cur_lod = beg_lod;
+
         co_await context.completion_context().until_ready_on(context.offscreen_context(), create_fence());
         co_await reschedule_to(context.thread_pool());
 
@@ -250,6 +318,12 @@ try
         }
 
         cur_lod = beg_lod;
+
+        // Park until something finer than what we have is requested.
+        // Always ready if the hints are not enabled.
+        if (cur_lod != 0)
+            co_await context.completion_context().until_ready_on(context.thread_pool(),
+                context.lod_hints().until_finer_than(uuid, cur_lod));
     }
     while (cur_lod != 0);
 }
@@ -437,7 +511,8 @@ auto decode_and_upload_mip(
     ResourceLoaderContext& context,
     const TextureFile&     file,
     RawTexture2D<>         texture,
-    u8                     mip_id)
+    u8                     mip_id,
+    u8                     base_mip) // Mip of the file stored at level 0 of the texture.
         -> Job<>
 {
     const auto&         header       = file.header();
@@ -447,7 +522,7 @@ auto decode_and_upload_mip(
 
     const FileEncoding      src_encoding = mip.encoding;
     const PixelDataFormat   format       = pick_pixel_data_format(src_encoding, num_channels);
-    const MipLevel          level        = int(mip_id);
+    const MipLevel          level        = int(mip_id - base_mip);
     const Extent2I          resolution   = Extent2I(mip.width, mip.height);
     const Span<const ubyte> src_bytes    = file.mip_bytes(mip_id);
 
@@ -474,7 +549,8 @@ auto upload_mip(
     ResourceLoaderContext& context,
     const TextureFile&     file,
     RawTexture2D<>         texture,
-    u8                     mip_id)
+    u8                     mip_id,
+    u8                     base_mip) // Mip of the file stored at level 0 of the texture.
         -> Job<>
 {
     const auto&         header       = file.header();
@@ -486,7 +562,7 @@ auto upload_mip(
 
     const FileEncoding     src_encoding = mip.encoding;
     const PixelDataFormat  format       = pick_pixel_data_format(src_encoding, num_channels);
-    const MipLevel         level        = int(mip_id);
+    const MipLevel         level        = int(mip_id - base_mip);
     const Extent2I         resolution   = Extent2I(mip.width, mip.height);
     const Span<const byte> src_bytes    = file.mip_bytes(mip_id);
 
@@ -506,8 +582,122 @@ auto upload_mip(
     );
 };
 
+struct TextureStorage
+{
+    SharedTexture2D    texture;
+    SharedTextureLease lease; // Null if not in the pool.
+};
+
+// Allocate the storage for the mips [base_mip, num_mips) of the file.
+// Must be called from the offscreen context.
+auto allocate_texture_storage(
+    ResourceLoaderContext& context,
+    const TextureFile&     file,
+    InternalFormat         iformat,
+    u8                     base_mip)
+        -> TextureStorage
+{
+    const auto&     mip        = file.mip_span(base_mip);
+    const Extent2I  resolution = Extent2I(mip.width, mip.height);
+    const NumLevels num_levels = file.header().num_mips - base_mip;
+
+    // Prefer a layer in the pool, so that the materials could be batched together.
+    // The texture is then a view of that layer, and nobody else needs to know.
+    // This fails if the pool is disabled, as it is unless something draws from it.
+    //
+    // Only the full chain is pooled. The pages are keyed by the number of levels,
+    // so each partial range of a streamed texture would take a page of its own.
+    auto pooled = base_mip == 0 ?
+        context.texture_pool().try_allocate(resolution, iformat, num_levels) :
+        nullopt;
+
+    TextureStorage storage = pooled ?
+        TextureStorage{
+            .texture = SharedTexture2D(MOVE(pooled->view)),
+            .lease   = MOVE(pooled->lease),
+        } :
+        TextureStorage{
+            .texture = SharedTexture2D(allocate_texture<TextureTarget::Texture2D>(resolution, iformat, num_levels)),
+            .lease   = nullptr,
+        };
+
+    storage.texture->set_sampler_min_mag_filters(MinFilter::LinearMipmapLinear, MagFilter::Linear);
+    return storage;
+}
+
+// Fault-in and upload the mips [beg_mip, end_mip) of the file, coarsest first,
+// into the texture that stores `base_mip` at level 0. Does not fence.
+// Must be called from the offscreen context, and resumes there.
+auto upload_mip_range(
+    ResourceLoaderContext& context,
+    const TextureFile&     file,
+    RawTexture2D<>         texture,
+    u8                     beg_mip,
+    u8                     end_mip,
+    u8                     base_mip)
+        -> Job<>
+{
+    if (beg_mip == end_mip) co_return;
+
+    const auto mip_ids = reverse(irange(beg_mip, end_mip));
+
+    // Fault-in the MIPs on the IO threads before decoding or uploading them,
+    // then hint the OS about the MIPs that will be needed next.
+    SmallVector<Span<const ubyte>, 3> mip_bytes;
+    for (const auto mip_id : mip_ids)
+        mip_bytes.emplace_back(file.mip_bytes(mip_id));
+
+    co_await context.io_context().until_all_resident_on(context.thread_pool(), mip_bytes);
+
+    if (beg_mip != 0)
+    {
+        const auto [next_beg_mip, next_end_mip] = next_lod_range(beg_mip, file.header().num_mips);
+        for (const auto mip_id : irange(next_beg_mip, next_end_mip))
+            IOContext::advise_willneed(file.mip_bytes(mip_id));
+    }
+
+    SmallVector<Job<>, 3> upload_jobs;
+    for (const auto mip_id : mip_ids)
+    {
+        const auto encoding = file.mip_span(mip_id).encoding;
+
+        if (needs_decoding(encoding))
+            upload_jobs.emplace_back(decode_and_upload_mip(context, file, texture, mip_id, base_mip));
+        else
+            upload_jobs.emplace_back(upload_mip(context, file, texture, mip_id, base_mip));
+    }
+
+    // NOTE: All uploading jobs are finishing in the offscreen
+    // context, so the last one will resume there too.
+    // TODO: Ready or succeed? Do we care? How can it fail anyway?
+    co_await until_all_succeed(upload_jobs);
+}
+
+
 } // namespace
 
+/*
+Textures are either loaded fully or streamed, depending on whether the
+TextureResidency is enabled when the loading starts.
+
+When loading fully, the full chain of mips is allocated once, and the mips
+are uploaded into it one at a time, coarsest first, with the base level
+clamped to the finest mip uploaded so far.
+
+When streaming, the storage of the texture only holds the resident mips, so
+that the dropped mips actually free the memory. Each change of the resident
+range allocates new storage, copies the mips that are kept from the old one,
+uploads the new mips, and swaps the storage in the resource.
+
+The mips are streamed in one at a time, coarsest first, down to the target
+of the TextureResidency. Dropping the mips needs nothing from the file, so
+that is done in a single step. In between, the loader is parked until the
+target changes. If the residency is disabled while streaming, the rest of
+the mips are streamed in a single step, and the resource is marked complete.
+
+When the residency is stopped, the resource is marked complete with whatever
+mips are resident at that point.
+*/
 auto load_texture(
     ResourceLoaderContext context,
     UUID                  uuid)
@@ -519,78 +709,167 @@ try
     auto file = TextureFile::open(context.resource_database().map_resource(uuid));
     const auto& header = file.header();
 
-    co_await reschedule_to(context.offscreen_context());
-
-    SharedTexture2D texture;
     const auto           num_channels = header.num_channels;
     const FileColorspace colorspace   = header.colorspace;
-    const NumLevels      num_mips     = header.num_mips;
-    const auto&          mip0         = file.mip_span(0);
-    const Extent2I       resolution0  = Extent2I(mip0.width, mip0.height);
+    const u8             num_mips     = header.num_mips;
     const InternalFormat iformat      = pick_internal_format(colorspace, num_channels);
-    texture->allocate_storage(resolution0, iformat, num_mips);
-    texture->set_sampler_min_mag_filters(MinFilter::LinearMipmapLinear, MagFilter::Linear);
 
-    // - Upload MIP range
-    // - Clamp MIPs
-    // - Update (ask the user to not touch the other lods?)
+    TextureResidency& residency = context.texture_residency();
 
-    SmallVector<Job<>, 3> upload_jobs;
+    auto usage    = ResourceUsage();
+    auto progress = ResourceProgress::Incomplete;
 
-    auto usage      = ResourceUsage();
-    auto progress   = ResourceProgress::Incomplete;
-    u8   cur_mip    = num_mips;
-    bool first_time = true;
-    do
+    Optional<TextureStorage> storage;
+
+    if (not residency.is_enabled())
     {
-        // FIXME: next_lod_range() is really dumb, and unsuitable for textures.
-        const auto [beg_mip, end_mip] = next_lod_range(cur_mip, num_mips);
-        const auto mip_ids            = reverse(irange(beg_mip, end_mip));
-        cur_mip = beg_mip;
-
-        // Upload data for new mips.
-        upload_jobs.clear();
-        for (const auto mip_id : mip_ids)
-        {
-            const auto encoding = file.mip_span(mip_id).encoding;
+        co_await reschedule_to(context.offscreen_context());
 
-            if (needs_decoding(encoding))
-                upload_jobs.emplace_back(decode_and_upload_mip(context, file, texture, mip_id));
-            else
-                upload_jobs.emplace_back(upload_mip(context, file, texture, mip_id));
-        }
+        const TextureStorage full = allocate_texture_storage(context, file, iformat, 0);
 
-        // NOTE: All uploading jobs are finishing in the offscreen
-        // context, so the last one will resume there too.
-        // TODO: Ready or succeed? Do we care? How can it fail anyway?
-        co_await until_all_succeed(upload_jobs);
+        u8 cur_mip = num_mips;
+        while (cur_mip != 0 and not residency.is_stopped())
+        {
+            // FIXME: next_lod_range() is really dumb, and unsuitable for textures.
+            const auto [beg_mip, end_mip] = next_lod_range(cur_mip, num_mips);
+            cur_mip = beg_mip;
 
-        // NOTE: Only fencing after uploading multiple MIPs in a batch.
-        co_await context.completion_context().until_ready_on(context.offscreen_context(), create_fence());
+            co_await upload_mip_range(context, file, full.texture, beg_mip, end_mip, 0);
 
-        if (cur_mip == 0) progress = ResourceProgress::Complete;
+            // NOTE: Only fencing after uploading multiple MIPs in a batch.
+            co_await context.completion_context().until_ready_on(context.offscreen_context(), create_fence());
+
+            if (cur_mip == 0) progress = ResourceProgress::Complete;
 
-        if (first_time)
-        {
-            first_time = false;
             // Clamp available MIP region.
             // NOTE: This will explode if not done from the GPU context.
-            texture->set_base_level(cur_mip);
-            usage = context.create_resource<RT::Texture>(uuid, progress, TextureResource{
-                .texture = texture
-            });
+            if (not storage)
+            {
+                full.texture->set_base_level(cur_mip);
+                if (full.lease) full.lease->set_base_level(cur_mip);
+                usage = context.create_resource<RT::Texture>(uuid, progress, TextureResource{
+                    .texture = full.texture,
+                    .lease   = full.lease,
+                });
+                storage = full;
+            }
+            else
+            {
+                context.update_resource<RT::Texture>(uuid, [&](TextureResource&)
+                    -> ResourceProgress
+                {
+                    full.texture->set_base_level(cur_mip);
+                    if (full.lease) full.lease->set_base_level(cur_mip);
+                    return progress;
+                });
+            }
         }
-        else
+    }
+    else
+    {
+        // NOTE: Only an estimate for the budget, the drivers pad as they like.
+        SmallVector<usize, 16> mip_sizes;
+        for (const u8 mip_id : irange(num_mips))
         {
-            context.update_resource<RT::Texture>(uuid, [&](TextureResource& resource)
-                -> ResourceProgress
+            const auto& mip = file.mip_span(mip_id);
+            mip_sizes.emplace_back(usize(mip.width) * mip.height * num_channels);
+        }
+
+        const auto& mip0 = file.mip_span(0);
+        residency.track(uuid, Extent2I(mip0.width, mip0.height), mip_sizes);
+        DEFER(residency.forget(uuid));
+
+        u8 resident = num_mips; // Nothing is resident yet.
+
+        while (not residency.is_stopped())
+        {
+            const u8 target = residency.target(uuid);
+
+            // FIXME: next_lod_range() is really dumb, and unsuitable for textures.
+            // If the residency got disabled, do not bother with the steps.
+            u8 next_mip = resident;
+            if (target < resident) next_mip = residency.is_enabled() ?
+                std::max(target, next_lod_range(resident, num_mips).beg_lod) : target;
+            if (target > resident) next_mip = target;
+
+            if (next_mip == resident)
             {
-                texture->set_base_level(cur_mip);
-                return progress; // This is very awkward.
-            });
+                if (resident == 0 and not residency.is_enabled())
+                    break;
+
+                // Park until the demand or the budget changes the target.
+                // Always ready if the residency is not enabled.
+                co_await context.completion_context().until_ready_on(context.thread_pool(),
+                    residency.until_target_differs(uuid, resident));
+                continue;
+            }
+
+            co_await reschedule_to(context.offscreen_context());
+
+            TextureStorage new_storage = allocate_texture_storage(context, file, iformat, next_mip);
+
+            // Mips [next_mip, kept_mip) are new, the rest is copied from the old storage.
+            const u8 kept_mip = std::max(next_mip, resident);
+
+            if (storage)
+            {
+                for (const u8 mip_id : irange(kept_mip, num_mips))
+                {
+                    const auto&    mip    = file.mip_span(mip_id);
+                    const Extent2I extent = Extent2I(mip.width, mip.height);
+                    storage->texture->copy_image_region_to({}, extent, new_storage.texture.get(), {},
+                        MipLevel{ mip_id - resident }, MipLevel{ mip_id - next_mip });
+                }
+            }
+
+            co_await upload_mip_range(context, file, new_storage.texture, next_mip, kept_mip, next_mip);
+
+            // NOTE: Only fencing after uploading multiple MIPs in a batch.
+            co_await context.completion_context().until_ready_on(context.offscreen_context(), create_fence());
+
+            if (next_mip == 0 and not residency.is_enabled())
+                progress = ResourceProgress::Complete;
+
+            if (not storage)
+            {
+                usage = context.create_resource<RT::Texture>(uuid, progress, TextureResource{
+                    .texture = new_storage.texture,
+                    .lease   = new_storage.lease,
+                });
+            }
+            else
+            {
+                context.update_resource<RT::Texture>(uuid, [&](TextureResource& resource)
+                    -> ResourceProgress
+                {
+                    resource.texture = new_storage.texture;
+                    resource.lease   = new_storage.lease;
+                    return progress;
+                });
+            }
+
+            storage  = MOVE(new_storage);
+            resident = next_mip;
+            residency.set_resident(uuid, resident);
+
+            if (progress == ResourceProgress::Complete)
+                break;
         }
     }
-    while (cur_mip != 0);
+
+    // Stopped before the first mip was resident, there is no resource to complete.
+    if (not storage)
+        throw RuntimeError("Texture loading was stopped.");
+
+    // The residency was disabled while parked at mip 0, or stopped.
+    if (progress != ResourceProgress::Complete)
+    {
+        context.update_resource<RT::Texture>(uuid, [](TextureResource&)
+            -> ResourceProgress
+        {
+            return ResourceProgress::Complete;
+        });
+    }
 }
 catch(...)
 {
@@ -28,7 +28,7 @@ auto please_type_pun(SrcT* from)
     // Can I have my sane type-punnig already?
 }
 
-auto mapping_bytes(const MappedRegion& mapping) noexcept
+auto mapping_bytes(const MappedView& mapping) noexcept
     -> ubyte*
 {
     return (ubyte*)mapping.get_address();
@@ -36,7 +36,7 @@ auto mapping_bytes(const MappedRegion& mapping) noexcept
 
 // Convenience for single-hop access to an object at a given file offset.
 template<typename T>
-auto ptr_at_offset(const MappedRegion& mregion, usize offset_bytes) noexcept
+auto ptr_at_offset(const MappedView& mregion, usize offset_bytes) noexcept
     -> T*
 {
     return please_type_pun<T>(mapping_bytes(mregion) + offset_bytes);
@@ -70,7 +70,7 @@ void throw_if_mismatched_preamble(const ResourcePreamble& preamble) noexcept(fal
 
 // Headers are always assumed to be at the very beginning of a mapping.
 template<typename HeaderT>
-void write_header_to(MappedRegion& mapping, const HeaderT& src) noexcept
+void write_header_to(MappedView& mapping, const HeaderT& src) noexcept
 {
     std::memcpy(mapping_bytes(mapping), &src, sizeof(HeaderT));
     mapping.flush(0, sizeof(HeaderT));
@@ -121,7 +121,7 @@ auto SkeletonFile::required_size(const Args& args) noexcept
     return total_size;
 }
 
-auto SkeletonFile::create_in(MappedRegion mapped_region, UUID self_uuid, const Args& args)
+auto SkeletonFile::create_in(MappedView mapped_region, UUID self_uuid, const Args& args)
     -> SkeletonFile
 {
     assert(required_size(args) == mapped_region.get_size());
@@ -141,7 +141,7 @@ auto SkeletonFile::create_in(MappedRegion mapped_region, UUID self_uuid, const A
     return file;
 }
 
-auto SkeletonFile::open(MappedRegion mapped_region)
+auto SkeletonFile::open(MappedView mapped_region)
     -> SkeletonFile
 {
     SkeletonFile file{ MOVE(mapped_region) };
@@ -239,7 +239,7 @@ auto AnimationFile::required_size(const Args& args) noexcept
     return header_size + joint_spans_size + all_keyframes_size;
 }
 
-auto AnimationFile::create_in(MappedRegion mapped_region, UUID self_uuid, const Args& args)
+auto AnimationFile::create_in(MappedView mapped_region, UUID self_uuid, const Args& args)
     -> AnimationFile
 {
     assert(required_size(args) == mapped_region.get_size());
@@ -288,7 +288,7 @@ auto AnimationFile::create_in(MappedRegion mapped_region, UUID self_uuid, const
     return file;
 }
 
-auto AnimationFile::open(MappedRegion mapped_region)
+auto AnimationFile::open(MappedView mapped_region)
     -> AnimationFile
 {
     AnimationFile file{ MOVE(mapped_region) };
@@ -362,7 +362,7 @@ auto StaticMeshFile::required_size(const Args& args) noexcept
     return total_size;
 }
 
-auto StaticMeshFile::create_in(MappedRegion mapped_region, UUID self_uuid, const Args& args)
+auto StaticMeshFile::create_in(MappedView mapped_region, UUID self_uuid, const Args& args)
     -> StaticMeshFile
 {
     assert(required_size(args) == mapped_region.get_size());
@@ -410,7 +410,7 @@ auto StaticMeshFile::create_in(MappedRegion mapped_region, UUID self_uuid, const
     return file;
 }
 
-auto StaticMeshFile::open(MappedRegion mapped_region)
+auto StaticMeshFile::open(MappedView mapped_region)
     -> StaticMeshFile
 {
     StaticMeshFile file{ MOVE(mapped_region) };
@@ -492,7 +492,7 @@ auto SkinnedMeshFile::required_size(const Args& args) noexcept
     return total_size;
 }
 
-auto SkinnedMeshFile::create_in(MappedRegion mapped_region, UUID self_uuid, const Args& args)
+auto SkinnedMeshFile::create_in(MappedView mapped_region, UUID self_uuid, const Args& args)
     -> SkinnedMeshFile
 {
     assert(required_size(args) == mapped_region.get_size());
@@ -541,7 +541,7 @@ auto SkinnedMeshFile::create_in(MappedRegion mapped_region, UUID self_uuid, cons
     return file;
 }
 
-auto SkinnedMeshFile::open(MappedRegion mapped_region)
+auto SkinnedMeshFile::open(MappedView mapped_region)
     -> SkinnedMeshFile
 {
     SkinnedMeshFile file{ MOVE(mapped_region) };
@@ -605,7 +605,7 @@ auto TextureFile::required_size(const Args& args) noexcept
     return total_size;
 }
 
-auto TextureFile::create_in(MappedRegion mapped_region, UUID self_uuid, const Args& args)
+auto TextureFile::create_in(MappedView mapped_region, UUID self_uuid, const Args& args)
     -> TextureFile
 {
     assert(required_size(args) == mapped_region.get_size());
@@ -648,7 +648,7 @@ auto TextureFile::create_in(MappedRegion mapped_region, UUID self_uuid, const Ar
     return file;
 }
 
-auto TextureFile::open(MappedRegion mapped_region)
+auto TextureFile::open(MappedView mapped_region)
     -> TextureFile
 {
     TextureFile file{ MOVE(mapped_region) };
@@ -71,11 +71,11 @@ public:
         -> usize;
 
     [[nodiscard]]
-    static auto create_in(MappedRegion mapped_region, UUID self_uuid, const Args& args)
+    static auto create_in(MappedView mapped_region, UUID self_uuid, const Args& args)
         -> SkeletonFile;
 
     [[nodiscard]]
-    static auto open(MappedRegion mapped_region)
+    static auto open(MappedView mapped_region)
         -> SkeletonFile;
 
     auto size_bytes()  const noexcept -> usize { return mregion_.get_size(); }
@@ -85,8 +85,8 @@ public:
     auto joint_names() const noexcept -> Span<ResourceName>;
 
 private:
-    SkeletonFile(MappedRegion mregion) : mregion_(MOVE(mregion)) {}
-    MappedRegion mregion_;
+    SkeletonFile(MappedView mregion) : mregion_(MOVE(mregion)) {}
+    MappedView mregion_;
 };
 
 /*
@@ -203,11 +203,11 @@ public:
         -> usize;
 
     [[nodiscard]]
-    static auto create_in(MappedRegion mapped_region, UUID self_uuid, const Args& args)
+    static auto create_in(MappedView mapped_region, UUID self_uuid, const Args& args)
         -> AnimationFile;
 
     [[nodiscard]]
-    static auto open(MappedRegion mapped_region)
+    static auto open(MappedView mapped_region)
         -> AnimationFile;
 
     auto size_bytes() const noexcept -> usize { return mregion_.get_size(); }
@@ -221,8 +221,8 @@ public:
     auto sca_keys        (uindex joint_id) const noexcept -> Span<KeyVec3>;
 
 private:
-    AnimationFile(MappedRegion mregion) : mregion_(MOVE(mregion)) {}
-    MappedRegion mregion_;
+    AnimationFile(MappedView mregion) : mregion_(MOVE(mregion)) {}
+    MappedView mregion_;
 };
 
 /*
@@ -291,11 +291,11 @@ public:
         -> usize;
 
     [[nodiscard]]
-    static auto create_in(MappedRegion mapped_region, UUID self_uuid, const Args& args)
+    static auto create_in(MappedView mapped_region, UUID self_uuid, const Args& args)
         -> StaticMeshFile;
 
     [[nodiscard]]
-    static auto open(MappedRegion mapped_region)
+    static auto open(MappedView mapped_region)
         -> StaticMeshFile;
 
     auto size_bytes() const noexcept -> usize { return mregion_.get_size(); }
@@ -307,8 +307,8 @@ public:
     auto lod_elems_bytes(uindex lod_id) const noexcept -> Span<ubyte>;
 
 private:
-    StaticMeshFile(MappedRegion mregion) : mregion_(MOVE(mregion)) {}
-    MappedRegion mregion_;
+    StaticMeshFile(MappedView mregion) : mregion_(MOVE(mregion)) {}
+    MappedView mregion_;
 };
 
 /*
@@ -379,11 +379,11 @@ public:
         -> usize;
 
     [[nodiscard]]
-    static auto create_in(MappedRegion mapped_region, UUID self_uuid, const Args& args)
+    static auto create_in(MappedView mapped_region, UUID self_uuid, const Args& args)
         -> SkinnedMeshFile;
 
     [[nodiscard]]
-    static auto open(MappedRegion mapped_region)
+    static auto open(MappedView mapped_region)
         -> SkinnedMeshFile;
 
     auto size_bytes() const noexcept -> usize { return mregion_.get_size(); }
@@ -395,8 +395,8 @@ public:
     auto lod_elems_bytes(uindex lod_id) const noexcept -> Span<ubyte>;
 
 private:
-    SkinnedMeshFile(MappedRegion mregion) : mregion_(MOVE(mregion)) {}
-    MappedRegion mregion_;
+    SkinnedMeshFile(MappedView mregion) : mregion_(MOVE(mregion)) {}
+    MappedView mregion_;
 };
 
 /*
@@ -494,11 +494,11 @@ public:
         -> usize;
 
     [[nodiscard]]
-    static auto create_in(MappedRegion mapped_region, UUID self_uuid, const Args& args)
+    static auto create_in(MappedView mapped_region, UUID self_uuid, const Args& args)
         -> TextureFile;
 
     [[nodiscard]]
-    static auto open(MappedRegion mapped_region)
+    static auto open(MappedView mapped_region)
         -> TextureFile;
 
     auto size_bytes() const noexcept -> usize { return mregion_.get_size(); }
@@ -509,8 +509,8 @@ public:
     auto mip_bytes(uindex mip_id) const noexcept -> Span<ubyte>;
 
 private:
-    TextureFile(MappedRegion mregion) : mregion_(MOVE(mregion)) {}
-    MappedRegion mregion_;
+    TextureFile(MappedView mregion) : mregion_(MOVE(mregion)) {}
+    MappedView mregion_;
 };
 
 JOSH3D_DEFINE_ENUM_EXTRAS(TextureFile::Encoding, RAW, PNG, BC7);
@@ -10,8 +10,10 @@
 #include "ImageProperties.hpp"
 #include "LODPack.hpp"
 #include "MeshStorage.hpp"
+#include "MipChain.hpp"
 #include "Resource.hpp"
 #include "SkeletalAnimation.hpp"
+#include "TexturePool.hpp"
 #include "Skeleton.hpp"
 #include "Transform.hpp"
 #include "UUID.hpp"
@@ -97,7 +99,8 @@ JOSH3D_DEFINE_RESOURCE_EXTRAS(SkinnedMesh, SkinnedMeshResource);
 
 struct TextureResource
 {
-    SharedTexture2D texture;
+    SharedTexture2D    texture;
+    SharedTextureLease lease; // Null if the texture is not in the TexturePool.
 };
 JOSH3D_DEFINE_RESOURCE_EXTRAS(Texture, TextureResource);
 
@@ -260,6 +263,7 @@ struct ImportTextureParams
     ImportEncoding encoding;
     Colorspace     colorspace;
     bool           generate_mips = true;
+    MipFilter      mip_filter    = MipFilter::Kaiser;
 };
 
 auto import_texture(
@@ -1,6 +1,8 @@
 #include "DefaultTextures.hpp"
 #include "Resources.hpp"
 #include "Common.hpp"
+#include "Active.hpp"
+#include "Camera.hpp"
 #include "Components.hpp"
 #include "async/CoroCore.hpp"
 #include "async/Coroutines.hpp"
@@ -10,12 +12,16 @@
 #include "ResourceRegistry.hpp"
 #include "ResourceUnpacker.hpp"
 #include "ECS.hpp"
+#include "Geometry.hpp"
+#include "GeometryCollision.hpp"
 #include "Scalars.hpp"
 #include "SceneGraph.hpp"
 #include "components/SkinnedMesh.hpp"
 #include "components/StaticMesh.hpp"
 #include "Tags.hpp"
+#include "Transform.hpp"
 #include "components/AlphaTested.hpp"
+#include <algorithm>
 
 
 namespace josh {
@@ -162,6 +168,7 @@ auto unpack_material_texture(
     uintptr                                  aba_tag,
     decltype(&MaterialPhong::diffuse)        slot_mptr,
     decltype(&MaterialPhong::diffuse_usage)  usage_slot_mptr,
+    decltype(&MaterialPhong::diffuse_lease)  lease_slot_mptr,
     invocable<Handle, MaterialPhong&> auto&& post_init)
         -> Job<>
 {
@@ -197,6 +204,7 @@ auto unpack_material_texture(
 
         mtl.*slot_mptr       = MOVE(resource.texture);
         mtl.*usage_slot_mptr = MOVE(usage);
+        mtl.*lease_slot_mptr = MOVE(resource.lease);
 
         post_init(handle, mtl);
     }
@@ -219,7 +227,8 @@ auto unpack_material_texture(
         if (mtl.aba_tag != aba_tag)
             co_return bail();
 
-        mtl.*slot_mptr = MOVE(resource.texture);
+        mtl.*slot_mptr       = MOVE(resource.texture);
+        mtl.*lease_slot_mptr = MOVE(resource.lease);
     }
 }
 
@@ -255,15 +264,15 @@ auto unpack_material(
 
     if (not material.diffuse_uuid.is_nil())
         jobs.push_back(unpack_material_texture(context, material.diffuse_uuid, handle, aba_tag,
-            &MaterialPhong::diffuse, &MaterialPhong::diffuse_usage, set_atested));
+            &MaterialPhong::diffuse, &MaterialPhong::diffuse_usage, &MaterialPhong::diffuse_lease, set_atested));
 
     if (not material.normal_uuid.is_nil())
         jobs.push_back(unpack_material_texture(context, material.normal_uuid, handle, aba_tag,
-            &MaterialPhong::normal, &MaterialPhong::normal_usage, no_op));
+            &MaterialPhong::normal, &MaterialPhong::normal_usage, &MaterialPhong::normal_lease, no_op));
 
     if (not material.specular_uuid.is_nil())
         jobs.push_back(unpack_material_texture(context, material.specular_uuid, handle, aba_tag,
-            &MaterialPhong::specular, &MaterialPhong::specular_usage, set_specpower));
+            &MaterialPhong::specular, &MaterialPhong::specular_usage, &MaterialPhong::specular_lease, set_specpower));
 
     co_await until_all_succeed(jobs);
 }
@@ -278,12 +287,88 @@ auto unpack_mdesc(
 
     StaticVector<Job<>, 2> jobs;
 
-    jobs.emplace_back(context.unpacker().unpack_any(mdesc.mesh_uuid, handle));
-    jobs.emplace_back(context.unpacker().unpack<RT::Material>(mdesc.material_uuid, handle));
+    jobs.emplace_back(context.unpacker().unpack_any(mdesc.mesh_uuid, handle, context.priority()));
+    jobs.emplace_back(context.unpacker().unpack<RT::Material>(mdesc.material_uuid, handle, context.priority()));
 
     co_await until_all_succeed(jobs);
 }
 
+namespace {
+
+struct NodeUnpackOrder
+{
+    uindex       node_idx;
+    TaskPriority priority;
+};
+
+/*
+Returns the nodes that have something to unpack, sorted by the distance
+from the active camera. Nodes in view get high priority, and the rest low.
+
+The nodes have no bounds until their resources are loaded,
+so only the node origins are tested against the view frustum.
+
+If there is no active camera, keeps the scene order with normal priority.
+
+PRE: `nodes` are in pre-order.
+PRE: Must be called from the local context, since this reads the registry.
+*/
+auto order_nodes_for_unpacking(
+    Span<const SceneResource::Node> nodes,
+    Handle                          scene_handle)
+        -> Vector<NodeUnpackOrder>
+{
+    Vector<NodeUnpackOrder> order; order.reserve(nodes.size());
+
+    const auto camera = get_active<Camera, MTransform>(*scene_handle.registry());
+
+    if (not camera)
+    {
+        for (const uindex i : irange(nodes.size()))
+            if (not nodes[i].uuid.is_nil())
+                order.push_back({ i, TaskPriority::Normal });
+        return order;
+    }
+
+    const mat4 root_mat = eval%[&]() -> mat4 {
+        if (const auto* mtf = scene_handle.try_get<MTransform>()) return mtf->model();
+        return glm::identity<mat4>();
+    };
+
+    // Pre-order guarantees that the parents are resolved before their children.
+    Vector<mat4> world_mats; world_mats.resize(nodes.size());
+    for (const uindex i : irange(nodes.size()))
+    {
+        const auto& node       = nodes[i];
+        const mat4& parent_mat = (node.parent_index == SceneResource::Node::no_parent) ?
+            root_mat : world_mats[node.parent_index];
+        world_mats[i] = parent_mat * node.transform.mtransform().model();
+    }
+
+    const mat4 camera_mat     = camera.get<MTransform>().model();
+    const vec3 camera_pos     = vec3(camera_mat[3]);
+    const auto frustum_world  = camera.get<Camera>().view_frustum_as_planes().transformed(camera_mat);
+
+    Vector<float> distances2; distances2.resize(nodes.size());
+    for (const uindex i : irange(nodes.size()))
+    {
+        if (nodes[i].uuid.is_nil()) continue;
+
+        const vec3 position = vec3(world_mats[i][3]);
+        const vec3 to_node  = position - camera_pos;
+        const bool in_view  = not is_fully_outside_of(Sphere{ .position = position }, frustum_world);
+
+        distances2[i] = glm::dot(to_node, to_node);
+        order.push_back({ i, in_view ? TaskPriority::High : TaskPriority::Low });
+    }
+
+    std::ranges::stable_sort(order, {}, [&](const NodeUnpackOrder& o) { return distances2[o.node_idx]; });
+
+    return order;
+}
+
+} // namespace
+
 auto unpack_scene(
     ResourceUnpackerContext context,
     UUID                    uuid,
@@ -318,9 +403,17 @@ auto unpack_scene(
 
     registry.create(new_entities.begin(), new_entities.end());
 
-    for (const auto [node, entity] : zip(nodes, new_entities))
+    // The nodes are emplaced in batches, rescheduling in-between, so that
+    // a budgeted flush of the local context could split this across frames.
+    constexpr usize batch_size = 1024;
+
+    for (const uindex i : irange(nodes.size()))
     {
-        const Handle node_handle = { registry, entity };
+        if (i != 0 and i % batch_size == 0)
+            co_await reschedule_to(context.local_context());
+
+        const auto&  node        = nodes[i];
+        const Handle node_handle = { registry, new_entities[i] };
         node_handle.emplace<Transform>(node.transform);
         if (node.parent_index != SceneResource::Node::no_parent)
         {
@@ -334,11 +427,15 @@ auto unpack_scene(
         }
     }
 
-    for (const auto [node, entity] : zip(nodes, new_entities))
+    // Unpack nodes closest to the camera first, and the ones in view with a higher priority,
+    // so that a large scene fills in from the viewer outwards over a number of frames.
+    const Vector<NodeUnpackOrder> order = order_nodes_for_unpacking(nodes, handle);
+
+    for (const auto& [node_idx, priority] : order)
     {
-        const Handle handle = { registry, entity };
-        if (not node.uuid.is_nil())
-            entity_jobs.emplace_back(context.unpacker().unpack_any(node.uuid, handle));
+        const auto&  node   = nodes[node_idx];
+        const Handle handle = { registry, new_entities[node_idx] };
+        entity_jobs.emplace_back(context.unpacker().unpack_any(node.uuid, handle, priority));
     }
 
     co_await until_all_succeed(entity_jobs);
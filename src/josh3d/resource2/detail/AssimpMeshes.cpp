@@ -3,7 +3,11 @@
 #include "Asset.hpp"
 #include "AssetImporter.hpp"
 #include "async/CoroCore.hpp"
+#include "ContainerUtils.hpp"
+#include "ContentHash.hpp"
 #include "default/ResourceFiles.hpp"
+#include "Processing.hpp"
+#include "ScopeExit.hpp"
 #include "VertexFormats.hpp"
 #include <assimp/mesh.h>
 #include <jsoncons/json.hpp>
@@ -73,9 +77,11 @@ void extract_skinned_mesh_verts_to(
 }
 
 
+// Extracts vertices [first_vert, first_vert + out_verts.size()).
 void extract_static_mesh_verts_to(
     Span<VertexStatic> out_verts,
-    const aiMesh*      ai_mesh)
+    const aiMesh*      ai_mesh,
+    size_t             first_vert = 0)
 {
     auto positions  = make_span(ai_mesh->mVertices,         ai_mesh->mNumVertices);
     auto uvs        = make_span(ai_mesh->mTextureCoords[0], ai_mesh->mNumVertices);
@@ -86,10 +92,11 @@ void extract_static_mesh_verts_to(
     if (!uvs.data())        { throw AssetContentsParsingError("Mesh data does not contain UVs.");        }
     if (!tangents.data())   { throw AssetContentsParsingError("Mesh data does not contain Tangents.");   }
 
-    assert(out_verts.size() == positions.size());
+    assert(first_vert + out_verts.size() <= positions.size());
 
-    for (size_t i{ 0 }; i < out_verts.size(); ++i) {
-        out_verts[i] = VertexStatic::pack(
+    for (size_t j{ 0 }; j < out_verts.size(); ++j) {
+        const size_t i = first_vert + j;
+        out_verts[j] = VertexStatic::pack(
             v2v(positions[i]),
             v2v(uvs      [i]),
             v2v(normals  [i]),
@@ -99,17 +106,20 @@ void extract_static_mesh_verts_to(
 }
 
 
+// Extracts elements of faces [first_face, first_face + out_elems.size() / 3).
 void extract_mesh_elems_to(
     Span<uint32_t> out_elems,
-    const aiMesh*  ai_mesh)
+    const aiMesh*  ai_mesh,
+    size_t         first_face = 0)
 {
     auto faces = make_span(ai_mesh->mFaces, ai_mesh->mNumFaces);
 
-    assert(out_elems.size() == faces.size() * 3);
+    assert(out_elems.size() % 3 == 0);
+    assert(first_face + out_elems.size() / 3 <= faces.size());
 
-    for (size_t f{ 0 }; f < faces.size(); ++f) {
-        const size_t  e    = f * 3; // Index of the first element in the face.
-        const aiFace& face = faces[f];
+    for (size_t j{ 0 }; j < out_elems.size() / 3; ++j) {
+        const size_t  e    = j * 3; // Index of the first element in the face.
+        const aiFace& face = faces[first_face + j];
         assert(face.mNumIndices == 3); // Must be guaranteed by the aiProcess_Triangulate flag.
         out_elems[e + 0] = face.mIndices[0];
         out_elems[e + 1] = face.mIndices[1];
@@ -118,6 +128,68 @@ void extract_mesh_elems_to(
 }
 
 
+// Hashes everything that ends up in the mesh file from the `ai_mesh`.
+//
+// NOTE: Hashing the source arrays, not the packed vertices. Those have padding,
+// and this way the duplicate is found before any resource is created.
+void hash_mesh_content_to(ContentHasher& hasher, const aiMesh* ai_mesh)
+{
+    const size_t num_verts = ai_mesh->mNumVertices;
+
+    // Missing arrays are rejected during extraction anyway.
+    const auto hash_array = [&](const aiVector3D* array)
+    {
+        hasher.update_value(u8(array != nullptr));
+        if (array) hasher.update(array, num_verts * sizeof(aiVector3D));
+    };
+
+    hasher.update_value(u64(num_verts));
+    hash_array(ai_mesh->mVertices);
+    hash_array(ai_mesh->mTextureCoords[0]);
+    hash_array(ai_mesh->mNormals);
+    hash_array(ai_mesh->mTangents);
+
+    hasher.update_value(u64(ai_mesh->mNumFaces));
+    for (const aiFace& face : make_span(ai_mesh->mFaces, ai_mesh->mNumFaces))
+        hasher.update(face.mIndices, face.mNumIndices * sizeof(face.mIndices[0]));
+
+    hasher.update_value(ai_mesh->mAABB);
+}
+
+
+void hash_mesh_joints_to(
+    ContentHasher&                        hasher,
+    const aiMesh*                         ai_mesh,
+    const HashMap<const aiNode*, size_t>& node2jointid)
+{
+    hasher.update_value(u64(ai_mesh->mNumBones));
+    for (const aiBone* bone : make_span(ai_mesh->mBones, ai_mesh->mNumBones))
+    {
+        const auto* jointid = try_find(node2jointid, bone->mNode);
+        hasher.update_value(u64(jointid ? jointid->second : -1));
+        hasher.update_value(u64(bone->mNumWeights));
+        hasher.update(bone->mWeights, bone->mNumWeights * sizeof(aiVertexWeight));
+    }
+}
+
+
+// Meshes above this number of vertices or faces are extracted in parallel chunks.
+constexpr size_t mesh_chunk_size = 64 * 1024;
+
+
+auto extract_mesh_elems_chunked(
+    AssetImporterContext& context,
+    Span<uint32_t>        out_elems,
+    const aiMesh*         ai_mesh)
+        -> Job<>
+{
+    return for_each_chunk_on(context.thread_pool(), out_elems.size() / 3, mesh_chunk_size,
+        [=](size_t first_face, size_t num_faces) {
+            extract_mesh_elems_to(out_elems.subspan(first_face * 3, num_faces * 3), ai_mesh, first_face);
+        });
+}
+
+
 } // namespace
 
 
@@ -128,6 +200,17 @@ auto import_static_mesh_async(
 {
     co_await reschedule_to(context.thread_pool());
 
+    const ResourceType resource_type = StaticMeshFile::resource_type;
+    const ContentHash  content_hash  = eval%[&]{
+        ContentHasher hasher;
+        hasher.update_value(resource_type);
+        hash_mesh_content_to(hasher, ai_mesh);
+        return hasher.digest();
+    };
+
+    if (const Optional existing = context.resource_database().find_by_content(resource_type, content_hash))
+        co_return *existing;
+
     const ResourcePathHint path_hint{
         .directory = "meshes",
         .name      = s2sv(ai_mesh->mName),
@@ -156,8 +239,7 @@ auto import_static_mesh_async(
         .lod_specs = spec,
     };
 
-    const size_t       file_size     = StaticMeshFile::required_size(args);
-    const ResourceType resource_type = StaticMeshFile::resource_type;
+    const size_t file_size = StaticMeshFile::required_size(args);
 
     auto [uuid, mregion] = context.resource_database().generate_resource(resource_type, path_hint, file_size);
 
@@ -166,8 +248,19 @@ auto import_static_mesh_async(
 
     header.aabb = aabb2aabb(ai_mesh->mAABB);
 
-    extract_static_mesh_verts_to(pun_span<VertexStatic>(file.lod_verts_bytes(0)), ai_mesh);
-    extract_mesh_elems_to       (pun_span<uint32_t>    (file.lod_elems_bytes(0)), ai_mesh);
+    const auto out_verts = pun_span<VertexStatic>(file.lod_verts_bytes(0));
+    const auto out_elems = pun_span<uint32_t>    (file.lod_elems_bytes(0));
+
+    Job<> extract_jobs[] = {
+        for_each_chunk_on(context.thread_pool(), num_verts, mesh_chunk_size,
+            [=](size_t first_vert, size_t count) {
+                extract_static_mesh_verts_to(out_verts.subspan(first_vert, count), ai_mesh, first_vert);
+            }),
+        extract_mesh_elems_chunked(context, out_elems, ai_mesh),
+    };
+    co_await until_all_succeed(extract_jobs);
+
+    context.resource_database().record_content(uuid, content_hash);
 
     co_return uuid;
 }
@@ -182,6 +275,21 @@ auto import_skinned_mesh_async(
 {
     co_await reschedule_to(context.thread_pool());
 
+    // NOTE: The skeleton is referenced by UUID, so the mesh is only
+    // reused if it was imported against the very same skeleton resource.
+    const ResourceType resource_type = SkinnedMeshFile::resource_type;
+    const ContentHash  content_hash  = eval%[&]{
+        ContentHasher hasher;
+        hasher.update_value(resource_type);
+        hasher.update_value(skeleton_uuid);
+        hash_mesh_content_to(hasher, ai_mesh);
+        hash_mesh_joints_to(hasher, ai_mesh, node2jointid);
+        return hasher.digest();
+    };
+
+    if (const Optional existing = context.resource_database().find_by_content(resource_type, content_hash))
+        co_return *existing;
+
     const ResourcePathHint path_hint{
         .directory = "meshes",
         .name      = s2sv(ai_mesh->mName),
@@ -211,8 +319,7 @@ auto import_skinned_mesh_async(
         .lod_specs     = spec,
     };
 
-    const size_t       file_size     = SkinnedMeshFile::required_size(args);
-    const ResourceType resource_type = SkinnedMeshFile::resource_type;
+    const size_t file_size = SkinnedMeshFile::required_size(args);
 
     auto [uuid, mregion] = context.resource_database().generate_resource(resource_type, path_hint, file_size);
 
@@ -221,8 +328,21 @@ auto import_skinned_mesh_async(
 
     header.aabb = aabb2aabb(ai_mesh->mAABB);
 
-    extract_skinned_mesh_verts_to(pun_span<VertexSkinned>(file.lod_verts_bytes(0)), ai_mesh, node2jointid);
-    extract_mesh_elems_to        (pun_span<uint32_t>     (file.lod_elems_bytes(0)), ai_mesh);
+    const auto out_verts = pun_span<VertexSkinned>(file.lod_verts_bytes(0));
+    const auto out_elems = pun_span<uint32_t>     (file.lod_elems_bytes(0));
+
+    // NOTE: Gathering the joint weights is a scatter over all vertices,
+    // so the vertices are extracted here in one go, while the element
+    // chunks are processed on the pool in the meantime.
+    Job<> elems_job = extract_mesh_elems_chunked(context, out_elems, ai_mesh);
+    {
+        // The chunks write into the file, must not unwind before they are done.
+        ON_SCOPE_FAIL([&]{ elems_job.wait_until_ready(); });
+        extract_skinned_mesh_verts_to(out_verts, ai_mesh, node2jointid);
+    }
+    co_await elems_job;
+
+    context.resource_database().record_content(uuid, content_hash);
 
     co_return uuid;
 }
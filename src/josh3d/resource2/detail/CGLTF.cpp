@@ -11,8 +11,11 @@
 #include "Ranges.hpp"
 #include "Transform.hpp"
 #include "VertexFormats.hpp"
+#include <boost/interprocess/exceptions.hpp>
 #include <cgltf.h>
 #include <glm/ext.hpp>
+#include <filesystem>
+#include <memory>
 
 
 namespace josh::detail::cgltf {
@@ -954,5 +957,86 @@ auto to_external_scene(const cgltf_data& gltf, Path _base_dir)
     return scene;
 }
 
+auto MappedFiles::file_options() noexcept
+    -> cgltf_file_options
+{
+    return {
+        .read = [](
+            const cgltf_memory_options* /*memory_options*/,
+            const cgltf_file_options*   file_options,
+            const char*                 path,
+            cgltf_size*                 size,
+            void**                      data)
+                -> cgltf_result
+        {
+            auto& self = *static_cast<MappedFiles*>(file_options->user_data);
+
+            std::error_code ec;
+            if (not std::filesystem::is_regular_file(path, ec))
+                return cgltf_result_file_not_found;
+
+            try
+            {
+                const auto mode     = boost::interprocess::read_only;
+                const auto mapping  = FileMapping(path, mode);
+                auto       mregion  = MappedRegion(mapping, mode);
+                const usize file_size = mregion.get_size();
+
+                // NOTE: The size could be requested explicitly, ex. the byteLength of a buffer.
+                if (*size > file_size)
+                    return cgltf_result_data_too_short;
+
+                if (*size == 0)
+                    *size = file_size;
+
+                void* address = mregion.get_address();
+                self.regions_.emplace(address, MOVE(mregion));
+                *data = address;
+            }
+            catch (const boost::interprocess::interprocess_exception&)
+            {
+                return cgltf_result_io_error;
+            }
+
+            return cgltf_result_success;
+        },
+        // NOTE: Newer cgltf versions also pass the size of the data here. We do not need it.
+        .release = [](
+            const cgltf_memory_options* /*memory_options*/,
+            const cgltf_file_options*   file_options,
+            void*                       data,
+            auto...                     /*size*/)
+        {
+            auto& self = *static_cast<MappedFiles*>(file_options->user_data);
+            if (data) self.regions_.erase(data);
+        },
+        .user_data = this,
+    };
+}
+
+auto parse_and_map_gltf(const Path& path)
+    -> MappedGLTF
+{
+    auto files = make_unique<MappedFiles>();
+
+    cgltf_options options = {};
+    options.file = files->file_options();
+
+    cgltf_data*  gltf   = {};
+    cgltf_result result = {};
+
+    result = cgltf_parse_file(&options, path.c_str(), &gltf);
+    if (result != cgltf_result_success)
+        throw_fmt<GLTFParseError>("Failed to parse gltf file {}, reason {}.", path, enum_string(result));
+
+    auto data = unique_data_ptr(gltf);
+
+    result = cgltf_load_buffers(&options, gltf, path.c_str());
+    if (result != cgltf_result_success)
+        throw_fmt<GLTFParseError>("Failed to load gltf buffers of {}, reason {}.", path, enum_string(result));
+
+    return { .files = MOVE(files), .data = MOVE(data) };
+}
+
 
 } // namespace josh::detail::cgltf
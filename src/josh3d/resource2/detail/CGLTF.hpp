@@ -5,6 +5,7 @@
 #include "EnumUtils.hpp"
 #include "ExternalScene.hpp"
 #include "Errors.hpp"
+#include "FileMapping.hpp"
 #include "Transform.hpp"
 #include <cgltf.h>
 
@@ -50,6 +51,54 @@ struct DataDeleter
 
 using unique_data_ptr = std::unique_ptr<cgltf_data, DataDeleter>;
 
+/*
+Backing storage for the gltf file data that memory-maps the files
+instead of reading them into heap copies with fread().
+
+This covers the .gltf/.glb file itself, and therefore the binary chunk
+of .glb, and any external .bin buffers loaded with `cgltf_load_buffers()`.
+Buffers embedded as base64 data URIs are still decoded into the heap by cgltf.
+
+The mappings are released when cgltf frees the respective data,
+or when this object is destroyed, whichever comes first.
+
+NOTE: Must outlive the `cgltf_data` parsed with its `file_options()`.
+*/
+class MappedFiles
+{
+public:
+    MappedFiles() = default;
+    MappedFiles(const MappedFiles&) = delete;
+    MappedFiles& operator=(const MappedFiles&) = delete;
+
+    // Options to be passed to both `cgltf_parse_file()` and `cgltf_load_buffers()`.
+    // References this object in the user data, so it must not be moved after this call.
+    auto file_options() noexcept -> cgltf_file_options;
+
+private:
+    HashMap<const void*, MappedRegion> regions_;
+};
+
+/*
+Parsed gltf data together with the mappings that back it.
+Keep this alive for as long as any views into the gltf buffers.
+*/
+struct MappedGLTF
+{
+    UniquePtr<MappedFiles> files; // Destroyed after the data. Pointer-stable for the cgltf callbacks.
+    unique_data_ptr        data;
+};
+
+/*
+Parse the gltf file at `path` and load all of its buffers,
+memory-mapping the files instead of reading them.
+
+Will throw `GLTFParseError` on failure.
+*/
+[[nodiscard]]
+auto parse_and_map_gltf(const Path& path)
+    -> MappedGLTF;
+
 inline auto to_vec3(const float (&v)[3]) noexcept
     -> vec3
 {
@@ -165,6 +165,8 @@ struct MTransform
 
     // Aka. world->local change-of-basis.
     auto model() const noexcept -> const mat4& { return _mat; }
+    // NOTE: Inverts the matrix on every call. For drawing, the AffineTransform
+    // of the same entity already has this cached.
     auto normal_model() const noexcept -> mat3 { return transpose(inverse(_mat)); }
 
     auto translate(const vec3& delta) noexcept
@@ -226,6 +228,59 @@ struct MTransform
 };
 
 
+/*
+World transform in a compact affine form for uploading to the GPU,
+together with its normal matrix. Produced alongside the MTransform
+by the TransformResolution, so that the stages never invert the model
+matrix themselves.
+
+The last row of an affine model matrix is always (0, 0, 0, 1), so only
+the first 3 rows are stored, as the columns of a mat3x4. That is 48 bytes
+instead of 64, and is laid out the same as a `mat3x4` in std430, where
+a point is transformed with `vec4(p, 1.0) * rows`.
+
+The normal matrix is the inverse-transpose of the upper 3x3 part. If the
+scaling is uniform, that is the same matrix divided by the squared scale,
+and no inversion is needed at all.
+*/
+struct AffineTransform
+{
+    mat3x4 rows;          // Rows of the upper 3x4 part of the model matrix.
+    mat3   normal_model;  // Inverse-transpose of the upper 3x3 part.
+    bool   uniform_scale; // No skew and the same scale along each basis vector.
+
+    static auto from_model(const mat4& model) noexcept -> AffineTransform;
+
+    // Reconstruct the full model matrix.
+    auto model() const noexcept -> mat4 { return mat4(glm::transpose(rows)); }
+};
+
+inline auto AffineTransform::from_model(const mat4& model) noexcept
+    -> AffineTransform
+{
+    const mat3 basis = mat3(model);
+
+    // Chained transforms are never exactly uniform, hence the tolerance.
+    const float tolerance = 1e-4f;
+    const float l2        = glm::length2(basis[0]);
+    const float tol_l2    = tolerance * l2;
+
+    const bool uniform_scale =
+        l2 > 0.f and
+        glm::abs(glm::length2(basis[1]) - l2) <= tol_l2 and
+        glm::abs(glm::length2(basis[2]) - l2) <= tol_l2 and
+        glm::abs(glm::dot(basis[0], basis[1])) <= tol_l2 and
+        glm::abs(glm::dot(basis[1], basis[2])) <= tol_l2 and
+        glm::abs(glm::dot(basis[2], basis[0])) <= tol_l2;
+
+    return {
+        .rows          = mat3x4(glm::transpose(model)),
+        .normal_model  = uniform_scale ? basis / l2 : glm::transpose(glm::inverse(basis)),
+        .uniform_scale = uniform_scale,
+    };
+}
+
+
 inline auto decompose_translation(const mat4& mat) noexcept
     -> vec3
 {
@@ -0,0 +1,145 @@
+#include "ContentHash.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+
+namespace josh {
+namespace {
+
+constexpr u64 prime1 = 0x9E37'79B1'85EB'CA87;
+constexpr u64 prime2 = 0xC2B2'AE3D'27D4'EB4F;
+constexpr u64 prime3 = 0x1656'67B1'9E37'79F9;
+constexpr u64 prime4 = 0x85EB'CA77'C2B2'AE63;
+constexpr u64 prime5 = 0x27D4'EB2F'1656'67C5;
+
+// NOTE: Assumes little-endian, same as the resource files themselves.
+auto read64(const ubyte* p) noexcept -> u64 { u64 v; std::memcpy(&v, p, sizeof(v)); return v; }
+auto read32(const ubyte* p) noexcept -> u32 { u32 v; std::memcpy(&v, p, sizeof(v)); return v; }
+
+auto round(u64 acc, u64 input) noexcept
+    -> u64
+{
+    acc += input * prime2;
+    acc  = std::rotl(acc, 31);
+    return acc * prime1;
+}
+
+auto merge_round(u64 acc, u64 val) noexcept
+    -> u64
+{
+    acc ^= round(0, val);
+    return acc * prime1 + prime4;
+}
+
+void consume_stripe(u64 (&acc)[4], const ubyte* stripe) noexcept
+{
+    acc[0] = round(acc[0], read64(stripe +  0));
+    acc[1] = round(acc[1], read64(stripe +  8));
+    acc[2] = round(acc[2], read64(stripe + 16));
+    acc[3] = round(acc[3], read64(stripe + 24));
+}
+
+} // namespace
+
+
+ContentHasher::State::State(u64 seed) noexcept
+    : seed(seed)
+    , acc{ seed + prime1 + prime2, seed + prime2, seed, seed - prime1 }
+{}
+
+void ContentHasher::State::update(const ubyte* data, usize size) noexcept
+{
+    total_size += size;
+
+    // Top up the partial stripe first.
+    if (buffered)
+    {
+        const usize num_fill = std::min(size, sizeof(buffer) - buffered);
+        std::memcpy(buffer + buffered, data, num_fill);
+        buffered += num_fill;
+        data     += num_fill;
+        size     -= num_fill;
+
+        if (buffered < sizeof(buffer)) return;
+
+        consume_stripe(acc, buffer);
+        buffered = 0;
+    }
+
+    // Then whole stripes straight from the input.
+    while (size >= 32)
+    {
+        consume_stripe(acc, data);
+        data += 32;
+        size -= 32;
+    }
+
+    std::memcpy(buffer, data, size);
+    buffered = size;
+}
+
+auto ContentHasher::State::digest() const noexcept
+    -> u64
+{
+    u64 h;
+    if (total_size >= 32)
+    {
+        h = std::rotl(acc[0], 1) + std::rotl(acc[1], 7) + std::rotl(acc[2], 12) + std::rotl(acc[3], 18);
+        for (const u64 v : acc)
+            h = merge_round(h, v);
+    }
+    else
+    {
+        h = seed + prime5;
+    }
+
+    h += total_size;
+
+    const ubyte* p   = buffer;
+    const ubyte* end = buffer + buffered;
+
+    for (; p + 8 <= end; p += 8)
+    {
+        h ^= round(0, read64(p));
+        h  = std::rotl(h, 27) * prime1 + prime4;
+    }
+
+    if (p + 4 <= end)
+    {
+        h ^= u64(read32(p)) * prime1;
+        h  = std::rotl(h, 23) * prime2 + prime3;
+        p += 4;
+    }
+
+    for (; p < end; ++p)
+    {
+        h ^= u64(*p) * prime5;
+        h  = std::rotl(h, 11) * prime1;
+    }
+
+    h ^= h >> 33;
+    h *= prime2;
+    h ^= h >> 29;
+    h *= prime3;
+    h ^= h >> 32;
+    return h;
+}
+
+void ContentHasher::update(const void* data, usize size) noexcept
+{
+    const auto* bytes = static_cast<const ubyte*>(data);
+    _lo.update(bytes, size);
+    _hi.update(bytes, size);
+}
+
+auto ContentHasher::xxh64(const void* data, usize size, u64 seed) noexcept
+    -> u64
+{
+    State state{ seed };
+    state.update(static_cast<const ubyte*>(data), size);
+    return state.digest();
+}
+
+
+} // namespace josh
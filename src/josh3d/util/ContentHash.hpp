@@ -0,0 +1,78 @@
+#pragma once
+#include "Common.hpp"
+#include "Scalars.hpp"
+#include <concepts>
+#include <type_traits>
+
+
+namespace josh {
+
+
+/*
+128-bit digest of some content, used to tell whether two resources
+are made from the same data. See ContentHasher.
+*/
+struct ContentHash
+{
+    u64 lo = 0;
+    u64 hi = 0;
+
+    bool operator==(const ContentHash&) const noexcept = default;
+
+    friend auto hash_value(const ContentHash& hash) noexcept -> usize { return usize(hash.lo); }
+};
+
+
+/*
+Streaming XXH64 of the same input with two different seeds,
+combined into a 128-bit ContentHash. Each half is exactly XXH64.
+
+Fast enough to hash the decoded pixels and vertex data during
+import without being noticed next to the decoding itself.
+
+Not cryptographic. The digest is only as good as the inputs that
+are fed to it: everything that changes the imported result must be
+hashed, including the import parameters.
+*/
+class ContentHasher
+{
+public:
+    static constexpr u64 seed_lo = 0;
+    static constexpr u64 seed_hi = 0x4A33'4443'4F4E'5448; // "J3DCONTH"
+
+    ContentHasher() noexcept : _lo(seed_lo), _hi(seed_hi) {}
+
+    void update(const void* data, usize size) noexcept;
+
+    void update(Span<const ubyte> bytes) noexcept { update(bytes.data(), bytes.size()); }
+
+    // Any trivially copyable value, as its object representation.
+    template<typename T>
+        requires std::is_trivially_copyable_v<T> and (not std::convertible_to<T, Span<const ubyte>>)
+    void update_value(const T& value) noexcept { update(&value, sizeof(T)); }
+
+    auto digest() const noexcept -> ContentHash { return { _lo.digest(), _hi.digest() }; }
+
+    // XXH64 of a single contiguous buffer.
+    static auto xxh64(const void* data, usize size, u64 seed = 0) noexcept -> u64;
+
+private:
+    struct State
+    {
+        explicit State(u64 seed) noexcept;
+        void update(const ubyte* data, usize size) noexcept;
+        auto digest() const noexcept -> u64;
+
+        u64   seed;
+        u64   acc[4];
+        u64   total_size = 0;
+        ubyte buffer[32];
+        usize buffered = 0;
+    };
+
+    State _lo;
+    State _hi;
+};
+
+
+} // namespace josh
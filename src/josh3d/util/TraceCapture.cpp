@@ -0,0 +1,243 @@
+#include "TraceCapture.hpp"
+#include "Errors.hpp"
+#include "Ranges.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fmt/format.h>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <utility>
+
+
+namespace josh::trace {
+namespace detail {
+
+std::atomic<bool> capturing = false;
+
+} // namespace detail
+namespace {
+
+struct Span
+{
+    char        name[48]; // Null-terminated, truncated.
+    const char* category;
+    TimePoint   begin;
+    TimePoint   end;
+    TrackID     track;
+};
+
+/*
+Single-producer ring of spans owned by a thread.
+
+Only the owning thread writes the spans and the head. The generation
+tells which capture the contents belong to. The owner resets the ring
+when it sees that a new capture has started.
+*/
+struct Ring
+{
+    TrackID           track;
+    String            track_name;
+    UniquePtr<Span[]> spans;
+    usize             capacity   = 0; // Power of two.
+    std::atomic<u64>  head       = 0;
+    std::atomic<u64>  generation = 0;
+};
+
+struct Rings
+{
+    std::mutex              mutex;
+    Vector<UniquePtr<Ring>> rings;          // Never shrinks, the rings outlive their threads.
+    std::atomic<u64>        generation = 0;
+    std::atomic<usize>      capacity   = 0;
+    TimePoint               capture_start;
+};
+
+auto rings() -> Rings&
+{
+    static Rings instance;
+    return instance;
+}
+
+std::atomic<TrackID> next_track = 0;
+
+thread_local TrackID this_track = next_track.fetch_add(1, std::memory_order_relaxed);
+thread_local String  this_track_name;
+thread_local Ring*   this_ring  = nullptr;
+
+auto acquire_ring()
+    -> Ring&
+{
+    if (not this_ring)
+    {
+        auto& r = rings();
+        auto ring = std::make_unique<Ring>();
+        ring->track      = this_track;
+        ring->track_name = this_track_name.empty() ? fmt::format("thread {}", this_track) : this_track_name;
+        this_ring = ring.get();
+
+        const std::scoped_lock lk{ r.mutex };
+        r.rings.push_back(MOVE(ring));
+    }
+
+    Ring&     ring       = *this_ring;
+    const u64 generation = rings().generation.load(std::memory_order_acquire);
+
+    if (ring.generation.load(std::memory_order_relaxed) != generation)
+    {
+        const usize capacity = std::bit_ceil(std::max(rings().capacity.load(std::memory_order_relaxed), usize(2)));
+        if (ring.capacity != capacity)
+        {
+            ring.spans    = std::make_unique<Span[]>(capacity);
+            ring.capacity = capacity;
+        }
+        ring.head.store(0, std::memory_order_relaxed);
+        ring.generation.store(generation, std::memory_order_release);
+    }
+
+    return ring;
+}
+
+void write_json_string(std::ostream& os, std::string_view str)
+{
+    os << '"';
+    for (const char c : str)
+    {
+        switch (c)
+        {
+            case '"':  os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            case '\n': os << "\\n";  break;
+            case '\t': os << "\\t";  break;
+            default:
+                if (u8(c) < 0x20) os << fmt::format("\\u{:04x}", int(c));
+                else              os << c;
+        }
+    }
+    os << '"';
+}
+
+} // namespace
+
+
+auto current_track() noexcept
+    -> TrackID
+{
+    return this_track;
+}
+
+void set_current_track_name(std::string_view name)
+{
+    this_track_name = name;
+}
+
+void start_capture(usize spans_per_thread)
+{
+    auto& r = rings();
+    r.capacity.store(spans_per_thread, std::memory_order_relaxed);
+    r.capture_start = Clock::now();
+    r.generation.fetch_add(1, std::memory_order_release);
+    detail::capturing.store(true, std::memory_order_release);
+}
+
+void stop_capture()
+{
+    detail::capturing.store(false, std::memory_order_release);
+}
+
+void record_span(
+    std::string_view name,
+    const char*      category,
+    TimePoint        begin,
+    TimePoint        end,
+    TrackID          track)
+{
+    if (not is_capturing()) return;
+
+    Ring&     ring = acquire_ring();
+    const u64 head = ring.head.load(std::memory_order_relaxed);
+    Span&     span = ring.spans[head & (ring.capacity - 1)];
+
+    const usize name_len = std::min(name.size(), sizeof(span.name) - 1);
+    std::memcpy(span.name, name.data(), name_len);
+    span.name[name_len] = '\0';
+    span.category = category;
+    span.begin    = begin;
+    span.end      = end;
+    span.track    = track;
+
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void write_chrome_trace(std::ostream& os)
+{
+    auto& r = rings();
+    const std::scoped_lock lk{ r.mutex };
+    const u64 generation = r.generation.load(std::memory_order_acquire);
+
+    const auto to_us = [&](TimePoint t)
+    {
+        return double((t - r.capture_start).count()) / 1000.0;
+    };
+
+    bool first = true;
+    const auto separator = [&]() -> const char*
+    {
+        return std::exchange(first, false) ? "\n" : ",\n";
+    };
+
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    // Process and track names.
+    os << separator() << R"({"ph":"M","name":"process_name","pid":1,"tid":0,"args":{"name":"CPU"}})";
+    os << separator() << R"({"ph":"M","name":"process_name","pid":2,"tid":0,"args":{"name":"GPU"}})";
+
+    for (const auto& ring : r.rings)
+    {
+        os << separator() << R"({"ph":"M","name":"thread_name","pid":1,"tid":)" << ring->track << R"(,"args":{"name":)";
+        write_json_string(os, ring->track_name);
+        os << "}}";
+    }
+
+    for (const auto& ring : r.rings)
+    {
+        if (ring->generation.load(std::memory_order_acquire) != generation)
+            continue;
+
+        const u64 head = ring->head.load(std::memory_order_acquire);
+
+        // If the ring has wrapped, skip the oldest span in case
+        // it is being overwritten by a straggling writer right now.
+        const u64 first_idx = head >= ring->capacity ? head - ring->capacity + 1 : 0;
+
+        for (const u64 i : irange(first_idx, head))
+        {
+            const Span& span = ring->spans[i & (ring->capacity - 1)];
+            const bool  gpu  = span.track == gpu_track;
+
+            os << separator() << R"({"ph":"X","name":)";
+            write_json_string(os, span.name);
+            os << fmt::format(R"(,"cat":"{}","ts":{:.3f},"dur":{:.3f},"pid":{},"tid":{}}})",
+                span.category, to_us(span.begin), to_us(span.end) - to_us(span.begin),
+                gpu ? 2 : 1, gpu ? 0 : span.track);
+        }
+    }
+
+    os << "\n]}\n";
+}
+
+void dump_chrome_trace(const Path& path)
+{
+    std::ofstream file{ path, std::ios::binary };
+    if (not file)
+        throw_fmt("Could not open \"{}\" for writing the trace.", path.string());
+
+    write_chrome_trace(file);
+
+    if (not file)
+        throw_fmt("Failed writing the trace to \"{}\".", path.string());
+}
+
+
+} // namespace josh::trace
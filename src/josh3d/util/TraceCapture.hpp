@@ -0,0 +1,115 @@
+#pragma once
+#include "Common.hpp"
+#include "Scalars.hpp"
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+#include <string_view>
+
+
+/*
+Headless capture of timed spans for offline profiling.
+
+This is meant for the situations where connecting a Tracy GUI is not
+possible: replays on remote machines, CI, etc. Spans are recorded into
+lock-free per-thread rings and can be written out in the Chrome trace
+event format, which can be opened in chrome://tracing or the Perfetto UI.
+
+    trace::start_capture();
+    ... // Run the frames.
+    trace::stop_capture();
+    trace::dump_chrome_trace("frames.json");
+
+Each ring keeps only the most recent spans of its thread, older spans are
+overwritten once the ring is full. The recording is a no-op when not capturing,
+save for a single relaxed atomic load.
+
+Any thread can record. The threads are identified by their "track",
+a small sequential index assigned on first use. A separate GPU track
+exists for spans that were measured on the device timeline.
+*/
+namespace josh::trace {
+
+
+using Clock     = std::chrono::high_resolution_clock;
+using TimePoint = std::chrono::time_point<Clock, std::chrono::nanoseconds>;
+using TrackID   = u32;
+
+// Special track for spans recorded on the GPU timeline.
+constexpr TrackID gpu_track = TrackID(-1);
+
+// Returns the track of the calling thread.
+auto current_track() noexcept -> TrackID;
+
+// Sets the display name of the track of the calling thread.
+// Should be called before the thread records anything.
+void set_current_track_name(std::string_view name);
+
+namespace detail { extern std::atomic<bool> capturing; }
+
+// Whether the capture is currently recording.
+inline auto is_capturing() noexcept
+    -> bool
+{
+    return detail::capturing.load(std::memory_order_relaxed);
+}
+
+// Starts recording a new capture and discards the previous one.
+// Rings are (re)allocated lazily by each thread to fit `spans_per_thread`.
+//
+// NOTE: Must not be called concurrently with the dump functions.
+void start_capture(usize spans_per_thread = 16 * 1024);
+
+// Stops recording. The recorded spans are kept until the next capture is started.
+void stop_capture();
+
+// Records a complete span into the ring of the calling thread.
+// The name is copied and truncated if needed, the category must be a static string.
+// The span is attributed to the `track`, which is the calling thread by default.
+void record_span(
+    std::string_view name,
+    const char*      category,
+    TimePoint        begin,
+    TimePoint        end,
+    TrackID          track = current_track());
+
+// Writes all recorded spans in the Chrome trace event JSON format.
+//
+// The capture should be stopped first, otherwise the spans
+// that are being recorded during the dump could come out torn.
+void write_chrome_trace(std::ostream& os);
+
+// Same as above, but to a file at `path`. Throws RuntimeError on failure.
+void dump_chrome_trace(const Path& path);
+
+
+/*
+RAII span of the current thread, recorded on destruction.
+The name must outlive the span. Costs nothing when not capturing.
+*/
+struct ScopedSpan
+{
+    ScopedSpan(std::string_view name, const char* category) noexcept
+        : _name(name)
+        , _category(category)
+    {
+        if (is_capturing())
+            _begin = Clock::now();
+    }
+
+    ~ScopedSpan() noexcept
+    {
+        if (_begin != TimePoint() and is_capturing())
+            record_span(_name, _category, _begin, Clock::now());
+    }
+
+    ScopedSpan(const ScopedSpan&) = delete;
+    ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+    std::string_view _name;
+    const char*      _category;
+    TimePoint        _begin = {};
+};
+
+
+} // namespace josh::trace
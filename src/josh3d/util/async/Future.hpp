@@ -188,6 +188,18 @@ Promise<T>::~Promise() noexcept
 }
 
 
+/*
+Support of the `readyable` concept for Future, so that it can
+be awaited through the CompletionContext in coroutines.
+*/
+template<typename T>
+auto is_ready(const Future<T>& future) noexcept
+    -> bool
+{
+    return future.is_available();
+}
+
+
 template<typename T>
 bool Future<T>::is_moved_from() const noexcept
 {
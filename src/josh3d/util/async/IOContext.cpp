@@ -0,0 +1,116 @@
+#include "IOContext.hpp"
+#include "BuildConfig.hpp"
+#include "Common.hpp"
+#include "Ranges.hpp"
+#include <algorithm>
+#ifdef JOSH3D_OS_LINUX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+namespace josh {
+namespace {
+
+#ifdef JOSH3D_OS_LINUX
+const usize page_size = usize(sysconf(_SC_PAGE_SIZE));
+#else
+const usize page_size = 4096;
+#endif
+
+struct PageRange
+{
+    uintptr beg; // Aligned down to the page boundary.
+    uintptr end; // Aligned up to the page boundary.
+};
+
+auto page_range(Span<const ubyte> bytes) noexcept
+    -> PageRange
+{
+    const auto beg = uintptr(bytes.data());
+    const auto end = beg + bytes.size();
+    return {
+        .beg = beg - (beg % page_size),
+        .end = end + (page_size - end % page_size) % page_size,
+    };
+}
+
+} // namespace
+
+
+IOContext::IOContext(usize num_threads, IOBackend backend)
+    : backend_{ backend }
+    , io_pool_{ num_threads, "io pool" }
+{}
+
+void IOContext::advise_willneed(Span<const ubyte> bytes) noexcept
+{
+    if (bytes.empty()) return;
+#ifdef JOSH3D_OS_LINUX
+    const auto [beg, end] = page_range(bytes);
+    // Failure is fine, this is just a hint.
+    posix_madvise((void*)beg, end - beg, POSIX_MADV_WILLNEED);
+#endif
+}
+
+auto IOContext::is_resident(Span<const ubyte> bytes) noexcept
+    -> bool
+{
+    if (bytes.empty()) return true;
+#ifdef JOSH3D_OS_LINUX
+    const auto [beg, end] = page_range(bytes);
+
+    // Query in chunks to not allocate for large ranges.
+    const usize   chunk_pages = 256;
+    unsigned char residency[chunk_pages];
+
+    for (uintptr addr = beg; addr < end; addr += chunk_pages * page_size)
+    {
+        const usize num_bytes = std::min(end - addr, chunk_pages * page_size);
+        const usize num_pages = num_bytes / page_size;
+
+        if (mincore((void*)addr, num_bytes, residency) != 0)
+            return false;
+
+        for (const usize i : irange(num_pages))
+            if (not (residency[i] & 1))
+                return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+auto IOContext::_all_resident(const ranges_type& ranges) noexcept
+    -> bool
+{
+    return std::ranges::all_of(ranges, &IOContext::is_resident);
+}
+
+void IOContext::_page_in(const ranges_type& ranges) noexcept
+{
+    // Let the OS see the whole batch first, so that it could issue the reads together.
+    for (const auto& range : ranges)
+        advise_willneed(range);
+
+    // Then wait for each page by faulting it in. This is what blocks,
+    // but we are on the IO thread, and blocking is our job.
+    for (const auto& range : ranges)
+    {
+        if (range.empty()) continue;
+        const auto [beg, end] = page_range(range);
+        // Touching the first byte of the range in the first page, not the page start,
+        // since the page start could be outside of the range, and we don't own it.
+        const volatile ubyte* first = range.data();
+        [[maybe_unused]] const ubyte _ = *first;
+        for (uintptr addr = beg + page_size; addr < end; addr += page_size)
+        {
+            const volatile ubyte* ptr = (const ubyte*)addr;
+            [[maybe_unused]] const ubyte _ = *ptr;
+        }
+    }
+}
+
+
+} // namespace josh
@@ -0,0 +1,152 @@
+#pragma once
+#include "CategoryCasts.hpp"
+#include "Common.hpp"
+#include "ContainerUtils.hpp"
+#include "Scalars.hpp"
+#include "async/CoroCore.hpp"
+#include "async/ThreadPool.hpp"
+#include <coroutine>
+#include <ranges>
+#include <type_traits>
+
+
+namespace josh {
+
+
+enum class IOBackend : u8
+{
+    Threaded, // Pages are brought in by the dedicated IO threads. The awaiting coroutine is suspended until then.
+    Inline,   // Awaiting never suspends. The reader will take the page faults itself. Mostly for debugging.
+};
+
+/*
+Asynchronous paging-in of memory-mapped file ranges.
+
+Reading from a cold MappedRegion or MappedView page-faults and blocks
+the reading thread until the data arrives from disk. For the loading
+pool that means idle workers, for the offscreen context it is worse,
+since it serializes all GPU uploads behind the disk.
+
+This context lets the caller wait for a set of ranges to become resident
+without blocking the caller's thread. The ranges are first advised to the
+OS as a batch, so that the reads can be issued together, then the pages
+are faulted-in on the IO threads, after which the awaiting coroutine is
+resumed on the specified executor.
+
+NOTE: This is not io_uring. The resources are accessed through mappings,
+and not read into buffers, so the natural unit of async IO here is a page
+fault taken on someone else's thread. An io_uring backend would need
+file descriptors and destination buffers, neither of which we have.
+*/
+class IOContext
+{
+public:
+    // Number of threads should be small. They spend all their time sleeping in the kernel anyway.
+    IOContext(usize num_threads = 2, IOBackend backend = IOBackend::Threaded);
+
+    auto backend() const noexcept -> IOBackend { return backend_; }
+
+    // Hint the OS to start reading the range in the background. Never blocks.
+    // Use this for the data that will be needed "soon", like the next LOD or MIP.
+    static void advise_willneed(Span<const ubyte> bytes) noexcept;
+
+    // Check if all pages of the range are currently resident in memory.
+    // Returns false if residency cannot be determined.
+    static auto is_resident(Span<const ubyte> bytes) noexcept -> bool;
+
+    // Suspend until all pages in the range are resident in memory, then resume on the `executor`.
+    // The blocking page faults happen on the IO threads, never on the awaiting thread.
+    //
+    // If the range is already resident, does not suspend and continues on the current thread.
+    [[nodiscard]]
+    auto until_resident_on(executor auto& executor, Span<const ubyte> bytes)
+        -> awaiter<void> auto;
+
+    // Batched version of `until_resident_on()`. The whole batch is advised at once.
+    //
+    // The ranges are copied into the awaiter, the range of ranges does not need to outlive it.
+    [[nodiscard]]
+    auto until_all_resident_on(executor auto& executor, std::ranges::input_range auto&& byte_ranges)
+        -> awaiter<void> auto;
+
+private:
+    IOBackend  backend_;
+    ThreadPool io_pool_;
+
+    using ranges_type = SmallVector<Span<const ubyte>, 4>;
+
+    // Advise all, then touch every page of every range.
+    static void _page_in(const ranges_type& ranges) noexcept;
+
+    static auto _all_resident(const ranges_type& ranges) noexcept -> bool;
+
+    template<executor E>
+    void _submit(ranges_type ranges, E& executor, std::coroutine_handle<> coroutine);
+};
+
+
+
+
+template<executor E>
+void IOContext::_submit(
+    ranges_type             ranges,
+    E&                      executor,
+    std::coroutine_handle<> coroutine)
+{
+    discard(io_pool_.emplace([ranges=MOVE(ranges), &executor, coroutine]
+    {
+        _page_in(ranges);
+
+        // The rest of the work has nothing to do on the IO thread.
+        auto resumer = [coroutine] { coroutine.resume(); };
+
+        using result_type =
+            decltype([&]() -> decltype(auto) { return executor.emplace(MOVE(resumer)); }());
+
+        if constexpr (std::is_void_v<result_type>)
+            executor.emplace(MOVE(resumer));
+        else
+            discard(executor.emplace(MOVE(resumer)));
+    }));
+}
+
+template<executor E>
+auto IOContext::until_all_resident_on(E& executor, std::ranges::input_range auto&& byte_ranges)
+    -> awaiter<void> auto
+{
+    struct Awaiter
+    {
+        IOContext&  self;
+        E&          executor;
+        ranges_type ranges;
+
+        auto await_ready() const noexcept
+            -> bool
+        {
+            return self.backend_ == IOBackend::Inline or _all_resident(ranges);
+        }
+
+        void await_suspend(std::coroutine_handle<> coroutine)
+        {
+            self._submit(MOVE(ranges), executor, coroutine);
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    ranges_type copied;
+    for (const auto& range : byte_ranges)
+        copied.emplace_back(Span<const ubyte>(range));
+
+    return Awaiter{ *this, executor, MOVE(copied) };
+}
+
+template<executor E>
+auto IOContext::until_resident_on(E& executor, Span<const ubyte> bytes)
+    -> awaiter<void> auto
+{
+    return until_all_resident_on(executor, Array<Span<const ubyte>, 1>{ bytes });
+}
+
+
+} // namespace josh
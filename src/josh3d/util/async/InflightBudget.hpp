@@ -0,0 +1,143 @@
+#pragma once
+#include "Scalars.hpp"
+#include "Semantics.hpp"
+#include <atomic>
+#include <cassert>
+#include <utility>
+
+
+namespace josh {
+
+
+class BudgetReservation;
+
+
+/*
+A shared budget of "units in-flight", most commonly bytes of
+intermediate data that exist only while some jobs are running.
+
+Jobs reserve a part of the budget before allocating, and release it
+once the data is gone. This bounds the peak memory of a large batch
+of jobs without limiting their number upfront.
+
+A single reservation larger than the whole capacity is granted only
+when nothing else is in-flight, so that it can still make progress.
+
+The reservation is a readyable, so waiting for the budget to free up
+is done through the CompletionContext:
+
+    auto reservation = budget.reserve(num_bytes);
+    co_await completion_context.until_ready(reservation);
+    co_await reschedule_to(thread_pool);
+    // ...allocate and do work, the budget is released when `reservation` dies.
+
+The budget must outlive all of its reservations.
+*/
+class InflightBudget
+    : private Immovable<InflightBudget>
+{
+public:
+    explicit InflightBudget(usize capacity) : capacity_(capacity) {}
+
+    auto capacity() const noexcept -> usize { return capacity_; }
+
+    // Returns the amount reserved at the time of the query.
+    // WARN: Subject to TOCTOU and should be only used as a hint.
+    auto hint_in_use() const noexcept
+        -> usize
+    {
+        return in_use_.load(std::memory_order_relaxed);
+    }
+
+    // Returns true and reserves `amount` if it fits into the remaining budget.
+    auto try_acquire(usize amount) noexcept
+        -> bool
+    {
+        usize in_use = in_use_.load(std::memory_order_relaxed);
+        do {
+            const bool fits      = in_use + amount <= capacity_;
+            const bool oversized = in_use == 0; // Let through anything if idle.
+            if (not fits and not oversized) return false;
+        } while (not in_use_.compare_exchange_weak(in_use, in_use + amount,
+            std::memory_order_acquire, std::memory_order_relaxed));
+        return true;
+    }
+
+    void release(usize amount) noexcept
+    {
+        [[maybe_unused]] const usize prev = in_use_.fetch_sub(amount, std::memory_order_release);
+        assert(prev >= amount);
+    }
+
+    // Returns an RAII reservation of `amount` that is acquired lazily,
+    // on the first successful `is_ready()` check, and released on destruction.
+    [[nodiscard]]
+    auto reserve(usize amount)
+        -> BudgetReservation;
+
+private:
+    usize              capacity_;
+    std::atomic<usize> in_use_{ 0 };
+};
+
+
+class BudgetReservation
+    : private MoveOnly<BudgetReservation>
+{
+public:
+    BudgetReservation(InflightBudget& budget, usize amount)
+        : budget_(&budget)
+        , amount_(amount)
+    {}
+
+    BudgetReservation(BudgetReservation&& other) noexcept
+        : budget_  (std::exchange(other.budget_,   nullptr))
+        , amount_  (std::exchange(other.amount_,   0))
+        , acquired_(std::exchange(other.acquired_, false))
+    {}
+
+    BudgetReservation& operator=(BudgetReservation&& other) noexcept
+    {
+        _release_if_acquired();
+        budget_   = std::exchange(other.budget_,   nullptr);
+        amount_   = std::exchange(other.amount_,   0);
+        acquired_ = std::exchange(other.acquired_, false);
+        return *this;
+    }
+
+    auto amount() const noexcept -> usize { return amount_; }
+
+    // Attempts to acquire the reservation if not acquired yet.
+    // Once this returns true, the amount is held until destruction.
+    auto is_ready() noexcept
+        -> bool
+    {
+        if (not acquired_ and budget_)
+            acquired_ = budget_->try_acquire(amount_);
+        return acquired_;
+    }
+
+    ~BudgetReservation() noexcept { _release_if_acquired(); }
+
+private:
+    InflightBudget* budget_;
+    usize           amount_;
+    bool            acquired_ = false;
+
+    void _release_if_acquired() noexcept
+    {
+        if (acquired_ and budget_) budget_->release(amount_);
+        acquired_ = false;
+    }
+};
+
+
+[[nodiscard]]
+inline auto InflightBudget::reserve(usize amount)
+    -> BudgetReservation
+{
+    return { *this, amount };
+}
+
+
+} // namespace josh
@@ -1,16 +1,59 @@
 #pragma once
 #include "CategoryCasts.hpp"
+#include "Scalars.hpp"
 #include "Semantics.hpp"
 #include "UniqueFunction.hpp"
 #include "async/ThreadsafeQueue.hpp"
 #include "async/TaskCounterGuard.hpp"
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <optional>
 #include <thread>
 
 
 namespace josh {
 
 
+/*
+Priority of a task in the LocalContext. Higher priority tasks
+are always executed before any lower priority ones in the queue.
+*/
+enum class TaskPriority : u8
+{
+    High,   // Ex. entities that are visible or close to the viewer.
+    Normal, // Default for everything.
+    Low,    // Ex. entities that are far away or behind the viewer.
+};
+
+class LocalContext;
+
+/*
+Executor that submits tasks to a LocalContext with a fixed priority.
+
+Rescheduling requires an lvalue executor, so keep this in the coroutine frame:
+
+    auto executor = local_context.with_priority(TaskPriority::High);
+    co_await reschedule_to(executor);
+*/
+class PrioritizedLocalContext
+{
+public:
+    PrioritizedLocalContext(LocalContext& context, TaskPriority priority)
+        : context_ { &context }
+        , priority_{ priority }
+    {}
+
+    void emplace(auto&& fun);
+
+    auto priority() const noexcept -> TaskPriority { return priority_; }
+    auto context()  const noexcept -> LocalContext& { return *context_; }
+
+private:
+    LocalContext* context_;
+    TaskPriority  priority_;
+};
+
 /*
 Another weird utility for properly executing tasks in the local context of some enclosing class.
 
@@ -20,19 +63,40 @@ when TaskCounterGuard's destructor waits for all tasks to complete by blocking t
 that is responsible for executing said tasks.
 
 The enclosing class must periodically pull tasks from the queue and execute them.
+It can either flush everything, or execute tasks only for a limited time with `flush_budgeted()`,
+in which case the remaining tasks are deferred until the next flush. This is meant for
+the per-frame update, so that a burst of tasks (ex. from loading a large scene)
+would be spread over multiple frames instead of stalling a single one.
+
+Tasks are executed in the order of their priority, then in FIFO order.
 
 If TaskCounterGuard is associated with the enclosing class (recommended),
 this will spin and execute tasks on destruction until all tasks are complete.
 */
 class LocalContext : public Immovable<LocalContext> {
 public:
-    ThreadsafeQueue<UniqueFunction<void()>> tasks;
+    using task_type = UniqueFunction<void()>;
+
+    // Maximum time spent executing tasks in a single `flush_budgeted()` call.
+    // At least one task is executed per call regardless, so that progress is guaranteed.
+    std::atomic<std::chrono::nanoseconds> time_budget{ std::chrono::milliseconds(2) };
 
     LocalContext() = default;
     LocalContext(TaskCounterGuard& task_counter) : task_counter_{ &task_counter } {}
 
     // Executor interface. Can be rescheduled to from a coroutine.
-    void emplace(auto&& fun) { tasks.emplace(FORWARD(fun)); }
+    // Submits with the normal priority.
+    void emplace(auto&& fun) { emplace(TaskPriority::Normal, FORWARD(fun)); }
+
+    // Submit a task with a specific priority.
+    void emplace(TaskPriority priority, auto&& fun) { queue(priority).emplace(FORWARD(fun)); }
+
+    // Returns an executor that submits tasks with the specified priority.
+    auto with_priority(TaskPriority priority) noexcept
+        -> PrioritizedLocalContext
+    {
+        return { *this, priority };
+    }
 
     // Execute the tasks in the queue until empty.
     // Returns the number of tasks executed.
@@ -44,7 +108,7 @@ public:
         -> size_t
     {
         size_t n = 0;
-        while (auto task = tasks.try_pop()) {
+        while (auto task = _pop_next(blocking)) {
             (*task)();
             ++n;
         }
@@ -58,13 +122,42 @@ public:
         -> size_t
     {
         size_t n = 0;
-        while (auto task = tasks.try_lock_and_try_pop()) {
+        while (auto task = _pop_next(nonblocking)) {
+            (*task)();
+            ++n;
+        }
+        return n;
+    }
+
+    // Execute the tasks in the queue until empty, the lock is contended,
+    // or the `time_budget` is exhausted, whichever comes first.
+    // Returns the number of tasks executed.
+    // Exceptions thrown by the underlying tasks are propagated.
+    auto flush_budgeted()
+        -> size_t
+    {
+        const auto deadline =
+            std::chrono::steady_clock::now() + time_budget.load(std::memory_order_relaxed);
+
+        size_t n = 0;
+        while (auto task = _pop_next(nonblocking)) {
             (*task)();
             ++n;
+            if (std::chrono::steady_clock::now() >= deadline) break;
         }
         return n;
     }
 
+    // Returns true if no tasks are queued at the time of the query.
+    // WARN: Subject to TOCTOU and should be only used as a hint.
+    auto hint_empty() const noexcept
+        -> bool
+    {
+        for (const auto& queue : queues_)
+            if (not queue.empty()) return false;
+        return true;
+    }
+
     // Spin until the task queue is flushed *and* no more tasks are in flight.
     // Will simply do `flush_strong()` if no task counter is tracked.
     //
@@ -115,9 +208,53 @@ public:
     }
 
 private:
+    static constexpr size_t num_priorities = 3;
+    std::array<ThreadsafeQueue<task_type>, num_priorities> queues_;
     TaskCounterGuard* task_counter_{ nullptr };
+
+    auto queue(TaskPriority priority) noexcept
+        -> ThreadsafeQueue<task_type>&
+    {
+        return queues_[size_t(priority)];
+    }
+
+    enum PopMode : bool { blocking, nonblocking };
+
+    // A contended queue is retried this many times before giving up in the nonblocking mode.
+    static constexpr size_t max_pop_attempts = 8;
+
+    // Pops the first task from the highest priority non-empty queue.
+    //
+    // In the nonblocking mode, a contended queue is never skipped in favor
+    // of the lower priorities, as it might not be empty. It is retried a few
+    // times instead, and if still contended, nothing is popped at all.
+    auto _pop_next(PopMode mode)
+        -> std::optional<task_type>
+    {
+        for (auto& queue : queues_) {
+            if (mode == blocking) {
+                if (auto task = queue.try_pop()) return task;
+                continue;
+            }
+
+            bool contended = false;
+            for (size_t attempt = 0; attempt < max_pop_attempts; ++attempt) {
+                if (auto task = queue.try_lock_and_try_pop(contended)) return task;
+                if (!contended) break;
+                std::this_thread::yield();
+            }
+            if (contended) return std::nullopt;
+        }
+        return std::nullopt;
+    }
 };
 
 
+void PrioritizedLocalContext::emplace(auto&& fun)
+{
+    context_->emplace(priority_, FORWARD(fun));
+}
+
+
 
 } // namespace josh
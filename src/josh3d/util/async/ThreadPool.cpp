@@ -1,5 +1,6 @@
 #include "ThreadPool.hpp"
 #include "Common.hpp"
+#include "TraceCapture.hpp"
 #include "async/ThreadAttributes.hpp"
 #include <fmt/core.h>
 
@@ -34,6 +35,7 @@ void ThreadPool::execution_loop(
     const auto idx_str     = std::to_string(thread_idx);
     const auto thread_name = fmt::format("#{} {}", idx_str, pool_name_);
     set_current_thread_name(thread_name.c_str());
+    trace::set_current_track_name(thread_name);
     startup_latch_.arrive_and_wait();
 
     while (true)
@@ -44,7 +46,7 @@ void ThreadPool::execution_loop(
 
         if (task.has_value())
         {
-            (*task)();
+            run_task(*task);
         }
         else /* no task has been fetched or stolen */
         {
@@ -54,7 +56,7 @@ void ThreadPool::execution_loop(
             // Might still not have a valid task if stop was requested.
             if (task.has_value())
             {
-                (*task)();
+                run_task(*task);
             }
             else /* stop requested */
             {
@@ -100,13 +102,20 @@ auto ThreadPool::try_fetch_or_steal(uindex thread_idx)
     return task;
 }
 
+void ThreadPool::run_task(task_type& task)
+{
+    // The span is a no-op unless a trace is being captured.
+    const trace::ScopedSpan span{ pool_name_, "job" };
+    task();
+}
+
 void ThreadPool::drain_queue_until_empty(uindex thread_idx)
 {
     Optional<task_type> task;
     while (true)
     {
         task = per_thread_tasks_[thread_idx].try_pop();
-        if (task) (*task)();
+        if (task) run_task(*task);
         else      break;
     }
 }
@@ -82,6 +82,7 @@ private:
     void execution_loop(std::stop_token stoken, uindex thread_idx);
     auto try_fetch_or_steal(uindex thread_idx) -> Optional<task_type>;
     void drain_queue_until_empty(uindex thread_idx);
+    void run_task(task_type& task);
 
 };
 
@@ -39,6 +39,10 @@ public:
     // If the lock cannot be acquired right now or the queue is empty return nullopt.
     std::optional<T> try_lock_and_try_pop();
 
+    // Same as above, but tells an empty queue from a contended one.
+    // Sets `contended` to true if the lock could not be acquired.
+    std::optional<T> try_lock_and_try_pop(bool& contended);
+
     // Pop value and return.
     // If the queue is empty wait until a value is pushed.
     T wait_and_pop();
@@ -188,7 +192,15 @@ std::optional<T> ThreadsafeQueue<T>::try_pop() {
 
 template<typename T>
 std::optional<T> ThreadsafeQueue<T>::try_lock_and_try_pop() {
+    bool contended;
+    return try_lock_and_try_pop(contended);
+}
+
+
+template<typename T>
+std::optional<T> ThreadsafeQueue<T>::try_lock_and_try_pop(bool& contended) {
     std::unique_lock lk{ mutex_, std::try_to_lock };
+    contended = !lk.owns_lock();
     if (lk.owns_lock()) {
         if (!que_.empty()) {
             auto value = std::move(que_.front());
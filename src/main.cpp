@@ -2,17 +2,20 @@
 #include "Filesystem.hpp"
 #include "GlobalContext.hpp"
 #include "Logging.hpp"
+#include "ShaderPool.hpp"
 #include "GLUtils.hpp"
 #include "async/ThreadAttributes.hpp"
 #include "VirtualFilesystem.hpp"
 #include "WindowSizeCache.hpp"
 #include "Tracy.hpp"
+#include "TraceCapture.hpp"
 #include <glbinding/gl/gl.h>
 #include <glbinding/glbinding.h>
 #include <glfwpp/glfwpp.h>
 #include <cxxopts.hpp> // This lib is kinda garbage from the POV of C++ idiomatics, replace later
 #include <boost/iostreams/tee.hpp>
 #include <boost/iostreams/stream.hpp>
+#include <fmt/core.h>
 #include <optional>
 #include <iostream>
 #include <vector>
@@ -39,6 +42,21 @@ static auto get_cli_options()
             "Enable logging of OpenGL shader compilation/linking",
             cxxopts::value<bool>()->default_value("true")
         )
+        (
+            "trace-frames",
+            "Capture a trace of the first N frames and write it in the Chrome trace format",
+            cxxopts::value<size_t>()
+        )
+        (
+            "trace-output",
+            "Output path of the trace captured with --trace-frames",
+            cxxopts::value<std::string>()->default_value("josh3d-trace.json")
+        )
+        (
+            "shader-cache",
+            "Directory of the on-disk cache of the linked shader programs, empty to disable",
+            cxxopts::value<std::string>()->default_value(".josh3d/shader_cache/")
+        )
         (
             "h,help",
             "Print help and exit"
@@ -68,6 +86,7 @@ auto main(int argc, const char* argv[])
     -> int
 {
     josh::set_current_thread_name("main");
+    josh::trace::set_current_track_name("main");
 
     auto cli_options      = get_cli_options();
     auto cli_parse_result = try_parse_cli_args(cli_options, argc, argv);
@@ -133,11 +152,20 @@ auto main(int argc, const char* argv[])
 
     hook_gl_logs_to(josh::logstream()); // Hook now to report initialization failures.
 
+    // Enable before creating the stages, since they request their shaders on construction.
+    if (const auto shader_cache_dir = cli_args["shader-cache"].as<std::string>(); not shader_cache_dir.empty())
+    {
+        if (not josh::shader_pool().enable_binary_cache(shader_cache_dir))
+            josh::logstream() << fmt::format("Shader cache disabled. Program binaries are not supported by the driver, "
+                "or the directory \"{}\" could not be created.\n", shader_cache_dir);
+    }
+
     const josh::RuntimeParams runtime_params = {
-        .main_window       = window,
+        .main_context      = &window,
         .database_root     = ".josh3d/", // TODO: Un-hardcode
         .task_pool_size    = 6,          // ''
         .loading_pool_size = 6,          // ''
+        .io_pool_size      = 2,          // ''
         .main_resolution   = josh::globals::window_size.size(),
         .main_format       = josh::HDRFormat::R11F_G11F_B10F
     };
@@ -145,6 +173,12 @@ auto main(int argc, const char* argv[])
     auto runtime     = josh::Runtime(runtime_params);
     auto application = DemoScene(window, runtime);
 
+    if (cli_args.count("trace-frames"))
+    {
+        if (const size_t num_frames = cli_args["trace-frames"].as<size_t>())
+            runtime.perf_assembly.capture_trace(num_frames, cli_args["trace-output"].as<std::string>());
+    }
+
     // The initialization will only log to the previously set logstream.
     // Everything after will tee to the ImGui log window.
     auto tee_device  = boost::iostreams::tee(std::clog, application.get_log_sink());
@@ -0,0 +1,110 @@
+#include "ResourceDatabase.hpp"
+#include "Errors.hpp"
+#include <cxxopts.hpp>
+#include <fmt/core.h>
+#include <fmt/std.h>
+#include <bit>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+
+/*
+Consolidates all loose resources of an existing database into pak archives.
+
+Do not run this while another process has the database open.
+*/
+static auto get_cli_options()
+    -> cxxopts::Options
+{
+    cxxopts::Options options{ "josh3d-repack", "Pack loose resources of a josh3d resource database into pak archives." };
+
+    options.add_options()
+        (
+            "database-root",
+            "Root directory of the resource database",
+            cxxopts::value<std::string>()->default_value(".josh3d/")
+        )
+        (
+            "max-archive-size",
+            "Maximum size of a single archive in MiB",
+            cxxopts::value<size_t>()->default_value("1024")
+        )
+        (
+            "alignment",
+            "Alignment of each resource within the archive in bytes. Must be a power of 2",
+            cxxopts::value<size_t>()->default_value("4096")
+        )
+        (
+            "h,help",
+            "Print help and exit"
+        )
+    ;
+
+    options.parse_positional({ "database-root" });
+
+    return options;
+}
+
+static auto try_parse_cli_args(cxxopts::Options& options, int argc, const char* argv[])
+    -> std::optional<cxxopts::ParseResult>
+{
+    try
+    {
+        return options.parse(argc, argv);
+    }
+    catch (const cxxopts::exceptions::exception& e)
+    {
+        std::cerr
+            << e.what()       << "\n"
+            << options.help() << "\n";
+            return std::nullopt;
+    }
+}
+
+auto main(int argc, const char* argv[])
+    -> int
+{
+    auto cli_options      = get_cli_options();
+    auto cli_parse_result = try_parse_cli_args(cli_options, argc, argv);
+
+    if (not cli_parse_result.has_value())
+        return 1;
+
+    auto& cli_args = cli_parse_result.value();
+
+    if (cli_args.count("help"))
+    {
+        std::cout << cli_options.help() << "\n";
+        return 0;
+    }
+
+    const josh::ResourceDatabase::RepackParams params = {
+        .max_archive_size = cli_args["max-archive-size"].as<size_t>() * 1024 * 1024,
+        .alignment        = cli_args["alignment"].as<size_t>(),
+    };
+
+    if (not std::has_single_bit(params.alignment))
+    {
+        std::cerr << "Alignment must be a power of 2.\n";
+        return 1;
+    }
+
+    try
+    {
+        auto database = josh::ResourceDatabase(cli_args["database-root"].as<std::string>());
+        const auto stats = database.repack(params);
+
+        std::cout << fmt::format(
+            "Packed {} resources ({} bytes) into {} archives. Removed {} loose files.\n",
+            stats.num_resources_packed, stats.num_bytes_packed, stats.num_archives_created, stats.num_files_removed);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -6,7 +6,7 @@ layout (location = 2) in vec2 in_uv;
 layout (std430, binding = 0) restrict readonly
 buffer InstanceDataBlock
 {
-    mat4 instance_transforms[];
+    mat3x4 instance_transforms[]; // Transposed affine model matrices.
 };
 
 uniform mat4 projection; // NOTE: "Shadow camera" params.
@@ -19,8 +19,8 @@ out      vec2 uv;
 void main()
 {
     draw_id = gl_DrawID;
-    const mat4 model = instance_transforms[draw_id];
+    const vec3 world_pos = vec4(in_pos, 1.0) * instance_transforms[draw_id];
 
     uv          = in_uv;
-    gl_Position = projection * view * model * vec4(in_pos, 1.0);
+    gl_Position = projection * view * vec4(world_pos, 1.0);
 }
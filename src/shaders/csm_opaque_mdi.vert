@@ -5,7 +5,7 @@ layout (location = 0) in vec3 in_pos;
 layout (std430, binding = 0) restrict readonly
 buffer InstanceDataBlock
 {
-    mat4 instance_transforms[];
+    mat3x4 instance_transforms[]; // Transposed affine model matrices.
 };
 
 uniform mat4 projection; // NOTE: "Shadow camera" params.
@@ -14,6 +14,6 @@ uniform mat4 view;       // "
 
 void main()
 {
-    const mat4 model = instance_transforms[gl_DrawID];
-    gl_Position = projection * view * model * vec4(in_pos, 1.0);
+    const vec3 world_pos = vec4(in_pos, 1.0) * instance_transforms[gl_DrawID];
+    gl_Position = projection * view * vec4(world_pos, 1.0);
 }
@@ -0,0 +1,29 @@
+#version 460 core
+
+in vec4 frag_pos;
+in vec3 light_pos;
+
+#ifdef ENABLE_ALPHA_TESTING
+
+in      vec2 uv;
+in flat uint draw_id;
+
+#ifndef MAX_TEXTURE_UNITS
+#define MAX_TEXTURE_UNITS 1
+#endif
+
+uniform sampler2D samplers[MAX_TEXTURE_UNITS];
+
+#endif // ENABLE_ALPHA_TESTING
+
+uniform float z_far;
+
+
+void main()
+{
+#ifdef ENABLE_ALPHA_TESTING
+    if (texture(samplers[draw_id], uv).a < 0.25) discard;
+#endif // ENABLE_ALPHA_TESTING
+
+    gl_FragDepth = length(frag_pos.xyz - light_pos) / z_far;
+}
@@ -0,0 +1,34 @@
+#version 460 core
+
+layout (location = 0) in vec3 in_pos;
+
+#ifdef ENABLE_ALPHA_TESTING
+layout (location = 2) in vec2 in_uv;
+out vec2 geom_uv;
+#endif // ENABLE_ALPHA_TESTING
+
+struct PointShadowDraw
+{
+    mat3x4 model_rows; // Transposed affine model matrix.
+    uint   face_mask;  // Bit per face of the cubemap, same order as the views.
+};
+
+layout (std430, binding = 0) restrict readonly
+buffer DrawDataBlock
+{
+    PointShadowDraw draws[];
+};
+
+out flat uint geom_draw_id;
+
+
+void main()
+{
+    geom_draw_id = gl_DrawID;
+
+#ifdef ENABLE_ALPHA_TESTING
+    geom_uv = in_uv;
+#endif // ENABLE_ALPHA_TESTING
+
+    gl_Position = /* projection * view * */ vec4(vec4(in_pos, 1.0) * draws[gl_DrawID].model_rows, 1.0);
+}
@@ -9,10 +9,10 @@ layout (location = 3) in vec3 in_tangent;
 
 struct InstanceData
 {
-    mat4  model;
-    mat3  normal_model;
-    uint  object_id;
-    float specpower;
+    mat3x4 model_rows; // Transposed affine model matrix.
+    mat3   normal_model;
+    uint   object_id;
+    float  specpower;
 };
 
 layout (std430, binding = 0) restrict readonly
@@ -33,7 +33,6 @@ void main()
 {
     draw_id = gl_DrawID;
     const InstanceData data = instances[draw_id];
-    const mat4 model        = data.model;
     const mat3 normal_model = data.normal_model;
 
     // Gram-Schmidt renormalization.
@@ -45,7 +44,7 @@ void main()
     object_id   = data.object_id;
     specpower   = data.specpower;
     uv          = in_uv;
-    frag_pos    = vec3(model * vec4(in_pos, 1.0));
+    frag_pos    = vec4(in_pos, 1.0) * data.model_rows;
     TBN         = mat3(T, B, N);
     gl_Position = camera.projview * vec4(frag_pos, 1.0);
 }
@@ -0,0 +1,52 @@
+#version 460 core
+#extension GL_GOOGLE_include_directive : enable
+#include "camera_ubo.glsl"
+
+layout (location = 0) in vec3 in_pos;
+layout (location = 1) in vec3 in_normal;
+layout (location = 2) in vec2 in_uv;
+layout (location = 3) in vec3 in_tangent;
+
+struct InstanceData
+{
+    mat3x4 model_rows; // Transposed affine model matrix.
+    mat3   normal_model;
+    uint   object_id;
+    float  specpower;
+};
+
+// All instances of all draws in the multidraw, indexed from the base instance of each draw.
+layout (std430, binding = 0) restrict readonly
+buffer InstanceDataBlock
+{
+    InstanceData instances[];
+};
+
+out flat uint  draw_id;
+out flat uint  object_id;
+out flat float specpower;
+out      vec2  uv;
+out      vec3  frag_pos;
+out      mat3  TBN;
+
+
+void main()
+{
+    // The draw_id selects the material, the instance selects the transform.
+    draw_id = gl_DrawID;
+    const InstanceData data = instances[gl_BaseInstance + gl_InstanceID];
+    const mat3 normal_model = data.normal_model;
+
+    // Gram-Schmidt renormalization.
+    vec3 T = normalize(normal_model * in_tangent);
+    vec3 N = normalize(normal_model * in_normal);
+    T = normalize(T - dot(T, N) * N);
+    vec3 B = cross(N, T);
+
+    object_id   = data.object_id;
+    specpower   = data.specpower;
+    uv          = in_uv;
+    frag_pos    = vec4(in_pos, 1.0) * data.model_rows;
+    TBN         = mat3(T, B, N);
+    gl_Position = camera.projview * vec4(frag_pos, 1.0);
+}
@@ -0,0 +1,71 @@
+#version 430 core
+
+in flat uint  draw_id;
+in flat uint  object_id;
+in flat float specpower;
+in      vec2  uv;
+in      vec3  frag_pos;
+in      mat3  TBN;
+
+#ifndef MAX_POOL_PAGES
+#define MAX_POOL_PAGES 16
+#endif
+
+uniform sampler2DArray pool_pages[MAX_POOL_PAGES];
+
+// Location of each texture of the draw in the TexturePool.
+// Ordered: diffuse, specular, normal, unused.
+struct PooledMaterial
+{
+    uvec4 pages;
+    uvec4 layers;
+    vec4  min_lods; // Base levels of the partially streamed textures.
+};
+
+layout (std430, binding = 1) restrict readonly
+buffer PooledMaterialBlock
+{
+    PooledMaterial materials[];
+};
+
+layout (location = 0) out vec3  out_normal;
+layout (location = 1) out vec3  out_albedo;
+layout (location = 2) out float out_specular;
+layout (location = 3) out uint  out_object_id;
+
+// Textures that are not set in the material use the global defaults.
+// These mirror the values of the DefaultTextures.
+const uint  no_page          = 0xFFFFFFFF;
+const vec4  default_diffuse  = vec4(vec3(0.434), 1.0); // sRGB 0xB0 in linear.
+const vec4  default_specular = vec4(0.0);
+const vec4  default_normal   = vec4(0.498, 0.498, 1.0, 1.0);
+
+
+vec4 sample_pooled(uint page, uint layer, float min_lod, vec4 fallback)
+{
+    if (page == no_page) return fallback;
+    // Clamp manually, the base level of an array texture is shared between all layers.
+    const float lod = max(textureQueryLod(pool_pages[page], uv).y, min_lod);
+    return textureLod(pool_pages[page], vec3(uv, float(layer)), lod);
+}
+
+
+void main()
+{
+    const PooledMaterial mtl = materials[draw_id];
+
+    const vec4  mat_diffuse  = sample_pooled(mtl.pages.x, mtl.layers.x, mtl.min_lods.x, default_diffuse);
+    const float mat_specular = sample_pooled(mtl.pages.y, mtl.layers.y, mtl.min_lods.y, default_specular).r;
+    const vec3  mat_normal   = sample_pooled(mtl.pages.z, mtl.layers.z, mtl.min_lods.z, default_normal).xyz;
+    const vec3  normal_ts    = mat_normal * 2.0 - 1.0;
+    const vec3  normal       = normalize(TBN * normal_ts);
+
+#ifdef ENABLE_ALPHA_TESTING
+    if (mat_diffuse.a < 0.5) discard;
+#endif // ENABLE_ALPHA_TESTING
+
+    out_normal    = gl_FrontFacing ? normal : -normal;
+    out_albedo    = mat_diffuse.rgb;
+    out_specular  = mat_specular.r;
+    out_object_id = object_id;
+}
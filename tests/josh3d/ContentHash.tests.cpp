@@ -0,0 +1,37 @@
+#include "ContentHash.hpp"
+#include "Scalars.hpp"
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <array>
+
+
+using namespace josh;
+
+
+TEST_CASE("ContentHasher matches the reference XXH64 and does not depend on how the input is split") {
+
+    CHECK(ContentHasher::xxh64("", 0)    == 0xEF46'DB37'51D8'E999);
+    CHECK(ContentHasher::xxh64("abc", 3) == 0x44BC'2CF5'AD77'0999);
+
+    std::array<ubyte, 100> bytes;
+    for (usize i = 0; i < bytes.size(); ++i)
+        bytes[i] = ubyte(i);
+
+    CHECK(ContentHasher::xxh64(bytes.data(), bytes.size(), 1) == 0x3D19'A3A2'098A'7023);
+
+    ContentHasher whole;
+    whole.update(bytes.data(), bytes.size());
+
+    ContentHasher pieces;
+    for (usize i = 0; i < bytes.size(); i += 7)
+        pieces.update(bytes.data() + i, std::min<usize>(7, bytes.size() - i));
+
+    const ContentHash digest = whole.digest();
+    CHECK(digest == pieces.digest());
+    CHECK(digest.lo == ContentHasher::xxh64(bytes.data(), bytes.size(), ContentHasher::seed_lo));
+    CHECK(digest.hi == ContentHasher::xxh64(bytes.data(), bytes.size(), ContentHasher::seed_hi));
+
+    ContentHasher other;
+    other.update(bytes.data(), bytes.size() - 1);
+    CHECK(digest != other.digest());
+}
@@ -0,0 +1,92 @@
+#include "stages/precompute/InstanceGrouping.hpp"
+#include "ECS.hpp"
+#include "Transform.hpp"
+#include "components/AlphaTested.hpp"
+#include "components/StaticMesh.hpp"
+#include "components/Visible.hpp"
+#include <doctest/doctest.h>
+#include <chrono>
+
+
+using namespace josh;
+
+
+static auto make_instance(Registry& registry, u64 mesh_id, bool visible = true, bool atested = false)
+    -> Entity
+{
+    const Entity e = registry.create();
+    auto& mesh = registry.emplace<StaticMesh>(e);
+    mesh.lods[0] = StaticMeshID{ mesh_id };
+    registry.emplace<MTransform>(e);
+    if (visible) registry.emplace<Visible>(e);
+    if (atested) registry.emplace<AlphaTested>(e);
+    return e;
+}
+
+
+TEST_CASE("group_instances() groups visible static meshes by mesh and alpha-testing") {
+
+    Registry registry;
+    const Entity a0 = make_instance(registry, 1);
+    const Entity b0 = make_instance(registry, 2);
+    const Entity a1 = make_instance(registry, 1);
+    /* hidden */      make_instance(registry, 1, false);
+    const Entity t0 = make_instance(registry, 1, true, true);
+    const Entity a2 = make_instance(registry, 1);
+
+    InstanceGroups             groups;
+    InstanceGrouping::_Scratch scratch;
+    group_instances(registry, groups, scratch);
+
+    CHECK(groups.num_instances() == 5);
+    REQUIRE(groups.opaque .size() == 2);
+    REQUIRE(groups.atested.size() == 1);
+
+    // Each group is a contiguous range, opaque groups first.
+    const auto instances_of = [&](const InstanceGroup& group) {
+        return Vector<Entity>(groups.instances.begin() + group.first,
+                              groups.instances.begin() + group.first + group.count);
+    };
+
+    for (const auto& group : groups.opaque)
+    {
+        const Array<u32, 3> defaults = { 0, 0, 0 };
+        CHECK(group.textures == defaults);
+        if (group.mesh.value == 1) CHECK(instances_of(group) == Vector<Entity>{ a0, a1, a2 });
+        if (group.mesh.value == 2) CHECK(instances_of(group) == Vector<Entity>{ b0 });
+    }
+    CHECK(groups.atested[0].first == 4);
+    CHECK(instances_of(groups.atested[0]) == Vector<Entity>{ t0 });
+
+    // Regrouping reuses the scratch and gives the same result.
+    registry.remove<Visible>(b0);
+    group_instances(registry, groups, scratch);
+    CHECK(groups.num_instances() == 4);
+    CHECK(groups.opaque.size()   == 1);
+}
+
+
+TEST_CASE("group_instances() benchmark" * doctest::skip()) {
+
+    // Run with `--no-skip` to see the numbers.
+    constexpr usize num_meshes    = 64;
+    constexpr usize num_instances = 100'000;
+
+    Registry registry;
+    for (usize i = 0; i < num_instances; ++i)
+        make_instance(registry, i % num_meshes, true, i % 8 == 0);
+
+    InstanceGroups             groups;
+    InstanceGrouping::_Scratch scratch;
+    group_instances(registry, groups, scratch); // Warm up the scratch.
+
+    constexpr usize num_runs = 32;
+    const auto start = std::chrono::steady_clock::now();
+    for (usize i = 0; i < num_runs; ++i)
+        group_instances(registry, groups, scratch);
+    const auto end = std::chrono::steady_clock::now();
+
+    const double ms = std::chrono::duration<double, std::milli>(end - start).count() / num_runs;
+    MESSAGE(num_instances, " instances into ", groups.num_groups(), " groups: ", ms, " ms");
+    CHECK(groups.num_groups() == num_meshes); // Every 8th mesh is always alpha-tested.
+}
@@ -0,0 +1,71 @@
+#include "MipChain.hpp"
+#include "ImageData.hpp"
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <iterator>
+
+
+using namespace josh;
+
+
+TEST_CASE("next_mip_resolution() halves down to 1x1") {
+
+    CHECK(next_mip_resolution({ 8, 4 }).width  == 4);
+    CHECK(next_mip_resolution({ 8, 4 }).height == 2);
+    CHECK(next_mip_resolution({ 5, 1 }).width  == 2);
+    CHECK(next_mip_resolution({ 5, 1 }).height == 1);
+}
+
+
+TEST_CASE("downsample_mip() keeps flat colors and filters in linear space") {
+
+    for (const MipFilter filter : { MipFilter::Box, MipFilter::Kaiser })
+    {
+        ImageData<ubyte> image = { { 8, 8 }, 4 };
+        for (usize i = 0; i < image.num_pixels(); ++i)
+        {
+            image.data()[i * 4 + 0] = 200;
+            image.data()[i * 4 + 1] = 100;
+            image.data()[i * 4 + 2] = 0;
+            image.data()[i * 4 + 3] = 255;
+        }
+
+        const ImageData<ubyte> mip = downsample_mip(image, { .filter = filter });
+        REQUIRE(mip.resolution().width  == 4);
+        REQUIRE(mip.resolution().height == 4);
+        for (usize i = 0; i < mip.num_pixels(); ++i)
+        {
+            CHECK(mip.data()[i * 4 + 0] == 200);
+            CHECK(mip.data()[i * 4 + 1] == 100);
+            CHECK(mip.data()[i * 4 + 2] == 0);
+            CHECK(mip.data()[i * 4 + 3] == 255);
+        }
+    }
+
+    // Black and white checker averages to ~188 in sRGB, not 128.
+    ImageData<ubyte> checker = { { 2, 2 }, 3 };
+    for (usize i = 0; i < checker.size(); ++i)
+    {
+        const usize px = i / 3;
+        checker.data()[i] = (px == 0 or px == 3) ? 255 : 0;
+    }
+
+    const ImageData<ubyte> srgb   = downsample_mip(checker, { .filter = MipFilter::Box, .srgb = true  });
+    const ImageData<ubyte> linear = downsample_mip(checker, { .filter = MipFilter::Box, .srgb = false });
+    CHECK(srgb  .data()[0] == doctest::Approx(188).epsilon(0.01));
+    CHECK(linear.data()[0] == doctest::Approx(128).epsilon(0.01));
+}
+
+
+TEST_CASE("downsample_mip() does not bleed the color of transparent texels") {
+
+    // Opaque red next to transparent green.
+    ImageData<ubyte> image = { { 2, 1 }, 4 };
+    const ubyte texels[] = { 255, 0, 0, 255,   0, 255, 0, 0 };
+    std::copy(std::begin(texels), std::end(texels), image.data());
+
+    const ImageData<ubyte> mip = downsample_mip(image, { .filter = MipFilter::Box });
+    CHECK(mip.data()[0] >= 254);
+    CHECK(mip.data()[1] <= 1);
+    CHECK(mip.data()[3] == doctest::Approx(128).epsilon(0.01));
+}
@@ -0,0 +1,130 @@
+#include "RenderGraph.hpp"
+#include "SystemKey.hpp"
+#include "TypeInfo.hpp"
+#include <doctest/doctest.h>
+
+
+using namespace josh;
+
+
+namespace {
+
+struct StageA {};
+struct StageB {};
+struct StageC {};
+struct StageD {};
+
+constexpr Extent2I resolution = { 64, 32 };
+
+auto key_of(auto stage) -> SystemKey { return { .type = type_id<decltype(stage)>() }; }
+
+} // namespace
+
+
+TEST_CASE("RenderGraph culls the stages that do not contribute to external resources") {
+
+    RenderGraph graph;
+    graph.compile({
+        { key_of(StageA()), StageResources()
+            .creates("T0"_hs, { resolution, InternalFormat::RGBA8 }) },
+        { key_of(StageB()), StageResources()
+            .creates("T1"_hs, { resolution, InternalFormat::RGBA8 }) },
+        { key_of(StageC()), StageResources()
+            .reads("T0"_hs)
+            .writes(resource_main_target) },
+    });
+
+    CHECK(not graph.is_culled(key_of(StageA())));
+    CHECK(    graph.is_culled(key_of(StageB())));
+    CHECK(not graph.is_culled(key_of(StageC())));
+    CHECK(not graph.is_culled(key_of(StageD()))); // Not in the graph.
+
+    CHECK(graph.stats().num_culled     == 1);
+    CHECK(graph.stats().num_transients == 1);
+}
+
+TEST_CASE("RenderGraph keeps everything before an undeclared stage") {
+
+    RenderGraph graph;
+    graph.compile({
+        { key_of(StageA()), StageResources()
+            .creates("T0"_hs, { resolution, InternalFormat::RGBA8 }) },
+        { key_of(StageB()), {} },
+    });
+
+    CHECK(not graph.is_culled(key_of(StageA())));
+    CHECK(not graph.is_culled(key_of(StageB())));
+}
+
+TEST_CASE("RenderGraph aliases transients of the same view class with disjoint lifetimes") {
+
+    RenderGraph graph;
+    graph.compile({
+        { key_of(StageA()), StageResources()
+            .creates("T0"_hs, { resolution, InternalFormat::RGBA8 }) },
+        { key_of(StageB()), StageResources()
+            .reads("T0"_hs)
+            .creates("T1"_hs, { resolution, InternalFormat::R11F_G11F_B10F }) },
+        { key_of(StageC()), StageResources()
+            .reads("T1"_hs)
+            .creates("T2"_hs, { resolution, InternalFormat::R32F }) },
+        { key_of(StageD()), StageResources()
+            .reads("T2"_hs)
+            .writes(resource_main_target) },
+    });
+
+    // T0 and T1 overlap at B, T1 and T2 overlap at C, but T2 can reuse T0.
+    CHECK(graph.stats().num_transients  == 3);
+    CHECK(graph.stats().num_textures    == 2);
+    CHECK(graph.stats().declared_bytes  == 3 * 64 * 32 * 4);
+    CHECK(graph.stats().allocated_bytes == 2 * 64 * 32 * 4);
+}
+
+TEST_CASE("RenderGraph does not alias across view classes") {
+
+    RenderGraph graph;
+    graph.compile({
+        { key_of(StageA()), StageResources()
+            .creates("T0"_hs, { resolution, InternalFormat::RGB8 }) },
+        { key_of(StageB()), StageResources()
+            .reads("T0"_hs)
+            .writes(resource_main_target) },
+        { key_of(StageC()), StageResources()
+            .creates("T1"_hs, { resolution, InternalFormat::RGBA8 }) },
+        { key_of(StageD()), StageResources()
+            .reads("T1"_hs)
+            .writes(resource_main_target) },
+    });
+
+    CHECK(graph.stats().num_textures == 2);
+}
+
+TEST_CASE("RenderGraph only issues barriers after image stores") {
+
+    RenderGraph graph;
+    graph.compile({
+        { key_of(StageA()), StageResources()
+            .creates("T0"_hs, { resolution, InternalFormat::RGBA8 })
+            .writes("T0"_hs, GPUAccess::Image) },
+        { key_of(StageB()), StageResources()
+            .reads("T0"_hs, GPUAccess::Sampler)
+            .creates("T1"_hs, { resolution, InternalFormat::RGBA8 }) },
+        { key_of(StageC()), StageResources()
+            .reads("T0"_hs, GPUAccess::Sampler)
+            .reads("T1"_hs, GPUAccess::Sampler)
+            .writes(resource_main_target) },
+    });
+
+    CHECK(graph.barriers_before(key_of(StageA())) == BarrierMask{});
+    CHECK(graph.barriers_before(key_of(StageB())) == BarrierMask::TextureFetchBit);
+    CHECK(graph.barriers_before(key_of(StageC())) == BarrierMask{}); // Already issued.
+}
+
+TEST_CASE("RenderGraph rejects transients created twice") {
+
+    RenderGraph graph;
+    CHECK_THROWS(graph.compile({
+        { key_of(StageA()), StageResources().creates("T0"_hs, { resolution, InternalFormat::R8 }) },
+        { key_of(StageB()), StageResources().creates("T0"_hs, { resolution, InternalFormat::R8 }) },
+    }));
+}
@@ -0,0 +1,86 @@
+#include "ContentHash.hpp"
+#include "Filesystem.hpp"
+#include "HashedString.hpp"
+#include "ResourceDatabase.hpp"
+#include "ScopeExit.hpp"
+#include "UUID.hpp"
+#include <doctest/doctest.h>
+#include <filesystem>
+
+
+using namespace josh;
+
+
+TEST_CASE("ResourceDatabase persists the content index, and drops the records of removed resources") {
+
+    const Path root = std::filesystem::temp_directory_path() / "josh3d-ResourceDatabase.tests";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    const auto cleanup = [&]{ std::error_code ec; std::filesystem::remove_all(root, ec); };
+    DEFER(cleanup());
+
+    const Path contents_path = root / "contents.jdb";
+    const Path tmp_path      = root / "contents.jdb.tmp";
+
+    constexpr ResourceType texture  = "Texture"_hs;
+    constexpr ResourceType material = "Material"_hs;
+
+    const ContentHash hash_a = { .lo = 1, .hi = 2 };
+    const ContentHash hash_b = { .lo = 3, .hi = 4 };
+
+    UUID a, b;
+    {
+        ResourceDatabase database{ root };
+        a = database.generate_resource(texture, { .directory="test", .name="a", .extension="bin" }, 16).uuid;
+        b = database.generate_resource(texture, { .directory="test", .name="b", .extension="bin" }, 16).uuid;
+
+        CHECK(database.find_by_content(texture, hash_a) == nullopt);
+
+        database.record_content(a, hash_a);
+        database.record_content(b, hash_b);
+        database.record_content(generate_uuid(), hash_b); // Not in the database, ignored.
+
+        CHECK(database.find_by_content(texture, hash_a) == a);
+        CHECK(database.find_by_content(texture, hash_b) == b);
+    }
+
+    CHECK(std::filesystem::file_size(contents_path) == 2 * sizeof(ContentRecord));
+
+    {
+        ResourceDatabase database{ root };
+
+        CHECK(database.find_by_content(texture,  hash_a) == a);
+        CHECK(database.find_by_content(texture,  hash_b) == b);
+        CHECK(database.find_by_content(material, hash_a) == nullopt);
+        CHECK(database.find_by_content(texture,  { .lo = 5, .hi = 6 }) == nullopt);
+
+        // Nothing stale, nothing to compact.
+        CHECK(std::filesystem::file_size(contents_path) == 2 * sizeof(ContentRecord));
+
+        CHECK(database.try_remove_resource(b) == ResourceDatabase::RemoveResourceOutcome::Success);
+        CHECK(database.find_by_content(texture, hash_b) == nullopt);
+    }
+
+    // The record of the removed resource is still in the file until the next load.
+    CHECK(std::filesystem::file_size(contents_path) == 2 * sizeof(ContentRecord));
+
+    {
+        ResourceDatabase database{ root };
+
+        CHECK(database.find_by_content(texture, hash_a) == a);
+        CHECK(database.find_by_content(texture, hash_b) == nullopt);
+
+        // Compacted through the temporary, which is gone after the rename.
+        CHECK(std::filesystem::file_size(contents_path) == sizeof(ContentRecord));
+        CHECK(not std::filesystem::exists(tmp_path));
+
+        // Still appendable after the compaction.
+        database.record_content(a, hash_b);
+    }
+
+    {
+        ResourceDatabase database{ root };
+        CHECK(database.find_by_content(texture, hash_a) == a);
+        CHECK(database.find_by_content(texture, hash_b) == a);
+    }
+}
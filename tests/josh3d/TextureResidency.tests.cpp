@@ -0,0 +1,67 @@
+#include "TextureResidency.hpp"
+#include "UUID.hpp"
+#include <doctest/doctest.h>
+
+
+using namespace josh;
+
+
+TEST_CASE("TextureResidency keeps the resident mips within the budget and drops the largest excess first") {
+
+    // 4 mips of a 8x8 texture at one byte per texel: 64, 16, 4, 1.
+    const usize    mip_bytes[] = { 64, 16, 4, 1 };
+    const Extent2I resolution  = { 8, 8 };
+
+    const UUID a = generate_uuid();
+    const UUID b = generate_uuid();
+
+    TextureResidency residency;
+
+    residency.track(a, resolution, mip_bytes);
+    residency.track(b, resolution, mip_bytes);
+
+    // Disabled, everything is loaded fully.
+    CHECK(residency.target(a) == 0);
+
+    residency.set_enabled(true);
+    residency.set_budget(200);
+
+    // Nothing demanded yet, the coarsest mip first.
+    CHECK(residency.target(a) == 3);
+
+    // A texel per pixel needs mip 0 for 8 pixels, mip 1 for 4, mip 3 for 1.
+    residency.demand(a, 8.f);
+    residency.demand(b, 4.f);
+    residency.update();
+
+    // Only streams up as far as demanded.
+    CHECK(residency.target(a) == 0);
+    CHECK(residency.target(b) == 1);
+
+    residency.set_resident(a, 0);
+    residency.set_resident(b, 1);
+
+    // Parked at the target, released once it changes.
+    auto parked = residency.until_target_differs(a, 0);
+    CHECK(not is_ready(parked));
+
+    // Not demanded anymore, but fits the budget, so stays resident.
+    residency.update();
+    CHECK(residency.target(a) == 0);
+    CHECK(residency.target(b) == 1);
+    CHECK(not is_ready(parked));
+
+    // Over budget now, drops the one with the most bytes above the demand.
+    residency.set_budget(50);
+    residency.update();
+    CHECK(residency.target(a) == 3);
+    CHECK(residency.target(b) == 1);
+    CHECK(is_ready(parked));
+
+    // Disabling releases everyone and goes back to full loading.
+    auto parked_b = residency.until_target_differs(b, 1);
+    CHECK(not is_ready(parked_b));
+    residency.set_enabled(false);
+    CHECK(is_ready(parked_b));
+    CHECK(residency.target(b) == 0);
+}
@@ -32,3 +32,46 @@ TEST_CASE("Transform and MTransform result model matrices are equivalent") {
 
 }
 
+
+TEST_CASE("AffineTransform matches the MTransform it was made from") {
+
+    constexpr glm::vec3 trans{ 4.f, -2.5f, 0.7f };
+    const     glm::quat rot  { glm::vec3{ pi / 5.f, pi * 0.3f, -pi / 9.f } };
+
+    const auto check_same = [](const glm::mat3& a, const glm::mat3& b) {
+        for (size_t i{ 0 }; i < 3; ++i) {
+            for (size_t j{ 0 }; j < 3; ++j) {
+                INFO("(Row, Column): ("<< j << ", " << i << ")");
+                CHECK(a[i][j] == doctest::Approx(b[i][j]).epsilon(1e-4));
+            }
+        }
+    };
+
+    SUBCASE("Uniform scale") {
+        const MTransform      mtf = MTransform().translate(trans).rotate(rot).scale(glm::vec3{ 2.5f });
+        const AffineTransform atf = AffineTransform::from_model(mtf.model());
+
+        CHECK(atf.uniform_scale);
+        check_same(atf.normal_model, mtf.normal_model());
+
+        const glm::vec4 p     = { 0.3f, -1.2f, 5.f, 1.f };
+        const glm::vec3 world = p * atf.rows; // As in the shaders.
+        const glm::vec3 ref   = glm::vec3(mtf.model() * p);
+        CHECK(world.x == doctest::Approx(ref.x));
+        CHECK(world.y == doctest::Approx(ref.y));
+        CHECK(world.z == doctest::Approx(ref.z));
+    }
+
+    SUBCASE("Non-uniform scale") {
+        const MTransform      mtf = MTransform().translate(trans).rotate(rot).scale(glm::vec3{ 0.3f, 1.7f, 0.95f });
+        const AffineTransform atf = AffineTransform::from_model(mtf.model());
+
+        CHECK(not atf.uniform_scale);
+        check_same(atf.normal_model, mtf.normal_model());
+
+        const glm::mat4 model = atf.model();
+        for (size_t i{ 0 }; i < 4; ++i)
+            for (size_t j{ 0 }; j < 4; ++j)
+                CHECK(model[i][j] == doctest::Approx(mtf.model()[i][j]));
+    }
+}